@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ * @file    bench_dma_regs.c
+ * @author  IC Simulator Team
+ * @brief   DMA Plugin Register Access Benchmarks
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
+
+#include "simulator/plugin_interface.h"
+#include "common/register_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_MIN_TIME_NS       200000000ULL   /* Run each case for at least 200ms */
+#define BENCH_BATCH             1024U          /* Accesses per timing sample */
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    const char *name;
+    uint32_t addr;
+    int write;
+} bench_access_t;
+
+/* Simulator hooks the plugin links against ----------------------------------*/
+
+int trigger_interrupt(const char *module, uint32_t irq_num)
+{
+    (void)module;
+    (void)irq_num;
+    return 0;
+}
+
+void* get_mapped_range(uint32_t addr, uint32_t len)
+{
+    (void)addr;
+    (void)len;
+    return NULL;
+}
+
+int sim_bus_read(uint32_t addr, uint32_t *value)
+{
+    (void)addr;
+    *value = 0;
+    return -1;
+}
+
+int sim_bus_write(uint32_t addr, uint32_t value)
+{
+    (void)addr;
+    (void)value;
+    return -1;
+}
+
+extern simulator_plugin_t* create_dma_plugin_multi_instance(const char *instance_name, int instance_id);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Monotonic time in nanoseconds
+ */
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  Mean cost of one plugin register access in ns
+ */
+static double bench_access(simulator_plugin_t *plugin, const bench_access_t *access)
+{
+    volatile uint32_t sink = 0;
+    uint64_t iterations = 0;
+    uint64_t start = bench_now_ns();
+    uint64_t elapsed;
+
+    do {
+        for (uint32_t i = 0; i < BENCH_BATCH; i++) {
+            if (access->write) {
+                plugin->reg_write(plugin, access->addr, i);
+            } else {
+                sink += plugin->reg_read(plugin, access->addr);
+            }
+        }
+        iterations += BENCH_BATCH;
+        elapsed = bench_now_ns() - start;
+    } while (elapsed < BENCH_MIN_TIME_NS);
+
+    (void)sink;
+    return (double)elapsed / (double)iterations;
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(void)
+{
+    simulator_plugin_t *plugin = create_dma_plugin_multi_instance("dma0", 0);
+    const bench_access_t accesses[] = {
+        { "read  IntStatus",         DMA_INT_STATUS_REG,                 0 },
+        { "write IntTCClear",        DMA_INT_CLEAR_REG,                  1 },
+        { "read  ch0 SrcAddr",       DMA_CH_SRC_REG(0),                  0 },
+        { "write ch0 DestAddr",      DMA_CH_DST_REG(0),                  1 },
+        { "read  ch15 Rows",         DMA_CH_ROWS_REG(15),                0 },
+        { "write ch15 Stride",       DMA_CH_STRIDE_REG(15),              1 },
+    };
+    double total = 0.0;
+
+    if (plugin == NULL || plugin->init(plugin) != 0) {
+        printf("Failed to create DMA plugin\n");
+        return 1;
+    }
+
+    printf("DMA plugin register access cost\n");
+    for (size_t i = 0; i < sizeof(accesses) / sizeof(accesses[0]); i++) {
+        double ns = bench_access(plugin, &accesses[i]);
+        total += ns;
+        printf("  %-22s %8.1f ns/access\n", accesses[i].name, ns);
+    }
+    printf("  %-22s %8.1f ns/access\n", "mean",
+           total / (double)(sizeof(accesses) / sizeof(accesses[0])));
+
+    plugin->cleanup(plugin);
+    free(plugin);
+    return 0;
+}
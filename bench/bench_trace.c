@@ -0,0 +1,467 @@
+/**
+ ******************************************************************************
+ * @file    bench_trace.c
+ * @author  IC Simulator Team
+ * @brief   Trace-Driven Plugin Benchmarks
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ *
+ * Usage: bench_trace TRACE
+ *        bench_trace --synthesize TRACE [FRAMES]
+ *
+ * Replays the register accesses of a trace straight into the plugin manager:
+ * no traps, no signals, no driver. TRACE is a log written by
+ * `ic_simulator --record FILE`, or a synthetic one written with --synthesize.
+ * Trapped accesses and device inputs are pre-decoded into sim_message_t
+ * batches per module before timing, so the loop measures the device models
+ * and handle_sim_message dispatch only. Plugin logging is discarded; the
+ * allocations made by simulator code are counted through the
+ * linker's --wrap of malloc/calloc/realloc/free.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
+
+#include "simulator/plugin_interface.h"
+#include "sim_interface/replay_log.h"
+#include "common/register_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_MIN_TIME_NS       200000000ULL   /* Run each case for at least 200ms */
+#define BENCH_BATCH             4096U          /* Messages per timing sample */
+#define BENCH_SCRATCH_SIZE      (16U * 1024U * 1024U)  /* Host memory behind DMA bus addresses */
+#define BENCH_SYNTH_FRAMES      10000U
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    sim_message_t *msgs;
+    size_t count;
+    size_t capacity;
+} bench_batch_t;
+
+typedef struct {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t bytes;
+} bench_alloc_stats_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t *g_scratch;
+static bench_alloc_stats_t g_alloc;
+static uint64_t g_irqs;
+
+/* Allocation counters (-Wl,--wrap=malloc,...) -------------------------------*/
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+    __atomic_fetch_add(&g_alloc.allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc.bytes, size, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    __atomic_fetch_add(&g_alloc.allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc.bytes, nmemb * size, __ATOMIC_RELAXED);
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    __atomic_fetch_add(&g_alloc.allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_alloc.bytes, size, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr != NULL) {
+        __atomic_fetch_add(&g_alloc.frees, 1, __ATOMIC_RELAXED);
+    }
+    __real_free(ptr);
+}
+
+/* Simulator hooks the plugins link against ----------------------------------*/
+
+int trigger_interrupt(const char *module, uint32_t irq_num)
+{
+    (void)module;
+    (void)irq_num;
+    __atomic_fetch_add(&g_irqs, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/* Device inputs come from the trace; the UART monitor thread's are dropped */
+int sim_device_input(const char *module, uint32_t channel, uint32_t value)
+{
+    (void)module;
+    (void)channel;
+    (void)value;
+    return 0;
+}
+
+/* Every bus address aliases into one scratch buffer so DMA transfers copy real memory */
+void* get_mapped_range(uint32_t addr, uint32_t len)
+{
+    uint32_t offset = addr & (BENCH_SCRATCH_SIZE - 1U);
+
+    if (len > BENCH_SCRATCH_SIZE - offset) {
+        return NULL;
+    }
+    return g_scratch + offset;
+}
+
+int sim_bus_read(uint32_t addr, uint32_t *value)
+{
+    uint32_t *ptr = get_mapped_range(addr, sizeof(*value));
+
+    if (ptr == NULL) {
+        return -1;
+    }
+    memcpy(value, ptr, sizeof(*value));
+    return 0;
+}
+
+int sim_bus_write(uint32_t addr, uint32_t value)
+{
+    uint32_t *ptr = get_mapped_range(addr, sizeof(value));
+
+    if (ptr == NULL) {
+        return -1;
+    }
+    memcpy(ptr, &value, sizeof(value));
+    return 0;
+}
+
+/* No virtual time outside the simulator: the UART idle timeout never fires */
+uint64_t sim_vtime_now(void)
+{
+    return 0;
+}
+
+int sim_vtimer_create(void (*fn)(void *ctx, uint64_t vtime_ns), void *ctx)
+{
+    (void)fn;
+    (void)ctx;
+    return -1;
+}
+
+void sim_vtimer_arm(int id, uint64_t deadline_ns)
+{
+    (void)id;
+    (void)deadline_ns;
+}
+
+void sim_vtimer_destroy(int id)
+{
+    (void)id;
+}
+
+extern int register_plugin(simulator_plugin_t *plugin);
+extern simulator_plugin_t* find_plugin(const char *name);
+extern void cleanup_plugins(void);
+extern int handle_sim_message(const sim_message_t *msg, sim_message_t *response);
+extern simulator_plugin_t* create_uart_plugin_multi_instance(const char *instance_name, int instance_id);
+extern simulator_plugin_t* create_dma_plugin_multi_instance(const char *instance_name, int instance_id);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Monotonic time in nanoseconds
+ */
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  Send plugin logging (stdout, including monitor threads) to /dev/null
+ * @retval Stream on the original stdout for the report
+ */
+static FILE* bench_redirect_logs(void)
+{
+    int report_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    FILE *report;
+
+    if (report_fd < 0 || null_fd < 0 || (report = fdopen(report_fd, "w")) == NULL) {
+        return stdout;
+    }
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+    return report;
+}
+
+/**
+ * @brief  Append one message to a batch
+ */
+static int batch_push(bench_batch_t *batch, const sim_message_t *msg)
+{
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2U : BENCH_BATCH;
+        sim_message_t *msgs = realloc(batch->msgs, capacity * sizeof(*msgs));
+        if (msgs == NULL) {
+            return -1;
+        }
+        batch->msgs = msgs;
+        batch->capacity = capacity;
+    }
+    batch->msgs[batch->count++] = *msg;
+    return 0;
+}
+
+/**
+ * @brief  Create and register the plugin a trace module name refers to
+ */
+static simulator_plugin_t* bench_create_plugin(const char *name)
+{
+    size_t len = strlen(name);
+    int instance_id = (len > 0 && name[len - 1] >= '0' && name[len - 1] <= '9') ? name[len - 1] - '0' : 0;
+    simulator_plugin_t *plugin = NULL;
+
+    if (strncmp(name, "uart", 4) == 0) {
+        plugin = create_uart_plugin_multi_instance(name, instance_id);
+    } else if (strncmp(name, "dma", 3) == 0) {
+        plugin = create_dma_plugin_multi_instance(name, instance_id);
+    }
+    if (plugin == NULL || register_plugin(plugin) != 0) {
+        return NULL;
+    }
+    return plugin;
+}
+
+/**
+ * @brief  Pre-decode trapped accesses and inputs into per-module batches
+ *         (batches[module_count] holds the whole trace in order)
+ */
+static int bench_load_trace(replay_reader_t *reader, bench_batch_t *batches)
+{
+    const replay_log_header_t *header = replay_reader_header(reader);
+    replay_event_t ev;
+    int rc;
+
+    while ((rc = replay_reader_next(reader, &ev)) == 1) {
+        sim_message_t msg;
+
+        if (ev.type != REPLAY_EV_TRAP && ev.type != REPLAY_EV_INPUT) {
+            continue;
+        }
+        memset(&msg, 0, sizeof(msg));
+        strcpy(msg.module, header->modules[ev.module]);
+        msg.value = ev.value;
+        if (ev.type == REPLAY_EV_TRAP) {
+            msg.type = ev.is_write ? MSG_REG_WRITE : MSG_REG_READ;
+            msg.address = ev.address;
+        } else {
+            msg.type = MSG_INPUT;
+            msg.data.input.channel = ev.channel;
+        }
+        if (batch_push(&batches[ev.module], &msg) != 0 ||
+            batch_push(&batches[header->module_count], &msg) != 0) {
+            return -1;
+        }
+    }
+    return rc;
+}
+
+/**
+ * @brief  Drive one batch through the plugin manager; returns ns/op
+ */
+static double bench_run(const bench_batch_t *batch, bench_alloc_stats_t *alloc, uint64_t *ops)
+{
+    sim_message_t response;
+    uint64_t iterations = 0;
+    uint64_t start;
+    uint64_t elapsed;
+    bench_alloc_stats_t before;
+
+    before = g_alloc;
+    start = bench_now_ns();
+    do {
+        for (size_t i = 0; i < batch->count; i += BENCH_BATCH) {
+            size_t end = (i + BENCH_BATCH < batch->count) ? i + BENCH_BATCH : batch->count;
+            for (size_t j = i; j < end; j++) {
+                handle_sim_message(&batch->msgs[j], &response);
+            }
+        }
+        iterations += batch->count;
+        elapsed = bench_now_ns() - start;
+    } while (elapsed < BENCH_MIN_TIME_NS);
+    alloc->allocs = g_alloc.allocs - before.allocs;
+    alloc->frees = g_alloc.frees - before.frees;
+    alloc->bytes = g_alloc.bytes - before.bytes;
+
+    *ops = iterations;
+    return (double)elapsed / (double)iterations;
+}
+
+/**
+ * @brief  Write a synthetic trace: UART polled transmit interleaved with DMA
+ *         channel programming and completion handling, as the drivers do
+ */
+static int bench_synthesize(const char *path, uint32_t frames)
+{
+    replay_log_header_t header;
+    replay_writer_t *writer;
+    replay_event_t ev;
+    int rc = 0;
+
+    memset(&header, 0, sizeof(header));
+    header.trap_ns = 100;
+    header.snapshot_interval = 0;
+    header.module_count = 2;
+    strcpy(header.modules[0], "uart0");
+    strcpy(header.modules[1], "dma0");
+
+    writer = replay_writer_open(path, &header);
+    if (writer == NULL) {
+        return -1;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.type = REPLAY_EV_TRAP;
+
+#define SYNTH_ACCESS(mod, wr, addr, val)                      \
+    do {                                                      \
+        ev.vtime += header.trap_ns;                           \
+        ev.module = (mod);                                    \
+        ev.is_write = (wr);                                   \
+        ev.address = (uint32_t)(addr);                        \
+        ev.value = (uint32_t)(val);                           \
+        rc |= replay_writer_append(writer, &ev);              \
+    } while (0)
+
+    SYNTH_ACCESS(0, true, UART_CTRL_REG, UART_CR_UARTEN);
+    SYNTH_ACCESS(1, true, DMA_GLOBAL_CTRL_REG, 1U);
+    for (uint32_t f = 0; f < frames && rc == 0; f++) {
+        uint32_t ch = f % 8U;
+
+        SYNTH_ACCESS(0, false, UART_STATUS_REG, 0U);
+        SYNTH_ACCESS(0, true, UART_TX_REG, 'a' + f % 26U);
+        SYNTH_ACCESS(1, true, DMA_CH_SRC_REG(ch), SRAM_BASE + ch * 0x1000U);
+        SYNTH_ACCESS(1, true, DMA_CH_DST_REG(ch), SRAM_BASE + 0x80000U + ch * 0x1000U);
+        SYNTH_ACCESS(1, true, DMA_CH_CTRL_REG(ch), 256U);
+        SYNTH_ACCESS(1, true, DMA_CH_CONFIG_REG(ch), DMA_CCFG_E | DMA_CCFG_ITC | DMA_CCFG_SINC | DMA_CCFG_DINC);
+        SYNTH_ACCESS(1, false, DMA_INT_STATUS_REG, 0U);
+        SYNTH_ACCESS(1, true, DMA_INT_CLEAR_REG, 1U << ch);
+        SYNTH_ACCESS(0, false, UART_STATUS_REG, 0U);
+    }
+
+#undef SYNTH_ACCESS
+
+    if (replay_writer_close(writer) != 0) {
+        rc = -1;
+    }
+    return rc;
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 3 && strcmp(argv[1], "--synthesize") == 0) {
+        uint32_t frames = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : BENCH_SYNTH_FRAMES;
+        if (bench_synthesize(argv[2], frames) != 0) {
+            printf("Failed to write synthetic trace %s\n", argv[2]);
+            return 1;
+        }
+        printf("Wrote synthetic trace %s (%u frames)\n", argv[2], frames);
+        return 0;
+    }
+    if (argc != 2) {
+        printf("Usage: %s TRACE\n       %s --synthesize TRACE [FRAMES]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    replay_reader_t *reader = replay_reader_open(argv[1]);
+    if (reader == NULL) {
+        return 1;
+    }
+    const replay_log_header_t *header = replay_reader_header(reader);
+    bench_batch_t batches[REPLAY_MAX_MODULES + 1];
+    simulator_plugin_t *plugins[REPLAY_MAX_MODULES];
+    int rc = 0;
+
+    memset(batches, 0, sizeof(batches));
+    g_scratch = calloc(1, BENCH_SCRATCH_SIZE);
+    if (g_scratch == NULL || bench_load_trace(reader, batches) != 0) {
+        printf("Failed to load trace %s\n", argv[1]);
+        rc = 1;
+        goto out;
+    }
+
+    FILE *report = bench_redirect_logs();
+    for (uint32_t m = 0; m < header->module_count; m++) {
+        plugins[m] = batches[m].count ? bench_create_plugin(header->modules[m]) : NULL;
+    }
+
+    fprintf(report, "Trace-driven plugin cost: %s, %zu messages\n", argv[1], batches[header->module_count].count);
+    fprintf(report, "  %-10s %10s %10s %12s %12s\n", "plugin", "messages", "ns/op", "allocs/op", "bytes/op");
+    for (uint32_t m = 0; m <= header->module_count; m++) {
+        const char *name = (m < header->module_count) ? header->modules[m] : "all";
+        bench_alloc_stats_t alloc;
+        uint64_t ops;
+        double ns;
+
+        if (batches[m].count == 0) {
+            continue;
+        }
+        if (m < header->module_count && plugins[m] == NULL) {
+            fprintf(report, "  %-10s %10zu   (no device model, skipped)\n", name, batches[m].count);
+            continue;
+        }
+        if (m == header->module_count) {
+            /* Messages for modules without a model only cost the lookup failure */
+            size_t kept = 0;
+            for (size_t i = 0; i < batches[m].count; i++) {
+                if (find_plugin(batches[m].msgs[i].module) != NULL) {
+                    batches[m].msgs[kept++] = batches[m].msgs[i];
+                }
+            }
+            batches[m].count = kept;
+        }
+        ns = bench_run(&batches[m], &alloc, &ops);
+        fprintf(report, "  %-10s %10zu %10.1f %12.4f %12.1f\n", name, batches[m].count, ns,
+               (double)alloc.allocs / (double)ops, (double)alloc.bytes / (double)ops);
+    }
+    fprintf(report, "  %llu interrupts raised by the models\n", (unsigned long long)g_irqs);
+    fflush(report);
+
+    cleanup_plugins();
+
+out:
+    for (uint32_t m = 0; m <= REPLAY_MAX_MODULES; m++) {
+        free(batches[m].msgs);
+    }
+    free(g_scratch);
+    replay_reader_close(reader);
+    return rc;
+}
@@ -0,0 +1,830 @@
+/**
+ ******************************************************************************
+ * @file    fuzz_devices.c
+ * @author  IC Simulator Team
+ * @brief   Snapshot-Reset Fuzzing Harness for the Device Models
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ *
+ * Usage: fuzz_devices [-runs N] [-max_total_time S] [-seed N] [-max_len N]
+ *                     [-artifact_prefix P] OUT_CORPUS [SEED_CORPUS...]
+ *
+ * Each input is decoded into a sequence of register accesses, interrupt
+ * service points, clock ticks and UART RX bytes, and driven into the uart0
+ * and dma0 models through handle_sim_message. Between executions the
+ * simulator is reset to a snapshot taken after initialization:
+ *   - device state through the plugins' save_state/load_state
+ *   - bus memory (the 1MB SRAM window DMA transfers reach) through dirty-page
+ *     tracking: the window stays write-protected, the first write to a page
+ *     faults, marks it dirty and unprotects it, and the reset copies back only
+ *     the dirty pages
+ * The device models are built with -fsanitize-coverage=trace-pc; inputs that
+ * reach new edges are kept in memory and written to OUT_CORPUS. A crash in a
+ * model writes the input to <artifact_prefix>crash-<hash> and aborts.
+ *
+ * LLVMFuzzerTestOneInput is exported as well, so the same target links
+ * against libFuzzer when built with -DFUZZ_NO_MAIN.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+
+#include "simulator/plugin_interface.h"
+#include "common/register_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Private define ------------------------------------------------------------*/
+#define FUZZ_MEM_BASE           SRAM_BASE
+#define FUZZ_MEM_SIZE           SRAM_SIZE
+#define FUZZ_PAGE_SIZE          4096U
+#define FUZZ_PAGES              (FUZZ_MEM_SIZE / FUZZ_PAGE_SIZE)
+#define FUZZ_STATE_SIZE         4096U
+#define FUZZ_MAP_SIZE           65536U          /* Edge coverage map */
+#define FUZZ_MAX_LEN_DEFAULT    512U
+#define FUZZ_MAX_CORPUS         4096U
+#define FUZZ_MAX_OPS            256U            /* Ops decoded per input */
+#define FUZZ_REPORT_NS          1000000000ULL
+#define FUZZ_MAX_TRANSFER       4096U           /* DMA size/row bytes written by inputs */
+#define FUZZ_MAX_ROWS           16U
+
+/* Op kinds (low 3 bits of the op byte) */
+#define FUZZ_OP_WRITE           0U
+#define FUZZ_OP_WRITE_ADDR      1U              /* Write a value inside the SRAM window */
+#define FUZZ_OP_READ            2U
+#define FUZZ_OP_SERVICE_IRQ     3U              /* Run the generic ISR for raised interrupts */
+#define FUZZ_OP_RX_DATA         4U
+#define FUZZ_OP_CLOCK           5U
+#define FUZZ_OP_INTERRUPT       6U              /* MSG_INTERRUPT to the model */
+#define FUZZ_OP_CHANNEL         7U              /* Program and start a DMA channel */
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+} fuzz_input_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} fuzz_entry_t;
+
+typedef struct {
+    const char *name;
+    uint32_t base;
+    uint32_t window;
+} fuzz_device_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const fuzz_device_t g_devices[] = {
+    { "uart0", UART0_BASE, 0x60U },
+    { "dma0",  DMA0_BASE,  0x300U },
+};
+#define FUZZ_DEVICE_COUNT (sizeof(g_devices) / sizeof(g_devices[0]))
+
+static simulator_plugin_t *g_plugins[FUZZ_DEVICE_COUNT];
+static uint8_t g_state[FUZZ_DEVICE_COUNT][FUZZ_STATE_SIZE];
+static size_t g_state_len[FUZZ_DEVICE_COUNT];
+
+/* Bus memory and its snapshot; g_dirty lists pages written since the last reset */
+static uint8_t *g_mem;
+static uint8_t *g_mem_snapshot;
+static uint32_t g_dirty[FUZZ_PAGES];
+static uint32_t g_dirty_count;
+static uint8_t g_dirty_flag[FUZZ_PAGES];
+
+/* Interrupts raised since the last service point, per device */
+static uint32_t g_irq_pending[FUZZ_DEVICE_COUNT];
+
+/* Edge coverage from -fsanitize-coverage=trace-pc; g_cov_words has a bit per
+ * 8-byte word of g_cov holding a hit, so the merge skips untouched words */
+static uint8_t g_cov[FUZZ_MAP_SIZE];
+static uint8_t g_cov_seen[FUZZ_MAP_SIZE];
+static uint64_t g_cov_words[FUZZ_MAP_SIZE / 8U / 64U];
+static __thread uintptr_t t_prev_loc;
+
+/* The input being executed, written out if a model crashes */
+static const uint8_t *g_current_data;
+static size_t g_current_size;
+static const char *g_artifact_prefix = "./";
+static FILE *g_report;
+static uint64_t g_pages_restored;
+
+/* Coverage callback ---------------------------------------------------------*/
+
+void __sanitizer_cov_trace_pc(void)
+{
+    uintptr_t loc = (uintptr_t)__builtin_return_address(0);
+
+    loc = (loc ^ (loc >> 16)) & (FUZZ_MAP_SIZE - 1U);
+    uintptr_t edge = loc ^ t_prev_loc;
+    if (!g_cov[edge]) {
+        g_cov[edge] = 1;
+        g_cov_words[edge / 512U] |= 1ULL << ((edge / 8U) % 64U);
+    }
+    t_prev_loc = loc >> 1;
+}
+
+/* Simulator hooks the plugins link against ----------------------------------*/
+
+int trigger_interrupt(const char *module, uint32_t irq_num)
+{
+    for (size_t i = 0; i < FUZZ_DEVICE_COUNT; i++) {
+        if (strcmp(g_devices[i].name, module) == 0) {
+            __atomic_fetch_or(&g_irq_pending[i], 1U << (irq_num & 31U), __ATOMIC_RELAXED);
+        }
+    }
+    return 0;
+}
+
+/* RX bytes come from the input; the UART monitor thread's are dropped */
+int sim_device_input(const char *module, uint32_t channel, uint32_t value)
+{
+    (void)module;
+    (void)channel;
+    (void)value;
+    return 0;
+}
+
+void* get_mapped_range(uint32_t addr, uint32_t len)
+{
+    if (addr < FUZZ_MEM_BASE || len > FUZZ_MEM_SIZE || addr - FUZZ_MEM_BASE > FUZZ_MEM_SIZE - len) {
+        return NULL;
+    }
+    return g_mem + (addr - FUZZ_MEM_BASE);
+}
+
+int sim_bus_read(uint32_t addr, uint32_t *value)
+{
+    uint8_t *ptr = get_mapped_range(addr, sizeof(*value));
+
+    if (ptr == NULL) {
+        return -1;
+    }
+    memcpy(value, ptr, sizeof(*value));
+    return 0;
+}
+
+int sim_bus_write(uint32_t addr, uint32_t value)
+{
+    uint8_t *ptr = get_mapped_range(addr, sizeof(value));
+
+    if (ptr == NULL) {
+        return -1;
+    }
+    memcpy(ptr, &value, sizeof(value));
+    return 0;
+}
+
+/* No virtual time outside the simulator: the UART idle timeout never fires */
+uint64_t sim_vtime_now(void)
+{
+    return 0;
+}
+
+int sim_vtimer_create(void (*fn)(void *ctx, uint64_t vtime_ns), void *ctx)
+{
+    (void)fn;
+    (void)ctx;
+    return -1;
+}
+
+void sim_vtimer_arm(int id, uint64_t deadline_ns)
+{
+    (void)id;
+    (void)deadline_ns;
+}
+
+void sim_vtimer_destroy(int id)
+{
+    (void)id;
+}
+
+extern int register_plugin(simulator_plugin_t *plugin);
+extern int handle_sim_message(const sim_message_t *msg, sim_message_t *response);
+extern simulator_plugin_t* create_uart_plugin_multi_instance(const char *instance_name, int instance_id);
+extern simulator_plugin_t* create_dma_plugin_multi_instance(const char *instance_name, int instance_id);
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint64_t fuzz_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t fuzz_hash(const uint8_t *data, size_t size)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief  Write an input to dir/prefix<hash> (async-signal-safe)
+ */
+static void fuzz_write_file(const char *dir, const char *prefix, const uint8_t *data, size_t size)
+{
+    static const char hex[] = "0123456789abcdef";
+    char path[512];
+    size_t n = 0;
+    uint64_t h = fuzz_hash(data, size);
+
+    for (const char *s = dir; *s && n < sizeof(path) - 40; s++) {
+        path[n++] = *s;
+    }
+    for (const char *s = prefix; *s && n < sizeof(path) - 20; s++) {
+        path[n++] = *s;
+    }
+    for (int i = 15; i >= 0; i--) {
+        path[n++] = hex[(h >> (i * 4)) & 0xFU];
+    }
+    path[n] = '\0';
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        ssize_t written = write(fd, data, size);
+        (void)written;
+        close(fd);
+    }
+}
+
+/**
+ * @brief  SIGSEGV: first write to a protected SRAM page marks it dirty;
+ *         any other fault is a crash in a model
+ */
+static void fuzz_segv_handler(int sig, siginfo_t *info, void *context)
+{
+    uint8_t *addr = (uint8_t*)info->si_addr;
+    (void)context;
+
+    if (addr >= g_mem && addr < g_mem + FUZZ_MEM_SIZE) {
+        uint32_t page = (uint32_t)((addr - g_mem) / FUZZ_PAGE_SIZE);
+        if (!__atomic_exchange_n(&g_dirty_flag[page], 1, __ATOMIC_ACQ_REL)) {
+            uint32_t slot = __atomic_fetch_add(&g_dirty_count, 1, __ATOMIC_ACQ_REL);
+            g_dirty[slot] = page;
+        }
+        mprotect(g_mem + (size_t)page * FUZZ_PAGE_SIZE, FUZZ_PAGE_SIZE, PROT_READ | PROT_WRITE);
+        return;
+    }
+
+    static const char msg[] = "==fuzz_devices== crash in device model, input saved\n";
+    ssize_t written = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    (void)written;
+    if (g_current_data != NULL) {
+        fuzz_write_file(g_artifact_prefix, "crash-", g_current_data, g_current_size);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static int fuzz_send(sim_message_t *msg, size_t device)
+{
+    strcpy(msg->module, g_devices[device].name);
+    return handle_sim_message(msg, NULL);
+}
+
+static void fuzz_reg_write(size_t device, uint32_t address, uint32_t value)
+{
+    sim_message_t msg = {0};
+    msg.type = MSG_REG_WRITE;
+    msg.address = address;
+    msg.value = value;
+    fuzz_send(&msg, device);
+}
+
+static uint32_t fuzz_reg_read(size_t device, uint32_t address)
+{
+    sim_message_t msg = {0};
+    sim_message_t response = {0};
+    msg.type = MSG_REG_READ;
+    msg.address = address;
+    strcpy(msg.module, g_devices[device].name);
+    handle_sim_message(&msg, &response);
+    return response.data.response.result;
+}
+
+/* Completes started transfers on this thread, so executions are deterministic */
+static void fuzz_clock(size_t device)
+{
+    sim_message_t msg = {0};
+    msg.type = MSG_CLOCK;
+    msg.data.clock.action = CLOCK_TICK;
+    fuzz_send(&msg, device);
+}
+
+/**
+ * @brief  Generic driver ISR: acknowledge whatever the device raised
+ */
+static void fuzz_service_irq(size_t device)
+{
+    uint32_t pending = __atomic_exchange_n(&g_irq_pending[device], 0, __ATOMIC_RELAXED);
+
+    if (pending == 0) {
+        return;
+    }
+    if (device == 1) {
+        uint32_t status = fuzz_reg_read(device, DMA_INT_STATUS_REG);
+        fuzz_reg_write(device, DMA_INT_CLEAR_REG, status);
+        fuzz_reg_write(device, DMA_INT_ERR_CLEAR_REG, status);
+    } else {
+        uint32_t flags = fuzz_reg_read(device, UART_STATUS_REG);
+        if ((flags & UART_FR_RXFE) == 0) {
+            (void)fuzz_reg_read(device, UART_RX_REG);
+        }
+    }
+}
+
+static bool fuzz_take(fuzz_input_t *in, void *out, size_t n)
+{
+    if (in->size - in->pos < n) {
+        return false;
+    }
+    memcpy(out, in->data + in->pos, n);
+    in->pos += n;
+    return true;
+}
+
+/**
+ * @brief  Restore device state and dirty bus memory to the snapshot
+ */
+static void fuzz_reset(void)
+{
+    for (size_t i = 0; i < FUZZ_DEVICE_COUNT; i++) {
+        g_plugins[i]->load_state(g_plugins[i], g_state[i], g_state_len[i]);
+        g_irq_pending[i] = 0;
+    }
+    uint32_t count = __atomic_exchange_n(&g_dirty_count, 0, __ATOMIC_ACQ_REL);
+    g_pages_restored += count;
+    for (uint32_t i = 0; i < count; i++) {
+        size_t offset = (size_t)g_dirty[i] * FUZZ_PAGE_SIZE;
+        memcpy(g_mem + offset, g_mem_snapshot + offset, FUZZ_PAGE_SIZE);
+        mprotect(g_mem + offset, FUZZ_PAGE_SIZE, PROT_READ);
+        __atomic_store_n(&g_dirty_flag[g_dirty[i]], 0, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief  Create the models, bring them to a typical post-init state and snapshot it
+ */
+static int fuzz_setup(void)
+{
+    struct sigaction sa;
+
+    g_mem = mmap(NULL, FUZZ_MEM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    g_mem_snapshot = malloc(FUZZ_MEM_SIZE);
+    if (g_mem == MAP_FAILED || g_mem_snapshot == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < FUZZ_MEM_SIZE; i++) {
+        g_mem[i] = (uint8_t)(i * 131U + 7U);
+    }
+
+    /* Plugin logging goes nowhere: it dominates the cost of an execution */
+    int null_fd = open("/dev/null", O_WRONLY);
+    int saved_fd = dup(STDOUT_FILENO);
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    g_plugins[0] = create_uart_plugin_multi_instance("uart0", 0);
+    g_plugins[1] = create_dma_plugin_multi_instance("dma0", 0);
+    for (size_t i = 0; i < FUZZ_DEVICE_COUNT; i++) {
+        if (g_plugins[i] == NULL || register_plugin(g_plugins[i]) != 0 ||
+            g_plugins[i]->save_state == NULL || g_plugins[i]->load_state == NULL) {
+            dup2(saved_fd, STDOUT_FILENO);
+            return -1;
+        }
+    }
+
+    /* Snapshot after the drivers' init sequence: UART and DMA enabled */
+    fuzz_reg_write(0, UART_CTRL_REG, UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE);
+    fuzz_reg_write(1, DMA_GLOBAL_CTRL_REG, 1U);
+    for (size_t i = 0; i < FUZZ_DEVICE_COUNT; i++) {
+        fuzz_clock(i);
+        g_state_len[i] = g_plugins[i]->save_state(g_plugins[i], g_state[i], FUZZ_STATE_SIZE);
+        if (g_state_len[i] == 0) {
+            dup2(saved_fd, STDOUT_FILENO);
+            return -1;
+        }
+    }
+    memcpy(g_mem_snapshot, g_mem, FUZZ_MEM_SIZE);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = fuzz_segv_handler;
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, NULL);
+    sigaction(SIGBUS, &sa, NULL);
+    mprotect(g_mem, FUZZ_MEM_SIZE, PROT_READ);
+
+    /* Keep the report on the real stdout */
+    g_report = fdopen(saved_fd, "w");
+    return g_report ? 0 : -1;
+}
+
+/* Fuzz target ---------------------------------------------------------------*/
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    (void)argc;
+    (void)argv;
+    return fuzz_setup();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_input_t in = { data, size, 0 };
+    uint8_t op;
+
+    g_current_data = data;
+    g_current_size = size;
+
+    for (uint32_t n = 0; n < FUZZ_MAX_OPS && fuzz_take(&in, &op, 1); n++) {
+        size_t device = (op >> 3) & 1U;
+        uint8_t reg;
+        uint32_t value = 0;
+        uint32_t address;
+
+        switch (op & 7U) {
+            case FUZZ_OP_WRITE:
+            case FUZZ_OP_WRITE_ADDR:
+                if (!fuzz_take(&in, &reg, 1) || !fuzz_take(&in, &value, 4)) {
+                    break;
+                }
+                if ((op & 7U) == FUZZ_OP_WRITE_ADDR) {
+                    value = FUZZ_MEM_BASE + (value & (FUZZ_MEM_SIZE - 1U));
+                }
+                address = g_devices[device].base + ((uint32_t)reg * 4U) % g_devices[device].window;
+                /* UARTEN starts/joins the UART monitor thread (up to 1s); keep it set */
+                if (device == 0 && address == UART_CTRL_REG) {
+                    value |= UART_CR_UARTEN;
+                }
+                /* Bound transfer volume so one input cannot run for seconds */
+                if (device == 1 && address >= DMA_CH_BASE_ADDR) {
+                    uint32_t offset = (address - DMA_CH_BASE_ADDR) % DMA_CH_OFFSET;
+                    if (offset == 0x0CU) {
+                        value &= FUZZ_MAX_TRANSFER - 1U;
+                    } else if (offset == 0x1CU) {
+                        value &= FUZZ_MAX_ROWS - 1U;
+                    }
+                }
+                fuzz_reg_write(device, address, value);
+                break;
+            case FUZZ_OP_READ:
+                if (fuzz_take(&in, &reg, 1)) {
+                    (void)fuzz_reg_read(device, g_devices[device].base + ((uint32_t)reg * 4U) % g_devices[device].window);
+                }
+                break;
+            case FUZZ_OP_SERVICE_IRQ:
+                fuzz_service_irq(device);
+                break;
+            case FUZZ_OP_RX_DATA: {
+                uint8_t len;
+                if (!fuzz_take(&in, &len, 1)) {
+                    break;
+                }
+                for (uint8_t i = 0; i < (len & 15U) && fuzz_take(&in, &reg, 1); i++) {
+                    sim_message_t msg = {0};
+                    msg.type = MSG_INPUT;
+                    msg.data.input.channel = 0;
+                    msg.value = reg;
+                    fuzz_send(&msg, 0);
+                }
+                break;
+            }
+            case FUZZ_OP_CLOCK:
+                fuzz_clock(device);
+                break;
+            case FUZZ_OP_INTERRUPT:
+                if (fuzz_take(&in, &reg, 1)) {
+                    sim_message_t msg = {0};
+                    msg.type = MSG_INTERRUPT;
+                    msg.data.interrupt.irq_num = reg;
+                    fuzz_send(&msg, device);
+                }
+                break;
+            case FUZZ_OP_CHANNEL: {
+                uint8_t ch;
+                uint16_t len;
+                uint32_t src;
+                uint32_t dst;
+                if (!fuzz_take(&in, &ch, 1) || !fuzz_take(&in, &len, 2) ||
+                    !fuzz_take(&in, &src, 4) || !fuzz_take(&in, &dst, 4)) {
+                    break;
+                }
+                ch %= DMA_MAX_CHANNELS;
+                fuzz_reg_write(1, DMA_CH_SRC_REG(ch), FUZZ_MEM_BASE + (src & (FUZZ_MEM_SIZE - 1U)));
+                fuzz_reg_write(1, DMA_CH_DST_REG(ch), FUZZ_MEM_BASE + (dst & (FUZZ_MEM_SIZE - 1U)));
+                fuzz_reg_write(1, DMA_CH_CTRL_REG(ch), len & (FUZZ_MAX_TRANSFER - 1U));
+                fuzz_reg_write(1, DMA_CH_CONFIG_REG(ch),
+                               DMA_CCFG_E | DMA_CCFG_ITC | DMA_CCFG_IE | (((uint32_t)ch << 4) & (DMA_CCFG_SINC | DMA_CCFG_DINC)));
+                break;
+            }
+        }
+    }
+
+    /* Let started transfers finish here rather than on the monitor thread */
+    for (size_t i = 0; i < FUZZ_DEVICE_COUNT; i++) {
+        fuzz_clock(i);
+    }
+    fuzz_reset();
+    g_current_data = NULL;
+    return 0;
+}
+
+#ifndef FUZZ_NO_MAIN
+
+/* Standalone mutational driver ----------------------------------------------*/
+
+static fuzz_entry_t g_corpus[FUZZ_MAX_CORPUS];
+static size_t g_corpus_count;
+static uint64_t g_rng;
+
+static uint32_t fuzz_rand(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return (uint32_t)(g_rng >> 11);
+}
+
+static void corpus_add(const uint8_t *data, size_t size)
+{
+    if (g_corpus_count >= FUZZ_MAX_CORPUS || size == 0) {
+        return;
+    }
+    uint8_t *copy = malloc(size);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, data, size);
+    g_corpus[g_corpus_count].data = copy;
+    g_corpus[g_corpus_count].size = size;
+    g_corpus_count++;
+}
+
+static void corpus_load_dir(const char *dir, size_t max_len)
+{
+    DIR *d = opendir(dir);
+    struct dirent *ent;
+
+    if (d == NULL) {
+        return;
+    }
+    while ((ent = readdir(d)) != NULL) {
+        char path[512];
+        struct stat st;
+        if (ent->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+            continue;
+        }
+        FILE *f = fopen(path, "rb");
+        if (f == NULL) {
+            continue;
+        }
+        uint8_t buf[4096];
+        size_t size = fread(buf, 1, max_len < sizeof(buf) ? max_len : sizeof(buf), f);
+        fclose(f);
+        corpus_add(buf, size);
+    }
+    closedir(d);
+}
+
+/**
+ * @brief  Edges reached for the first time by the last execution
+ */
+static uint32_t coverage_merge(void)
+{
+    uint32_t fresh = 0;
+    uint64_t *cov = (uint64_t*)g_cov;
+
+    for (size_t b = 0; b < sizeof(g_cov_words) / sizeof(g_cov_words[0]); b++) {
+        uint64_t words = g_cov_words[b];
+        g_cov_words[b] = 0;
+        while (words) {
+            size_t w = b * 64U + (size_t)__builtin_ctzll(words);
+            words &= words - 1U;
+            for (size_t i = w * 8U; i < w * 8U + 8U; i++) {
+                if (g_cov[i] && !g_cov_seen[i]) {
+                    g_cov_seen[i] = 1;
+                    fresh++;
+                }
+            }
+            cov[w] = 0;
+        }
+    }
+    return fresh;
+}
+
+static uint32_t coverage_count(void)
+{
+    uint32_t count = 0;
+    for (size_t i = 0; i < FUZZ_MAP_SIZE; i++) {
+        count += g_cov_seen[i];
+    }
+    return count;
+}
+
+static size_t fuzz_mutate(uint8_t *buf, size_t size, size_t max_len)
+{
+    uint32_t rounds = 1U + fuzz_rand() % 4U;
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        switch (fuzz_rand() % 6U) {
+            case 0:     /* Flip a bit */
+                if (size) {
+                    buf[fuzz_rand() % size] ^= (uint8_t)(1U << (fuzz_rand() % 8U));
+                }
+                break;
+            case 1:     /* Random byte */
+                if (size) {
+                    buf[fuzz_rand() % size] = (uint8_t)fuzz_rand();
+                }
+                break;
+            case 2:     /* Interesting 32-bit value */
+                if (size >= 4) {
+                    static const uint32_t values[] = { 0, 1, 0x7FFFFFFFU, 0x80000000U, 0xFFFFFFFFU, 0x100000U, 0xFFFFU };
+                    uint32_t v = values[fuzz_rand() % (sizeof(values) / sizeof(values[0]))];
+                    memcpy(buf + fuzz_rand() % (size - 3), &v, 4);
+                }
+                break;
+            case 3:     /* Insert random bytes (a new op) */
+                if (size + 6 <= max_len) {
+                    size_t at = size ? fuzz_rand() % (size + 1) : 0;
+                    memmove(buf + at + 6, buf + at, size - at);
+                    for (size_t i = 0; i < 6; i++) {
+                        buf[at + i] = (uint8_t)fuzz_rand();
+                    }
+                    size += 6;
+                }
+                break;
+            case 4:     /* Delete a chunk */
+                if (size > 2) {
+                    size_t at = fuzz_rand() % size;
+                    size_t len = 1 + fuzz_rand() % (size - at);
+                    if (len < size) {
+                        memmove(buf + at, buf + at + len, size - at - len);
+                        size -= len;
+                    }
+                }
+                break;
+            case 5:     /* Splice the tail of another corpus entry */
+                if (g_corpus_count) {
+                    const fuzz_entry_t *other = &g_corpus[fuzz_rand() % g_corpus_count];
+                    size_t at = size ? fuzz_rand() % size : 0;
+                    size_t from = fuzz_rand() % other->size;
+                    size_t len = other->size - from;
+                    if (at + len > max_len) {
+                        len = max_len - at;
+                    }
+                    memcpy(buf + at, other->data + from, len);
+                    size = at + len;
+                }
+                break;
+        }
+    }
+    return size;
+}
+
+static void fuzz_usage(const char *prog)
+{
+    printf("Usage: %s [-runs N] [-max_total_time S] [-seed N] [-max_len N] [-artifact_prefix P] "
+           "OUT_CORPUS [SEED_CORPUS...]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t runs = 0;
+    uint64_t max_time_ns = 0;
+    size_t max_len = FUZZ_MAX_LEN_DEFAULT;
+    const char *dirs[16];
+    int dir_count = 0;
+
+    g_rng = (uint64_t)time(NULL) | 1U;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-runs") == 0 && i + 1 < argc) {
+            runs = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-max_total_time") == 0 && i + 1 < argc) {
+            max_time_ns = strtoull(argv[++i], NULL, 0) * 1000000000ULL;
+        } else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) {
+            g_rng = strtoull(argv[++i], NULL, 0) | 1U;
+        } else if (strcmp(argv[i], "-max_len") == 0 && i + 1 < argc) {
+            max_len = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-artifact_prefix") == 0 && i + 1 < argc) {
+            g_artifact_prefix = argv[++i];
+        } else if (argv[i][0] != '-' && dir_count < 16) {
+            dirs[dir_count++] = argv[i];
+        } else {
+            fuzz_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (dir_count == 0 || max_len == 0 || max_len > 4096) {
+        fuzz_usage(argv[0]);
+        return 1;
+    }
+    mkdir(dirs[0], 0755);
+
+    if (LLVMFuzzerInitialize(&argc, &argv) != 0) {
+        printf("Failed to set up device models\n");
+        return 1;
+    }
+
+    for (int i = 0; i < dir_count; i++) {
+        corpus_load_dir(dirs[i], max_len);
+    }
+    if (g_corpus_count == 0) {
+        static const uint8_t empty[] = { FUZZ_OP_CLOCK };
+        corpus_add(empty, sizeof(empty));
+    }
+
+    /* Replay the corpus first so its coverage is not reported as new */
+    for (size_t i = 0; i < g_corpus_count; i++) {
+        LLVMFuzzerTestOneInput(g_corpus[i].data, g_corpus[i].size);
+        coverage_merge();
+    }
+    fprintf(g_report, "#0 INITED cov: %u corp: %zu\n", coverage_count(), g_corpus_count);
+    fflush(g_report);
+
+    char out_prefix[512];
+    snprintf(out_prefix, sizeof(out_prefix), "%s/", dirs[0]);
+
+    uint8_t *buf = malloc(max_len);
+    uint64_t start = fuzz_now_ns();
+    uint64_t last_report = start;
+    uint64_t execs = 0;
+    if (buf == NULL) {
+        return 1;
+    }
+
+    for (;;) {
+        const fuzz_entry_t *base = &g_corpus[fuzz_rand() % g_corpus_count];
+        size_t size = base->size < max_len ? base->size : max_len;
+
+        memcpy(buf, base->data, size);
+        size = fuzz_mutate(buf, size, max_len);
+        if (size == 0) {
+            continue;
+        }
+        LLVMFuzzerTestOneInput(buf, size);
+        execs++;
+
+        if (coverage_merge() > 0) {
+            corpus_add(buf, size);
+            fuzz_write_file(out_prefix, "", buf, size);
+        }
+
+        if ((execs & 255U) == 0 || (runs && execs >= runs)) {
+            uint64_t now = fuzz_now_ns();
+            bool done = (runs && execs >= runs) || (max_time_ns && now - start >= max_time_ns);
+            if (now - last_report >= FUZZ_REPORT_NS || done) {
+                fprintf(g_report, "#%llu cov: %u corp: %zu exec/s: %.0f dirty pages/exec: %.2f\n",
+                        (unsigned long long)execs, coverage_count(), g_corpus_count,
+                        (double)execs * 1e9 / (double)(now - start), (double)g_pages_restored / (double)execs);
+                fflush(g_report);
+                last_report = now;
+            }
+            if (done) {
+                break;
+            }
+        }
+    }
+
+    fprintf(g_report, "Done %llu runs in %.1f s, %zu corpus entries\n", (unsigned long long)execs,
+            (double)(fuzz_now_ns() - start) / 1e9, g_corpus_count);
+    fflush(g_report);
+    _exit(0);   /* Device threads are left running; nothing to flush */
+}
+
+#endif /* FUZZ_NO_MAIN */
@@ -11,7 +11,8 @@ typedef enum {
     MSG_REG_READ = 3,
     MSG_REG_WRITE = 4,
     MSG_INTERRUPT = 5,
-    MSG_RESPONSE = 6
+    MSG_RESPONSE = 6,
+    MSG_INPUT = 7           // 芯片外部输入（UART RX线等）
 } msg_type_t;
 
 // 时钟动作
@@ -45,6 +46,9 @@ typedef struct {
         struct {
             uint32_t irq_num;
         } interrupt;
+        struct {
+            uint32_t channel;   // 输入通道，值在value中
+        } input;
         struct {
             int32_t result;
             int32_t error;
@@ -40,6 +40,10 @@
 #define PERIPH_BASE           0x40000000UL
 #define APB1_BASE             (PERIPH_BASE + 0x00000000UL)
 #define APB2_BASE             (PERIPH_BASE + 0x00010000UL)
+#define SRAM_BASE             0x20000000UL
+#define SRAM_SIZE             0x00100000UL  /* 1MB on-chip SRAM */
+#define DRAM_BASE             0x80000000UL
+#define DRAM_SIZE             0x10000000UL  /* 256MB external DRAM */
 
 /* =============================================== */
 /* ================ UART ======================== */
@@ -66,6 +70,13 @@ typedef struct {
     __I  uint32_t MIS;       /*!< Masked Interrupt Status,         Address offset: 0x40 */
     __O  uint32_t ICR;       /*!< Interrupt Clear Register,        Address offset: 0x44 */
     __IO uint32_t DMACR;     /*!< DMA Control Register,            Address offset: 0x48 */
+    uint32_t      RESERVED2[1]; /*!< Reserved,                     Address offset: 0x4C */
+    __IO uint32_t IMODCNT;   /*!< Interrupt Moderation Count,      Address offset: 0x50 */
+    __IO uint32_t IMODTIME;  /*!< Interrupt Moderation Time (us),  Address offset: 0x54 */
+    __I  uint32_t IRQRAISED; /*!< Interrupts Raised (W: clear),    Address offset: 0x58 */
+    __I  uint32_t IRQSUPP;   /*!< Interrupt Events Suppressed,     Address offset: 0x5C */
+    __I  uint32_t RXLVL;     /*!< Receive FIFO Level (bytes),      Address offset: 0x60 */
+    __IO uint32_t RXTO;      /*!< Receive Idle Timeout (ns),       Address offset: 0x64 */
 } UART_TypeDef;
 
 /* UART Flag Register (FR) */
@@ -97,6 +108,20 @@ typedef struct {
 #define UART_FR_RI_Msk        (0x1UL << UART_FR_RI_Pos)
 #define UART_FR_RI            UART_FR_RI_Msk
 
+/* UART Receive Status Register (RSR), cleared by any write to ECR */
+#define UART_RSR_FE_Pos       (0U)
+#define UART_RSR_FE_Msk       (0x1UL << UART_RSR_FE_Pos)
+#define UART_RSR_FE           UART_RSR_FE_Msk           /*!< Framing error */
+#define UART_RSR_PE_Pos       (1U)
+#define UART_RSR_PE_Msk       (0x1UL << UART_RSR_PE_Pos)
+#define UART_RSR_PE           UART_RSR_PE_Msk           /*!< Parity error */
+#define UART_RSR_BE_Pos       (2U)
+#define UART_RSR_BE_Msk       (0x1UL << UART_RSR_BE_Pos)
+#define UART_RSR_BE           UART_RSR_BE_Msk           /*!< Break error */
+#define UART_RSR_OE_Pos       (3U)
+#define UART_RSR_OE_Msk       (0x1UL << UART_RSR_OE_Pos)
+#define UART_RSR_OE           UART_RSR_OE_Msk           /*!< Overrun: a byte arrived with the receive FIFO full */
+
 /* UART Control Register (CR) */
 #define UART_CR_UARTEN_Pos    (0U)
 #define UART_CR_UARTEN_Msk    (0x1UL << UART_CR_UARTEN_Pos)
@@ -204,6 +229,12 @@ typedef struct {
 #define UART_IMSC_OEIM_Msk    (0x1UL << UART_IMSC_OEIM_Pos)
 #define UART_IMSC_OEIM        UART_IMSC_OEIM_Msk
 
+/* UART RIS/MIS/ICR use the IMSC bit positions. RT is the receive timeout:
+   the line stayed idle for RXTO ns of virtual time after the last received byte */
+
+/* UART Receive Idle Timeout Register (RXTO), 0 selects the default */
+#define UART_RXTO_DEFAULT     277778U                   /*!< 32 bit periods at 115200 baud */
+
 /* =============================================== */
 /* ================ DMA ========================= */
 /* =============================================== */
@@ -227,7 +258,11 @@ typedef struct {
     __IO uint32_t SoftLSReq;      /*!< Software Last Single Request,       Address offset: 0x02C */
     __IO uint32_t Configuration;  /*!< Configuration Register,             Address offset: 0x030 */
     __IO uint32_t Sync;           /*!< Synchronization Register,           Address offset: 0x034 */
-    uint32_t      RESERVED0[50];  /*!< Reserved,                           Address offset: 0x038-0x0FC */
+    __IO uint32_t IntModCnt;      /*!< Interrupt Moderation Count,         Address offset: 0x038 */
+    __IO uint32_t IntModTime;     /*!< Interrupt Moderation Time (us),     Address offset: 0x03C */
+    __I  uint32_t IrqRaised;      /*!< Interrupts Raised (W: clear stats), Address offset: 0x040 */
+    __I  uint32_t IrqSuppressed;  /*!< Interrupt Events Suppressed,        Address offset: 0x044 */
+    uint32_t      RESERVED0[46];  /*!< Reserved,                           Address offset: 0x048-0x0FC */
 } DMA_TypeDef;
 
 /* DMA Channel Register Layout */
@@ -237,9 +272,67 @@ typedef struct {
     __IO uint32_t LLI;            /*!< Channel Linked List Item Register,   Address offset: 0x08 */
     __IO uint32_t Control;        /*!< Channel Control Register,            Address offset: 0x0C */
     __IO uint32_t Configuration;  /*!< Channel Configuration Register,      Address offset: 0x10 */
-    uint32_t      RESERVED[3];    /*!< Reserved,                            Address offset: 0x14-0x1C */
+    __IO uint32_t Status;         /*!< Channel Status Register (W1C),       Address offset: 0x14 */
+    __IO uint32_t Stride;         /*!< Channel 2D Row Stride Register,      Address offset: 0x18 */
+    __IO uint32_t Rows;           /*!< Channel 2D Row Count Register,       Address offset: 0x1C */
 } DMA_Channel_TypeDef;
 
+/* DMA Linked List Item: loaded into SrcAddr/DestAddr/LLI/Control when the
+   current block completes; LLI = 0 ends the chain. Items are word aligned and
+   share the channel Configuration, the interrupt is raised after the last one */
+typedef struct {
+    __IO uint32_t SrcAddr;        /*!< Source address of the next block                 */
+    __IO uint32_t DestAddr;       /*!< Destination address of the next block            */
+    __IO uint32_t LLI;            /*!< Address of the following item, 0 ends the chain  */
+    __IO uint32_t Control;        /*!< Size of the next block in bytes                  */
+} DMA_LLI_TypeDef;
+
+/* DMA Channel Control Register (Control): transfer size in bytes (bytes per row in 2D mode) */
+
+/* DMA Channel Configuration Register (Configuration) */
+#define DMA_CCFG_E_Pos        (0U)
+#define DMA_CCFG_E_Msk        (0x1UL << DMA_CCFG_E_Pos)
+#define DMA_CCFG_E            DMA_CCFG_E_Msk            /*!< Channel enable, cleared by hardware on completion */
+#define DMA_CCFG_ITC_Pos      (1U)
+#define DMA_CCFG_ITC_Msk      (0x1UL << DMA_CCFG_ITC_Pos)
+#define DMA_CCFG_ITC          DMA_CCFG_ITC_Msk          /*!< Terminal count interrupt enable */
+#define DMA_CCFG_IE_Pos       (2U)
+#define DMA_CCFG_IE_Msk       (0x1UL << DMA_CCFG_IE_Pos)
+#define DMA_CCFG_IE           DMA_CCFG_IE_Msk           /*!< Error interrupt enable */
+#define DMA_CCFG_SINC_Pos     (4U)
+#define DMA_CCFG_SINC_Msk     (0x1UL << DMA_CCFG_SINC_Pos)
+#define DMA_CCFG_SINC         DMA_CCFG_SINC_Msk         /*!< Source address increment */
+#define DMA_CCFG_DINC_Pos     (5U)
+#define DMA_CCFG_DINC_Msk     (0x1UL << DMA_CCFG_DINC_Pos)
+#define DMA_CCFG_DINC         DMA_CCFG_DINC_Msk         /*!< Destination address increment */
+#define DMA_CCFG_FLOW_Pos     (6U)
+#define DMA_CCFG_FLOW_Msk     (0x3UL << DMA_CCFG_FLOW_Pos) /*!< Flow: 0 M2M, 1 M2P, 2 P2M, 3 P2P */
+#define DMA_CCFG_2D_Pos       (12U)
+#define DMA_CCFG_2D_Msk       (0x1UL << DMA_CCFG_2D_Pos)
+#define DMA_CCFG_2D           DMA_CCFG_2D_Msk           /*!< 2D strided mode: Rows x Control bytes */
+#define DMA_CCFG_FILL_Pos     (13U)
+#define DMA_CCFG_FILL_Msk     (0x1UL << DMA_CCFG_FILL_Pos)
+#define DMA_CCFG_FILL         DMA_CCFG_FILL_Msk         /*!< Constant fill: SrcAddr holds the pattern */
+#define DMA_CCFG_ESIZE_Pos    (14U)
+#define DMA_CCFG_ESIZE_Msk    (0x3UL << DMA_CCFG_ESIZE_Pos) /*!< Element size: log2(bytes) */
+
+/* DMA Channel Status Register (Status) */
+#define DMA_CSTAT_BUSY_Pos    (0U)
+#define DMA_CSTAT_BUSY_Msk    (0x1UL << DMA_CSTAT_BUSY_Pos)
+#define DMA_CSTAT_BUSY        DMA_CSTAT_BUSY_Msk
+#define DMA_CSTAT_DONE_Pos    (1U)
+#define DMA_CSTAT_DONE_Msk    (0x1UL << DMA_CSTAT_DONE_Pos)
+#define DMA_CSTAT_DONE        DMA_CSTAT_DONE_Msk
+#define DMA_CSTAT_ERR_Pos     (2U)
+#define DMA_CSTAT_ERR_Msk     (0x1UL << DMA_CSTAT_ERR_Pos)
+#define DMA_CSTAT_ERR         DMA_CSTAT_ERR_Msk
+
+/* DMA Channel 2D Row Stride Register (Stride), 0 means rows are packed */
+#define DMA_CSTRIDE_SRC_Pos   (0U)
+#define DMA_CSTRIDE_SRC_Msk   (0xFFFFUL << DMA_CSTRIDE_SRC_Pos)
+#define DMA_CSTRIDE_DST_Pos   (16U)
+#define DMA_CSTRIDE_DST_Msk   (0xFFFFUL << DMA_CSTRIDE_DST_Pos)
+
 /* DMA instances */
 #define DMA0              ((DMA_TypeDef *) DMA0_BASE)
 #define DMA1              ((DMA_TypeDef *) DMA1_BASE)
@@ -292,6 +385,11 @@ typedef struct {
 #define UART_STATUS_REG     (UART_BASE + 0x18)  /* Same as FR register */
 #define UART_CTRL_REG       (UART_BASE + 0x30)  /* Same as CR register */
 #define UART_DMA_CTRL_REG   (UART_BASE + 0x48)  /* Same as DMACR register */
+#define UART_IMOD_CNT_REG   (UART_BASE + 0x50)  /* Same as IMODCNT register */
+#define UART_IMOD_TIME_REG  (UART_BASE + 0x54)  /* Same as IMODTIME register */
+#define UART_IRQ_RAISED_REG (UART_BASE + 0x58)  /* Same as IRQRAISED register */
+#define UART_IRQ_SUPP_REG   (UART_BASE + 0x5C)  /* Same as IRQSUPP register */
+#define UART_RX_LEVEL_REG   (UART_BASE + 0x60)  /* Same as RXLVL register */
 
 /* Legacy status bits */
 #define UART_TX_READY       (~UART_FR_TXFF)     /* TX not full */
@@ -307,15 +405,23 @@ typedef struct {
 #define DMA_GLOBAL_STATUS_REG   (DMA_BASE_ADDR + 0x00)  /* IntStatus register */
 #define DMA_INT_STATUS_REG      (DMA_BASE_ADDR + 0x00)  /* IntStatus register */
 #define DMA_INT_CLEAR_REG       (DMA_BASE_ADDR + 0x008) /* IntTCClear register */
+#define DMA_INT_ERR_CLEAR_REG   (DMA_BASE_ADDR + 0x010) /* IntErrClr register */
+#define DMA_INT_MOD_CNT_REG     (DMA_BASE_ADDR + 0x038) /* IntModCnt register */
+#define DMA_INT_MOD_TIME_REG    (DMA_BASE_ADDR + 0x03C) /* IntModTime register */
+#define DMA_IRQ_RAISED_REG      (DMA_BASE_ADDR + 0x040) /* IrqRaised register */
+#define DMA_IRQ_SUPPRESSED_REG  (DMA_BASE_ADDR + 0x044) /* IrqSuppressed register */
 #define DMA_MAX_CHANNELS        8
 #define DMA_CH_OFFSET           0x20
 #define DMA_CH_BASE_ADDR        (DMA_BASE_ADDR + 0x100)  /* Channel registers base */
 #define DMA_CH_CTRL_REG(ch)     (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x0C)
-#define DMA_CH_STATUS_REG(ch)   (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x10)
+#define DMA_CH_STATUS_REG(ch)   (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x14)
 #define DMA_CH_SRC_REG(ch)      (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x00)
 #define DMA_CH_DST_REG(ch)      (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x04)
 #define DMA_CH_SIZE_REG(ch)     (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x0C)
 #define DMA_CH_CONFIG_REG(ch)   (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x10)
+#define DMA_CH_LLI_REG(ch)      (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x08)
+#define DMA_CH_STRIDE_REG(ch)   (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x18)
+#define DMA_CH_ROWS_REG(ch)     (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x1C)
 #define DMA_CH_CURRENT_SRC_REG(ch) (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x00)
 #define DMA_CH_CURRENT_DST_REG(ch) (DMA_CH_BASE_ADDR + (ch) * DMA_CH_OFFSET + 0x04)
 
@@ -329,6 +435,9 @@ typedef struct {
     uint32_t config;
     uint32_t current_src;
     uint32_t current_dst;
+    uint32_t lli;
+    uint32_t stride;
+    uint32_t rows;
 } dma_channel_regs_t;
 
 /* ================================================================================ */
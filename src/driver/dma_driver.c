@@ -53,24 +53,27 @@
   */
 #define DMA_TIMEOUT_VALUE                5000U          /* 5 seconds timeout */
 
-/* DMA Control Register Bit Definitions */
+/* DMA Global Control Register Bit Definitions */
 #define DMA_CTRL_ENABLE         (1 << 0)
-#define DMA_CTRL_START          (1 << 1)
-#define DMA_CTRL_ABORT          (1 << 2)
+
+/* Combined DMA controller interrupt line and the channels this driver manages */
+#define DMA_IRQ_NUM             8U
+#define DMA_CHANNEL_MASK        ((1UL << DMA_MAX_CHANNELS) - 1U)
 
 /* DMA Status Register Bit Definitions */
-#define DMA_STATUS_BUSY         (1 << 0)
-#define DMA_STATUS_DONE         (1 << 1)
-#define DMA_STATUS_ERROR        (1 << 2)
+#define DMA_STATUS_BUSY         DMA_CSTAT_BUSY
+#define DMA_STATUS_DONE         DMA_CSTAT_DONE
+#define DMA_STATUS_ERROR        DMA_CSTAT_ERR
 
 /* DMA Configuration Register Bit Definitions */
-#define DMA_CONFIG_MEM_TO_MEM   (0 << 0)
-#define DMA_CONFIG_MEM_TO_PER   (1 << 0)
-#define DMA_CONFIG_PER_TO_MEM   (2 << 0)
-#define DMA_CONFIG_PER_TO_PER   (3 << 0)
-#define DMA_CONFIG_INC_SRC      (1 << 4)
-#define DMA_CONFIG_INC_DST      (1 << 5)
-#define DMA_CONFIG_INT_ENABLE   (1 << 8)
+#define DMA_CONFIG_ENABLE       DMA_CCFG_E
+#define DMA_CONFIG_INC_SRC      DMA_CCFG_SINC
+#define DMA_CONFIG_INC_DST      DMA_CCFG_DINC
+#define DMA_CONFIG_INT_ENABLE   (DMA_CCFG_ITC | DMA_CCFG_IE)
+#define DMA_CONFIG_2D           DMA_CCFG_2D
+#define DMA_CONFIG_FILL         DMA_CCFG_FILL
+#define DMA_CONFIG_FLOW(type)   (((uint32_t)(type) << DMA_CCFG_FLOW_Pos) & DMA_CCFG_FLOW_Msk)
+#define DMA_CONFIG_ESIZE(bytes) (((uint32_t)__builtin_ctz(bytes) << DMA_CCFG_ESIZE_Pos) & DMA_CCFG_ESIZE_Msk)
 
 /* HAL common definitions */
 #ifndef RESET
@@ -96,13 +99,20 @@
 #define DMA_GLOBAL_STATUS_PTR   ((volatile uint32_t*)DMA_GLOBAL_STATUS_REG)
 #define DMA_INT_STATUS_PTR      ((volatile uint32_t*)DMA_INT_STATUS_REG)
 #define DMA_INT_CLEAR_PTR       ((volatile uint32_t*)DMA_INT_CLEAR_REG)
+#define DMA_INT_ERR_CLEAR_PTR   ((volatile uint32_t*)DMA_INT_ERR_CLEAR_REG)
+#define DMA_INT_MOD_CNT_PTR     ((volatile uint32_t*)DMA_INT_MOD_CNT_REG)
+#define DMA_INT_MOD_TIME_PTR    ((volatile uint32_t*)DMA_INT_MOD_TIME_REG)
+#define DMA_IRQ_RAISED_PTR      ((volatile uint32_t*)DMA_IRQ_RAISED_REG)
+#define DMA_IRQ_SUPPRESSED_PTR  ((volatile uint32_t*)DMA_IRQ_SUPPRESSED_REG)
 
-#define DMA_CH_CTRL_PTR(ch)     ((volatile uint32_t*)DMA_CH_CTRL_REG(ch))
 #define DMA_CH_STATUS_PTR(ch)   ((volatile uint32_t*)DMA_CH_STATUS_REG(ch))
 #define DMA_CH_SRC_PTR(ch)      ((volatile uint32_t*)DMA_CH_SRC_REG(ch))
 #define DMA_CH_DST_PTR(ch)      ((volatile uint32_t*)DMA_CH_DST_REG(ch))
 #define DMA_CH_SIZE_PTR(ch)     ((volatile uint32_t*)DMA_CH_SIZE_REG(ch))
 #define DMA_CH_CONFIG_PTR(ch)   ((volatile uint32_t*)DMA_CH_CONFIG_REG(ch))
+#define DMA_CH_LLI_PTR(ch)      ((volatile uint32_t*)DMA_CH_LLI_REG(ch))
+#define DMA_CH_STRIDE_PTR(ch)   ((volatile uint32_t*)DMA_CH_STRIDE_REG(ch))
+#define DMA_CH_ROWS_PTR(ch)     ((volatile uint32_t*)DMA_CH_ROWS_REG(ch))
 
 /* Legacy DMA channel management structure */
 typedef struct {
@@ -443,7 +453,7 @@ HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, HAL_DMA_Level
     }
 
     /* Polling mode not supported in circular mode */
-    if ((hdma->Instance->Configuration & DMA_CHANNEL_ENABLE) != 0U) {
+    if (hdma->Init.Mode == DMA_CIRCULAR) {
         hdma->ErrorCode = HAL_DMA_ERROR_NOT_SUPPORTED;
         return HAL_ERROR;
     }
@@ -451,22 +461,22 @@ HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, HAL_DMA_Level
     /* Get the level transfer complete flag */
     if (HAL_DMA_FULL_TRANSFER == CompleteLevel) {
         /* Transfer Complete flag */
-        temp = DMA_TRANSFER_COMPLETE_INT;
+        temp = DMA_CSTAT_DONE;
     }
     else {
         /* Half Transfer Complete flag */
-        temp = DMA_TRANSFER_COMPLETE_INT;  /* Simplified - no half complete in this implementation */
+        temp = DMA_CSTAT_DONE;  /* Simplified - no half complete in this implementation */
     }
 
     /* Get tick */
     tickstart = HAL_GetTick();
 
-    while (__HAL_DMA_GET_FLAG(hdma, temp) == 0U) {
-        if ((__HAL_DMA_GET_FLAG(hdma, DMA_TRANSFER_ERROR_INT) != 0U)) {
+    while ((hdma->Instance->Status & temp) == 0U) {
+        if ((hdma->Instance->Status & DMA_CSTAT_ERR) != 0U) {
             /* When a DMA transfer error occurs */
             /* A hardware clear of its EN bits is performed */
             /* Clear all flags */
-            __HAL_DMA_CLEAR_FLAG(hdma, DMA_TRANSFER_ERROR_INT);
+            hdma->Instance->Status = DMA_CSTAT_ERR;
 
             /* Update error code */
             hdma->ErrorCode = HAL_DMA_ERROR_TE;
@@ -496,8 +506,8 @@ HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, HAL_DMA_Level
         }
     }
 
-    /* Clear the transfer complete flag */
-    __HAL_DMA_CLEAR_FLAG(hdma, temp);
+    /* Clear the transfer complete flag (write 1 to clear) */
+    hdma->Instance->Status = temp;
 
     /* The selected channel is disabled */
     hdma->State = HAL_DMA_STATE_READY;
@@ -509,24 +519,21 @@ HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, HAL_DMA_Level
 }
 
 /**
-  * @brief  Handle DMA interrupt request.
-  * @param  hdma Pointer to a DMA_HandleTypeDef structure that contains
-  *              the configuration information for the specified DMA Channel.
+  * @brief  Process the interrupt flags of one DMA channel.
+  * @note   The controller only latches channels whose ITC/IE bits are set, so
+  *         the flags are taken from the channel Status register alone.
+  * @param  hdma  Pointer to a DMA_HandleTypeDef structure that contains
+  *               the configuration information for the specified DMA Channel.
+  * @param  flags Channel Status register value (DMA_CSTAT_xxx)
   * @retval None
   */
-void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+static void DMA_ProcessIRQFlags(DMA_HandleTypeDef *hdma, uint32_t flags)
 {
-    uint32_t flag_it = hdma->Instance->Configuration;
-    uint32_t source_it = flag_it;
-
     /* Transfer Error Interrupt management ***************************************/
-    if ((RESET != (flag_it & DMA_TRANSFER_ERROR_INT)) && (RESET != (source_it & DMA_TRANSFER_ERROR_INT))) {
+    if (RESET != (flags & DMA_TRANSFER_ERROR_INT)) {
         /* Disable the transfer error interrupt */
         __HAL_DMA_DISABLE_IT(hdma, DMA_TRANSFER_ERROR_INT);
 
-        /* Clear the transfer error flag */
-        __HAL_DMA_CLEAR_FLAG(hdma, DMA_TRANSFER_ERROR_INT);
-
         /* Update error code */
         hdma->ErrorCode = HAL_DMA_ERROR_TE;
 
@@ -543,13 +550,10 @@ void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
     }
 
     /* Transfer Complete Interrupt management ***********************************/
-    if ((RESET != (flag_it & DMA_TRANSFER_COMPLETE_INT)) && (RESET != (source_it & DMA_TRANSFER_COMPLETE_INT))) {
+    if (RESET != (flags & DMA_TRANSFER_COMPLETE_INT)) {
         /* Disable the transfer complete interrupt */
         __HAL_DMA_DISABLE_IT(hdma, DMA_TRANSFER_COMPLETE_INT);
 
-        /* Clear the transfer complete flag */
-        __HAL_DMA_CLEAR_FLAG(hdma, DMA_TRANSFER_COMPLETE_INT);
-
         /* Update error code */
         hdma->ErrorCode = HAL_DMA_ERROR_NONE;
 
@@ -566,6 +570,22 @@ void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
     }
 }
 
+/**
+  * @brief  Handle DMA interrupt request.
+  * @param  hdma Pointer to a DMA_HandleTypeDef structure that contains
+  *              the configuration information for the specified DMA Channel.
+  * @retval None
+  */
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma)
+{
+    uint32_t flags = hdma->Instance->Status;
+
+    DMA_ProcessIRQFlags(hdma, flags);
+
+    /* Clear the handled flags */
+    __HAL_DMA_CLEAR_FLAG(hdma, flags & (DMA_TRANSFER_COMPLETE_INT | DMA_TRANSFER_ERROR_INT));
+}
+
 /**
   * @}
   */
@@ -628,6 +648,9 @@ static HAL_StatusTypeDef DMA_SetConfig(DMA_HandleTypeDef *hdma, uint32_t SrcAddr
     /* Configure DMA Channel data length */
     hdma->Instance->Control = DataLength;
 
+    /* Single block: no linked list item */
+    hdma->Instance->LLI = 0U;
+
     return HAL_OK;
 }
 
@@ -640,11 +663,33 @@ static HAL_StatusTypeDef DMA_SetConfig(DMA_HandleTypeDef *hdma, uint32_t SrcAddr
 static void DMA_ConfigureTransfer(DMA_HandleTypeDef *hdma)
 {
     uint32_t tmp;
+    uint32_t src_inc;
+    uint32_t dst_inc;
+
+    /* Map memory/peripheral increment to source/destination by direction,
+       the peripheral port is the source in memory-to-memory mode */
+    switch (hdma->Init.Direction) {
+        case DMA_MEMORY_TO_PERIPH:
+            src_inc = hdma->Init.MemInc;
+            dst_inc = hdma->Init.PeriphInc;
+            break;
+        case DMA_PERIPH_TO_PERIPH:
+            src_inc = hdma->Init.PeriphInc;
+            dst_inc = hdma->Init.PeriphInc;
+            break;
+        case DMA_PERIPH_TO_MEMORY:
+        case DMA_MEMORY_TO_MEMORY:
+        default:
+            src_inc = hdma->Init.PeriphInc;
+            dst_inc = hdma->Init.MemInc;
+            break;
+    }
 
-    /* Prepare the DMA Channel configuration */
-    tmp = hdma->Init.Direction | hdma->Init.PeriphInc | hdma->Init.MemInc |
-          hdma->Init.PeriphDataAlignment | hdma->Init.MemDataAlignment |
-          hdma->Init.Mode | hdma->Init.Priority;
+    /* Prepare the DMA Channel configuration, the channel stays disabled */
+    tmp = DMA_CONFIG_FLOW(hdma->Init.Direction) |
+          ((uint32_t)hdma->Init.MemDataAlignment << DMA_CCFG_ESIZE_Pos);
+    if (src_inc != 0U) tmp |= DMA_CCFG_SINC;
+    if (dst_inc != 0U) tmp |= DMA_CCFG_DINC;
 
     /* Write to DMA Channel control register */
     hdma->Instance->Configuration = tmp;
@@ -673,47 +718,54 @@ static uint32_t HAL_GetTick(void)
 
 /**
   * @brief  Legacy DMA interrupt handler
+  * @note   The controller raises one interrupt for any number of completions.
+  *         IntStatus is read once, only the channels whose bits are set are
+  *         visited, and they are acknowledged with a single W1C write.
   * @retval None
   */
 void dma_interrupt_handler(void) {
-    printf("[%s:%s] DMA interrupt received\n", __FILE__, __func__);
+    uint32_t int_status = *DMA_INT_STATUS_PTR & DMA_CHANNEL_MASK;
+    uint32_t err_status = 0;
+    uint32_t pending = int_status;
     
-    uint32_t int_status = *DMA_INT_STATUS_PTR;
-    
-    for (uint8_t ch = 0; ch < DMA_MAX_CHANNELS; ch++) {
-        if (int_status & (1 << ch)) {
-            printf("[%s:%s] DMA channel %d interrupt\n", __FILE__, __func__, ch);
-            
-            /* Call HAL IRQ handler if handle is available */
-            if (g_dma_channels[ch].hdma != NULL) {
-                HAL_DMA_IRQHandler(g_dma_channels[ch].hdma);
-            }
-            
-            /* Legacy callback handling */
-            uint32_t ch_status = *DMA_CH_STATUS_PTR(ch);
-            dma_channel_status_t status;
-            
-            if (ch_status & DMA_STATUS_ERROR) {
-                status = DMA_CH_ERROR;
-                printf("[%s:%s] DMA channel %d error\n", __FILE__, __func__, ch);
-            } else if (ch_status & DMA_STATUS_DONE) {
-                status = DMA_CH_DONE;
-                printf("[%s:%s] DMA channel %d transfer complete\n", __FILE__, __func__, ch);
-            } else {
-                status = DMA_CH_BUSY;
-            }
-            
-            /* Update channel state */
-            g_dma_channels[ch].busy = (status == DMA_CH_BUSY);
-            
-            /* Call legacy callback function */
-            if (g_dma_channels[ch].callback) {
-                g_dma_channels[ch].callback(ch, status);
-            }
-            
-            /* Clear interrupt flag */
-            *DMA_INT_CLEAR_PTR |= (1 << ch);
+    while (pending) {
+        uint8_t ch = (uint8_t)__builtin_ctz(pending);
+        pending &= pending - 1U;
+        
+        uint32_t ch_status = *DMA_CH_STATUS_PTR(ch);
+        dma_channel_status_t status;
+        
+        /* Call HAL IRQ handler if handle is available */
+        if (g_dma_channels[ch].hdma != NULL) {
+            DMA_ProcessIRQFlags(g_dma_channels[ch].hdma, ch_status);
+        }
+        
+        /* Legacy callback handling */
+        if (ch_status & DMA_STATUS_ERROR) {
+            status = DMA_CH_ERROR;
+            err_status |= 1UL << ch;
+            printf("[%s:%s] DMA channel %d error\n", __FILE__, __func__, ch);
+        } else if (ch_status & DMA_STATUS_DONE) {
+            status = DMA_CH_DONE;
+        } else {
+            status = DMA_CH_BUSY;
         }
+        
+        /* Update channel state */
+        g_dma_channels[ch].busy = (status == DMA_CH_BUSY);
+        
+        /* Call legacy callback function */
+        if (g_dma_channels[ch].callback) {
+            g_dma_channels[ch].callback(ch, status);
+        }
+    }
+    
+    /* Acknowledge every handled channel at once */
+    if (int_status) {
+        *DMA_INT_CLEAR_PTR = int_status;
+    }
+    if (err_status) {
+        *DMA_INT_ERR_CLEAR_PTR = err_status;
     }
 }
 
@@ -752,8 +804,8 @@ int dma_init(void) {
         HAL_DMA_Init(&g_dma_handles[ch]);
     }
     
-    /* Register DMA interrupt handler (IRQ 8) */
-    if (register_interrupt_handler(8, dma_interrupt_handler) != 0) {
+    /* Register the combined DMA interrupt handler */
+    if (register_interrupt_handler(DMA_IRQ_NUM, dma_interrupt_handler) != 0) {
         printf("[%s:%s] Failed to register DMA interrupt handler\n", __FILE__, __func__);
         return -1;
     }
@@ -879,6 +931,19 @@ int dma_configure_channel(uint8_t channel, const dma_config_t *config) {
         return -1;
     }
     
+    /* Validate transfer shape */
+    uint32_t elem_size = config->elem_size ? config->elem_size : 1U;
+    if ((elem_size != 1U && elem_size != 2U && elem_size != 4U && elem_size != 8U) ||
+        (config->size % elem_size) != 0U ||
+        config->mode > DMA_XFER_FILL ||
+        (config->mode == DMA_XFER_FILL && elem_size > 4U) ||
+        (config->mode == DMA_XFER_2D && config->rows == 0U) ||
+        (config->lli != 0U && ((config->lli & 3U) != 0U || config->mode != DMA_XFER_LINEAR))) {
+        printf("[%s:%s] Invalid transfer shape: mode=%d, elem_size=%u, size=%u, rows=%u\n",
+               __FILE__, __func__, config->mode, elem_size, config->size, config->rows);
+        return -1;
+    }
+    
     if (!g_dma_channels[channel].allocated) {
         printf("[%s:%s] Channel %d not allocated\n", __FILE__, __func__, channel);
         return -1;
@@ -915,22 +980,37 @@ int dma_configure_channel(uint8_t channel, const dma_config_t *config) {
     hdma->Init.MemInc = config->inc_src ? DMA_MINC_ENABLE : DMA_MINC_DISABLE;
     hdma->Init.PeriphInc = config->inc_dst ? DMA_PINC_ENABLE : DMA_PINC_DISABLE;
     
-    /* Legacy register configuration for compatibility */
-    *DMA_CH_SRC_PTR(channel) = config->src_addr;
+    /* Legacy register configuration for compatibility,
+       in fill mode the source address register holds the fill pattern */
+    *DMA_CH_SRC_PTR(channel) = (config->mode == DMA_XFER_FILL) ? config->fill_value : config->src_addr;
     *DMA_CH_DST_PTR(channel) = config->dst_addr;
     *DMA_CH_SIZE_PTR(channel) = config->size;
+    *DMA_CH_LLI_PTR(channel) = config->lli;
     
     /* Configure transfer parameters */
     uint32_t config_reg = 0;
-    config_reg |= (config->type & 0x3);
+    config_reg |= DMA_CONFIG_FLOW(config->type);
+    config_reg |= DMA_CONFIG_ESIZE(elem_size);
     if (config->inc_src) config_reg |= DMA_CONFIG_INC_SRC;
     if (config->inc_dst) config_reg |= DMA_CONFIG_INC_DST;
     if (config->interrupt_enable) config_reg |= DMA_CONFIG_INT_ENABLE;
     
+    /* 2D strided / fill shape */
+    if (config->mode == DMA_XFER_2D || (config->mode == DMA_XFER_FILL && config->rows > 1U)) {
+        config_reg |= DMA_CONFIG_2D;
+        *DMA_CH_ROWS_PTR(channel) = config->rows;
+        *DMA_CH_STRIDE_PTR(channel) = ((uint32_t)config->src_stride << DMA_CSTRIDE_SRC_Pos) |
+                                      ((uint32_t)config->dst_stride << DMA_CSTRIDE_DST_Pos);
+    }
+    if (config->mode == DMA_XFER_FILL) {
+        config_reg |= DMA_CONFIG_FILL;
+    }
+    
     *DMA_CH_CONFIG_PTR(channel) = config_reg;
     
-    printf("[%s:%s] Configured DMA channel %d: src=0x%08X, dst=0x%08X, size=%d\n",
-           __FILE__, __func__, channel, config->src_addr, config->dst_addr, config->size);
+    printf("[%s:%s] Configured DMA channel %d: src=0x%08X, dst=0x%08X, size=%d, mode=%d, rows=%d\n",
+           __FILE__, __func__, channel, config->src_addr, config->dst_addr, config->size,
+           config->mode, config->rows);
     
     return 0;
 }
@@ -951,9 +1031,10 @@ int dma_start_transfer(uint8_t channel) {
         return -1;
     }
     
-    /* Enable channel and start transfer */
-    *DMA_CH_CTRL_PTR(channel) = DMA_CTRL_ENABLE | DMA_CTRL_START;
+    /* Mark busy first: the completion interrupt may arrive before the enable write returns */
     g_dma_channels[channel].busy = true;
+    /* Enable channel, the rising edge of the enable bit starts the transfer */
+    *DMA_CH_CONFIG_PTR(channel) |= DMA_CONFIG_ENABLE;
     
     printf("[%s:%s] Started DMA transfer on channel %d\n", __FILE__, __func__, channel);
     return 0;
@@ -970,8 +1051,8 @@ int dma_stop_transfer(uint8_t channel) {
         return -1;
     }
     
-    /* Abort transfer */
-    *DMA_CH_CTRL_PTR(channel) = DMA_CTRL_ABORT;
+    /* Abort transfer by clearing the channel enable bit */
+    *DMA_CH_CONFIG_PTR(channel) &= ~DMA_CONFIG_ENABLE;
     g_dma_channels[channel].busy = false;
     
     /* Also abort via HAL */
@@ -1061,6 +1142,10 @@ int dma_transfer_async(uint8_t channel, uint32_t src, uint32_t dst, uint32_t siz
             printf("[%s:%s] HAL_DMA_Start_IT failed: %d\n", __FILE__, __func__, status);
             return -1;
         }
+        
+        /* HAL_DMA_Start_IT already enabled the channel */
+        g_dma_channels[channel].busy = true;
+        return 0;
     }
     
     return dma_start_transfer(channel);
@@ -1129,6 +1214,72 @@ int dma_transfer_sync(uint8_t channel, uint32_t src, uint32_t dst, uint32_t size
     return 0;
 }
 
+/**
+  * @brief  Wait for a transfer started with dma_start_transfer
+  * @note   Polls the channel status register, so it also covers channels set up
+  *         with dma_configure_channel (e.g. a fixed peripheral source).
+  * @param  channel Channel index
+  * @param  timeout_ms Timeout in milliseconds
+  * @retval 0 on success, -1 on error or timeout
+  */
+int dma_wait_transfer(uint8_t channel, uint32_t timeout_ms) {
+    if (channel >= DMA_MAX_CHANNELS || !g_dma_channels[channel].allocated) {
+        printf("[%s:%s] Invalid channel %d\n", __FILE__, __func__, channel);
+        return -1;
+    }
+    
+    /* Poll every 100us, the channel completes on the DMA engine thread */
+    for (uint32_t polls = 0; polls <= timeout_ms * 10U; polls++) {
+        uint32_t status = *DMA_CH_STATUS_PTR(channel);
+        if (status & DMA_STATUS_ERROR) {
+            g_dma_channels[channel].busy = false;
+            printf("[%s:%s] DMA transfer error on channel %d\n", __FILE__, __func__, channel);
+            return -1;
+        }
+        if (status & DMA_STATUS_DONE) {
+            g_dma_channels[channel].busy = false;
+            return 0;
+        }
+        usleep(100);
+    }
+    
+    printf("[%s:%s] DMA transfer timeout on channel %d\n", __FILE__, __func__, channel);
+    dma_stop_transfer(channel);
+    return -1;
+}
+
+/**
+  * @brief  Configure completion interrupt moderation
+  * @note   The interrupt is raised once count completion batches have accumulated,
+  *         or time_us after the first unreported one. 0/0 reports every batch.
+  * @param  count Count threshold
+  * @param  time_us Time threshold in microseconds
+  * @retval 0 on success
+  */
+int dma_set_irq_moderation(uint32_t count, uint32_t time_us) {
+    *DMA_INT_MOD_TIME_PTR = time_us;
+    *DMA_INT_MOD_CNT_PTR = count;
+    return 0;
+}
+
+/**
+  * @brief  Read interrupt moderation statistics
+  * @param  raised Interrupts actually raised (may be NULL)
+  * @param  suppressed Events folded into another interrupt (may be NULL)
+  * @param  reset Clear the statistics after reading
+  */
+void dma_get_irq_stats(uint32_t *raised, uint32_t *suppressed, bool reset) {
+    if (raised) {
+        *raised = *DMA_IRQ_RAISED_PTR;
+    }
+    if (suppressed) {
+        *suppressed = *DMA_IRQ_SUPPRESSED_PTR;
+    }
+    if (reset) {
+        *DMA_IRQ_RAISED_PTR = 0;
+    }
+}
+
 /**
   * @brief  Register callback function
   * @param  channel Channel index
@@ -168,14 +168,30 @@ typedef enum {
     DMA_TRANSFER_PER_TO_PER = 3
 } dma_transfer_type_t;
 
+/**
+  * @brief  DMA Transfer Shape Definition
+  */
+typedef enum {
+    DMA_XFER_LINEAR = 0,    /*!< Contiguous copy of size bytes                        */
+    DMA_XFER_2D     = 1,    /*!< rows x size bytes, rows separated by src/dst_stride  */
+    DMA_XFER_FILL   = 2     /*!< Constant fill with fill_value, 2D when rows > 1      */
+} dma_xfer_mode_t;
+
 typedef struct {
     uint32_t src_addr;
     uint32_t dst_addr;
-    uint32_t size;
+    uint32_t size;              /*!< Transfer size in bytes (bytes per row in 2D mode)    */
     dma_transfer_type_t type;
     bool inc_src;
     bool inc_dst;
     bool interrupt_enable;
+    dma_xfer_mode_t mode;       /*!< Linear, 2D strided or constant fill                  */
+    uint8_t elem_size;          /*!< Element size in bytes: 1, 2, 4 or 8 (fill: 1, 2, 4)  */
+    uint16_t rows;              /*!< 2D/fill: number of rows                              */
+    uint16_t src_stride;        /*!< 2D: bytes between source row starts (0 = packed)     */
+    uint16_t dst_stride;        /*!< 2D/fill: bytes between destination row starts        */
+    uint32_t fill_value;        /*!< Fill: 32-bit pattern replicated into every element   */
+    uint32_t lli;               /*!< Linear: first DMA_LLI_TypeDef of a chain, 0 if none  */
 } dma_config_t;
 
 /**
@@ -302,14 +318,14 @@ typedef struct __DMA_HandleTypeDef {
   * @param  __FLAG__ Get the specified flag.
   * @retval The state of FLAG (SET or RESET).
   */
-#define __HAL_DMA_GET_FLAG(__HANDLE__, __FLAG__)   (((__HANDLE__)->Instance->Configuration & (__FLAG__)) == (__FLAG__))
+#define __HAL_DMA_GET_FLAG(__HANDLE__, __FLAG__)   (((__HANDLE__)->Instance->Status & (__FLAG__)) == (__FLAG__))
 
 /** @brief  Clear the DMA Channel pending flags.
   * @param  __HANDLE__ DMA handle
   * @param  __FLAG__ specifies the flag to clear.
   * @retval None
   */
-#define __HAL_DMA_CLEAR_FLAG(__HANDLE__, __FLAG__)  ((__HANDLE__)->Instance->Configuration &= ~(__FLAG__))
+#define __HAL_DMA_CLEAR_FLAG(__HANDLE__, __FLAG__)  ((__HANDLE__)->Instance->Status = (__FLAG__))
 
 /** @brief  Enable the specified DMA Channel interrupts.
   * @param  __HANDLE__ DMA handle
@@ -403,8 +419,11 @@ int dma_transfer_async(uint8_t channel, uint32_t src, uint32_t dst, uint32_t siz
                       dma_transfer_type_t type, dma_callback_t callback);
 int dma_transfer_sync(uint8_t channel, uint32_t src, uint32_t dst, uint32_t size, 
                      dma_transfer_type_t type);
+int dma_wait_transfer(uint8_t channel, uint32_t timeout_ms);
 void dma_interrupt_handler(void);
 int dma_register_callback(uint8_t channel, dma_callback_t callback);
+int dma_set_irq_moderation(uint32_t count, uint32_t time_us);
+void dma_get_irq_stats(uint32_t *raised, uint32_t *suppressed, bool reset);
 
 /**
   * @}
@@ -28,6 +28,7 @@
 #include "dma_driver.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -85,6 +86,35 @@ static uart_dma_transfer_t g_uart_dma_tx = {0};
 static uart_dma_transfer_t g_uart_dma_rx = {0};
 static bool g_uart_dma_initialized = false;
 
+/* RX loan ring: driver-owned ring in SRAM that DMA fills from the RX FIFO,
+   readable spans are loaned to the application in place */
+typedef struct {
+    uint8_t *data;          /*!< Ring storage (SRAM, identity mapped)           */
+    uint32_t addr;          /*!< Ring bus address, DMA destination              */
+    uint32_t size;          /*!< Ring size in bytes, a power of two             */
+    uint32_t head;          /*!< Bytes written by DMA (free running)            */
+    uint32_t tail;          /*!< Bytes released by the application (free running) */
+    uint32_t loaned;        /*!< Length of the outstanding loan, 0 if none      */
+    int8_t dma_channel;     /*!< DMA channel number                             */
+    bool active;            /*!< Ring started                                   */
+} uart_rx_ring_t;
+
+static uart_rx_ring_t g_uart_rx_ring = {0};
+
+/* Vectored transmit in flight, the DMA callback carries no handle */
+static UART_HandleTypeDef *g_uart_txv_handle = NULL;
+static int8_t g_uart_txv_channel = -1;
+
+/* Reception to idle in progress: one DMA transfer per idle event */
+typedef struct {
+    UART_HandleTypeDef *huart;  /*!< Handle receiving, NULL if none               */
+    uint32_t imsc;              /*!< IMSC to restore when the reception ends       */
+    uint32_t xfer;              /*!< Bytes in the DMA transfer in flight, 0 if none */
+    int8_t dma_channel;         /*!< DMA channel number                             */
+} uart_rx_idle_t;
+
+static uart_rx_idle_t g_uart_rx_idle = {NULL, 0U, 0U, -1};
+
 /**
   * @}
   */
@@ -100,6 +130,9 @@ static HAL_StatusTypeDef UART_CheckIdleState(UART_HandleTypeDef *huart);
 static void UART_DMATransmitCplt(UART_HandleTypeDef *huart);
 static void UART_DMAReceiveCplt(UART_HandleTypeDef *huart);
 static void UART_DMAError(UART_HandleTypeDef *huart);
+static void uart_txv_dma_callback(uint8_t channel, dma_channel_status_t status);
+static void uart_rx_idle_dma_callback(uint8_t channel, dma_channel_status_t status);
+static void uart_rx_idle_stop(void);
 static uint32_t HAL_GetTick(void);
 
 /**
@@ -186,6 +219,18 @@ HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart)
 
     huart->gState = HAL_UART_STATE_BUSY;
 
+    /* Abort a vectored transmit still in flight */
+    if (g_uart_txv_handle == huart) {
+        g_uart_txv_handle = NULL;
+        dma_free_channel((uint8_t)g_uart_txv_channel);
+        g_uart_txv_channel = -1;
+    }
+
+    /* Abort a reception to idle still in progress */
+    if (g_uart_rx_idle.huart == huart) {
+        uart_rx_idle_stop();
+    }
+
     /* Disable the UART */
     huart->Instance->CR &= ~UART_CR_UARTEN;
 
@@ -281,8 +326,8 @@ HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pD
 
     /* Process Unlocked */
     while (huart->TxXferCount > 0U) {
-        /* Wait for TXE flag to be raised */
-        if (__HAL_UART_GET_FLAG(huart, UART_FLAG_TXFE) == 0U) {
+        /* Wait until the TX FIFO has room */
+        if (__HAL_UART_GET_FLAG(huart, UART_FLAG_TXFF) == 0U) {
             /* Write data to Transmit Data register */
             huart->Instance->DR = (uint8_t)(*pdata8bits & 0xFFU);
             pdata8bits++;
@@ -307,6 +352,165 @@ HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pD
     return HAL_OK;
 }
 
+/**
+  * @brief  Send a frame gathered from several buffers with one DMA operation.
+  * @note   The first buffer is programmed into the channel, the others are
+  *         chained through the linked list items at huart->pTxLli, so the
+  *         frame goes out without copying and HAL_UART_TxCpltCallback (or
+  *         HAL_UART_ErrorCallback) is raised once, after the last byte.
+  *         Buffers and items must lie in SRAM, the DMA reads them directly.
+  * @param  huart Pointer to a UART_HandleTypeDef structure that contains
+  *               the configuration information for the specified UART module.
+  * @param  iov    Buffers to send in order, empty ones are skipped
+  * @param  iovcnt Number of buffers, at most huart->TxLliCount + 1
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_UART_TransmitV(UART_HandleTypeDef *huart, const struct iovec *iov, int iovcnt)
+{
+    dma_config_t config = {
+        .dst_addr = UART_TX_REG,
+        .type = DMA_TRANSFER_MEM_TO_PER,
+        .inc_src = true,
+        .inc_dst = false,
+        .interrupt_enable = true
+    };
+    DMA_LLI_TypeDef *prev = NULL;
+    uint32_t items = 0;
+
+    /* Check that a Tx process is not already ongoing */
+    if (huart->gState != HAL_UART_STATE_READY || g_uart_txv_handle != NULL) {
+        return HAL_BUSY;
+    }
+
+    if ((iov == NULL) || (iovcnt <= 0) || (iovcnt > (int)huart->TxLliCount + 1)) {
+        return HAL_ERROR;
+    }
+
+    /* Build the chain: config holds the first block, each later block is an item */
+    for (int i = 0; i < iovcnt; i++) {
+        uintptr_t base = (uintptr_t)iov[i].iov_base;
+        uint32_t len = (uint32_t)iov[i].iov_len;
+
+        if (len == 0U) {
+            continue;
+        }
+        if (iov[i].iov_len > SRAM_SIZE || base < SRAM_BASE || base - SRAM_BASE > SRAM_SIZE - len) {
+            printf("[%s:%s] Buffer %d not DMA addressable: 0x%08lX, %lu bytes\n",
+                   __FILE__, __func__, i, (unsigned long)base, (unsigned long)iov[i].iov_len);
+            return HAL_ERROR;
+        }
+
+        if (config.size == 0U) {
+            config.src_addr = (uint32_t)base;
+            config.size = len;
+            continue;
+        }
+
+        DMA_LLI_TypeDef *item = &huart->pTxLli[items++];
+        item->SrcAddr = (uint32_t)base;
+        item->DestAddr = UART_TX_REG;
+        item->LLI = 0U;
+        item->Control = len;
+        if (prev == NULL) {
+            config.lli = (uint32_t)(uintptr_t)item;
+        } else {
+            prev->LLI = (uint32_t)(uintptr_t)item;
+        }
+        prev = item;
+    }
+
+    if (config.size == 0U) {
+        return HAL_ERROR;
+    }
+    if (items > 0U && ((uintptr_t)huart->pTxLli < SRAM_BASE ||
+                       (uintptr_t)huart->pTxLli - SRAM_BASE > SRAM_SIZE - items * sizeof(DMA_LLI_TypeDef))) {
+        printf("[%s:%s] Linked list items not DMA addressable\n", __FILE__, __func__);
+        return HAL_ERROR;
+    }
+
+    int channel = dma_allocate_channel();
+    if (channel < 0) {
+        return HAL_BUSY;
+    }
+
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->TxCompleted = false;
+    g_uart_txv_handle = huart;
+    g_uart_txv_channel = (int8_t)channel;
+
+    if (dma_register_callback((uint8_t)channel, uart_txv_dma_callback) != 0 ||
+        dma_configure_channel((uint8_t)channel, &config) != 0 ||
+        dma_start_transfer((uint8_t)channel) != 0) {
+        g_uart_txv_handle = NULL;
+        g_uart_txv_channel = -1;
+        dma_free_channel((uint8_t)channel);
+        huart->gState = HAL_UART_STATE_READY;
+        return HAL_ERROR;
+    }
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  Receive a frame of unknown length with DMA, up to Size bytes.
+  * @note   The reception ends when the line goes idle for RXTO after the last
+  *         byte: the idle interrupt hands the bytes in the FIFO to DMA and
+  *         HAL_UARTEx_RxEventCallback reports the length actually received,
+  *         so a frame costs one UART interrupt instead of one per byte.
+  *         Bytes beyond Size stay in the FIFO. The buffer must lie in SRAM.
+  * @param  huart Pointer to a UART_HandleTypeDef structure that contains
+  *               the configuration information for the specified UART module.
+  * @param  pData Pointer to data buffer.
+  * @param  Size  Largest frame to receive.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    uintptr_t base = (uintptr_t)pData;
+
+    /* Check that a Rx process is not already ongoing */
+    if (huart->RxState != HAL_UART_STATE_READY || g_uart_rx_idle.huart != NULL) {
+        return HAL_BUSY;
+    }
+
+    if ((pData == NULL) || (Size == 0U)) {
+        return HAL_ERROR;
+    }
+    if (base < SRAM_BASE || base - SRAM_BASE > SRAM_SIZE - Size) {
+        printf("[%s:%s] Buffer not DMA addressable: 0x%08lX\n", __FILE__, __func__, (unsigned long)base);
+        return HAL_ERROR;
+    }
+
+    int channel = dma_allocate_channel();
+    if (channel < 0) {
+        return HAL_BUSY;
+    }
+    if (dma_register_callback((uint8_t)channel, uart_rx_idle_dma_callback) != 0 ||
+        register_interrupt_handler(6, uart_rx_interrupt_handler) != 0) {
+        dma_free_channel((uint8_t)channel);
+        return HAL_ERROR;
+    }
+
+    huart->pRxBuffPtr = pData;
+    huart->RxXferSize = Size;
+    huart->RxXferCount = Size;
+    huart->RxCompleted = false;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+
+    g_uart_rx_idle.dma_channel = (int8_t)channel;
+    g_uart_rx_idle.xfer = 0U;
+    g_uart_rx_idle.imsc = huart->Instance->IMSC;
+    g_uart_rx_idle.huart = huart;
+
+    /* 只保留空闲中断：逐字节的接收中断在接收期间屏蔽 */
+    huart->Instance->ICR = UART_IMSC_RTIM;
+    huart->Instance->IMSC = (g_uart_rx_idle.imsc & ~UART_IMSC_RXIM) | UART_IMSC_RTIM;
+
+    return HAL_OK;
+}
+
 /**
   * @brief  Receive an amount of data in blocking mode.
   * @param  huart Pointer to a UART_HandleTypeDef structure that contains
@@ -496,6 +700,11 @@ static HAL_StatusTypeDef UART_CheckIdleState(UART_HandleTypeDef *huart)
 #define UART_STATUS_REG_PTR     ((volatile uint32_t*)UART_STATUS_REG)
 #define UART_CTRL_REG_PTR       ((volatile uint32_t*)UART_CTRL_REG)
 #define UART_DMA_CTRL_REG_PTR   ((volatile uint32_t*)UART_DMA_CTRL_REG)
+#define UART_IMOD_CNT_REG_PTR   ((volatile uint32_t*)UART_IMOD_CNT_REG)
+#define UART_IMOD_TIME_REG_PTR  ((volatile uint32_t*)UART_IMOD_TIME_REG)
+#define UART_IRQ_RAISED_REG_PTR ((volatile uint32_t*)UART_IRQ_RAISED_REG)
+#define UART_IRQ_SUPP_REG_PTR   ((volatile uint32_t*)UART_IRQ_SUPP_REG)
+#define UART_RX_LEVEL_REG_PTR   ((volatile uint32_t*)UART_RX_LEVEL_REG)
 
 /* HAL_GetTick simulation for timeout handling */
 #ifndef HAL_MAX_DELAY
@@ -529,12 +738,68 @@ void uart_tx_interrupt_handler(void)
     }
 }
 
+/**
+  * @brief  Handle a UART interrupt request.
+  * @note   Serves the receive idle timeout of HAL_UARTEx_ReceiveToIdle_DMA:
+  *         the bytes waiting in the FIFO are moved to the buffer by DMA.
+  * @param  huart Pointer to a UART_HandleTypeDef structure that contains
+  *               the configuration information for the specified UART module.
+  * @retval None
+  */
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    uint32_t mis = huart->Instance->MIS;
+
+    if (!(mis & UART_IMSC_RTIM)) {
+        return;
+    }
+    huart->Instance->ICR = UART_IMSC_RTIM;
+
+    /* 上一次搬运未完成时，其完成回调即结束本次接收 */
+    if (g_uart_rx_idle.huart != huart || g_uart_rx_idle.xfer != 0U) {
+        return;
+    }
+
+    uint32_t count = huart->Instance->RXLVL;
+    if (count > huart->RxXferCount) {
+        count = huart->RxXferCount;
+    }
+    if (count == 0U) {
+        return;
+    }
+
+    dma_config_t config = {
+        .src_addr = UART_RX_REG,
+        .dst_addr = (uint32_t)(uintptr_t)(huart->pRxBuffPtr + (huart->RxXferSize - huart->RxXferCount)),
+        .size = count,
+        .type = DMA_TRANSFER_PER_TO_MEM,
+        .inc_src = false,
+        .inc_dst = true,
+        .interrupt_enable = true
+    };
+
+    g_uart_rx_idle.xfer = count;
+    if (dma_configure_channel((uint8_t)g_uart_rx_idle.dma_channel, &config) != 0 ||
+        dma_start_transfer((uint8_t)g_uart_rx_idle.dma_channel) != 0) {
+        g_uart_rx_idle.xfer = 0U;
+        uart_rx_idle_stop();
+        huart->ErrorCode |= HAL_UART_ERROR_DMA;
+        HAL_UART_ErrorCallback(huart);
+    }
+}
+
 /**
   * @brief  Legacy UART RX interrupt handler
   * @retval None
   */
 void uart_rx_interrupt_handler(void)
 {
+    /* 接收到空闲期间的中断属于该次接收 */
+    if (g_uart_rx_idle.huart != NULL) {
+        HAL_UART_IRQHandler(g_uart_rx_idle.huart);
+        return;
+    }
+
     printf("[%s:%s] UART RX interrupt received.\n", __FILE__, __func__);
     uart_rx_available = 1;
     
@@ -575,6 +840,79 @@ static void uart_dma_tx_callback(uint8_t channel, dma_channel_status_t status) {
     }
 }
 
+/**
+  * @brief  向量发送的DMA完成回调：整条链表传输结束后只调用一次
+  * @param  channel DMA通道号
+  * @param  status 传输状态
+  * @retval None
+  */
+static void uart_txv_dma_callback(uint8_t channel, dma_channel_status_t status) {
+    UART_HandleTypeDef *huart = g_uart_txv_handle;
+
+    if (status == DMA_CH_BUSY || huart == NULL || channel != (uint8_t)g_uart_txv_channel) {
+        return;
+    }
+
+    g_uart_txv_handle = NULL;
+    g_uart_txv_channel = -1;
+    dma_free_channel(channel);
+
+    if (status == DMA_CH_ERROR) {
+        huart->ErrorCode |= HAL_UART_ERROR_DMA;
+    }
+    huart->TxCompleted = true;
+    huart->gState = HAL_UART_STATE_READY;
+
+    if (status == DMA_CH_DONE) {
+        HAL_UART_TxCpltCallback(huart);
+    } else {
+        HAL_UART_ErrorCallback(huart);
+    }
+}
+
+/**
+  * @brief  结束接收到空闲：恢复中断屏蔽并释放DMA通道
+  * @retval None
+  */
+static void uart_rx_idle_stop(void) {
+    UART_HandleTypeDef *huart = g_uart_rx_idle.huart;
+
+    huart->Instance->IMSC = g_uart_rx_idle.imsc;
+    dma_free_channel((uint8_t)g_uart_rx_idle.dma_channel);
+    g_uart_rx_idle.huart = NULL;
+    g_uart_rx_idle.dma_channel = -1;
+    huart->RxCompleted = true;
+    huart->RxState = HAL_UART_STATE_READY;
+}
+
+/**
+  * @brief  接收到空闲的DMA完成回调：上报实际收到的长度
+  * @param  channel DMA通道号
+  * @param  status 传输状态
+  * @retval None
+  */
+static void uart_rx_idle_dma_callback(uint8_t channel, dma_channel_status_t status) {
+    UART_HandleTypeDef *huart = g_uart_rx_idle.huart;
+
+    if (status == DMA_CH_BUSY || huart == NULL || channel != (uint8_t)g_uart_rx_idle.dma_channel) {
+        return;
+    }
+
+    if (status == DMA_CH_DONE) {
+        huart->RxXferCount -= (uint16_t)g_uart_rx_idle.xfer;
+    } else {
+        huart->ErrorCode |= HAL_UART_ERROR_DMA;
+    }
+    g_uart_rx_idle.xfer = 0U;
+    uart_rx_idle_stop();
+
+    if (status == DMA_CH_DONE) {
+        HAL_UARTEx_RxEventCallback(huart, (uint16_t)(huart->RxXferSize - huart->RxXferCount));
+    } else {
+        HAL_UART_ErrorCallback(huart);
+    }
+}
+
 /**
   * @brief  DMA接收完成回调函数
   * @param  channel DMA通道号
@@ -665,6 +1003,7 @@ void uart_cleanup(void)
     *UART_CTRL_REG_PTR = 0x00;
     
     /* 清理DMA */
+    uart_rx_ring_stop();
     uart_dma_cleanup();
     
     /* DeInitialize HAL UART */
@@ -1022,6 +1361,172 @@ int uart_dma_wait_receive_complete(uint32_t timeout_ms)
     return 0;
 }
 
+/**
+  * @brief  Start the RX loan ring
+  * @note   The driver owns the ring: DMA moves received bytes from the RX FIFO
+  *         into it, and uart_rx_loan() hands contiguous spans to the caller in
+  *         place instead of copying them into a caller buffer.
+  * @param  ring_addr Bus address of the ring, must lie in SRAM
+  * @param  size Ring size in bytes, a power of two
+  * @retval 0 on success, -1 on error
+  */
+int uart_rx_ring_start(uint32_t ring_addr, uint32_t size)
+{
+    if (g_uart_rx_ring.active) {
+        printf("[%s:%s] RX ring already started\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    if (size == 0U || (size & (size - 1U)) != 0U ||
+        ring_addr < SRAM_BASE || ring_addr - SRAM_BASE > SRAM_SIZE - size) {
+        printf("[%s:%s] Invalid parameters: addr=0x%08X, size=%u\n", __FILE__, __func__, ring_addr, size);
+        return -1;
+    }
+    
+    int channel = dma_allocate_channel();
+    if (channel < 0) {
+        printf("[%s:%s] No DMA channel for RX ring\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    memset(&g_uart_rx_ring, 0, sizeof(g_uart_rx_ring));
+    g_uart_rx_ring.data = (uint8_t *)(uintptr_t)ring_addr;
+    g_uart_rx_ring.addr = ring_addr;
+    g_uart_rx_ring.size = size;
+    g_uart_rx_ring.dma_channel = (int8_t)channel;
+    g_uart_rx_ring.active = true;
+    
+    /* 启用UART DMA接收 */
+    *UART_DMA_CTRL_REG_PTR |= UART_DMA_RX_ENABLE;
+    
+    printf("[%s:%s] RX ring started: addr=0x%08X, size=%u, DMA channel %d\n",
+           __FILE__, __func__, ring_addr, size, channel);
+    return 0;
+}
+
+/**
+  * @brief  Stop the RX loan ring and release its DMA channel
+  * @note   Bytes left in the ring are discarded, an outstanding loan becomes invalid.
+  * @retval None
+  */
+void uart_rx_ring_stop(void)
+{
+    if (!g_uart_rx_ring.active) {
+        return;
+    }
+    
+    *UART_DMA_CTRL_REG_PTR &= ~UART_DMA_RX_ENABLE;
+    dma_free_channel((uint8_t)g_uart_rx_ring.dma_channel);
+    
+    printf("[%s:%s] RX ring stopped after %u bytes\n", __FILE__, __func__, g_uart_rx_ring.head);
+    memset(&g_uart_rx_ring, 0, sizeof(g_uart_rx_ring));
+}
+
+/**
+  * @brief  Move what the RX FIFO holds into the free space after the ring head
+  * @note   One DMA transfer per contiguous run: the FIFO data register is a fixed
+  *         source, the ring is an incrementing destination.
+  * @retval Number of bytes moved, -1 on DMA error
+  */
+static int uart_rx_ring_fill(void)
+{
+    uart_rx_ring_t *ring = &g_uart_rx_ring;
+    uint32_t offset = ring->head & (ring->size - 1U);
+    uint32_t count = *UART_RX_LEVEL_REG_PTR;
+    
+    if (count > ring->size - (ring->head - ring->tail)) {
+        count = ring->size - (ring->head - ring->tail);  /* 环满时留在FIFO中 */
+    }
+    if (count > ring->size - offset) {
+        count = ring->size - offset;                     /* 环尾回绕由下一次搬运处理 */
+    }
+    if (count == 0U) {
+        return 0;
+    }
+    
+    dma_config_t config = {
+        .src_addr = UART_RX_REG,
+        .dst_addr = ring->addr + offset,
+        .size = count,
+        .type = DMA_TRANSFER_PER_TO_MEM,
+        .inc_src = false,
+        .inc_dst = true,
+        .interrupt_enable = false
+    };
+    
+    if (dma_configure_channel((uint8_t)ring->dma_channel, &config) != 0 ||
+        dma_start_transfer((uint8_t)ring->dma_channel) != 0 ||
+        dma_wait_transfer((uint8_t)ring->dma_channel, 100) != 0) {
+        printf("[%s:%s] RX ring DMA transfer failed\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    ring->head += count;
+    return (int)count;
+}
+
+/**
+  * @brief  Loan the next contiguous span of received data
+  * @note   The span stays valid until uart_rx_release(). At most one loan is
+  *         outstanding; a span never crosses the end of the ring, so data that
+  *         wraps is returned by the next loan. A zero length means no data yet.
+  * @param  data Receives a pointer to the first readable byte
+  * @param  len Receives the span length in bytes
+  * @retval 0 on success, -1 on error
+  */
+int uart_rx_loan(const uint8_t **data, uint32_t *len)
+{
+    uart_rx_ring_t *ring = &g_uart_rx_ring;
+    int moved;
+    
+    if (data == NULL || len == NULL) {
+        return -1;
+    }
+    
+    if (!ring->active || ring->loaned != 0U) {
+        printf("[%s:%s] RX ring not started or a loan is outstanding\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    /* Drain the FIFO, a wrap at the ring end takes a second transfer */
+    do {
+        moved = uart_rx_ring_fill();
+    } while (moved > 0);
+    if (moved < 0) {
+        return -1;
+    }
+    
+    uint32_t offset = ring->tail & (ring->size - 1U);
+    uint32_t count = ring->head - ring->tail;
+    if (count > ring->size - offset) {
+        count = ring->size - offset;
+    }
+    
+    *data = ring->data + offset;
+    *len = count;
+    ring->loaned = count;
+    return 0;
+}
+
+/**
+  * @brief  Return a loaned span to the ring
+  * @param  len Bytes consumed from the start of the span, may be less than loaned;
+  *         the rest is loaned again next time
+  * @retval 0 on success, -1 on error
+  */
+int uart_rx_release(uint32_t len)
+{
+    if (!g_uart_rx_ring.active || len > g_uart_rx_ring.loaned) {
+        printf("[%s:%s] Invalid release of %u bytes (loaned %u)\n",
+               __FILE__, __func__, len, g_uart_rx_ring.loaned);
+        return -1;
+    }
+    
+    g_uart_rx_ring.tail += len;
+    g_uart_rx_ring.loaned = 0;
+    return 0;
+}
+
 /**
   * @brief  Set UART transfer mode
   * @param  mode Transfer mode
@@ -1049,6 +1554,40 @@ UART_TransferModeTypeDef uart_get_mode(void)
     return g_uart_mode;
 }
 
+/**
+  * @brief  Configure TX/RX interrupt moderation
+  * @note   Each line raises once count events have accumulated, or time_us
+  *         after the first unreported one. 0/0 reports every event.
+  * @param  count Count threshold
+  * @param  time_us Time threshold in microseconds
+  * @retval 0 on success
+  */
+int uart_set_irq_moderation(uint32_t count, uint32_t time_us)
+{
+    *UART_IMOD_TIME_REG_PTR = time_us;
+    *UART_IMOD_CNT_REG_PTR = count;
+    return 0;
+}
+
+/**
+  * @brief  Read interrupt moderation statistics (TX and RX combined)
+  * @param  raised Interrupts actually raised (may be NULL)
+  * @param  suppressed Events folded into another interrupt (may be NULL)
+  * @param  reset Clear the statistics after reading
+  */
+void uart_get_irq_stats(uint32_t *raised, uint32_t *suppressed, bool reset)
+{
+    if (raised != NULL) {
+        *raised = *UART_IRQ_RAISED_REG_PTR;
+    }
+    if (suppressed != NULL) {
+        *suppressed = *UART_IRQ_SUPP_REG_PTR;
+    }
+    if (reset) {
+        *UART_IRQ_RAISED_REG_PTR = 0;
+    }
+}
+
 /**
   * @}
   */
@@ -1191,6 +1730,23 @@ __weak void HAL_UART_AbortReceiveCpltCallback(UART_HandleTypeDef *huart)
 }
 
 /**
+  * @brief  Reception event callback, raised when a reception to idle ends.
+  * @param  huart UART handle.
+  * @param  Size  Number of bytes received into the buffer.
+  * @retval None
+  */
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    /* Prevent unused argument(s) compilation warning */
+    UNUSED(huart);
+
+    /* NOTE: This function should not be modified, when the callback is needed,
+             the HAL_UARTEx_RxEventCallback could be implemented in the user file
+     */
+    printf("[%s:%s] UART RX event callback, %u bytes\n", __FILE__, __func__, (unsigned)Size);
+}
+
+/**
   * @brief  DMA transmit complete callback.
   * @param  huart UART handle.
   * @retval None
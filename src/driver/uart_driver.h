@@ -30,6 +30,16 @@ extern "C" {
 #include <stdbool.h>
 #include "../common/register_map.h"
 
+#ifdef _WIN32
+#include <stddef.h>
+struct iovec {
+    void   *iov_base;
+    size_t  iov_len;
+};
+#else
+#include <sys/uio.h>
+#endif
+
 /** @addtogroup IC_Simulator_Driver
   * @{
   */
@@ -188,6 +198,10 @@ typedef struct __UART_HandleTypeDef {
 
     volatile bool                    RxCompleted;      /*!< UART Rx completion flag            */
 
+    DMA_LLI_TypeDef                  *pTxLli;          /*!< Tx scatter-gather items, in SRAM   */
+
+    uint16_t                         TxLliCount;       /*!< Number of items at pTxLli          */
+
 } UART_HandleTypeDef;
 
 /**
@@ -330,7 +344,9 @@ HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef *huart, uint8_t *pData, ui
 HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
 HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
 HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_TransmitV(UART_HandleTypeDef *huart, const struct iovec *iov, int iovcnt);
 HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
 HAL_StatusTypeDef HAL_UART_DMAPause(UART_HandleTypeDef *huart);
 HAL_StatusTypeDef HAL_UART_DMAResume(UART_HandleTypeDef *huart);
 HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart);
@@ -352,6 +368,7 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
 void HAL_UART_AbortCpltCallback(UART_HandleTypeDef *huart);
 void HAL_UART_AbortTransmitCpltCallback(UART_HandleTypeDef *huart);
 void HAL_UART_AbortReceiveCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
 
 /**
   * @}
@@ -383,12 +400,18 @@ int uart_dma_init(void);
 void uart_dma_cleanup(void);
 int uart_dma_send(const uint8_t *data, uint32_t size);
 int uart_dma_receive(uint8_t *buffer, uint32_t size);
+int uart_rx_ring_start(uint32_t ring_addr, uint32_t size);
+void uart_rx_ring_stop(void);
+int uart_rx_loan(const uint8_t **data, uint32_t *len);
+int uart_rx_release(uint32_t len);
 bool uart_dma_send_completed(void);
 bool uart_dma_receive_completed(void);
 int uart_dma_wait_send_complete(uint32_t timeout_ms);
 int uart_dma_wait_receive_complete(uint32_t timeout_ms);
 int uart_set_mode(UART_TransferModeTypeDef mode);
 UART_TransferModeTypeDef uart_get_mode(void);
+int uart_set_irq_moderation(uint32_t count, uint32_t time_us);
+void uart_get_irq_stats(uint32_t *raised, uint32_t *suppressed, bool reset);
 void uart_tx_interrupt_handler(void);
 void uart_rx_interrupt_handler(void);
 
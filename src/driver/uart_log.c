@@ -0,0 +1,529 @@
+/**
+ ******************************************************************************
+ * @file    uart_log.c
+ * @author  IC Simulator Team
+ * @brief   Non-blocking UART Log Sink Source File (CMSIS Style)
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ * Writers format a record and copy it into a ring in SRAM; a DMA channel
+ * drains the ring into the UART data register one record at a time, and the
+ * DMA completion interrupt starts the next record. Writers never wait for the
+ * UART: the cost of a write is a reservation, a memcpy and a commit, plus a
+ * few register writes when it finds the drain idle and starts it.
+ *
+ * Ring layout: every record starts with an 8-byte header and is padded to a
+ * multiple of 8 bytes, so a payload is contiguous in SRAM and can be handed
+ * to DMA as is. A record that would cross the end of the ring is preceded by
+ * a pad record filling the rest of the ring.
+ *
+ * Positions are free running: head (reserved by writers) >= rd (next record
+ * for DMA) >= tail (everything before it is free). Writers reserve with a CAS
+ * on head and commit by storing the record's position into its header, so
+ * writers in interrupts and in thread context never wait for each other.
+ *
+ * Under the overwrite policy the drain copies each payload to a wire buffer
+ * behind the ring before handing it to DMA, so the ring is free up to rd and
+ * discarding the oldest records makes room for a writer at once.
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+
+#include "uart_log.h"
+#include "dma_driver.h"
+#include "../common/register_map.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define usleep(us) Sleep((us)/1000)
+#else
+    #include <unistd.h>
+#endif
+
+/** @addtogroup IC_Simulator_Driver
+  * @{
+  */
+
+/** @defgroup UART_Log UART Log
+  * @brief Non-blocking DMA-drained log sink
+  * @{
+  */
+
+/* Private define ------------------------------------------------------------*/
+
+/** @defgroup UART_Log_Private_Constants UART Log Private Constants
+  * @{
+  */
+#define LOG_HDR_SIZE            8U
+#define LOG_RECORD_SIZE(len)    ((LOG_HDR_SIZE + (len) + 7U) & ~7U)
+#define LOG_FLAG_PAD            0x0001U     /*!< Filler up to the ring end, not sent */
+/**
+  * @}
+  */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/** @defgroup UART_Log_Private_Types UART Log Private Types
+  * @{
+  */
+
+/**
+  * @brief  Record header, the position word commits the record
+  */
+typedef struct {
+    uint32_t pos;           /*!< Record position once committed              */
+    uint16_t len;           /*!< Payload length (pad: whole pad record size) */
+    uint16_t flags;         /*!< LOG_FLAG_PAD                                */
+} log_hdr_t;
+
+/**
+  * @brief  Log sink state
+  */
+typedef struct {
+    uint8_t *data;          /*!< Ring storage (SRAM, identity mapped)        */
+    uint32_t addr;          /*!< Ring bus address, DMA source                */
+    uint32_t size;          /*!< Ring size in bytes, a power of two          */
+    uart_log_policy_t policy;
+    uint32_t head;          /*!< Bytes reserved by writers                   */
+    uint32_t rd;            /*!< Next record to hand to DMA                  */
+    uint32_t tail;          /*!< Bytes before tail are free                  */
+    uint32_t xfer_len;      /*!< Payload length of the record on the wire    */
+    uint32_t wire;          /*!< Wire buffer bus address (overwrite), else 0 */
+    int busy;               /*!< Drain owner: a transfer is being set up or in flight */
+    int8_t dma_channel;     /*!< DMA channel number                          */
+    bool active;            /*!< Sink initialized                            */
+    uart_log_stats_t stats;
+} uart_log_t;
+/**
+  * @}
+  */
+
+/* Private variables ---------------------------------------------------------*/
+static uart_log_t g_log = {0};
+
+/* Private function prototypes -----------------------------------------------*/
+static void log_drain_kick(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Header at a ring position
+  */
+static log_hdr_t *log_hdr(uint32_t pos)
+{
+    return (log_hdr_t *)(g_log.data + (pos & (g_log.size - 1U)));
+}
+
+/**
+  * @brief  Ring bytes a committed record occupies
+  */
+static uint32_t log_record_size(const log_hdr_t *hdr)
+{
+    return (hdr->flags & LOG_FLAG_PAD) ? hdr->len : LOG_RECORD_SIZE(hdr->len);
+}
+
+/**
+  * @brief  Whether the record at pos has been committed by its writer
+  */
+static bool log_committed(uint32_t pos)
+{
+    return pos != __atomic_load_n(&g_log.head, __ATOMIC_ACQUIRE) &&
+           __atomic_load_n(&log_hdr(pos)->pos, __ATOMIC_ACQUIRE) == pos;
+}
+
+/**
+  * @brief  Position before which the ring is free
+  * @note   With a wire buffer a record is copied out before it goes on the
+  *         wire, so its space is free as soon as rd passes it.
+  */
+static uint32_t log_free_pos(void)
+{
+    return __atomic_load_n(g_log.wire != 0U ? &g_log.rd : &g_log.tail, __ATOMIC_ACQUIRE);
+}
+
+/**
+  * @brief  Reserve room for a record, preceded by a pad when it would wrap
+  * @param  rec Record size in bytes
+  * @param  pos Receives the reserved position (of the pad, if any)
+  * @param  pad Receives the pad size, 0 if none
+  * @retval 0 on success, -1 if the ring has no room
+  */
+static int log_reserve(uint32_t rec, uint32_t *pos, uint32_t *pad)
+{
+    uint32_t head = __atomic_load_n(&g_log.head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        uint32_t offset = head & (g_log.size - 1U);
+        uint32_t filler = (offset + rec > g_log.size) ? g_log.size - offset : 0U;
+        uint32_t used = head - log_free_pos();
+
+        if (used + filler + rec > g_log.size) {
+            return -1;
+        }
+        if (__atomic_compare_exchange_n(&g_log.head, &head, head + filler + rec, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            uint32_t level = used + filler + rec;
+            uint32_t high = __atomic_load_n(&g_log.stats.high_water, __ATOMIC_RELAXED);
+            while (level > high &&
+                   !__atomic_compare_exchange_n(&g_log.stats.high_water, &high, level, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+            *pos = head;
+            *pad = filler;
+            return 0;
+        }
+    }
+}
+
+/**
+  * @brief  Overwrite policy: discard the oldest records not yet handed to DMA
+  * @note   Nothing is discarded unless the committed records at rd free enough
+  *         room for rec, so a writer never loses older records and its own.
+  * @retval true if the reservation should be retried
+  */
+static bool log_discard_oldest(uint32_t rec)
+{
+    uint32_t r = __atomic_load_n(&g_log.rd, __ATOMIC_ACQUIRE);
+    uint32_t head = __atomic_load_n(&g_log.head, __ATOMIC_ACQUIRE);
+
+    uint32_t offset = head & (g_log.size - 1U);
+    uint32_t filler = (offset + rec > g_log.size) ? g_log.size - offset : 0U;
+    uint32_t room = g_log.size - (head - r);
+    uint32_t end = r;
+    uint32_t records = 0;
+
+    while (room < filler + rec) {
+        if (!log_committed(end)) {
+            return false;   /* 最旧的记录还在写，丢弃它之前的不够用 */
+        }
+        log_hdr_t *hdr = log_hdr(end);
+        uint32_t total = log_record_size(hdr);
+        records += (hdr->flags & LOG_FLAG_PAD) ? 0U : 1U;
+        room += total;
+        end += total;
+    }
+
+    if (end != r && __atomic_compare_exchange_n(&g_log.rd, &r, end, false,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&g_log.stats.overwritten, records, __ATOMIC_RELAXED);
+    }
+    return true;        /* 已腾出空间，或被DMA/其他写者抢先，重试 */
+}
+
+/**
+  * @brief  Start the DMA transfer of one record payload to the UART
+  */
+static int log_start_dma(uint32_t src, uint32_t len)
+{
+    dma_config_t config = {
+        .src_addr = src,
+        .dst_addr = UART_TX_REG,
+        .size = len,
+        .type = DMA_TRANSFER_MEM_TO_PER,
+        .inc_src = true,
+        .inc_dst = false,
+        .interrupt_enable = true
+    };
+
+    if (dma_configure_channel((uint8_t)g_log.dma_channel, &config) != 0) {
+        return -1;
+    }
+    return dma_start_transfer((uint8_t)g_log.dma_channel);
+}
+
+/**
+  * @brief  Hand the next committed record to DMA, caller owns g_log.busy
+  * @note   Releases busy when nothing is ready; a writer that commits in the
+  *         window before the release is picked up by the re-check.
+  */
+static void log_drain_locked(void)
+{
+    for (;;) {
+        uint32_t r = __atomic_load_n(&g_log.rd, __ATOMIC_ACQUIRE);
+
+        /* No transfer in flight: everything before rd is sent or discarded */
+        __atomic_store_n(&g_log.tail, r, __ATOMIC_RELEASE);
+        if (!log_committed(r)) {
+            break;
+        }
+
+        log_hdr_t *hdr = log_hdr(r);
+        uint16_t flags = hdr->flags;
+        uint32_t len = hdr->len;
+        uint32_t src = g_log.addr + ((r + LOG_HDR_SIZE) & (g_log.size - 1U));
+        if (g_log.wire != 0U && !(flags & LOG_FLAG_PAD)) {
+            if (len > UART_LOG_MAX_RECORD) {
+                continue;   /* 记录已被丢弃且空间被复用，rd已前移 */
+            }
+            /* 先拷出再推进rd：rd越过后记录空间立即可被写者复用 */
+            memcpy((uint8_t *)(uintptr_t)g_log.wire, (uint8_t *)hdr + LOG_HDR_SIZE, len);
+            src = g_log.wire;
+        }
+        if (!__atomic_compare_exchange_n(&g_log.rd, &r, r + log_record_size(hdr), false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;   /* 被覆盖策略丢弃 */
+        }
+        if (flags & LOG_FLAG_PAD) {
+            continue;
+        }
+
+        g_log.xfer_len = len;
+        if (log_start_dma(src, len) == 0) {
+            return;     /* busy保持到传输完成中断 */
+        }
+        __atomic_fetch_add(&g_log.stats.dma_errors, 1U, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&g_log.busy, 0, __ATOMIC_RELEASE);
+    if (log_committed(__atomic_load_n(&g_log.rd, __ATOMIC_ACQUIRE))) {
+        log_drain_kick();
+    }
+}
+
+/**
+  * @brief  Start the drain if no transfer is being set up or in flight
+  */
+static void log_drain_kick(void)
+{
+    if (!__atomic_exchange_n(&g_log.busy, 1, __ATOMIC_ACQ_REL)) {
+        log_drain_locked();
+    }
+}
+
+/**
+  * @brief  DMA completion: the record on the wire is sent, start the next one
+  */
+static void log_dma_callback(uint8_t channel, dma_channel_status_t status)
+{
+    (void)channel;
+
+    if (status == DMA_CH_BUSY || !g_log.active) {
+        return;
+    }
+    if (status == DMA_CH_DONE) {
+        __atomic_fetch_add(&g_log.stats.sent_bytes, g_log.xfer_len, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&g_log.stats.dma_errors, 1U, __ATOMIC_RELAXED);
+    }
+    log_drain_locked();
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+/** @defgroup UART_Log_Exported_Functions UART Log Exported Functions
+  * @{
+  */
+
+/**
+  * @brief  Initialize the log sink
+  * @param  ring_addr Bus address of the ring, must lie in SRAM (DMA source)
+  * @param  size Ring size in bytes, a power of two of at least UART_LOG_MIN_RING;
+  *         the overwrite policy also uses UART_LOG_MAX_RECORD bytes after it
+  * @param  policy What writers do when the ring is full
+  * @retval 0 on success, -1 on error
+  */
+int uart_log_init(uint32_t ring_addr, uint32_t size, uart_log_policy_t policy)
+{
+    if (g_log.active) {
+        printf("[%s:%s] Log sink already initialized\n", __FILE__, __func__);
+        return -1;
+    }
+
+    uint32_t span = (policy == UART_LOG_OVERWRITE) ? UART_LOG_MAX_RECORD : 0U;
+
+    if (size < UART_LOG_MIN_RING || (size & (size - 1U)) != 0U || (ring_addr & 7U) != 0U ||
+        size > SRAM_SIZE - span || ring_addr < SRAM_BASE ||
+        ring_addr - SRAM_BASE > SRAM_SIZE - span - size || policy > UART_LOG_BLOCK) {
+        printf("[%s:%s] Invalid parameters: addr=0x%08X, size=%u, policy=%d\n",
+               __FILE__, __func__, ring_addr, size, policy);
+        return -1;
+    }
+
+    int channel = dma_allocate_channel();
+    if (channel < 0 || dma_register_callback((uint8_t)channel, log_dma_callback) != 0) {
+        printf("[%s:%s] No DMA channel for the log sink\n", __FILE__, __func__);
+        return -1;
+    }
+
+    memset(&g_log, 0, sizeof(g_log));
+    g_log.data = (uint8_t *)(uintptr_t)ring_addr;
+    g_log.addr = ring_addr;
+    g_log.size = size;
+    g_log.policy = policy;
+    g_log.dma_channel = (int8_t)channel;
+    g_log.wire = span != 0U ? ring_addr + size : 0U;
+    memset(g_log.data, 0xFF, size); /* 全1的提交字不是合法位置(位置8字节对齐) */
+    __atomic_store_n(&g_log.active, true, __ATOMIC_RELEASE);
+
+    printf("[%s:%s] Log sink ready: ring 0x%08X, %u bytes, DMA channel %d, policy %d\n",
+           __FILE__, __func__, ring_addr, size, channel, policy);
+    return 0;
+}
+
+/**
+  * @brief  Flush the ring and release the DMA channel
+  * @retval None
+  */
+void uart_log_deinit(void)
+{
+    if (!g_log.active) {
+        return;
+    }
+
+    uart_log_flush(UART_LOG_BLOCK_TIMEOUT);
+    __atomic_store_n(&g_log.active, false, __ATOMIC_RELEASE);
+    dma_free_channel((uint8_t)g_log.dma_channel);
+
+    printf("[%s:%s] Log sink closed: %u records, %u bytes sent, %u dropped, %u overwritten\n",
+           __FILE__, __func__, g_log.stats.records, g_log.stats.sent_bytes,
+           g_log.stats.dropped, g_log.stats.overwritten);
+}
+
+/**
+  * @brief  Append one record
+  * @note   Safe from interrupt handlers except under the block policy.
+  * @param  data Record bytes
+  * @param  len Record length, longer than UART_LOG_MAX_RECORD is truncated
+  * @retval 0 on success, -1 if the record was dropped or the sink is not ready
+  */
+int uart_log_write(const char *data, uint32_t len)
+{
+    uint32_t pos, pad, waited = 0;
+
+    if (!__atomic_load_n(&g_log.active, __ATOMIC_ACQUIRE) || data == NULL) {
+        return -1;
+    }
+    if (len > UART_LOG_MAX_RECORD) {
+        len = UART_LOG_MAX_RECORD;
+        __atomic_fetch_add(&g_log.stats.truncated, 1U, __ATOMIC_RELAXED);
+    }
+    if (len == 0U) {
+        return 0;
+    }
+
+    uint32_t rec = LOG_RECORD_SIZE(len);
+    while (log_reserve(rec, &pos, &pad) != 0) {
+        if (g_log.policy == UART_LOG_OVERWRITE && log_discard_oldest(rec)) {
+            continue;
+        }
+        if (g_log.policy == UART_LOG_BLOCK && waited < UART_LOG_BLOCK_TIMEOUT * 10U) {
+            if (waited++ == 0U) {
+                __atomic_fetch_add(&g_log.stats.blocked, 1U, __ATOMIC_RELAXED);
+            }
+            log_drain_kick();
+            usleep(100);
+            continue;
+        }
+        __atomic_fetch_add(&g_log.stats.dropped, 1U, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    if (pad) {
+        log_hdr_t *filler = log_hdr(pos);
+        filler->len = (uint16_t)pad;
+        filler->flags = LOG_FLAG_PAD;
+        __atomic_store_n(&filler->pos, pos, __ATOMIC_RELEASE);
+        pos += pad;
+    }
+
+    log_hdr_t *hdr = log_hdr(pos);
+    memcpy((uint8_t *)hdr + LOG_HDR_SIZE, data, len);
+    hdr->len = (uint16_t)len;
+    hdr->flags = 0;
+    __atomic_store_n(&hdr->pos, pos, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&g_log.stats.records, 1U, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_log.stats.bytes, len, __ATOMIC_RELAXED);
+    log_drain_kick();
+    return 0;
+}
+
+/**
+  * @brief  Format and append one record
+  * @retval 0 on success, -1 if the record was dropped
+  */
+int uart_log_printf(const char *fmt, ...)
+{
+    char buf[UART_LOG_MAX_RECORD + 1U];
+    va_list args;
+
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+
+    if (n < 0) {
+        return -1;
+    }
+    if ((uint32_t)n > UART_LOG_MAX_RECORD) {
+        __atomic_fetch_add(&g_log.stats.truncated, 1U, __ATOMIC_RELAXED);
+        n = (int)UART_LOG_MAX_RECORD;
+    }
+    return uart_log_write(buf, (uint32_t)n);
+}
+
+/**
+  * @brief  Wait until every committed record has been sent
+  * @param  timeout_ms Timeout in milliseconds
+  * @retval 0 on success, -1 on timeout
+  */
+int uart_log_flush(uint32_t timeout_ms)
+{
+    if (!g_log.active) {
+        return -1;
+    }
+
+    for (uint32_t polls = 0; polls <= timeout_ms * 10U; polls++) {
+        log_drain_kick();
+        if (__atomic_load_n(&g_log.rd, __ATOMIC_ACQUIRE) == __atomic_load_n(&g_log.head, __ATOMIC_ACQUIRE) &&
+            !__atomic_load_n(&g_log.busy, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+        usleep(100);
+    }
+
+    printf("[%s:%s] Log flush timeout: %u bytes pending\n",
+           __FILE__, __func__, g_log.head - g_log.tail);
+    return -1;
+}
+
+/**
+  * @brief  Read the sink counters
+  * @param  stats Receives the counters
+  * @retval None
+  */
+void uart_log_get_stats(uart_log_stats_t *stats)
+{
+    if (stats != NULL) {
+        memcpy(stats, &g_log.stats, sizeof(*stats));
+    }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT IC Simulator Project *****END OF FILE****/
@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file    uart_log.h
+ * @author  IC Simulator Team
+ * @brief   Non-blocking UART Log Sink Header File (CMSIS Style)
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+#ifndef UART_LOG_H
+#define UART_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @addtogroup IC_Simulator_Driver
+  * @{
+  */
+
+/** @addtogroup UART_Log
+  * @{
+  */
+
+/* Exported constants --------------------------------------------------------*/
+
+/** @defgroup UART_Log_Exported_Constants UART Log Exported Constants
+  * @{
+  */
+#define UART_LOG_MAX_RECORD     256U    /*!< Longest record, longer ones are truncated */
+#define UART_LOG_MIN_RING       64U     /*!< Smallest ring size in bytes               */
+#define UART_LOG_BLOCK_TIMEOUT  1000U   /*!< Longest wait of the block policy (ms)     */
+/**
+  * @}
+  */
+
+/* Exported types ------------------------------------------------------------*/
+
+/** @defgroup UART_Log_Exported_Types UART Log Exported Types
+  * @{
+  */
+
+/**
+  * @brief  What a writer does when the ring has no room for its record
+  */
+typedef enum {
+    UART_LOG_DROP = 0,          /*!< Discard the new record                              */
+    UART_LOG_OVERWRITE,         /*!< Discard the oldest records not yet handed to DMA    */
+    UART_LOG_BLOCK              /*!< Wait for DMA to free space (not from interrupts)    */
+} uart_log_policy_t;
+
+/**
+  * @brief  Log sink counters
+  */
+typedef struct {
+    uint32_t records;           /*!< Records accepted into the ring                      */
+    uint32_t bytes;             /*!< Payload bytes accepted                              */
+    uint32_t dropped;           /*!< Records discarded for lack of room                  */
+    uint32_t overwritten;       /*!< Older records discarded by the overwrite policy     */
+    uint32_t truncated;         /*!< Records cut to UART_LOG_MAX_RECORD                  */
+    uint32_t blocked;           /*!< Writes that had to wait (block policy)              */
+    uint32_t sent_bytes;        /*!< Payload bytes the DMA has written to the UART       */
+    uint32_t dma_errors;        /*!< Drain transfers that failed                         */
+    uint32_t high_water;        /*!< Most ring bytes in use at once                      */
+} uart_log_stats_t;
+/**
+  * @}
+  */
+
+/* Exported functions --------------------------------------------------------*/
+
+/** @addtogroup UART_Log_Exported_Functions
+  * @{
+  */
+int uart_log_init(uint32_t ring_addr, uint32_t size, uart_log_policy_t policy);
+void uart_log_deinit(void);
+int uart_log_write(const char *data, uint32_t len);
+int uart_log_printf(const char *fmt, ...);
+int uart_log_flush(uint32_t timeout_ms);
+void uart_log_get_stats(uart_log_stats_t *stats);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_LOG_H
@@ -2,7 +2,14 @@
 #include "sim_interface/interrupt_manager.h"
 #include "driver/dma_driver.h"
 #include "sim_interface/sim_interface.h"
+#include "sim_interface/replay.h"
+#include "sim_interface/sim_control.h"
+#include "sim_interface/sim_perf.h"
+#include "sim_interface/trap_profile.h"
+#include "sim_interface/vtime_profile.h"
+#include "sim_interface/sim_stimulus.h"
 #include "simulator/plugin_interface.h"
+#include "simulator/plugins/lockstep_plugin.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,21 +22,55 @@
     #include <unistd.h>
 #endif
 
+// 记录/回放日志路径（命令行--record/--replay）
+static const char *g_record_path = NULL;
+static const char *g_replay_path = NULL;
+
+// 差分锁步的模块名（命令行--lockstep），用同一实现的第二个实例作为候选实现
+static const char *g_lockstep_module = NULL;
+
+// 控制套接字路径（命令行--control），运行中可用bin/ic_ctl查看状态
+static const char *g_control_path = NULL;
+
+// 宿主性能计数器报告路径（命令行--perf），按陷入/分发/中断阶段归账
+static const char *g_perf_path = NULL;
+
+// 访问点剖析报告路径（命令行--trap-profile），折叠栈写入同名.folded文件
+static const char *g_trap_profile_path = NULL;
+
+// 虚拟时间采样剖析的折叠栈路径和采样间隔（命令行--vtime-profile/--vtime-interval）
+static const char *g_vtime_profile_path = NULL;
+static uint64_t g_vtime_interval_ns = 0;
+
+// 外部激励发生器（命令行--stimulus，可重复）
+static sim_stim_config_t g_stimuli[SIM_STIM_MAX];
+static int g_stimulus_count = 0;
+
 // 静态寄存器映射表
 static const struct {
     uint32_t start_addr;
     uint32_t end_addr;
     const char *module;
 } register_mappings[] = {
-    {UART_BASE + 0x0000, UART_BASE + 0x0050, "uart0"},  // UART0寄存器区域
-    {UART_BASE + 0x1000, UART_BASE + 0x1050, "uart1"},  // UART1寄存器区域  
-    {UART_BASE + 0x2000, UART_BASE + 0x2050, "uart2"},  // UART2寄存器区域
+    {UART_BASE + 0x0000, UART_BASE + 0x0068, "uart0"},  // UART0寄存器区域
+    {UART_BASE + 0x1000, UART_BASE + 0x1068, "uart1"},  // UART1寄存器区域  
+    {UART_BASE + 0x2000, UART_BASE + 0x2068, "uart2"},  // UART2寄存器区域
     {DMA_BASE_ADDR + 0x0000, DMA_BASE_ADDR + 0x0300, "dma0"},   // DMA0寄存器区域 (全局寄存器 + 16个通道)
     {DMA_BASE_ADDR + 0x1000, DMA_BASE_ADDR + 0x1300, "dma1"},   // DMA1寄存器区域
     {DMA_BASE_ADDR + 0x2000, DMA_BASE_ADDR + 0x2300, "dma2"},   // DMA2寄存器区域
     // 可以在这里添加更多模块的寄存器映射
 };
 
+// 静态内存区域映射表
+static const struct {
+    uint32_t start_addr;
+    uint32_t size;
+    const char *name;
+} memory_mappings[] = {
+    {SRAM_BASE, SRAM_SIZE, "sram"},  // 片上SRAM，DMA源/目标缓冲区
+    {DRAM_BASE, DRAM_SIZE, "dram"},  // 外部DRAM，大块DMA传输（按需分配物理页）
+};
+
 // 静态信号映射表
 static const struct {
     int signal_num;
@@ -42,9 +83,7 @@ static const struct {
     {37, "uart1", 6},  // UART1 RX中断
     {38, "uart2", 5},  // UART2 TX中断
     {39, "uart2", 6},  // UART2 RX中断
-    {40, "dma0", 8},   // DMA0中断 (SIGRTMIN+6)
-    {41, "dma0", 9},   // DMA0通道1中断
-    {42, "dma0", 10},  // DMA0通道2中断
+    {40, "dma0", 8},   // DMA0合并中断：所有通道的完成/错误 (SIGRTMIN+6)
     {43, "dma1", 8},   // DMA1中断
     {44, "dma2", 8},   // DMA2中断
     // 可以在这里添加更多模块的中断映射
@@ -52,15 +91,31 @@ static const struct {
 
 #define REGISTER_MAPPING_COUNT (sizeof(register_mappings) / sizeof(register_mappings[0]))
 #define SIGNAL_MAPPING_COUNT (sizeof(signal_mappings) / sizeof(signal_mappings[0]))
+#define MEMORY_MAPPING_COUNT (sizeof(memory_mappings) / sizeof(memory_mappings[0]))
 
 // 外部函数声明
 extern simulator_plugin_t* create_uart_plugin_multi_instance(const char *instance_name, int instance_id);
 extern simulator_plugin_t* create_dma_plugin_multi_instance(const char *instance_name, int instance_id);
 
+// 创建设备插件；--lockstep指定的模块包装为锁步插件
+static simulator_plugin_t* create_device_plugin(simulator_plugin_t* (*create)(const char *, int),
+                                                const char *name, int instance_id) {
+    simulator_plugin_t *plugin = create(name, instance_id);
+    if (!plugin || !g_lockstep_module || strcmp(g_lockstep_module, name) != 0) {
+        return plugin;
+    }
+    
+    char candidate_name[32];
+    snprintf(candidate_name, sizeof(candidate_name), "%s.cand", name);
+    return create_lockstep_plugin(plugin, create(candidate_name, instance_id));
+}
+
 // 测试函数声明
 void test_uart_basic(void);
 void test_uart_interrupt(void);
+void test_uart_irq_moderation(void);
 void test_dma_basic(void);
+void test_dma_interrupt(void);
 void test_uart_dma(void);
 extern int register_plugin(simulator_plugin_t *plugin);
 extern int handle_sim_message(const sim_message_t *msg, sim_message_t *response);
@@ -83,6 +138,24 @@ int init_register_mappings(void) {
     return 0;
 }
 
+// 初始化静态内存区域映射
+int init_memory_mappings(void) {
+    printf("[%s:%s] Initializing static memory mappings...\n", __FILE__, __func__);
+    
+    for (size_t i = 0; i < MEMORY_MAPPING_COUNT; i++) {
+        if (add_memory_mapping(memory_mappings[i].start_addr,
+                               memory_mappings[i].size,
+                               memory_mappings[i].name) != 0) {
+            printf("[%s:%s] Failed to add memory mapping for %s\n", 
+                   __FILE__, __func__, memory_mappings[i].name);
+            return -1;
+        }
+    }
+    
+    printf("[%s:%s] %zu memory mappings initialized\n", __FILE__, __func__, MEMORY_MAPPING_COUNT);
+    return 0;
+}
+
 // 初始化静态信号映射
 int init_signal_mappings(void) {
     printf("[%s:%s] Initializing static signal mappings...\n", __FILE__, __func__);
@@ -118,13 +191,13 @@ int simulator_init(void) {
     }
     
     // 3. 注册插件
-    simulator_plugin_t *uart_plugin = create_uart_plugin_multi_instance("uart0", 0);
+    simulator_plugin_t *uart_plugin = create_device_plugin(create_uart_plugin_multi_instance, "uart0", 0);
     if (!uart_plugin || register_plugin(uart_plugin) != 0) {
         printf("[%s:%s] Failed to register UART plugin\n", __FILE__, __func__);
         return -1;
     }
     
-    simulator_plugin_t *dma_plugin = create_dma_plugin_multi_instance("dma0", 0);
+    simulator_plugin_t *dma_plugin = create_device_plugin(create_dma_plugin_multi_instance, "dma0", 0);
     if (!dma_plugin || register_plugin(dma_plugin) != 0) {
         printf("[%s:%s] Failed to register DMA plugin\n", __FILE__, __func__);
         return -1;
@@ -136,12 +209,58 @@ int simulator_init(void) {
         return -1;
     }
     
+    // 初始化静态内存区域映射
+    if (init_memory_mappings() != 0) {
+        printf("[%s:%s] Failed to initialize memory mappings\n", __FILE__, __func__);
+        return -1;
+    }
+    
     // 5. 初始化静态信号映射
     if (init_signal_mappings() != 0) {
         printf("[%s:%s] Failed to initialize signal mappings\n", __FILE__, __func__);
         return -1;
     }
     
+    // 记录/回放从驱动初始化的第一次寄存器访问开始
+    if (g_record_path && replay_record_start(g_record_path, REPLAY_DEFAULT_SNAPSHOT_INTERVAL) != 0) {
+        printf("[%s:%s] Failed to start recording\n", __FILE__, __func__);
+        return -1;
+    }
+    if (g_replay_path && replay_start(g_replay_path) != 0) {
+        printf("[%s:%s] Failed to start replay\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    // 激励在驱动初始化前就位，按虚拟时间到达；回放时输入由日志提供
+    for (int i = 0; i < g_stimulus_count; i++) {
+        if (sim_stim_add(&g_stimuli[i]) != 0) {
+            printf("[%s:%s] Failed to add %s stimulus\n", __FILE__, __func__, g_stimuli[i].module);
+            return -1;
+        }
+    }
+    
+    // 性能计数器在仿真线程上打开，统计从驱动初始化开始
+    if (g_perf_path && sim_perf_start(g_perf_path) != 0) {
+        printf("[%s:%s] Failed to start perf counters\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    if (g_trap_profile_path && trap_profile_start(g_trap_profile_path) != 0) {
+        printf("[%s:%s] Failed to start trap profiler\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    if (g_vtime_profile_path && vtime_profile_start(g_vtime_profile_path, g_vtime_interval_ns) != 0) {
+        printf("[%s:%s] Failed to start virtual-time profiler\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    // 控制套接字在驱动初始化前启动，可以观察整个运行过程
+    if (g_control_path && sim_control_start(g_control_path) != 0) {
+        printf("[%s:%s] Failed to start control socket\n", __FILE__, __func__);
+        return -1;
+    }
+    
     // 6. 初始化驱动
     if (uart_init() != 0) {
         printf("[%s:%s] Failed to initialize UART driver\n", __FILE__, __func__);
@@ -162,9 +281,17 @@ int simulator_init(void) {
 void simulator_cleanup(void) {
     printf("[%s:%s] IC Simulator cleaning up...\n", __FILE__, __func__);
     
+    sim_control_stop();
     uart_cleanup();
     dma_cleanup();
     interrupt_manager_cleanup();
+    sim_perf_stop();
+    trap_profile_stop();
+    vtime_profile_stop();
+    replay_stop();
+    sim_stim_report();
+    sim_stim_clear();
+    sim_irq_report();
     sim_interface_cleanup();
     
     printf("[%s:%s] IC Simulator cleanup completed\n", __FILE__, __func__);
@@ -176,7 +303,9 @@ void run_test_suite(void) {
     
     test_uart_basic();
     test_uart_interrupt();
+    test_uart_irq_moderation();
     test_dma_basic();
+    test_dma_interrupt();
     test_uart_dma();
     
     printf("[%s:%s] Test suite completed\n", __FILE__, __func__);
@@ -229,11 +358,39 @@ void test_uart_interrupt(void) {
     printf("[%s:%s] UART interrupt test completed\n", __FILE__, __func__);
 }
 
+void test_uart_irq_moderation(void) {
+    printf("[%s:%s] \n=== UART Interrupt Moderation Test ===\n", __FILE__, __func__);
+    
+    // 每4个TX完成事件上报一次中断，8个字节应只发出2次中断
+    const uint32_t count = 4;
+    const char *burst = "ABCDEFGH";
+    uint32_t raised = 0, suppressed = 0;
+    
+    uart_get_irq_stats(NULL, NULL, true);
+    uart_set_irq_moderation(count, 0);
+    volatile uint32_t *uart_dr = (volatile uint32_t *)UART_TX_REG;
+    for (size_t i = 0; i < strlen(burst); i++) {
+        *uart_dr = (uint8_t)burst[i];  // 每次写DR产生一个TX完成事件
+    }
+    uart_get_irq_stats(&raised, &suppressed, true);
+    uart_set_irq_moderation(0, 0);
+    
+    if (raised == strlen(burst) / count && suppressed == strlen(burst) - raised) {
+        printf("[%s:%s] ✓ %zu TX events raised %u interrupts (%u suppressed)\n", 
+               __FILE__, __func__, strlen(burst), raised, suppressed);
+    } else {
+        printf("[%s:%s] ✗ Unexpected moderation stats: raised=%u suppressed=%u\n", 
+               __FILE__, __func__, raised, suppressed);
+    }
+    
+    printf("[%s:%s] UART interrupt moderation test completed\n", __FILE__, __func__);
+}
+
 void test_dma_basic(void) {
     printf("[%s:%s] \n=== DMA Basic Test ===\n", __FILE__, __func__);
     
     // 测试DMA寄存器访问
-    volatile uint32_t *dma_ctrl = (uint32_t*)DMA_BASE_ADDR; // DMA0地址
+    volatile uint32_t *dma_ctrl = (uint32_t*)DMA_GLOBAL_CTRL_REG; // DMA0全局控制寄存器
     
     printf("[%s:%s] Enabling DMA controller\n", __FILE__, __func__);
     *dma_ctrl = 0x01;  // 启用DMA
@@ -245,22 +402,89 @@ void test_dma_basic(void) {
     volatile uint32_t *ch0_dst = (uint32_t*)DMA_CH_DST_REG(0);    // 通道0目标地址寄存器
     volatile uint32_t *ch0_size = (uint32_t*)DMA_CH_SIZE_REG(0);  // 通道0传输大小寄存器
     volatile uint32_t *ch0_config = (uint32_t*)DMA_CH_CONFIG_REG(0); // 通道0配置寄存器
-    volatile uint32_t *ch0_ctrl = (uint32_t*)DMA_CH_CTRL_REG(0);  // 通道0控制寄存器
+    volatile uint32_t *ch0_status = (uint32_t*)DMA_CH_STATUS_REG(0); // 通道0状态寄存器
+    
+    // 在SRAM中准备源数据
+    uint8_t *sram_src = (uint8_t *)SRAM_BASE;
+    uint8_t *sram_dst = (uint8_t *)(SRAM_BASE + 0x1000);
+    for (int i = 0; i < 1024; i++) {
+        sram_src[i] = (uint8_t)i;
+    }
     
     printf("[%s:%s] Configuring DMA channel 0\n", __FILE__, __func__);
-    *ch0_src = 0x20000000;     // 源地址
-    *ch0_dst = 0x20001000;     // 目标地址
-    *ch0_size = 1024;          // 传输1KB
-    *ch0_config = 0x30;        // 内存到内存，源和目标地址递增
+    *ch0_src = SRAM_BASE;           // 源地址
+    *ch0_dst = SRAM_BASE + 0x1000;  // 目标地址
+    *ch0_size = 1024;               // 传输1KB
+    *ch0_config = DMA_CCFG_SINC | DMA_CCFG_DINC;  // 内存到内存，源和目标地址递增
     
     printf("[%s:%s] Starting DMA transfer\n", __FILE__, __func__);
-    *ch0_ctrl = 0x03;          // 启用并开始传输
+    *ch0_config = DMA_CCFG_SINC | DMA_CCFG_DINC | DMA_CCFG_E;  // 启用通道开始传输
     
     sleep(1);  // 等待传输完成
     
+    if ((*ch0_status & DMA_CSTAT_DONE) && memcmp(sram_src, sram_dst, 1024) == 0) {
+        printf("[%s:%s] ✓ DMA memory-to-memory copy verified\n", __FILE__, __func__);
+    } else {
+        printf("[%s:%s] ✗ DMA memory-to-memory copy mismatch\n", __FILE__, __func__);
+    }
+    
     printf("[%s:%s] DMA basic test completed\n", __FILE__, __func__);
 }
 
+// DMA完成回调计数（在中断上下文中更新）
+static volatile int g_dma_irq_completions = 0;
+
+static void dma_test_callback(uint8_t channel, dma_channel_status_t status) {
+    (void)channel;
+    if (status == DMA_CH_DONE) {
+        g_dma_irq_completions++;
+    }
+}
+
+void test_dma_interrupt(void) {
+    printf("[%s:%s] \n=== DMA Interrupt Test ===\n", __FILE__, __func__);
+    
+    const int channel_count = 3;
+    int channels[3];
+    uint8_t *sram_src = (uint8_t *)(SRAM_BASE + 0x4000);
+    uint8_t *sram_dst = (uint8_t *)(SRAM_BASE + 0x8000);
+    
+    for (int i = 0; i < 3 * 256; i++) {
+        sram_src[i] = (uint8_t)(i * 7);
+    }
+    memset(sram_dst, 0, 3 * 256);
+    g_dma_irq_completions = 0;
+    
+    // 三个通道各自完成后由同一个合并中断上报
+    for (int i = 0; i < channel_count; i++) {
+        channels[i] = dma_allocate_channel();
+        if (channels[i] < 0 ||
+            dma_transfer_async((uint8_t)channels[i], SRAM_BASE + 0x4000 + i * 256, SRAM_BASE + 0x8000 + i * 256,
+                               256, DMA_TRANSFER_MEM_TO_MEM, dma_test_callback) != 0) {
+            printf("[%s:%s] ✗ Failed to start DMA channel %d\n", __FILE__, __func__, i);
+            return;
+        }
+    }
+    
+    for (int wait = 0; wait < 5 && g_dma_irq_completions < channel_count; wait++) {
+        sleep(1);  // 中断信号会提前唤醒sleep
+    }
+    
+    if (g_dma_irq_completions == channel_count && memcmp(sram_src, sram_dst, 3 * 256) == 0) {
+        printf("[%s:%s] ✓ %d DMA completions delivered through the combined interrupt\n", 
+               __FILE__, __func__, channel_count);
+    } else {
+        printf("[%s:%s] ✗ DMA interrupt completions: %d of %d\n", 
+               __FILE__, __func__, g_dma_irq_completions, channel_count);
+    }
+    
+    for (int i = 0; i < channel_count; i++) {
+        dma_free_channel((uint8_t)channels[i]);
+    }
+    
+    printf("[%s:%s] DMA interrupt test completed\n", __FILE__, __func__);
+}
+
 void test_uart_dma(void) {
     printf("[%s:%s] \n=== UART DMA Test ===\n", __FILE__, __func__);
     
@@ -356,7 +580,48 @@ void test_uart_dma(void) {
     printf("[%s:%s] UART DMA test completed\n", __FILE__, __func__);
 }
 
-int main(void) {
+static void print_usage(const char *program) {
+    printf("Usage: %s [--record FILE | --replay FILE] [--lockstep MODULE] [--control SOCKET]\n"
+           "       [--perf FILE] [--trap-profile FILE] [--vtime-profile FILE [--vtime-interval NS]]\n"
+           "       [--stimulus MODULE:KIND[:key=value,...]]...\n"
+           "  KIND: const | poisson | burst | file\n"
+           "  keys: rate, interval, baud, seed, count, start, on, off, channel, payload=seq|random, mask, path\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            g_record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            g_replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--lockstep") == 0 && i + 1 < argc) {
+            g_lockstep_module = argv[++i];
+        } else if (strcmp(argv[i], "--control") == 0 && i + 1 < argc) {
+            g_control_path = argv[++i];
+        } else if (strcmp(argv[i], "--perf") == 0 && i + 1 < argc) {
+            g_perf_path = argv[++i];
+        } else if (strcmp(argv[i], "--trap-profile") == 0 && i + 1 < argc) {
+            g_trap_profile_path = argv[++i];
+        } else if (strcmp(argv[i], "--vtime-profile") == 0 && i + 1 < argc) {
+            g_vtime_profile_path = argv[++i];
+        } else if (strcmp(argv[i], "--vtime-interval") == 0 && i + 1 < argc) {
+            g_vtime_interval_ns = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--stimulus") == 0 && i + 1 < argc) {
+            if (g_stimulus_count >= SIM_STIM_MAX || sim_stim_parse(argv[++i], &g_stimuli[g_stimulus_count]) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            g_stimulus_count++;
+        } else {
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (g_record_path && g_replay_path) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    
     printf("[%s:%s] IC Simulator Test Starting...\n", __FILE__, __func__);
     
     // 初始化系统
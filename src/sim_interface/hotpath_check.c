@@ -0,0 +1,262 @@
+#define _GNU_SOURCE
+
+// 热路径插桩运行时 - 只链接进bin/ic_simulator_hotpath（见Makefile的hotpath-check）
+//
+// 启动时（构造函数，早于任何线程）：
+//   - 启用sim_hotpath守卫；
+//   - 安装seccomp过滤器：除少数线程管理相关的系统调用外，其余系统调用都以SIGSYS
+//     陷入本文件的处理器，处理器记录后经固定地址的跳板指令代为执行，
+//     过滤器按指令地址放行跳板，不需要ptrace。过滤器由之后创建的线程继承。
+// malloc/calloc/realloc/free经链接器--wrap转到本文件计数（只覆盖模拟器代码
+// 自身的调用，libc内部的分配看不到）。
+// 退出时（析构函数）打印各区间的事件数和调用点；设置了IC_HOTPATH_BUDGET时
+// 与预算文件比较，超出预算以退出码1结束进程。
+//
+// 限制：addr2line等子进程会继承过滤器，报告只用dladdr符号化；放行的系统调用
+// （信号屏蔽、线程创建和退出）不计数。
+
+#include "sim_hotpath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <ucontext.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <linux/audit.h>
+
+#define HOTPATH_TOP_SITES 20
+
+// 系统调用跳板：参数按函数调用约定传入，hotpath_syscall_return是syscall指令的下一条，
+// 即seccomp看到的instruction_pointer
+long hotpath_syscall(long nr, long a1, long a2, long a3, long a4, long a5, long a6);
+extern char hotpath_syscall_return[];
+__asm__(
+    ".text\n"
+    ".type hotpath_syscall, @function\n"
+    "hotpath_syscall:\n"
+    "    movq %rdi, %rax\n"
+    "    movq %rsi, %rdi\n"
+    "    movq %rdx, %rsi\n"
+    "    movq %rcx, %rdx\n"
+    "    movq %r8, %r10\n"
+    "    movq %r9, %r8\n"
+    "    movq 8(%rsp), %r9\n"
+    "    syscall\n"
+    "hotpath_syscall_return:\n"
+    "    ret\n"
+    ".size hotpath_syscall, .-hotpath_syscall\n");
+
+// 直接放行的系统调用：在信号全部屏蔽的窗口内执行（线程启动和退出、
+// 信号处理器返回），此时无法递送SIGSYS，陷入会导致进程被内核杀死
+static const long g_allowed_syscalls[] = {
+    SYS_rt_sigreturn, SYS_rt_sigprocmask, SYS_clone, SYS_clone3, SYS_fork, SYS_vfork,
+    SYS_execve, SYS_exit, SYS_exit_group, SYS_set_robust_list, SYS_rseq, SYS_madvise, SYS_munmap,
+};
+
+#define ALLOWED_COUNT ((int)(sizeof(g_allowed_syscalls) / sizeof(g_allowed_syscalls[0])))
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    sim_hotpath_record(SIM_HOTPATH_ALLOC, (uintptr_t)__builtin_return_address(0), 0);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    sim_hotpath_record(SIM_HOTPATH_ALLOC, (uintptr_t)__builtin_return_address(0), 0);
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    sim_hotpath_record(SIM_HOTPATH_ALLOC, (uintptr_t)__builtin_return_address(0), 0);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) {
+        sim_hotpath_record(SIM_HOTPATH_FREE, (uintptr_t)__builtin_return_address(0), 0);
+    }
+    __real_free(ptr);
+}
+
+// SIGSYS处理器：记录后经跳板代为执行，返回值写回RAX
+static void sigsys_handler(int sig, siginfo_t *si, void *ctx) {
+    (void)sig;
+    ucontext_t *uc = (ucontext_t *)ctx;
+    greg_t *regs = uc->uc_mcontext.gregs;
+
+    sim_hotpath_record(SIM_HOTPATH_SYSCALL, (uintptr_t)si->si_call_addr, si->si_syscall);
+    regs[REG_RAX] = hotpath_syscall(si->si_syscall, regs[REG_RDI], regs[REG_RSI], regs[REG_RDX],
+                                    regs[REG_R10], regs[REG_R8], regs[REG_R9]);
+}
+
+// 安装过滤器：放行名单 -> 放行；来自跳板 -> 放行；其余 -> SIGSYS
+static int install_syscall_filter(void) {
+    struct sock_filter filter[ALLOWED_COUNT + 12];
+    int n = 0;
+    uint64_t ip = (uint64_t)(uintptr_t)hotpath_syscall_return;
+
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch));
+    filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, AUDIT_ARCH_X86_64, 1, 0);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr));
+    for (int i = 0; i < ALLOWED_COUNT; i++) {
+        // 命中时跳到末尾的ALLOW：跳过其后的(ALLOWED_COUNT - 1 - i)条名单和4条指令
+        filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)g_allowed_syscalls[i],
+                                                   (uint8_t)(ALLOWED_COUNT - 1 - i + 4), 0);
+    }
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, instruction_pointer));
+    filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)ip, 0, 3);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, instruction_pointer) + 4);
+    filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)(ip >> 32), 0, 1);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRAP);
+
+    struct sock_fprog prog = { .len = (unsigned short)n, .filter = filter };
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) {
+        return -1;
+    }
+    return prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog);
+}
+
+__attribute__((constructor))
+static void hotpath_check_init(void) {
+    struct sigaction sa;
+
+    sim_hotpath_enable();
+
+    // SIGSYS不能被屏蔽，处理器中嵌套的中断信号里也会有系统调用
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = sigsys_handler;
+    if (sigaction(SIGSYS, &sa, NULL) != 0 || install_syscall_filter() != 0) {
+        perror("hotpath seccomp");
+        printf("[%s:%s] Warning: syscall counting disabled, counting allocations only\n", __FILE__, __func__);
+        return;
+    }
+    printf("[%s:%s] Hot-path checking enabled: allocations and syscalls in guarded regions are counted\n",
+           __FILE__, __func__);
+}
+
+static int compare_sites(const void *a, const void *b) {
+    const sim_hotpath_site_t *sa = (const sim_hotpath_site_t *)a;
+    const sim_hotpath_site_t *sb = (const sim_hotpath_site_t *)b;
+    if (sa->count != sb->count) {
+        return sa->count < sb->count ? 1 : -1;
+    }
+    return sa->site < sb->site ? -1 : sa->site > sb->site;
+}
+
+static void describe_site(uintptr_t site, char *buf, size_t size) {
+    Dl_info info;
+    if (dladdr((void *)site, &info) && info.dli_fname) {
+        const char *base = strrchr(info.dli_fname, '/');
+        base = base ? base + 1 : info.dli_fname;
+        if (info.dli_sname) {
+            snprintf(buf, size, "%s (%s+0x%lx)", info.dli_sname, base, (unsigned long)(site - (uintptr_t)info.dli_fbase));
+        } else {
+            snprintf(buf, size, "%s+0x%lx", base, (unsigned long)(site - (uintptr_t)info.dli_fbase));
+        }
+    } else {
+        snprintf(buf, size, "0x%lx", (unsigned long)site);
+    }
+}
+
+// 每千次进入区间的事件数
+static double per_thousand(uint64_t events, uint64_t entries) {
+    return entries ? 1000.0 * (double)events / (double)entries : 0.0;
+}
+
+// 比较预算文件：每行"区间 事件 每千次进入允许的上限"，未列出的组合预算为0
+static int check_budget(const char *path, const sim_hotpath_stats_t *stats) {
+    double budget[SIM_HOTPATH_REGION_COUNT][SIM_HOTPATH_KIND_COUNT] = {{0}};
+    char line[256];
+    char region[32];
+    char kind[32];
+    double limit;
+    int regressions = 0;
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || sscanf(line, "%31s %31s %lf", region, kind, &limit) != 3) {
+            continue;
+        }
+        for (int r = 0; r < SIM_HOTPATH_REGION_COUNT; r++) {
+            for (int k = 0; k < SIM_HOTPATH_KIND_COUNT; k++) {
+                if (strcmp(region, sim_hotpath_region_name((sim_hotpath_region_t)r)) == 0 &&
+                    strcmp(kind, sim_hotpath_kind_name((sim_hotpath_kind_t)k)) == 0) {
+                    budget[r][k] = limit;
+                }
+            }
+        }
+    }
+    fclose(fp);
+
+    for (int r = 0; r < SIM_HOTPATH_REGION_COUNT; r++) {
+        for (int k = 0; k < SIM_HOTPATH_KIND_COUNT; k++) {
+            double measured = per_thousand(stats[r].events[k], stats[r].entries);
+            if (measured > budget[r][k]) {
+                printf("[%s:%s] REGRESSION: %s %s %.1f per 1000 entries exceeds budget %.1f\n", __FILE__, __func__,
+                       sim_hotpath_region_name((sim_hotpath_region_t)r), sim_hotpath_kind_name((sim_hotpath_kind_t)k),
+                       measured, budget[r][k]);
+                regressions++;
+            }
+        }
+    }
+    return regressions;
+}
+
+__attribute__((destructor))
+static void hotpath_check_report(void) {
+    sim_hotpath_stats_t stats[SIM_HOTPATH_REGION_COUNT];
+    static sim_hotpath_site_t sites[SIM_HOTPATH_MAX_SITES];
+    char where[160];
+
+    sim_hotpath_get_stats(stats);
+    printf("[%s:%s] Hot-path events (per 1000 region entries):\n", __FILE__, __func__);
+    printf("region      entries     alloc      free   syscall\n");
+    for (int r = 0; r < SIM_HOTPATH_REGION_COUNT; r++) {
+        printf("%-8s %10llu %9.1f %9.1f %9.1f\n", sim_hotpath_region_name((sim_hotpath_region_t)r),
+               (unsigned long long)stats[r].entries,
+               per_thousand(stats[r].events[SIM_HOTPATH_ALLOC], stats[r].entries),
+               per_thousand(stats[r].events[SIM_HOTPATH_FREE], stats[r].entries),
+               per_thousand(stats[r].events[SIM_HOTPATH_SYSCALL], stats[r].entries));
+    }
+
+    int count = sim_hotpath_get_sites(sites, SIM_HOTPATH_MAX_SITES);
+    qsort(sites, (size_t)count, sizeof(sites[0]), compare_sites);
+    if (count > 0) {
+        printf("   count  region    event    nr  site\n");
+    }
+    for (int i = 0; i < count && i < HOTPATH_TOP_SITES; i++) {
+        describe_site(sites[i].site, where, sizeof(where));
+        printf("%8llu  %-8s  %-7s %4ld  %s\n", (unsigned long long)sites[i].count,
+               sim_hotpath_region_name(sites[i].region), sim_hotpath_kind_name(sites[i].kind),
+               sites[i].kind == SIM_HOTPATH_SYSCALL ? sites[i].detail : -1L, where);
+    }
+
+    const char *budget = getenv("IC_HOTPATH_BUDGET");
+    if (budget) {
+        int regressions = check_budget(budget, stats);
+        printf("[%s:%s] Hot-path budget %s: %s\n", __FILE__, __func__, budget,
+               regressions ? "FAILED" : "passed");
+        if (regressions) {
+            fflush(stdout);
+            _exit(1);
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "interrupt_manager.h"
+#include "sim_hotpath.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -98,7 +99,9 @@ int handle_interrupt(uint32_t irq_num) {
             if (g_interrupt_bindings[i].handler) {
                 printf("[%s:%s] Handling interrupt: IRQ %d\n", 
                        __FILE__, __func__, irq_num);
+                sim_hotpath_enter(SIM_HOTPATH_IRQ);
                 g_interrupt_bindings[i].handler();
+                sim_hotpath_exit();
                 return 0;
             } else {
                 printf("[%s:%s] Error: No handler for interrupt IRQ %d\n", 
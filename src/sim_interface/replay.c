@@ -0,0 +1,611 @@
+#define _GNU_SOURCE
+
+#include "replay.h"
+#include "sim_interface.h"
+#include "../simulator/plugin_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// 声明外部函数
+extern simulator_plugin_t* find_plugin(const char *name);
+extern int handle_sim_message(const sim_message_t *msg, sim_message_t *response);
+extern int get_plugin_count(void);
+extern simulator_plugin_t* get_plugin_at(int index);
+
+#define REPLAY_SNAPSHOT_BUFFER   (64u * 1024u)
+#define REPLAY_TURN_TIMEOUT_NS   (10ULL * 1000000000ULL)  // 等待轮次超过10秒视为分歧
+#define REPLAY_TURN_PASSTHROUGH  -1
+
+static replay_mode_t g_mode = REPLAY_MODE_OFF;
+static replay_log_header_t g_header;
+static replay_stats_t g_stats;
+static uint64_t g_trap_seq = 0;
+
+// 记录：日志写入串行化；持锁期间屏蔽所有信号，避免中断处理程序在同一线程上重入
+static pthread_mutex_t g_log_lock = PTHREAD_MUTEX_INITIALIZER;
+static replay_writer_t *g_writer = NULL;
+static uint32_t g_snapshot_interval = REPLAY_DEFAULT_SNAPSHOT_INTERVAL;
+static uint8_t g_snapshot_buf[REPLAY_SNAPSHOT_BUFFER];
+
+// 回放：g_next是下一条陷入事件，只有g_turn与自己的线程槽相同的线程可以访问
+static replay_reader_t *g_reader = NULL;
+static replay_event_t g_next;
+static int g_turn = REPLAY_TURN_PASSTHROUGH;
+
+// 定位：重新施加记录的访问时设备发出的中断不发信号
+static bool g_seeking = false;
+
+// 线程槽：线程第一次陷入时按顺序分配，中断上下文统一为REPLAY_SLOT_ISR
+static int g_slot_count = 0;
+static __thread int t_slot = -1;
+static __thread int t_isr_depth = 0;
+static __thread bool t_in_log = false;
+
+static int module_index(const char *name) {
+    for (uint32_t i = 0; i < g_header.module_count; i++) {
+        if (strcmp(g_header.modules[i], name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static uint8_t current_slot(void) {
+    if (t_isr_depth > 0) {
+        return REPLAY_SLOT_ISR;
+    }
+    if (t_slot < 0) {
+        t_slot = __atomic_fetch_add(&g_slot_count, 1, __ATOMIC_RELAXED) & 0x7F;
+    }
+    return (uint8_t)t_slot;
+}
+
+// ---- 记录 ----
+
+static void log_lock(sigset_t *old) {
+    sigset_t all;
+    sigfillset(&all);
+    sigdelset(&all, SIGSYS);    // 同步信号，屏蔽时产生会直接杀死进程（见hotpath_check.c）
+    pthread_sigmask(SIG_BLOCK, &all, old);
+    pthread_mutex_lock(&g_log_lock);
+    t_in_log = true;
+}
+
+static void log_unlock(const sigset_t *old) {
+    t_in_log = false;
+    pthread_mutex_unlock(&g_log_lock);
+    pthread_sigmask(SIG_SETMASK, old, NULL);
+}
+
+// 持锁调用
+static void log_append(replay_event_t *ev) {
+    if (!g_writer) {
+        return;
+    }
+    if (ev->type != REPLAY_EV_SNAPSHOT) {
+        ev->vtime = sim_vtime_now();
+    }
+    if (replay_writer_append(g_writer, ev) != 0) {
+        printf("[%s:%s] Replay log write failed, recording stopped\n", __FILE__, __func__);
+        replay_writer_close(g_writer);
+        g_writer = NULL;
+    }
+}
+
+// 持锁调用：保存所有支持save_state的插件状态
+static void log_snapshot(void) {
+    replay_event_t ev;
+    size_t pos = 0;
+
+    memset(&ev, 0, sizeof(ev));
+    for (int i = 0; i < get_plugin_count(); i++) {
+        simulator_plugin_t *plugin = get_plugin_at(i);
+        int module = module_index(plugin->name);
+        if (module < 0 || !plugin->save_state) {
+            continue;
+        }
+        uint8_t state[REPLAY_SNAPSHOT_BUFFER / 8];
+        size_t len = plugin->save_state(plugin, state, sizeof(state));
+        if (len == 0 || len > sizeof(state) ||
+            replay_snapshot_put(g_snapshot_buf, sizeof(g_snapshot_buf), &pos, (uint8_t)module,
+                                state, (uint32_t)len) != 0) {
+            continue;
+        }
+        ev.count++;
+    }
+
+    ev.type = REPLAY_EV_SNAPSHOT;
+    ev.vtime = sim_vtime_now();
+    ev.trap_seq = g_trap_seq;
+    ev.data = g_snapshot_buf;
+    ev.data_len = (uint32_t)pos;
+    log_append(&ev);
+    g_stats.snapshots++;
+}
+
+int replay_record_start(const char *path, uint32_t snapshot_interval) {
+    if (g_mode != REPLAY_MODE_OFF) {
+        return -1;
+    }
+
+    memset(&g_header, 0, sizeof(g_header));
+    g_header.trap_ns = SIM_VTIME_TRAP_NS;
+    g_header.snapshot_interval = snapshot_interval ? snapshot_interval : REPLAY_DEFAULT_SNAPSHOT_INTERVAL;
+    for (int i = 0; i < get_plugin_count() && g_header.module_count < REPLAY_MAX_MODULES; i++) {
+        strncpy(g_header.modules[g_header.module_count++], get_plugin_at(i)->name, 31);
+    }
+
+    g_writer = replay_writer_open(path, &g_header);
+    if (!g_writer) {
+        return -1;
+    }
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_snapshot_interval = g_header.snapshot_interval;
+    g_trap_seq = 0;
+
+    // 起点快照：从头回放和按时间跳转都从一个快照开始
+    sigset_t old;
+    log_lock(&old);
+    log_snapshot();
+    log_unlock(&old);
+
+    g_mode = REPLAY_MODE_RECORD;
+    printf("[%s:%s] Recording nondeterministic inputs to %s (%u modules, snapshot every %u traps)\n",
+           __FILE__, __func__, path, g_header.module_count, g_snapshot_interval);
+    return 0;
+}
+
+// ---- 回放 ----
+
+static void replay_diverge(const char *fmt, ...) {
+    if (!g_stats.diverged) {
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(g_stats.diverge_reason, sizeof(g_stats.diverge_reason), fmt, ap);
+        va_end(ap);
+        g_stats.diverged = true;
+        g_stats.diverge_trap = g_trap_seq;
+        printf("[%s:%s] Replay diverged at trap %llu: %s, continuing live\n", __FILE__, __func__,
+               (unsigned long long)g_trap_seq, g_stats.diverge_reason);
+    }
+    __atomic_store_n(&g_turn, REPLAY_TURN_PASSTHROUGH, __ATOMIC_RELEASE);
+}
+
+// 回放全速运行，设备模型的后台工作（如DMA监控线程上的传输）可能还没赶上记录时的进度。
+// 递送中断前用时钟节拍让各设备在当前线程上同步完成已启动的工作。
+static void replay_sync_devices(void) {
+    for (int i = 0; i < get_plugin_count(); i++) {
+        simulator_plugin_t *plugin = get_plugin_at(i);
+        if (plugin->clock) {
+            plugin->clock(plugin, CLOCK_TICK, 0);
+        }
+    }
+}
+
+// 在记录的位置递送中断：调用方在陷入处理中，信号在处理程序返回时才递送
+static void replay_deliver_irq(const replay_event_t *ev) {
+    int sig = sim_irq_signal(g_header.modules[ev->module], ev->value);
+    if (sig < 0) {
+        replay_diverge("no signal mapping for %s IRQ %u", g_header.modules[ev->module], ev->value);
+        return;
+    }
+    replay_sync_devices();
+    g_stats.irqs++;
+    pthread_kill(pthread_self(), sig);
+}
+
+// 执行到下一条陷入事件为止的所有非陷入事件，然后把轮次交给该陷入的线程槽
+static void replay_advance(void) {
+    replay_event_t ev;
+
+    for (;;) {
+        int rc = replay_reader_next(g_reader, &ev);
+        if (rc == 0) {
+            printf("[%s:%s] Replay log exhausted after %llu traps, continuing live\n",
+                   __FILE__, __func__, (unsigned long long)g_trap_seq);
+            __atomic_store_n(&g_turn, REPLAY_TURN_PASSTHROUGH, __ATOMIC_RELEASE);
+            return;
+        }
+        if (rc < 0) {
+            replay_diverge("corrupt log record after trap %llu", (unsigned long long)g_trap_seq);
+            return;
+        }
+
+        switch (ev.type) {
+            case REPLAY_EV_TRAP:
+                g_next = ev;
+                __atomic_store_n(&g_turn, (int)ev.slot, __ATOMIC_RELEASE);
+                return;
+            case REPLAY_EV_INPUT: {
+                sim_message_t msg = {0};
+                msg.type = MSG_INPUT;
+                strcpy(msg.module, g_header.modules[ev.module]);
+                msg.value = ev.value;
+                msg.data.input.channel = ev.channel;
+                sim_vtime_set(ev.vtime);
+                handle_sim_message(&msg, NULL);
+                g_stats.inputs++;
+                break;
+            }
+            case REPLAY_EV_IRQ:
+                replay_deliver_irq(&ev);
+                break;
+            case REPLAY_EV_RAISE:
+                g_stats.raises++;
+                break;
+            case REPLAY_EV_SNAPSHOT:
+                g_stats.snapshots++;
+                break;
+        }
+    }
+}
+
+// 等待轮到当前线程执行下一次陷入；返回false表示已切换为直通
+static bool replay_wait_turn(void) {
+    struct timespec start = {0, 0};
+    uint32_t spins = 0;
+
+    for (;;) {
+        int turn = __atomic_load_n(&g_turn, __ATOMIC_ACQUIRE);
+        if (turn == REPLAY_TURN_PASSTHROUGH) {
+            return false;
+        }
+        if (t_isr_depth > 0) {
+            if (turn == REPLAY_SLOT_ISR) {
+                return true;
+            }
+        } else if (t_slot >= 0) {
+            if (turn == t_slot) {
+                return true;
+            }
+        } else if (turn != REPLAY_SLOT_ISR) {
+            // 尚未分配槽的线程认领下一个新槽
+            int expected = turn;
+            if (turn == __atomic_load_n(&g_slot_count, __ATOMIC_ACQUIRE) &&
+                __atomic_compare_exchange_n(&g_slot_count, &expected, turn + 1, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                t_slot = turn;
+                return true;
+            }
+        }
+
+        // 轮次属于其他线程：让出CPU，超时视为分歧
+        if ((++spins & 0x3FF) == 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (start.tv_sec == 0 && start.tv_nsec == 0) {
+                start = now;
+            } else if ((uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL +
+                       (uint64_t)now.tv_nsec - (uint64_t)start.tv_nsec > REPLAY_TURN_TIMEOUT_NS) {
+                replay_diverge("slot %d waited for a turn held by slot 0x%02X",
+                               t_isr_depth > 0 ? REPLAY_SLOT_ISR : t_slot, turn);
+                return false;
+            }
+        }
+        sched_yield();
+    }
+}
+
+int replay_start(const char *path) {
+    if (g_mode != REPLAY_MODE_OFF) {
+        return -1;
+    }
+
+    g_reader = replay_reader_open(path);
+    if (!g_reader) {
+        return -1;
+    }
+    g_header = *replay_reader_header(g_reader);
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_trap_seq = 0;
+    g_slot_count = 0;
+
+    // 检查记录时的模块都已注册
+    for (uint32_t i = 0; i < g_header.module_count; i++) {
+        if (!find_plugin(g_header.modules[i])) {
+            printf("[%s:%s] Replay log needs module %s, which is not registered\n",
+                   __FILE__, __func__, g_header.modules[i]);
+            replay_reader_close(g_reader);
+            g_reader = NULL;
+            return -1;
+        }
+    }
+
+    g_mode = REPLAY_MODE_REPLAY;
+    printf("[%s:%s] Replaying %s (%u modules, vtime %u ns/trap)\n",
+           __FILE__, __func__, path, g_header.module_count, g_header.trap_ns);
+    replay_advance();
+    return 0;
+}
+
+// 把快照中的设备状态恢复到已注册的插件
+static int restore_snapshot(const replay_log_header_t *header, const replay_event_t *snapshot) {
+    size_t pos = 0;
+    uint8_t module;
+    const uint8_t *state;
+    uint32_t len;
+    int rc;
+
+    while ((rc = replay_snapshot_next(snapshot, &pos, &module, &state, &len)) == 1) {
+        if (module >= header->module_count) {
+            return -1;
+        }
+        simulator_plugin_t *plugin = find_plugin(header->modules[module]);
+        if (!plugin || !plugin->load_state || plugin->load_state(plugin, state, len) != 0) {
+            printf("[%s:%s] Cannot restore state of %s\n", __FILE__, __func__, header->modules[module]);
+            return -1;
+        }
+    }
+    if (rc == 0) {
+        sim_vtime_set(snapshot->vtime);
+    }
+    return rc;
+}
+
+int replay_seek(const char *path, uint64_t vtime) {
+    replay_event_t ev;
+    int applied = 0;
+    int rc;
+
+    if (g_mode != REPLAY_MODE_OFF) {
+        return -1;
+    }
+
+    replay_reader_t *reader = replay_reader_open(path);
+    if (!reader) {
+        return -1;
+    }
+    const replay_log_header_t *header = replay_reader_header(reader);
+    for (uint32_t i = 0; i < header->module_count; i++) {
+        if (!find_plugin(header->modules[i])) {
+            printf("[%s:%s] Replay log needs module %s, which is not registered\n",
+                   __FILE__, __func__, header->modules[i]);
+            replay_reader_close(reader);
+            return -1;
+        }
+    }
+
+    // 记录开始时写了起点快照，早于它的时刻无法定位
+    rc = replay_reader_seek(reader, vtime, &ev);
+    if (rc != 1 || restore_snapshot(header, &ev) != 0) {
+        printf("[%s:%s] No usable snapshot at or before vtime %llu in %s\n",
+               __FILE__, __func__, (unsigned long long)vtime, path);
+        replay_reader_close(reader);
+        return -1;
+    }
+    uint64_t snapshot_trap = ev.trap_seq;
+
+    // 重新施加快照之后到vtime为止的访问和外部输入；中断只影响驱动，这里不递送
+    g_seeking = true;
+    while ((rc = replay_reader_next(reader, &ev)) == 1 && ev.vtime <= vtime) {
+        sim_message_t msg = {0};
+        sim_message_t response = {0};
+
+        if (ev.type == REPLAY_EV_TRAP) {
+            msg.type = ev.is_write ? MSG_REG_WRITE : MSG_REG_READ;
+            msg.address = ev.address;
+            msg.value = ev.value;
+        } else if (ev.type == REPLAY_EV_INPUT) {
+            msg.type = MSG_INPUT;
+            msg.value = ev.value;
+            msg.data.input.channel = ev.channel;
+        } else {
+            continue;
+        }
+        strcpy(msg.module, header->modules[ev.module]);
+        sim_vtime_set(ev.vtime);
+        handle_sim_message(&msg, &response);
+        applied++;
+    }
+    replay_sync_devices();
+    g_seeking = false;
+    sim_vtime_set(vtime);
+    replay_reader_close(reader);
+
+    if (rc < 0) {
+        printf("[%s:%s] Corrupt log record while seeking %s\n", __FILE__, __func__, path);
+        return -1;
+    }
+    printf("[%s:%s] Restored snapshot at trap %llu and re-applied %d events up to vtime %llu\n",
+           __FILE__, __func__, (unsigned long long)snapshot_trap, applied, (unsigned long long)vtime);
+    return applied;
+}
+
+// ---- 钩子 ----
+
+int replay_trap_access(const sim_message_t *msg, sim_message_t *response) {
+    bool is_write = msg->type == MSG_REG_WRITE;
+    int rc;
+
+    if (g_mode == REPLAY_MODE_RECORD) {
+        replay_event_t ev;
+        sigset_t old;
+        memset(&ev, 0, sizeof(ev));
+
+        // 访问本身也在锁内执行，日志顺序即设备看到的顺序
+        log_lock(&old);
+        rc = handle_sim_message(msg, response);
+        int module = module_index(msg->module);
+        if (module >= 0) {
+            ev.type = REPLAY_EV_TRAP;
+            ev.slot = current_slot();
+            ev.module = (uint8_t)module;
+            ev.is_write = is_write;
+            ev.address = msg->address;
+            ev.value = is_write ? msg->value : (uint32_t)response->data.response.result;
+            log_append(&ev);
+            g_stats.traps++;
+            if (++g_trap_seq % g_snapshot_interval == 0) {
+                log_snapshot();
+            }
+        }
+        log_unlock(&old);
+        return rc;
+    }
+
+    if (g_mode != REPLAY_MODE_REPLAY || !replay_wait_turn()) {
+        return handle_sim_message(msg, response);
+    }
+
+    // 轮次属于当前线程，g_next不会被其他线程改动
+    if (strcmp(g_header.modules[g_next.module], msg->module) != 0 ||
+        g_next.address != msg->address || g_next.is_write != is_write ||
+        (is_write && g_next.value != msg->value)) {
+        replay_diverge("expected %s 0x%08X=0x%08X, driver did %s 0x%08X=0x%08X",
+                       g_next.is_write ? "write" : "read", g_next.address, g_next.value,
+                       is_write ? "write" : "read", msg->address, is_write ? msg->value : 0);
+        return handle_sim_message(msg, response);
+    }
+
+    rc = handle_sim_message(msg, response);
+    if (!is_write && response) {
+        if ((uint32_t)response->data.response.result != g_next.value) {
+            if (g_stats.read_mismatches++ == 0) {
+                printf("[%s:%s] First model mismatch at trap %llu: read 0x%08X returned 0x%08X, recorded 0x%08X\n",
+                       __FILE__, __func__, (unsigned long long)g_trap_seq, msg->address,
+                       (uint32_t)response->data.response.result, g_next.value);
+            }
+        }
+        response->data.response.result = (int32_t)g_next.value;
+    }
+    sim_vtime_set(g_next.vtime);
+    g_stats.traps++;
+    g_trap_seq++;
+    replay_advance();
+    return rc;
+}
+
+int replay_device_input(const sim_message_t *msg) {
+    if (g_mode == REPLAY_MODE_REPLAY) {
+        return 0;   // 外部输入由日志提供
+    }
+    if (g_mode != REPLAY_MODE_RECORD) {
+        return handle_sim_message(msg, NULL);
+    }
+
+    replay_event_t ev;
+    sigset_t old;
+    memset(&ev, 0, sizeof(ev));
+
+    log_lock(&old);
+    int module = module_index(msg->module);
+    if (module >= 0) {
+        ev.type = REPLAY_EV_INPUT;
+        ev.module = (uint8_t)module;
+        ev.channel = msg->data.input.channel;
+        ev.value = msg->value;
+        log_append(&ev);
+        g_stats.inputs++;
+    }
+    int rc = handle_sim_message(msg, NULL);
+    log_unlock(&old);
+    return rc;
+}
+
+bool replay_irq_raise(const char *module, uint32_t irq_num) {
+    if (g_mode == REPLAY_MODE_REPLAY) {
+        __atomic_fetch_add(&g_stats.live_raises, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    if (g_seeking) {
+        return false;
+    }
+    if (g_mode != REPLAY_MODE_RECORD) {
+        return true;
+    }
+
+    int index = module_index(module);
+    if (index >= 0) {
+        replay_event_t ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = REPLAY_EV_RAISE;
+        ev.module = (uint8_t)index;
+        ev.value = irq_num;
+
+        // 陷入访问中发出的中断已经持有日志锁
+        if (t_in_log) {
+            log_append(&ev);
+        } else {
+            sigset_t old;
+            log_lock(&old);
+            log_append(&ev);
+            log_unlock(&old);
+        }
+        __atomic_fetch_add(&g_stats.raises, 1, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+void replay_irq_enter(const char *module, uint32_t irq_num) {
+    if (g_mode == REPLAY_MODE_RECORD) {
+        int index = module_index(module);
+        if (index >= 0) {
+            replay_event_t ev;
+            sigset_t old;
+            memset(&ev, 0, sizeof(ev));
+            ev.type = REPLAY_EV_IRQ;
+            ev.module = (uint8_t)index;
+            ev.slot = current_slot();
+            ev.value = irq_num;
+
+            log_lock(&old);
+            log_append(&ev);
+            g_stats.irqs++;
+            log_unlock(&old);
+        }
+    }
+    t_isr_depth++;
+}
+
+void replay_irq_exit(void) {
+    if (t_isr_depth > 0) {
+        t_isr_depth--;
+    }
+}
+
+replay_mode_t replay_get_mode(void) {
+    return g_mode;
+}
+
+void replay_get_stats(replay_stats_t *stats) {
+    *stats = g_stats;
+    if (g_writer) {
+        stats->log_bytes = replay_writer_bytes(g_writer);
+        stats->log_raw_bytes = replay_writer_raw_bytes(g_writer);
+    }
+}
+
+void replay_stop(void) {
+    if (g_mode == REPLAY_MODE_RECORD) {
+        sigset_t old;
+        log_lock(&old);
+        log_snapshot();
+        g_stats.log_bytes = replay_writer_bytes(g_writer);
+        g_stats.log_raw_bytes = replay_writer_raw_bytes(g_writer);
+        replay_writer_close(g_writer);
+        g_writer = NULL;
+        g_mode = REPLAY_MODE_OFF;
+        log_unlock(&old);
+
+        printf("[%s:%s] Recorded %llu traps, %llu inputs, %llu IRQ deliveries, %llu snapshots in %llu bytes (%llu before compression)\n",
+               __FILE__, __func__, (unsigned long long)g_stats.traps, (unsigned long long)g_stats.inputs,
+               (unsigned long long)g_stats.irqs, (unsigned long long)g_stats.snapshots,
+               (unsigned long long)g_stats.log_bytes, (unsigned long long)g_stats.log_raw_bytes);
+    } else if (g_mode == REPLAY_MODE_REPLAY) {
+        __atomic_store_n(&g_turn, REPLAY_TURN_PASSTHROUGH, __ATOMIC_RELEASE);
+        g_mode = REPLAY_MODE_OFF;
+        replay_reader_close(g_reader);
+        g_reader = NULL;
+
+        printf("[%s:%s] Replayed %llu traps, %llu inputs, %llu IRQ deliveries; %llu model read mismatches; %s\n",
+               __FILE__, __func__, (unsigned long long)g_stats.traps, (unsigned long long)g_stats.inputs,
+               (unsigned long long)g_stats.irqs, (unsigned long long)g_stats.read_mismatches,
+               g_stats.diverged ? g_stats.diverge_reason : "no divergence");
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "../common/protocol.h"
+#include "replay_log.h"
+
+// 确定性记录/回放
+//
+// 仿真中的不确定性来自芯片外部：UART RX等外部输入到达的时刻、中断信号在哪两次
+// 寄存器访问之间被递送、以及多个线程的陷入访问交错顺序。记录模式把这些输入连同
+// 虚拟时间写入二进制日志（格式见replay_log.h）；回放模式按日志重现：
+//   - 陷入访问按记录的线程槽顺序放行，读访问返回记录的值（与设备模型的实时结果比对）
+//   - 外部输入在记录的位置注入设备，设备自身的输入源（如UART监控线程）被屏蔽
+//   - 中断只在记录的位置递送给陷入线程，设备实时发出的中断只计数不发信号
+// 回放不依赖sleep和线程调度，偏离记录时报告第一处分歧并切换为直通。
+
+typedef enum {
+    REPLAY_MODE_OFF = 0,
+    REPLAY_MODE_RECORD,
+    REPLAY_MODE_REPLAY
+} replay_mode_t;
+
+#define REPLAY_DEFAULT_SNAPSHOT_INTERVAL  4096   // 每隔多少次陷入写一个设备快照
+
+typedef struct {
+    uint64_t traps;             // 记录/回放的陷入访问数
+    uint64_t inputs;            // 外部输入数
+    uint64_t irqs;              // 中断递送数
+    uint64_t raises;            // 日志中设备发出的中断数
+    uint64_t live_raises;       // 回放时设备模型实际发出的中断数
+    uint64_t snapshots;
+    uint64_t log_bytes;
+    uint64_t log_raw_bytes;     // 日志事件压缩前的字节数
+    uint64_t read_mismatches;   // 设备模型读出值与记录不一致的次数
+    bool diverged;              // 访问序列偏离记录，已切换为直通
+    uint64_t diverge_trap;      // 第一处分歧的陷入序号
+    char diverge_reason[160];
+} replay_stats_t;
+
+// 开始记录，需在插件注册之后、驱动初始化之前调用
+int replay_record_start(const char *path, uint32_t snapshot_interval);
+
+// 开始回放，需在插件注册之后、驱动初始化之前调用
+int replay_start(const char *path);
+
+// 停止记录（写入最后的快照和索引）或回放，并打印统计
+void replay_stop(void);
+
+replay_mode_t replay_get_mode(void);
+void replay_get_stats(replay_stats_t *stats);
+
+// 把已注册插件的设备状态定位到日志中的虚拟时间vtime：从不晚于vtime的最近快照恢复，
+// 再重新施加其后到vtime为止记录的陷入访问和外部输入。只恢复设备，不恢复驱动，
+// 需在记录/回放之外调用；返回重新施加的事件数，失败返回-1
+int replay_seek(const char *path, uint64_t vtime);
+
+// ---- sim_interface内部钩子 ----
+
+// 执行一次陷入的寄存器访问
+int replay_trap_access(const sim_message_t *msg, sim_message_t *response);
+
+// 执行一次外部输入（MSG_INPUT）
+int replay_device_input(const sim_message_t *msg);
+
+// 设备发出中断；返回false表示不发信号（回放时由日志决定递送位置）
+bool replay_irq_raise(const char *module, uint32_t irq_num);
+
+// 中断处理程序进入/退出
+void replay_irq_enter(const char *module, uint32_t irq_num);
+void replay_irq_exit(void);
+
+#endif // REPLAY_H
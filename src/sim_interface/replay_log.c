@@ -0,0 +1,827 @@
+#define _GNU_SOURCE
+
+#include "replay_log.h"
+#include "trace_lz.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define REPLAY_INDEX_INITIAL    64
+#define REPLAY_TRAILER_SIZE     16      // u32 条目数 + u64 索引偏移 + u32 magic
+#define REPLAY_HEADER_FIXED     16      // magic + 版本 + 模块数 + trap_ns + 快照间隔
+#define REPLAY_CHUNK_HEADER     72      // 见write_chunk_header
+#define REPLAY_MAX_RECORD       32      // 非快照事件编码后的最大长度
+
+#define REPLAY_CHUNK_COMPRESSED 0x1     // 块头flags：负载经trace_lz压缩
+#define REPLAY_CHUNK_SNAPSHOT   0x2     // 块头flags：块以快照开头
+
+struct replay_writer {
+    FILE *fp;
+    uint64_t offset;            // 已写入文件的字节数
+    uint64_t raw_total;         // 已写入的事件压缩前的字节数
+    // 当前块：原始事件在raw中累积，关闭块时压缩到packed再写出
+    uint8_t *raw;
+    size_t raw_used;
+    size_t raw_cap;
+    uint8_t *packed;
+    size_t packed_cap;
+    replay_chunk_info_t chunk;
+    uint32_t chunk_flags;
+    trace_lz_state_t lz;
+    uint64_t last_vtime;
+    uint32_t last_addr;
+    replay_index_entry_t *index;
+    size_t index_count;
+    size_t index_cap;
+};
+
+struct replay_reader {
+    const uint8_t *map;
+    size_t size;
+    uint16_t version;
+    size_t events_begin;
+    size_t events_end;
+    // 当前解码的事件区：版本1为整个事件流，版本2为当前块（解压到chunk_buf或直接指向映射）
+    const uint8_t *data;
+    size_t data_end;
+    size_t pos;
+    size_t next_chunk;
+    uint8_t *chunk_buf;         // 按最大块分配一次，陷入路径上解码时不再分配内存
+    uint64_t last_vtime;
+    uint32_t last_addr;
+    replay_log_header_t header;
+    replay_index_entry_t *index;
+    size_t index_count;
+    replay_chunk_info_t *chunks;
+    size_t chunk_count;
+};
+
+// ---- 编码辅助 ----
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int get_varint(const uint8_t *p, size_t end, size_t *pos, uint64_t *v) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= end) {
+            return -1;
+        }
+        uint8_t b = p[(*pos)++];
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static void put_le(uint8_t *p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+// ---- 块头 ----
+//
+//   u32 magic  u32 存储长度  u32 原始长度  u32 事件数
+//   u64 首个事件的虚拟时间  u64 最后一个事件的虚拟时间
+//   u32 模块位图  u32 flags  u8[32] 地址布隆过滤器
+
+static void bloom_hashes(uint32_t address, uint32_t h[2]) {
+    uint32_t word = address >> 2;
+    h[0] = (word * 0x9E3779B1u) >> 24;
+    h[1] = (word * 0x85EBCA77u) >> 24;
+}
+
+bool replay_chunk_may_contain(const replay_chunk_info_t *chunk, uint32_t address) {
+    uint32_t h[2];
+    bloom_hashes(address, h);
+    return (chunk->addr_bloom[h[0] >> 3] & (1u << (h[0] & 7))) &&
+           (chunk->addr_bloom[h[1] >> 3] & (1u << (h[1] & 7)));
+}
+
+static void write_chunk_header(uint8_t *p, const replay_chunk_info_t *c, uint32_t flags) {
+    put_le(p, REPLAY_LOG_CHUNK_MAGIC, 4);
+    put_le(p + 4, c->stored_len, 4);
+    put_le(p + 8, c->raw_len, 4);
+    put_le(p + 12, c->events, 4);
+    put_le(p + 16, c->vtime_first, 8);
+    put_le(p + 24, c->vtime_last, 8);
+    put_le(p + 32, c->module_mask, 4);
+    put_le(p + 36, flags, 4);
+    memcpy(p + 40, c->addr_bloom, sizeof(c->addr_bloom));
+}
+
+static void read_chunk_header(const uint8_t *p, replay_chunk_info_t *c, uint32_t *flags) {
+    c->stored_len = (uint32_t)get_le(p + 4, 4);
+    c->raw_len = (uint32_t)get_le(p + 8, 4);
+    c->events = (uint32_t)get_le(p + 12, 4);
+    c->vtime_first = get_le(p + 16, 8);
+    c->vtime_last = get_le(p + 24, 8);
+    c->module_mask = (uint32_t)get_le(p + 32, 4);
+    *flags = (uint32_t)get_le(p + 36, 4);
+    c->compressed = (*flags & REPLAY_CHUNK_COMPRESSED) != 0;
+    c->snapshot = (*flags & REPLAY_CHUNK_SNAPSHOT) != 0;
+    memcpy(c->addr_bloom, p + 40, sizeof(c->addr_bloom));
+}
+
+// ---- 写入 ----
+
+static int writer_put(replay_writer_t *w, const void *data, size_t len) {
+    if (len && fwrite(data, 1, len, w->fp) != len) {
+        return -1;
+    }
+    w->offset += len;
+    return 0;
+}
+
+// 确保当前块能再容纳len字节（只有大快照会让块超出REPLAY_CHUNK_SIZE）
+static int writer_reserve(replay_writer_t *w, size_t len) {
+    if (w->raw_used + len <= w->raw_cap) {
+        return 0;
+    }
+    size_t cap = w->raw_used + len;
+    uint8_t *raw = realloc(w->raw, cap);
+    if (!raw) {
+        return -1;
+    }
+    w->raw = raw;
+    w->raw_cap = cap;
+    uint8_t *packed = realloc(w->packed, TRACE_LZ_BOUND(cap));
+    if (!packed) {
+        return -1;
+    }
+    w->packed = packed;
+    w->packed_cap = TRACE_LZ_BOUND(cap);
+    return 0;
+}
+
+// 压缩并写出当前块；压缩后不更小时原样存储
+static int writer_close_chunk(replay_writer_t *w) {
+    if (w->raw_used == 0) {
+        return 0;
+    }
+    replay_chunk_info_t *c = &w->chunk;
+    const uint8_t *payload = w->raw;
+    size_t packed = trace_lz_compress(&w->lz, w->raw, w->raw_used, w->packed, w->packed_cap);
+    c->raw_len = (uint32_t)w->raw_used;
+    if (packed && packed < w->raw_used) {
+        payload = w->packed;
+        c->stored_len = (uint32_t)packed;
+        w->chunk_flags |= REPLAY_CHUNK_COMPRESSED;
+    } else {
+        c->stored_len = c->raw_len;
+    }
+
+    uint8_t header[REPLAY_CHUNK_HEADER];
+    write_chunk_header(header, c, w->chunk_flags);
+    int result = writer_put(w, header, sizeof(header));
+    if (result == 0) {
+        result = writer_put(w, payload, c->stored_len);
+    }
+    w->raw_total += w->raw_used;
+    w->raw_used = 0;
+    return result;
+}
+
+// 开始新块：增量编码的基准改为块内第一条事件
+static void writer_begin_chunk(replay_writer_t *w, const replay_event_t *ev) {
+    memset(&w->chunk, 0, sizeof(w->chunk));
+    w->chunk.offset = w->offset;
+    w->chunk.vtime_first = ev->vtime;
+    w->chunk.snapshot = ev->type == REPLAY_EV_SNAPSHOT;
+    w->chunk_flags = w->chunk.snapshot ? REPLAY_CHUNK_SNAPSHOT : 0;
+    w->last_vtime = ev->vtime;
+    w->last_addr = 0;
+}
+
+replay_writer_t* replay_writer_open(const char *path, const replay_log_header_t *header) {
+    replay_writer_t *w = calloc(1, sizeof(replay_writer_t));
+    if (!w) {
+        return NULL;
+    }
+    w->raw_cap = REPLAY_CHUNK_SIZE;
+    w->packed_cap = TRACE_LZ_BOUND(REPLAY_CHUNK_SIZE);
+    w->raw = malloc(w->raw_cap);
+    w->packed = malloc(w->packed_cap);
+    w->fp = fopen(path, "wb");
+    if (!w->fp || !w->raw || !w->packed) {
+        printf("[%s:%s] Cannot create replay log %s\n", __FILE__, __func__, path);
+        if (w->fp) {
+            fclose(w->fp);
+        }
+        free(w->raw);
+        free(w->packed);
+        free(w);
+        return NULL;
+    }
+
+    uint8_t fixed[REPLAY_HEADER_FIXED];
+    put_le(fixed, REPLAY_LOG_MAGIC, 4);
+    put_le(fixed + 4, REPLAY_LOG_VERSION, 2);
+    put_le(fixed + 6, header->module_count, 2);
+    put_le(fixed + 8, header->trap_ns, 4);
+    put_le(fixed + 12, header->snapshot_interval, 4);
+    writer_put(w, fixed, sizeof(fixed));
+    for (uint32_t i = 0; i < header->module_count; i++) {
+        writer_put(w, header->modules[i], sizeof(header->modules[i]));
+    }
+    return w;
+}
+
+int replay_writer_append(replay_writer_t *w, const replay_event_t *ev) {
+    uint8_t rec[REPLAY_MAX_RECORD];
+    size_t n = 0;
+
+    // 快照总是开始新块，其他事件在块满时开始新块
+    if (ev->type == REPLAY_EV_SNAPSHOT || w->raw_used + REPLAY_MAX_RECORD > REPLAY_CHUNK_SIZE) {
+        if (writer_close_chunk(w) != 0) {
+            return -1;
+        }
+    }
+    if (w->raw_used == 0) {
+        writer_begin_chunk(w, ev);
+    }
+
+    if (ev->type == REPLAY_EV_SNAPSHOT) {
+        if (w->index_count == w->index_cap) {
+            size_t cap = w->index_cap ? w->index_cap * 2 : REPLAY_INDEX_INITIAL;
+            replay_index_entry_t *index = realloc(w->index, cap * sizeof(*index));
+            if (!index) {
+                return -1;
+            }
+            w->index = index;
+            w->index_cap = cap;
+        }
+        w->index[w->index_count].vtime = ev->vtime;
+        w->index[w->index_count].trap_seq = ev->trap_seq;
+        w->index[w->index_count].offset = w->chunk.offset;
+        w->index_count++;
+
+        // 快照使用绝对值
+        rec[n++] = REPLAY_EV_SNAPSHOT;
+        n += put_varint(rec + n, ev->vtime);
+        n += put_varint(rec + n, ev->trap_seq);
+        n += put_varint(rec + n, ev->count);
+        n += put_varint(rec + n, ev->data_len);
+        if (writer_reserve(w, n + ev->data_len) != 0) {
+            return -1;
+        }
+        memcpy(w->raw + w->raw_used, rec, n);
+        memcpy(w->raw + w->raw_used + n, ev->data, ev->data_len);
+        w->raw_used += n + ev->data_len;
+        // 快照含所有设备的状态，不计入模块位图
+        w->chunk.events++;
+        w->chunk.vtime_last = ev->vtime;
+        return 0;
+    }
+
+    uint64_t dv = ev->vtime >= w->last_vtime ? ev->vtime - w->last_vtime : 0;
+    rec[n++] = (uint8_t)(ev->type | (ev->is_write ? 0x10 : 0));
+    n += put_varint(rec + n, dv);
+    w->last_vtime += dv;
+
+    switch (ev->type) {
+        case REPLAY_EV_TRAP: {
+            uint32_t h[2];
+            rec[n++] = ev->slot;
+            rec[n++] = ev->module;
+            n += put_varint(rec + n, zigzag((int64_t)ev->address - (int64_t)w->last_addr));
+            n += put_varint(rec + n, ev->value);
+            w->last_addr = ev->address;
+            bloom_hashes(ev->address, h);
+            w->chunk.addr_bloom[h[0] >> 3] |= (uint8_t)(1u << (h[0] & 7));
+            w->chunk.addr_bloom[h[1] >> 3] |= (uint8_t)(1u << (h[1] & 7));
+            break;
+        }
+        case REPLAY_EV_INPUT:
+            rec[n++] = ev->module;
+            n += put_varint(rec + n, ev->channel);
+            n += put_varint(rec + n, ev->value);
+            break;
+        case REPLAY_EV_IRQ:
+        case REPLAY_EV_RAISE:
+            rec[n++] = ev->module;
+            rec[n++] = ev->slot;
+            n += put_varint(rec + n, ev->value);
+            break;
+        default:
+            return -1;
+    }
+    memcpy(w->raw + w->raw_used, rec, n);
+    w->raw_used += n;
+    w->chunk.module_mask |= 1u << (ev->module & 31);
+    w->chunk.events++;
+    w->chunk.vtime_last = w->last_vtime;
+    return 0;
+}
+
+uint64_t replay_writer_bytes(const replay_writer_t *w) {
+    return w->offset + w->raw_used;
+}
+
+uint64_t replay_writer_raw_bytes(const replay_writer_t *w) {
+    return w->raw_total + w->raw_used;
+}
+
+int replay_writer_close(replay_writer_t *w) {
+    if (!w) {
+        return 0;
+    }
+
+    int result = writer_close_chunk(w);
+    uint64_t index_offset = w->offset;
+    for (size_t i = 0; i < w->index_count && result == 0; i++) {
+        uint8_t entry[24];
+        put_le(entry, w->index[i].vtime, 8);
+        put_le(entry + 8, w->index[i].trap_seq, 8);
+        put_le(entry + 16, w->index[i].offset, 8);
+        result = writer_put(w, entry, sizeof(entry));
+    }
+
+    uint8_t trailer[REPLAY_TRAILER_SIZE];
+    put_le(trailer, w->index_count, 4);
+    put_le(trailer + 4, index_offset, 8);
+    put_le(trailer + 12, REPLAY_LOG_INDEX_MAGIC, 4);
+    if (result == 0) {
+        result = writer_put(w, trailer, sizeof(trailer));
+    }
+    if (fclose(w->fp) != 0) {
+        result = -1;
+    }
+    free(w->raw);
+    free(w->packed);
+    free(w->index);
+    free(w);
+    return result;
+}
+
+// ---- 快照负载 ----
+
+int replay_snapshot_put(uint8_t *buf, size_t size, size_t *pos, uint8_t module,
+                        const void *state, uint32_t len) {
+    uint8_t head[16];
+    size_t n = 0;
+    head[n++] = module;
+    n += put_varint(head + n, len);
+    if (*pos + n + len > size) {
+        return -1;
+    }
+    memcpy(buf + *pos, head, n);
+    memcpy(buf + *pos + n, state, len);
+    *pos += n + len;
+    return 0;
+}
+
+int replay_snapshot_next(const replay_event_t *snap, size_t *pos, uint8_t *module,
+                         const uint8_t **state, uint32_t *len) {
+    uint64_t v;
+    if (*pos >= snap->data_len) {
+        return 0;
+    }
+    *module = snap->data[(*pos)++];
+    if (get_varint(snap->data, snap->data_len, pos, &v) != 0 || *pos + v > snap->data_len) {
+        return -1;
+    }
+    *state = snap->data + *pos;
+    *len = (uint32_t)v;
+    *pos += v;
+    return 1;
+}
+
+// ---- 读取 ----
+
+// 载入第i块：压缩块解压到chunk_buf，未压缩的块直接在映射上解码
+static int reader_load_chunk(replay_reader_t *r, size_t i) {
+    const replay_chunk_info_t *c = &r->chunks[i];
+    const uint8_t *payload = r->map + c->offset + REPLAY_CHUNK_HEADER;
+    if (c->compressed) {
+        long n = trace_lz_decompress(payload, c->stored_len, r->chunk_buf, c->raw_len);
+        if (n != (long)c->raw_len) {
+            return -1;
+        }
+        r->data = r->chunk_buf;
+    } else {
+        r->data = payload;
+    }
+    r->data_end = c->raw_len;
+    r->pos = 0;
+    r->next_chunk = i + 1;
+    r->last_vtime = c->vtime_first;
+    r->last_addr = 0;
+    return 0;
+}
+
+// 回到事件流开头
+static void reader_rewind(replay_reader_t *r) {
+    if (r->version == 1) {
+        r->data = r->map;
+        r->data_end = r->events_end;
+        r->pos = r->events_begin;
+    } else {
+        r->data = NULL;
+        r->data_end = 0;
+        r->pos = 0;
+        r->next_chunk = 0;
+    }
+    r->last_vtime = 0;
+    r->last_addr = 0;
+}
+
+// 在当前位置解码一条事件，当前块读完时接着载入下一块
+static int reader_decode(replay_reader_t *r, replay_event_t *ev) {
+    if (r->pos >= r->data_end) {
+        if (r->version == 1 || r->next_chunk >= r->chunk_count) {
+            return 0;
+        }
+        if (reader_load_chunk(r, r->next_chunk) != 0) {
+            return -1;
+        }
+    }
+
+    const uint8_t *p = r->data;
+    size_t end = r->data_end;
+    size_t pos = r->pos;
+    uint64_t v;
+
+    memset(ev, 0, sizeof(*ev));
+    uint8_t type = p[pos++];
+    ev->type = (replay_event_type_t)(type & 0x0F);
+    ev->is_write = (type & 0x10) != 0;
+
+    if (ev->type == REPLAY_EV_SNAPSHOT) {
+        uint64_t count, len;
+        if (get_varint(p, end, &pos, &ev->vtime) != 0 ||
+            get_varint(p, end, &pos, &ev->trap_seq) != 0 ||
+            get_varint(p, end, &pos, &count) != 0 ||
+            get_varint(p, end, &pos, &len) != 0 || pos + len > end) {
+            return -1;
+        }
+        ev->count = (uint32_t)count;
+        ev->data = p + pos;
+        ev->data_len = (uint32_t)len;
+        r->pos = pos + len;
+        r->last_vtime = ev->vtime;
+        r->last_addr = 0;
+        return 1;
+    }
+
+    if (get_varint(p, end, &pos, &v) != 0) {
+        return -1;
+    }
+    ev->vtime = r->last_vtime + v;
+
+    switch (ev->type) {
+        case REPLAY_EV_TRAP:
+            if (pos + 2 > end) {
+                return -1;
+            }
+            ev->slot = p[pos++];
+            ev->module = p[pos++];
+            if (get_varint(p, end, &pos, &v) != 0) {
+                return -1;
+            }
+            ev->address = (uint32_t)((int64_t)r->last_addr + unzigzag(v));
+            if (get_varint(p, end, &pos, &v) != 0) {
+                return -1;
+            }
+            ev->value = (uint32_t)v;
+            break;
+        case REPLAY_EV_INPUT:
+            if (pos + 1 > end) {
+                return -1;
+            }
+            ev->module = p[pos++];
+            if (get_varint(p, end, &pos, &v) != 0) {
+                return -1;
+            }
+            ev->channel = (uint32_t)v;
+            if (get_varint(p, end, &pos, &v) != 0) {
+                return -1;
+            }
+            ev->value = (uint32_t)v;
+            break;
+        case REPLAY_EV_IRQ:
+        case REPLAY_EV_RAISE:
+            if (pos + 2 > end) {
+                return -1;
+            }
+            ev->module = p[pos++];
+            ev->slot = p[pos++];
+            if (get_varint(p, end, &pos, &v) != 0) {
+                return -1;
+            }
+            ev->value = (uint32_t)v;
+            break;
+        default:
+            return -1;
+    }
+    if (ev->module >= r->header.module_count) {
+        return -1;
+    }
+
+    r->pos = pos;
+    r->last_vtime = ev->vtime;
+    if (ev->type == REPLAY_EV_TRAP) {
+        r->last_addr = ev->address;
+    }
+    return 1;
+}
+
+static int reader_index_add(replay_reader_t *r, size_t *cap, const replay_event_t *ev, size_t offset) {
+    if (r->index_count == *cap) {
+        *cap = *cap ? *cap * 2 : REPLAY_INDEX_INITIAL;
+        replay_index_entry_t *index = realloc(r->index, *cap * sizeof(*index));
+        if (!index) {
+            return -1;
+        }
+        r->index = index;
+    }
+    r->index[r->index_count].vtime = ev->vtime;
+    r->index[r->index_count].trap_seq = ev->trap_seq;
+    r->index[r->index_count].offset = offset;
+    r->index_count++;
+    return 0;
+}
+
+// 遍历[events_begin, limit)内的块头建立块表（不解压），返回最后一个完整块的结束位置
+static size_t reader_scan_chunks(replay_reader_t *r, size_t limit) {
+    size_t cap = 0;
+    size_t pos = r->events_begin;
+    uint32_t max_raw = 0;
+
+    while (pos + REPLAY_CHUNK_HEADER <= limit && get_le(r->map + pos, 4) == REPLAY_LOG_CHUNK_MAGIC) {
+        replay_chunk_info_t c;
+        uint32_t flags;
+        read_chunk_header(r->map + pos, &c, &flags);
+        if (pos + REPLAY_CHUNK_HEADER + c.stored_len > limit ||
+            (!c.compressed && c.stored_len != c.raw_len) || c.events == 0) {
+            break;
+        }
+        c.offset = pos;
+        if (r->chunk_count == cap) {
+            cap = cap ? cap * 2 : REPLAY_INDEX_INITIAL;
+            replay_chunk_info_t *chunks = realloc(r->chunks, cap * sizeof(*chunks));
+            if (!chunks) {
+                return 0;
+            }
+            r->chunks = chunks;
+        }
+        r->chunks[r->chunk_count++] = c;
+        if (c.raw_len > max_raw) {
+            max_raw = c.raw_len;
+        }
+        pos += REPLAY_CHUNK_HEADER + c.stored_len;
+    }
+
+    r->chunk_buf = malloc(max_raw ? max_raw : 1);
+    return r->chunk_buf ? pos : 0;
+}
+
+// 没有文件尾（记录中途退出）时重建索引：版本2只解码以快照开头的块的第一条事件，
+// 版本1扫描整个事件流并截掉末尾不完整的事件
+static int reader_rebuild_index(replay_reader_t *r) {
+    size_t cap = 0;
+    replay_event_t ev;
+
+    if (r->version != 1) {
+        for (size_t i = 0; i < r->chunk_count; i++) {
+            if (!r->chunks[i].snapshot) {
+                continue;
+            }
+            if (reader_load_chunk(r, i) != 0 || reader_decode(r, &ev) != 1 ||
+                ev.type != REPLAY_EV_SNAPSHOT) {
+                // 损坏的块及其后的块都不再使用
+                r->chunk_count = i;
+                break;
+            }
+            if (reader_index_add(r, &cap, &ev, (size_t)r->chunks[i].offset) != 0) {
+                return -1;
+            }
+        }
+        reader_rewind(r);
+        return 0;
+    }
+
+    r->events_end = r->size;
+    reader_rewind(r);
+    for (;;) {
+        size_t at = r->pos;
+        int rc = reader_decode(r, &ev);
+        if (rc <= 0) {
+            r->events_end = at;
+            break;
+        }
+        if (ev.type == REPLAY_EV_SNAPSHOT && reader_index_add(r, &cap, &ev, at) != 0) {
+            return -1;
+        }
+    }
+    reader_rewind(r);
+    return 0;
+}
+
+replay_reader_t* replay_reader_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("[%s:%s] Cannot open replay log %s\n", __FILE__, __func__, path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < REPLAY_HEADER_FIXED) {
+        printf("[%s:%s] %s is not a replay log\n", __FILE__, __func__, path);
+        close(fd);
+        return NULL;
+    }
+
+    const uint8_t *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+
+    replay_reader_t *r = calloc(1, sizeof(replay_reader_t));
+    if (!r) {
+        munmap((void*)map, (size_t)st.st_size);
+        return NULL;
+    }
+    r->map = map;
+    r->size = (size_t)st.st_size;
+    r->version = (uint16_t)get_le(map + 4, 2);
+
+    if (get_le(map, 4) != REPLAY_LOG_MAGIC || r->version < 1 || r->version > REPLAY_LOG_VERSION) {
+        printf("[%s:%s] %s: bad magic or unsupported version\n", __FILE__, __func__, path);
+        replay_reader_close(r);
+        return NULL;
+    }
+    r->header.module_count = (uint32_t)get_le(map + 6, 2);
+    r->header.trap_ns = (uint32_t)get_le(map + 8, 4);
+    r->header.snapshot_interval = (uint32_t)get_le(map + 12, 4);
+    r->events_begin = REPLAY_HEADER_FIXED + r->header.module_count * 32u;
+    if (r->header.module_count > REPLAY_MAX_MODULES || r->events_begin > r->size) {
+        printf("[%s:%s] %s: corrupt header\n", __FILE__, __func__, path);
+        replay_reader_close(r);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < r->header.module_count; i++) {
+        memcpy(r->header.modules[i], map + REPLAY_HEADER_FIXED + i * 32u, 32);
+        r->header.modules[i][31] = '\0';
+    }
+
+    // 优先使用文件尾的索引
+    bool indexed = false;
+    if (r->size >= r->events_begin + REPLAY_TRAILER_SIZE) {
+        const uint8_t *t = map + r->size - REPLAY_TRAILER_SIZE;
+        uint64_t count = get_le(t, 4);
+        uint64_t index_offset = get_le(t + 4, 8);
+        if (get_le(t + 12, 4) == REPLAY_LOG_INDEX_MAGIC && index_offset >= r->events_begin &&
+            index_offset + count * 24 + REPLAY_TRAILER_SIZE == r->size) {
+            r->index = count ? malloc(count * sizeof(replay_index_entry_t)) : NULL;
+            if (count == 0 || r->index) {
+                for (uint64_t i = 0; i < count; i++) {
+                    const uint8_t *e = map + index_offset + i * 24;
+                    r->index[i].vtime = get_le(e, 8);
+                    r->index[i].trap_seq = get_le(e + 8, 8);
+                    r->index[i].offset = get_le(e + 16, 8);
+                }
+                r->index_count = (size_t)count;
+                r->events_end = (size_t)index_offset;
+                indexed = true;
+            }
+        }
+    }
+
+    if (r->version != 1) {
+        size_t limit = indexed ? r->events_end : r->size;
+        size_t scanned = reader_scan_chunks(r, limit);
+        if (!r->chunk_buf || (indexed && scanned != limit)) {
+            printf("[%s:%s] %s: corrupt chunk at offset %zu\n", __FILE__, __func__, path, scanned);
+            replay_reader_close(r);
+            return NULL;
+        }
+        r->events_end = scanned;
+    }
+    if (!indexed) {
+        printf("[%s:%s] %s has no index (truncated recording), rebuilding\n", __FILE__, __func__, path);
+        if (reader_rebuild_index(r) != 0) {
+            replay_reader_close(r);
+            return NULL;
+        }
+    }
+
+    reader_rewind(r);
+    return r;
+}
+
+void replay_reader_close(replay_reader_t *r) {
+    if (!r) {
+        return;
+    }
+    munmap((void*)r->map, r->size);
+    free(r->index);
+    free(r->chunks);
+    free(r->chunk_buf);
+    free(r);
+}
+
+const replay_log_header_t* replay_reader_header(const replay_reader_t *r) {
+    return &r->header;
+}
+
+int replay_reader_next(replay_reader_t *r, replay_event_t *ev) {
+    return reader_decode(r, ev);
+}
+
+size_t replay_reader_index(const replay_reader_t *r, const replay_index_entry_t **entries) {
+    *entries = r->index;
+    return r->index_count;
+}
+
+size_t replay_reader_chunks(const replay_reader_t *r, const replay_chunk_info_t **chunks) {
+    *chunks = r->chunks;
+    return r->chunk_count;
+}
+
+int replay_reader_seek_chunk(replay_reader_t *r, size_t i) {
+    if (i >= r->chunk_count || reader_load_chunk(r, i) != 0) {
+        reader_rewind(r);
+        return -1;
+    }
+    return 0;
+}
+
+// 定位到offset处的快照：版本2先找到快照所在的块
+static int reader_seek_offset(replay_reader_t *r, uint64_t offset) {
+    if (r->version == 1) {
+        r->data = r->map;
+        r->data_end = r->events_end;
+        r->pos = (size_t)offset;
+        return 0;
+    }
+    size_t lo = 0, hi = r->chunk_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->chunks[mid].offset < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == r->chunk_count || r->chunks[lo].offset != offset) {
+        return -1;
+    }
+    return reader_load_chunk(r, lo);
+}
+
+int replay_reader_seek(replay_reader_t *r, uint64_t vtime, replay_event_t *snapshot) {
+    // 索引按虚拟时间递增，二分查找最后一个不晚于vtime的快照
+    size_t lo = 0, hi = r->index_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->index[mid].vtime <= vtime) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    reader_rewind(r);
+    if (lo == 0) {
+        return 0;
+    }
+    if (reader_seek_offset(r, r->index[lo - 1].offset) != 0 ||
+        reader_decode(r, snapshot) != 1 || snapshot->type != REPLAY_EV_SNAPSHOT) {
+        reader_rewind(r);
+        return -1;
+    }
+    return 1;
+}
@@ -0,0 +1,124 @@
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// 记录/回放日志的二进制格式
+//
+//   文件头：magic "ICRR"、版本、模块表（记录开始时已注册的插件名）
+//   事件块：事件流切成独立压缩的块（trace_lz），每块 = 块头 + 压缩（或原样存储）的事件
+//     块头：magic "ICRC"、存储/原始长度、事件数、虚拟时间范围、
+//           模块位图、寄存器地址布隆过滤器（离线工具不解压即可跳过无关的块）
+//   事件：每条事件 = 类型字节 + 虚拟时间增量(varint) + 负载
+//     TRAP     陷入的寄存器访问：线程槽、模块、地址增量(zigzag varint)、读出/写入的值
+//     INPUT    芯片外部输入（UART RX字节等）：模块、通道、值
+//     IRQ      中断在此处递送给驱动
+//     RAISE    设备发出中断（回放时只用于比对）
+//     SNAPSHOT 周期性设备状态快照：绝对虚拟时间、陷入序号、各插件的save_state数据
+//   文件尾：快照索引（虚拟时间、陷入序号、所在块的文件偏移），用于按时间跳转
+//
+// 每块以块内第一条事件的虚拟时间和地址0为增量基准，快照总是块的第一条事件，
+// 从任一块开始都能独立解码。记录中途崩溃没有文件尾时，读取方扫描块头重建索引。
+// 版本1（未分块的事件流）仍可读取。
+
+#define REPLAY_LOG_MAGIC        0x52524349u   // "ICRR"
+#define REPLAY_LOG_INDEX_MAGIC  0x58524349u   // "ICRX"
+#define REPLAY_LOG_CHUNK_MAGIC  0x43524349u   // "ICRC"
+#define REPLAY_LOG_VERSION      2
+#define REPLAY_CHUNK_SIZE       (64u * 1024u)  // 块的原始事件字节数上限（单个快照可以超出）
+#define REPLAY_CHUNK_BLOOM_BITS 256
+#define REPLAY_MAX_MODULES      32
+
+// 中断上下文中的访问：线程槽的最高位
+#define REPLAY_SLOT_ISR         0x80
+
+typedef enum {
+    REPLAY_EV_TRAP = 1,
+    REPLAY_EV_INPUT = 2,
+    REPLAY_EV_IRQ = 3,
+    REPLAY_EV_RAISE = 4,
+    REPLAY_EV_SNAPSHOT = 5
+} replay_event_type_t;
+
+typedef struct {
+    replay_event_type_t type;
+    uint64_t vtime;             // 虚拟时间（纳秒）
+    uint8_t module;             // 模块表索引
+    uint8_t slot;               // 线程槽（TRAP/IRQ）
+    bool is_write;              // TRAP
+    uint32_t address;           // TRAP
+    uint32_t value;             // TRAP读出/写入的值、INPUT的值、IRQ/RAISE的中断号
+    uint32_t channel;           // INPUT
+    uint64_t trap_seq;          // SNAPSHOT：此前的陷入次数
+    uint32_t count;             // SNAPSHOT：设备状态条目数
+    const uint8_t *data;        // SNAPSHOT：条目数据，用replay_snapshot_next遍历
+    uint32_t data_len;
+} replay_event_t;
+
+typedef struct {
+    uint64_t vtime;
+    uint64_t trap_seq;
+    uint64_t offset;            // 快照事件在文件中的偏移
+} replay_index_entry_t;
+
+// 一个事件块的块头信息
+typedef struct {
+    uint64_t offset;            // 块头在文件中的偏移
+    uint64_t vtime_first;       // 块内事件的虚拟时间范围
+    uint64_t vtime_last;
+    uint32_t events;
+    uint32_t raw_len;           // 解压后的字节数
+    uint32_t stored_len;        // 文件中的字节数
+    bool compressed;
+    bool snapshot;              // 块以快照开头
+    uint32_t module_mask;       // 块内事件涉及的模块（模块表索引的位图，不含快照）
+    uint8_t addr_bloom[REPLAY_CHUNK_BLOOM_BITS / 8];  // TRAP地址的布隆过滤器
+} replay_chunk_info_t;
+
+typedef struct {
+    uint32_t trap_ns;           // 每次陷入推进的虚拟时间
+    uint32_t snapshot_interval; // 每隔多少次陷入写一个快照
+    uint32_t module_count;
+    char modules[REPLAY_MAX_MODULES][32];
+} replay_log_header_t;
+
+typedef struct replay_writer replay_writer_t;
+typedef struct replay_reader replay_reader_t;
+
+// 写入：调用方负责串行化
+replay_writer_t* replay_writer_open(const char *path, const replay_log_header_t *header);
+int replay_writer_append(replay_writer_t *w, const replay_event_t *ev);
+// 已写入文件的字节数（含未写出的当前块），以及压缩前的事件字节数
+uint64_t replay_writer_bytes(const replay_writer_t *w);
+uint64_t replay_writer_raw_bytes(const replay_writer_t *w);
+// 写入索引和文件尾并关闭
+int replay_writer_close(replay_writer_t *w);
+
+// 快照负载编码：依次追加(模块, 状态数据)，buf不足时返回-1
+int replay_snapshot_put(uint8_t *buf, size_t size, size_t *pos, uint8_t module,
+                        const void *state, uint32_t len);
+// 遍历快照负载，返回1表示取到一条，0表示结束，-1表示数据损坏
+int replay_snapshot_next(const replay_event_t *snap, size_t *pos, uint8_t *module,
+                         const uint8_t **state, uint32_t *len);
+
+// 读取：整个文件只读映射
+replay_reader_t* replay_reader_open(const char *path);
+void replay_reader_close(replay_reader_t *r);
+const replay_log_header_t* replay_reader_header(const replay_reader_t *r);
+// 返回1表示取到事件，0表示结束，-1表示数据损坏
+int replay_reader_next(replay_reader_t *r, replay_event_t *ev);
+size_t replay_reader_index(const replay_reader_t *r, const replay_index_entry_t **entries);
+// 定位到虚拟时间不晚于vtime的最近快照之后；返回1并填充snapshot，
+// 没有合适的快照时回到事件流开头并返回0
+int replay_reader_seek(replay_reader_t *r, uint64_t vtime, replay_event_t *snapshot);
+
+// 块表（不解压即可得到）；版本1的日志没有块，返回0
+size_t replay_reader_chunks(const replay_reader_t *r, const replay_chunk_info_t **chunks);
+// 定位到第i块的开头，之后replay_reader_next依次读出该块及后续块的事件
+int replay_reader_seek_chunk(replay_reader_t *r, size_t i);
+// 块内是否可能有对address的访问（布隆过滤器，可能误报，不会漏报）
+bool replay_chunk_may_contain(const replay_chunk_info_t *chunk, uint32_t address);
+
+#endif // REPLAY_LOG_H
@@ -0,0 +1,448 @@
+#define _GNU_SOURCE
+
+#include "sim_control.h"
+#include "sim_interface.h"
+#include "replay.h"
+#include "../simulator/plugin_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// 声明外部函数
+extern simulator_plugin_t* find_plugin(const char *name);
+extern int get_plugin_count(void);
+extern simulator_plugin_t* get_plugin_at(int index);
+
+#define CONTROL_MAX_MODULES   32
+#define CONTROL_MAX_IRQS      16
+#define CONTROL_MAX_ITEMS     128
+#define CONTROL_LINE_MAX      256
+#define CONTROL_REPLY_MAX     8192
+
+// 控制线程状态；速率采样只由控制线程读写
+typedef struct {
+    int listen_fd;
+    int client_fd;
+    int stop_pipe[2];
+    pthread_t thread;
+    bool running;
+    char path[108];
+
+    char line[CONTROL_LINE_MAX];
+    size_t line_len;
+
+    uint64_t sample_ns;
+    uint64_t sample_traps[CONTROL_MAX_MODULES];
+    double trap_rate[CONTROL_MAX_MODULES];
+
+    char reply[CONTROL_REPLY_MAX];
+    size_t reply_len;
+} control_state_t;
+
+static control_state_t g_ctl = {
+    .listen_fd = -1,
+    .client_fd = -1,
+    .stop_pipe = {-1, -1},
+};
+
+static uint64_t control_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 追加回复内容，超出缓冲的部分截断
+static void reply(const char *fmt, ...) {
+    va_list ap;
+    size_t room = sizeof(g_ctl.reply) - g_ctl.reply_len;
+
+    va_start(ap, fmt);
+    int n = vsnprintf(g_ctl.reply + g_ctl.reply_len, room, fmt, ap);
+    va_end(ap);
+    if (n > 0) {
+        g_ctl.reply_len += (size_t)n < room ? (size_t)n : room - 1;
+    }
+}
+
+// 发送回复；客户端断开时返回-1
+static int reply_flush(void) {
+    size_t sent = 0;
+
+    while (sent < g_ctl.reply_len) {
+        ssize_t n = send(g_ctl.client_fd, g_ctl.reply + sent, g_ctl.reply_len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            g_ctl.reply_len = 0;
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    g_ctl.reply_len = 0;
+    return 0;
+}
+
+// 采样各模块的陷入总数，计算上一周期的速率
+static void control_sample(void) {
+    sim_trap_stats_t stats[CONTROL_MAX_MODULES];
+    uint64_t now = control_now_ns();
+    int count = sim_trap_stats(stats, CONTROL_MAX_MODULES);
+    double elapsed = (double)(now - g_ctl.sample_ns) / 1e9;
+
+    for (int i = 0; i < count; i++) {
+        uint64_t traps = stats[i].reads + stats[i].writes;
+        if (g_ctl.sample_ns && elapsed > 0) {
+            g_ctl.trap_rate[i] = (double)(traps - g_ctl.sample_traps[i]) / elapsed;
+        }
+        g_ctl.sample_traps[i] = traps;
+    }
+    g_ctl.sample_ns = now;
+}
+
+static void cmd_stats(void) {
+    sim_trap_stats_t traps[CONTROL_MAX_MODULES];
+    sim_irq_stats_t irqs[CONTROL_MAX_IRQS];
+    int trap_count = sim_trap_stats(traps, CONTROL_MAX_MODULES);
+    int irq_count = sim_irq_stats(irqs, CONTROL_MAX_IRQS);
+
+    reply("vtime_ns %llu\n", (unsigned long long)sim_vtime_now());
+    reply("%-8s %12s %12s %12s  %-10s %-10s %s\n",
+          "module", "reads", "writes", "traps/s", "last_addr", "last_val", "last_vtime_ns");
+    for (int i = 0; i < trap_count; i++) {
+        reply("%-8s %12llu %12llu %12.1f  0x%08X 0x%08X %llu\n", traps[i].module,
+              (unsigned long long)traps[i].reads, (unsigned long long)traps[i].writes,
+              g_ctl.trap_rate[i], traps[i].last_addr, traps[i].last_value,
+              (unsigned long long)traps[i].last_vtime_ns);
+    }
+    reply("%-8s %4s %6s %12s %12s %6s %11s %11s %4s %7s %6s\n", "module", "irq", "signal", "raised", "delivered",
+          "lost", "lat_max_ns", "isr_max_ns", "nest", "backlog", "alarms");
+    for (int i = 0; i < irq_count; i++) {
+        reply("%-8s %4u %6d %12llu %12llu %6llu %11llu %11llu %4u %7u %6llu\n", irqs[i].module, irqs[i].irq_num,
+              irqs[i].signal_num, (unsigned long long)irqs[i].raised, (unsigned long long)irqs[i].delivered,
+              (unsigned long long)irqs[i].lost, (unsigned long long)irqs[i].latency_max_ns,
+              (unsigned long long)irqs[i].handler_max_ns, irqs[i].max_nesting, irqs[i].max_backlog,
+              (unsigned long long)irqs[i].backlog_alarms);
+    }
+    reply("OK\n");
+}
+
+// 列出一个插件的某类观测条目
+static void reply_inspect(simulator_plugin_t *plugin, plugin_inspect_kind_t kind) {
+    plugin_inspect_item_t items[CONTROL_MAX_ITEMS];
+    int count = plugin->inspect(plugin, items, CONTROL_MAX_ITEMS);
+
+    for (int i = 0; i < count; i++) {
+        if (items[i].kind != kind) {
+            continue;
+        }
+        if (kind == PLUGIN_INSPECT_REG) {
+            reply("%-8s %-16s 0x%08X 0x%08X\n", plugin->name, items[i].name, items[i].address, items[i].value);
+        } else {
+            reply("%-8s %-16s %8u / %u\n", plugin->name, items[i].name, items[i].value, items[i].capacity);
+        }
+    }
+}
+
+static void cmd_regs(const char *module) {
+    simulator_plugin_t *plugin = module ? find_plugin(module) : NULL;
+
+    if (!plugin) {
+        reply("ERR unknown module\n");
+        return;
+    }
+    if (!plugin->inspect) {
+        reply("ERR %s does not support inspection\n", plugin->name);
+        return;
+    }
+    reply_inspect(plugin, PLUGIN_INSPECT_REG);
+    reply("OK\n");
+}
+
+static void cmd_queues(const char *module) {
+    if (module) {
+        simulator_plugin_t *plugin = find_plugin(module);
+        if (!plugin || !plugin->inspect) {
+            reply("ERR unknown module\n");
+            return;
+        }
+        reply_inspect(plugin, PLUGIN_INSPECT_QUEUE);
+    } else {
+        for (int i = 0; i < get_plugin_count(); i++) {
+            simulator_plugin_t *plugin = get_plugin_at(i);
+            if (plugin && plugin->inspect) {
+                reply_inspect(plugin, PLUGIN_INSPECT_QUEUE);
+            }
+        }
+    }
+    reply("OK\n");
+}
+
+static void cmd_poke(const char *addr_arg, const char *value_arg) {
+    char *end_addr = NULL;
+    char *end_value = NULL;
+
+    if (!addr_arg || !value_arg) {
+        reply("ERR usage: poke ADDR VALUE\n");
+        return;
+    }
+    unsigned long addr = strtoul(addr_arg, &end_addr, 0);
+    unsigned long value = strtoul(value_arg, &end_value, 0);
+    if (*end_addr || *end_value) {
+        reply("ERR usage: poke ADDR VALUE\n");
+        return;
+    }
+    // 记录日志里没有控制面写入，记录或回放时写寄存器会使回放偏离
+    if (replay_get_mode() != REPLAY_MODE_OFF) {
+        reply("ERR poke is not available while recording or replaying\n");
+        return;
+    }
+    int rc = sim_post_bus_write((uint32_t)addr, (uint32_t)value);
+    if (rc == -1) {
+        reply("ERR 0x%08lX is not a device register\n", addr);
+        return;
+    }
+    if (rc != 0) {
+        reply("ERR request queue full, the simulation is not trapping\n");
+        return;
+    }
+    reply("queued for the next register access\nOK\n");
+}
+
+static void cmd_irq(const char *module, const char *irq_arg) {
+    char *end = NULL;
+
+    if (!module || !irq_arg) {
+        reply("ERR usage: irq MODULE IRQ\n");
+        return;
+    }
+    unsigned long irq = strtoul(irq_arg, &end, 0);
+    if (*end) {
+        reply("ERR %s has no IRQ %s\n", module, irq_arg);
+        return;
+    }
+    // 回放时中断只由日志递送；记录时注入的中断经记录钩子写入日志
+    if (replay_get_mode() == REPLAY_MODE_REPLAY) {
+        reply("ERR irq is not available while replaying\n");
+        return;
+    }
+    int rc = sim_post_irq(module, (uint32_t)irq);
+    if (rc == -1) {
+        reply("ERR %s has no IRQ %s\n", module, irq_arg);
+        return;
+    }
+    if (rc != 0) {
+        reply("ERR request queue full, the simulation is not trapping\n");
+        return;
+    }
+    reply("queued for the next register access\nOK\n");
+}
+
+// 执行一行命令；返回-1表示关闭连接
+static int control_command(char *line) {
+    char *save = NULL;
+    char *cmd = strtok_r(line, " \t\r", &save);
+    char *arg1 = cmd ? strtok_r(NULL, " \t\r", &save) : NULL;
+    char *arg2 = arg1 ? strtok_r(NULL, " \t\r", &save) : NULL;
+
+    if (!cmd) {
+        return 0;
+    }
+    if (strcmp(cmd, "stats") == 0) {
+        cmd_stats();
+    } else if (strcmp(cmd, "regs") == 0) {
+        cmd_regs(arg1);
+    } else if (strcmp(cmd, "queues") == 0) {
+        cmd_queues(arg1);
+    } else if (strcmp(cmd, "poke") == 0) {
+        cmd_poke(arg1, arg2);
+    } else if (strcmp(cmd, "irq") == 0) {
+        cmd_irq(arg1, arg2);
+    } else if (strcmp(cmd, "help") == 0) {
+        reply("stats | regs MODULE | queues [MODULE] | poke ADDR VALUE | irq MODULE IRQ | quit\nOK\n");
+    } else if (strcmp(cmd, "quit") == 0) {
+        reply("OK\n");
+        reply_flush();
+        return -1;
+    } else {
+        reply("ERR unknown command '%s'\n", cmd);
+    }
+    return reply_flush();
+}
+
+// 读取客户端数据并逐行执行；返回-1表示关闭连接
+static int control_client_read(void) {
+    char buf[CONTROL_LINE_MAX];
+    ssize_t n = recv(g_ctl.client_fd, buf, sizeof(buf), 0);
+
+    if (n < 0 && errno == EINTR) {
+        return 0;
+    }
+    if (n <= 0) {
+        return -1;
+    }
+    for (ssize_t i = 0; i < n; i++) {
+        if (buf[i] != '\n') {
+            // 超长的行截断，仍按一行处理
+            if (g_ctl.line_len < sizeof(g_ctl.line) - 1) {
+                g_ctl.line[g_ctl.line_len++] = buf[i];
+            }
+            continue;
+        }
+        g_ctl.line[g_ctl.line_len] = '\0';
+        g_ctl.line_len = 0;
+        if (control_command(g_ctl.line) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 控制线程：同一时刻服务一个客户端，空闲时按周期采样陷入速率
+static void* control_thread(void *arg) {
+    (void)arg;
+
+    // 中断信号不在本线程上执行ISR
+    sigset_t all;
+    sigfillset(&all);
+    sigdelset(&all, SIGSYS);    // hotpath-check经SIGSYS统计系统调用
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    control_sample();
+    uint64_t next_sample = g_ctl.sample_ns + SIM_CONTROL_SAMPLE_MS * 1000000ULL;
+
+    for (;;) {
+        struct pollfd fds[3];
+        int nfds = 0;
+        fds[nfds++] = (struct pollfd){ .fd = g_ctl.stop_pipe[0], .events = POLLIN };
+        fds[nfds++] = (struct pollfd){ .fd = g_ctl.listen_fd, .events = POLLIN };
+        if (g_ctl.client_fd >= 0) {
+            fds[nfds++] = (struct pollfd){ .fd = g_ctl.client_fd, .events = POLLIN };
+        }
+
+        uint64_t now = control_now_ns();
+        int timeout_ms = now >= next_sample ? 0 : (int)((next_sample - now) / 1000000ULL) + 1;
+        int ready = poll(fds, (nfds_t)nfds, timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (control_now_ns() >= next_sample) {
+            control_sample();
+            next_sample = g_ctl.sample_ns + SIM_CONTROL_SAMPLE_MS * 1000000ULL;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        if (fds[0].revents) {
+            break;
+        }
+        if (nfds > 2 && fds[2].revents && control_client_read() != 0) {
+            close(g_ctl.client_fd);
+            g_ctl.client_fd = -1;
+        }
+        if (fds[1].revents & POLLIN) {
+            int fd = accept(g_ctl.listen_fd, NULL, NULL);
+            if (fd >= 0 && g_ctl.client_fd >= 0) {
+                const char *busy = "ERR another client is connected\n";
+                send(fd, busy, strlen(busy), MSG_NOSIGNAL);
+                close(fd);
+            } else if (fd >= 0) {
+                g_ctl.client_fd = fd;
+                g_ctl.line_len = 0;
+            }
+        }
+    }
+
+    if (g_ctl.client_fd >= 0) {
+        close(g_ctl.client_fd);
+        g_ctl.client_fd = -1;
+    }
+    return NULL;
+}
+
+// 启动控制套接字
+int sim_control_start(const char *path) {
+    struct sockaddr_un addr;
+
+    if (g_ctl.running) {
+        return -1;
+    }
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("[%s:%s] Error: socket path too long: %s\n", __FILE__, __func__, path);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    g_ctl.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (g_ctl.listen_fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(g_ctl.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(g_ctl.listen_fd, 4) != 0) {
+        perror("bind");
+        close(g_ctl.listen_fd);
+        g_ctl.listen_fd = -1;
+        return -1;
+    }
+    if (pipe(g_ctl.stop_pipe) != 0) {
+        perror("pipe");
+        close(g_ctl.listen_fd);
+        g_ctl.listen_fd = -1;
+        unlink(path);
+        return -1;
+    }
+
+    strcpy(g_ctl.path, path);
+    g_ctl.sample_ns = 0;
+    memset(g_ctl.sample_traps, 0, sizeof(g_ctl.sample_traps));
+    memset(g_ctl.trap_rate, 0, sizeof(g_ctl.trap_rate));
+    if (pthread_create(&g_ctl.thread, NULL, control_thread, NULL) != 0) {
+        printf("[%s:%s] Error: failed to create control thread\n", __FILE__, __func__);
+        close(g_ctl.stop_pipe[0]);
+        close(g_ctl.stop_pipe[1]);
+        close(g_ctl.listen_fd);
+        g_ctl.listen_fd = -1;
+        unlink(path);
+        return -1;
+    }
+    g_ctl.running = true;
+
+    printf("[%s:%s] Control socket listening on %s\n", __FILE__, __func__, path);
+    return 0;
+}
+
+// 停止控制线程
+void sim_control_stop(void) {
+    if (!g_ctl.running) {
+        return;
+    }
+
+    char stop = 1;
+    if (write(g_ctl.stop_pipe[1], &stop, 1) != 1) {
+        perror("write");
+    }
+    pthread_join(g_ctl.thread, NULL);
+    g_ctl.running = false;
+
+    close(g_ctl.stop_pipe[0]);
+    close(g_ctl.stop_pipe[1]);
+    close(g_ctl.listen_fd);
+    g_ctl.listen_fd = -1;
+    unlink(g_ctl.path);
+
+    printf("[%s:%s] Control socket closed\n", __FILE__, __func__);
+}
@@ -0,0 +1,31 @@
+#ifndef SIM_CONTROL_H
+#define SIM_CONTROL_H
+
+// 运行时观测与控制套接字
+//
+// 长时间运行（soak）时不停下仿真即可查看内部状态：后台线程在Unix域套接字上
+// 逐行接收文本命令，每个回复以"OK"或"ERR 原因"一行结束（客户端见tools/ic_ctl.c）。
+//   stats            虚拟时间、各模块的陷入访问计数/速率/最近一次访问、各中断的发出和递送计数
+//   regs MODULE      设备寄存器当前值（插件inspect方法，无副作用）
+//   queues [MODULE]  设备内部队列深度
+//   poke ADDR VALUE  写外设寄存器（经总线分发，与DMA访问外设寄存器相同）
+//   irq MODULE IRQ   注入中断
+// poke和irq只入队（sim_post_*），在仿真线程下一次陷入访问之前执行，不与设备模型并发；
+// 驱动不访问寄存器时请求一直排队。
+//   help / quit
+//
+// 统计由陷入路径以seqlock写入，控制线程只读快照，陷入路径从不加锁或等待控制线程；
+// 陷入速率由控制线程按SIM_CONTROL_SAMPLE_MS周期采样计算。
+// 控制线程屏蔽所有信号，注入的中断仍在仿真线程上执行ISR。
+// 记录或回放时拒绝poke（日志中没有控制面写入）；回放时拒绝irq，
+// 记录时注入的中断与设备发出的中断一样写入日志。
+
+#define SIM_CONTROL_SAMPLE_MS  1000
+
+// 在path上创建套接字并启动控制线程（已存在的同名套接字文件被替换）
+int sim_control_start(const char *path);
+
+// 停止控制线程并删除套接字文件，需在插件清理之前调用
+void sim_control_stop(void);
+
+#endif // SIM_CONTROL_H
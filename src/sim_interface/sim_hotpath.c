@@ -0,0 +1,123 @@
+#include "sim_hotpath.h"
+#include <stddef.h>
+
+#define SIM_HOTPATH_MAX_DEPTH 8     // 区间嵌套深度（陷入 -> 分发，ISR中再陷入）
+
+typedef struct {
+    uint64_t key;               // 0表示空槽，先以CAS占用再填写其余字段
+    sim_hotpath_region_t region;
+    sim_hotpath_kind_t kind;
+    uintptr_t site;
+    long detail;
+    uint64_t count;
+} site_slot_t;
+
+// 启用标志在创建线程之前写入，之后只读
+static bool g_enabled = false;
+static uint64_t g_entries[SIM_HOTPATH_REGION_COUNT];
+static uint64_t g_events[SIM_HOTPATH_REGION_COUNT][SIM_HOTPATH_KIND_COUNT];
+static site_slot_t g_sites[SIM_HOTPATH_MAX_SITES];
+
+// 每个线程（含其上的信号处理器）自己的区间栈
+static __thread sim_hotpath_region_t t_regions[SIM_HOTPATH_MAX_DEPTH];
+static __thread int t_depth = 0;
+
+void sim_hotpath_enable(void) {
+    g_enabled = true;
+}
+
+bool sim_hotpath_enabled(void) {
+    return g_enabled;
+}
+
+void sim_hotpath_enter(sim_hotpath_region_t region) {
+    if (!g_enabled) {
+        return;
+    }
+    if (t_depth < SIM_HOTPATH_MAX_DEPTH) {
+        t_regions[t_depth] = region;
+    }
+    t_depth++;
+    __atomic_fetch_add(&g_entries[region], 1, __ATOMIC_RELAXED);
+}
+
+void sim_hotpath_exit(void) {
+    if (g_enabled && t_depth > 0) {
+        t_depth--;
+    }
+}
+
+static uint64_t site_key(sim_hotpath_region_t region, sim_hotpath_kind_t kind, uintptr_t site, long detail) {
+    uint64_t h = 1469598103934665603ULL;
+    h = (h ^ (uint64_t)region) * 1099511628211ULL;
+    h = (h ^ (uint64_t)kind) * 1099511628211ULL;
+    h = (h ^ (uint64_t)site) * 1099511628211ULL;
+    h = (h ^ (uint64_t)detail) * 1099511628211ULL;
+    return h ? h : 1;
+}
+
+void sim_hotpath_record(sim_hotpath_kind_t kind, uintptr_t site, long detail) {
+    if (!g_enabled || t_depth == 0) {
+        return;
+    }
+    int top = t_depth <= SIM_HOTPATH_MAX_DEPTH ? t_depth - 1 : SIM_HOTPATH_MAX_DEPTH - 1;
+    sim_hotpath_region_t region = t_regions[top];
+    __atomic_fetch_add(&g_events[region][kind], 1, __ATOMIC_RELAXED);
+
+    // 调用点表：按键线性探测，空槽用CAS占用，占用者随后填写字段（读取只在退出时进行）
+    uint64_t key = site_key(region, kind, site, detail);
+    for (size_t probe = 0; probe < SIM_HOTPATH_MAX_SITES; probe++) {
+        site_slot_t *slot = &g_sites[(key + probe) & (SIM_HOTPATH_MAX_SITES - 1)];
+        uint64_t current = __atomic_load_n(&slot->key, __ATOMIC_ACQUIRE);
+        if (current == 0) {
+            if (__atomic_compare_exchange_n(&slot->key, &current, key, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                slot->region = region;
+                slot->kind = kind;
+                slot->site = site;
+                slot->detail = detail;
+                __atomic_fetch_add(&slot->count, 1, __ATOMIC_RELAXED);
+                return;
+            }
+        }
+        if (current == key) {
+            __atomic_fetch_add(&slot->count, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+}
+
+void sim_hotpath_get_stats(sim_hotpath_stats_t stats[SIM_HOTPATH_REGION_COUNT]) {
+    for (int r = 0; r < SIM_HOTPATH_REGION_COUNT; r++) {
+        stats[r].entries = __atomic_load_n(&g_entries[r], __ATOMIC_RELAXED);
+        for (int k = 0; k < SIM_HOTPATH_KIND_COUNT; k++) {
+            stats[r].events[k] = __atomic_load_n(&g_events[r][k], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+int sim_hotpath_get_sites(sim_hotpath_site_t *sites, int max) {
+    int count = 0;
+    for (size_t i = 0; i < SIM_HOTPATH_MAX_SITES && count < max; i++) {
+        const site_slot_t *slot = &g_sites[i];
+        if (__atomic_load_n(&slot->key, __ATOMIC_ACQUIRE) == 0) {
+            continue;
+        }
+        sites[count].region = slot->region;
+        sites[count].kind = slot->kind;
+        sites[count].site = slot->site;
+        sites[count].detail = slot->detail;
+        sites[count].count = __atomic_load_n(&slot->count, __ATOMIC_RELAXED);
+        count++;
+    }
+    return count;
+}
+
+const char* sim_hotpath_region_name(sim_hotpath_region_t region) {
+    static const char *names[SIM_HOTPATH_REGION_COUNT] = { "trap", "dispatch", "irq", "dma" };
+    return region < SIM_HOTPATH_REGION_COUNT ? names[region] : "?";
+}
+
+const char* sim_hotpath_kind_name(sim_hotpath_kind_t kind) {
+    static const char *names[SIM_HOTPATH_KIND_COUNT] = { "alloc", "free", "syscall" };
+    return kind < SIM_HOTPATH_KIND_COUNT ? names[kind] : "?";
+}
@@ -0,0 +1,68 @@
+#ifndef SIM_HOTPATH_H
+#define SIM_HOTPATH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 热路径守卫 - 标记稳态下不应分配内存、不应进入内核的代码区间
+//
+// 区间（可嵌套，事件只记在最内层区间上）：
+//   SIM_HOTPATH_TRAP      段错误处理器：指令解码和写回寄存器
+//   SIM_HOTPATH_DISPATCH  handle_sim_message及插件的reg_read/reg_write等回调
+//   SIM_HOTPATH_IRQ       handle_interrupt及驱动的ISR
+//   SIM_HOTPATH_DMA       DMA控制器执行通道传输并上报完成
+//
+// 标记始终编译进来，未启用时sim_hotpath_enter/exit只检查一个全局标志。
+// 插桩构建（make hotpath-check，见hotpath_check.c）拦截malloc/free并用seccomp
+// 捕获系统调用，发生在区间内的事件经sim_hotpath_record按区间和调用点累计。
+
+typedef enum {
+    SIM_HOTPATH_TRAP = 0,
+    SIM_HOTPATH_DISPATCH,
+    SIM_HOTPATH_IRQ,
+    SIM_HOTPATH_DMA,
+    SIM_HOTPATH_REGION_COUNT
+} sim_hotpath_region_t;
+
+typedef enum {
+    SIM_HOTPATH_ALLOC = 0,      // malloc/calloc/realloc
+    SIM_HOTPATH_FREE,
+    SIM_HOTPATH_SYSCALL,
+    SIM_HOTPATH_KIND_COUNT
+} sim_hotpath_kind_t;
+
+#define SIM_HOTPATH_MAX_SITES 256
+
+typedef struct {
+    uint64_t entries;                           // 进入区间的次数
+    uint64_t events[SIM_HOTPATH_KIND_COUNT];    // 区间内发生的事件数
+} sim_hotpath_stats_t;
+
+// 一个调用点：分配的返回地址或系统调用指令地址，detail为系统调用号
+typedef struct {
+    sim_hotpath_region_t region;
+    sim_hotpath_kind_t kind;
+    uintptr_t site;
+    long detail;
+    uint64_t count;
+} sim_hotpath_site_t;
+
+// 启用守卫，由插桩运行时在创建任何线程之前调用
+void sim_hotpath_enable(void);
+bool sim_hotpath_enabled(void);
+
+// 进入/离开区间，可在信号处理器中调用
+void sim_hotpath_enter(sim_hotpath_region_t region);
+void sim_hotpath_exit(void);
+
+// 记录一次事件，不在区间内时忽略；不分配内存、不进入内核
+void sim_hotpath_record(sim_hotpath_kind_t kind, uintptr_t site, long detail);
+
+// 读取各区间的累计值和调用点表（调用点表满后的事件只计入区间总数）
+void sim_hotpath_get_stats(sim_hotpath_stats_t stats[SIM_HOTPATH_REGION_COUNT]);
+int sim_hotpath_get_sites(sim_hotpath_site_t *sites, int max);
+
+const char* sim_hotpath_region_name(sim_hotpath_region_t region);
+const char* sim_hotpath_kind_name(sim_hotpath_kind_t kind);
+
+#endif // SIM_HOTPATH_H
@@ -4,15 +4,25 @@
 #include "sim_interface.h"
 #include "../simulator/plugin_interface.h"
 #include "interrupt_manager.h"
+#include "replay.h"
+#include "sim_perf.h"
+#include "trap_profile.h"
+#include "vtime_profile.h"
+#include "sim_hotpath.h"
+#include "sim_stimulus.h"
+#include <pthread.h>
+#include "../simulator/plugins/lockstep_plugin.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <signal.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <errno.h>
 #include <ucontext.h>
+#include <time.h>
 
 #ifndef MAP_ANONYMOUS
 #define MAP_ANONYMOUS 0x20
@@ -26,12 +36,94 @@ extern void cleanup_plugins(void);
 
 #define MAX_REG_MAPPINGS 32
 #define MAX_SIGNAL_MAPPINGS 16
+#define MAX_MEM_MAPPINGS 8
 
 static reg_mapping_t g_reg_mappings[MAX_REG_MAPPINGS];
 static signal_mapping_t g_signal_mappings[MAX_SIGNAL_MAPPINGS];
 static int g_reg_mapping_count = 0;
 static int g_signal_mapping_count = 0;
+static mem_mapping_t g_mem_mappings[MAX_MEM_MAPPINGS];
+static int g_mem_mapping_count = 0;
 static uint32_t g_msg_id_counter = 1;
+static uint64_t g_vtime_ns = 0;
+
+// 虚拟时间定时器：deadline为0表示未启动；g_vtimer_next不大于所有已启动定时器的到期时刻，
+// 陷入路径只比较这一个值，没有定时器到期时不扫描
+typedef struct {
+    sim_vtimer_fn_t fn;
+    void *ctx;
+    uint64_t deadline_ns;
+    bool used;
+} sim_vtimer_t;
+
+static sim_vtimer_t g_vtimers[SIM_VTIMER_MAX];
+static uint64_t g_vtimer_next = UINT64_MAX;
+
+// 控制面请求队列：投递方之间用互斥锁串行（不在陷入路径上），
+// 陷入线程（可能嵌套在中断里）先复制条目再用CAS推进tail认领，槽位在tail越过之前不会被覆盖
+typedef struct {
+    bool is_irq;
+    char module[32];
+    uint32_t addr;              // 寄存器写的地址
+    uint32_t value;             // 寄存器写的值或中断号
+} sim_post_t;
+
+static sim_post_t g_posts[SIM_POST_MAX];
+static uint32_t g_post_head = 0;
+static uint32_t g_post_tail = 0;
+static pthread_mutex_t g_post_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// 模块访问统计：只由陷入路径（主线程的段错误处理器，不会嵌套）写入，
+// 控制线程按seqlock读取一致的快照，写者从不等待读者
+typedef struct {
+    uint32_t seq;               // 奇数表示写入进行中
+    uint64_t reads;
+    uint64_t writes;
+    uint32_t last_addr;
+    uint32_t last_value;
+    uint64_t last_vtime_ns;
+} trap_stats_slot_t;
+
+static trap_stats_slot_t g_trap_stats[MAX_REG_MAPPINGS];
+
+// 访问足迹位图：陷入路径和DMA线程都可能写入，按位原子或
+static uint32_t g_footprint[MAX_REG_MAPPINGS][SIM_FOOTPRINT_MAX_WORDS / 32];
+
+// 中断计数：trigger_interrupt可能在任意线程上调用，单个计数用原子加即可
+static uint64_t g_irq_raised[MAX_SIGNAL_MAPPINGS];
+static uint64_t g_irq_delivered[MAX_SIGNAL_MAPPINGS];
+
+// 中断剖析：发出时间按发出序号写入环形表，信号处理器按递送序号取出，
+// 得到发出到进入ISR的延迟。环满时旧记录被覆盖，对应的递送不计延迟
+#define IRQ_RAISE_RING 64
+
+typedef struct {
+    uint64_t seq;               // 发出序号+1，最后写入；读取前后不一致说明条目被覆盖
+    uint64_t host_ns;
+    uint64_t vtime_ns;
+} irq_raise_t;
+
+// 计数字段由信号处理器（主线程）写入、控制线程读取，逐字段原子访问即可
+typedef struct {
+    irq_raise_t ring[IRQ_RAISE_RING];
+    uint64_t lost;
+    uint64_t latency_samples;
+    uint64_t latency_total_ns;
+    uint64_t latency_max_ns;
+    uint64_t latency_max_vtime_ns;
+    uint64_t handler_total_ns;
+    uint64_t handler_max_ns;
+    uint32_t max_nesting;
+    uint32_t max_backlog;
+    uint64_t backlog_alarms;
+    uint32_t alarm_active;      // 积压告警已触发，积压清空后重新布防
+} irq_profile_t;
+
+static irq_profile_t g_irq_profile[MAX_SIGNAL_MAPPINGS];
+
+// ISR嵌套：每个中断信号在自身处理期间被屏蔽，深度不超过信号映射数
+static int g_irq_depth = 0;
+static uint64_t g_irq_child_ns[MAX_SIGNAL_MAPPINGS + 1];
 
 // 查找寄存器映射
 static reg_mapping_t* find_register_mapping(void *addr) {
@@ -47,9 +139,148 @@ static reg_mapping_t* find_register_mapping(void *addr) {
     return NULL;
 }
 
+// 计算ModR/M寻址部分的长度（ModR/M + SIB + 位移）
+static int modrm_operand_length(const uint8_t *modrm) {
+    uint8_t mod = modrm[0] >> 6;
+    uint8_t rm = modrm[0] & 0x07;
+    int length = 1;
+    
+    if (mod == 3) {                           // 寄存器到寄存器
+        return length;
+    }
+    if (rm == 4) {                            // 带SIB字节
+        length++;
+        if (mod == 0 && (modrm[1] & 0x07) == 5) {
+            length += 4;                      // SIB无基址，32位位移
+        }
+    }
+    if (mod == 1) {
+        length += 1;                          // 8位位移
+    } else if (mod == 2) {
+        length += 4;                          // 32位位移
+    } else if (rm == 5) {
+        length += 4;                          // RIP相对寻址
+    }
+    return length;
+}
+
+// 获取ModR/M reg字段对应的通用寄存器
+static greg_t* modrm_reg_operand(ucontext_t *uc, uint8_t rex, uint8_t modrm) {
+    static const int reg_map[16] = {
+        REG_RAX, REG_RCX, REG_RDX, REG_RBX, REG_RSP, REG_RBP, REG_RSI, REG_RDI,
+        REG_R8,  REG_R9,  REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15
+    };
+    int index = ((modrm >> 3) & 0x07) | ((rex & 0x04) ? 8 : 0);
+    return &uc->uc_mcontext.gregs[reg_map[index]];
+}
+
+// 更新一个模块的访问统计（seqlock写端）
+static void trap_stats_update(trap_stats_slot_t *slot, const sim_message_t *msg, uint32_t value, uint64_t vtime) {
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    if (msg->type == MSG_REG_READ) {
+        __atomic_store_n(&slot->reads, slot->reads + 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(&slot->writes, slot->writes + 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&slot->last_addr, msg->address, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->last_value, value, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->last_vtime_ns, vtime, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// 记录一次寄存器访问的足迹，超出记录窗口的偏移忽略
+static void footprint_mark(reg_mapping_t *mapping, uint32_t addr) {
+    uint32_t word = (addr - mapping->start_addr) >> 2;
+    if (word < SIM_FOOTPRINT_MAX_WORDS) {
+        __atomic_fetch_or(&g_footprint[mapping - g_reg_mappings][word >> 5], 1U << (word & 31), __ATOMIC_RELAXED);
+    }
+}
+
+// 陷入路径：执行已投递的控制面请求
+static void sim_post_drain(void) {
+    uint32_t tail = __atomic_load_n(&g_post_tail, __ATOMIC_ACQUIRE);
+
+    while (tail != __atomic_load_n(&g_post_head, __ATOMIC_ACQUIRE)) {
+        sim_post_t post = g_posts[tail % SIM_POST_MAX];
+        if (!__atomic_compare_exchange_n(&g_post_tail, &tail, tail + 1, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue;   // 被嵌套的陷入先认领，tail已更新
+        }
+        if (post.is_irq) {
+            trigger_interrupt(post.module, post.value);
+        } else {
+            sim_bus_write(post.addr, post.value);
+        }
+        tail++;
+    }
+}
+
+static int sim_post(const sim_post_t *post) {
+    int result = -2;
+
+    pthread_mutex_lock(&g_post_lock);
+    uint32_t head = g_post_head;
+    if (head - __atomic_load_n(&g_post_tail, __ATOMIC_ACQUIRE) < SIM_POST_MAX) {
+        g_posts[head % SIM_POST_MAX] = *post;
+        __atomic_store_n(&g_post_head, head + 1, __ATOMIC_RELEASE);
+        result = 0;
+    }
+    pthread_mutex_unlock(&g_post_lock);
+    return result;
+}
+
+int sim_post_bus_write(uint32_t addr, uint32_t value) {
+    sim_post_t post = {0};
+
+    if (!find_register_mapping((void *)(uintptr_t)addr)) {
+        return -1;
+    }
+    post.addr = addr;
+    post.value = value;
+    return sim_post(&post);
+}
+
+int sim_post_irq(const char *module, uint32_t irq_num) {
+    sim_post_t post = {0};
+
+    if (sim_irq_signal(module, irq_num) < 0) {
+        return -1;
+    }
+    post.is_irq = true;
+    strncpy(post.module, module, sizeof(post.module) - 1);
+    post.value = irq_num;
+    return sim_post(&post);
+}
+
+// 分发一次陷入的寄存器访问：推进虚拟时间，经过记录/回放层
+static int sim_trap_access(reg_mapping_t *mapping, const sim_message_t *msg, sim_message_t *response) {
+    uint64_t vtime = sim_vtime_advance(SIM_VTIME_TRAP_NS);
+    sim_stim_poll(vtime);   // 到期的外部激励先于本次访问到达设备
+    sim_vtimer_poll(vtime);
+    sim_post_drain();
+    sim_perf_begin(SIM_PERF_DISPATCH);
+    int result = replay_trap_access(msg, response);
+    sim_perf_end(SIM_PERF_DISPATCH);
+    
+    uint32_t value = msg->type == MSG_REG_READ ? (uint32_t)response->data.response.result : msg->value;
+    trap_stats_update(&g_trap_stats[mapping - g_reg_mappings], msg, value, vtime);
+    footprint_mark(mapping, msg->address);
+    return result;
+}
+
+static uint64_t sim_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 // 段错误信号处理器
 static void segfault_handler(int sig, siginfo_t *si, void *ctx) {
     (void)sig;
+    uint64_t profile_start = trap_profile_active() ? sim_monotonic_ns() : 0;
 
     void *fault_addr = si->si_addr;
     reg_mapping_t *mapping = find_register_mapping(fault_addr);
@@ -65,6 +296,8 @@ static void segfault_handler(int sig, siginfo_t *si, void *ctx) {
     sim_message_t msg = {0};
     sim_message_t response = {0};
     
+    sim_perf_begin(SIM_PERF_TRAP);
+    sim_hotpath_enter(SIM_HOTPATH_TRAP);
     strcpy(msg.module, mapping->module);
     msg.address = (uintptr_t)fault_addr;
     msg.id = g_msg_id_counter++;
@@ -74,82 +307,60 @@ static void segfault_handler(int sig, siginfo_t *si, void *ctx) {
     uintptr_t rip = uc->uc_mcontext.gregs[REG_RIP];
     uint8_t *insn = (uint8_t *)rip;
     
-    int instruction_length = 2; // default length
+    // 可选的REX前缀（r8-r15寄存器）
+    uint8_t rex = 0;
+    int prefix_length = 0;
+    if ((insn[0] & 0xF0) == 0x40) {
+        rex = insn[0];
+        insn++;
+        prefix_length = 1;
+    }
     
     if (insn[0] == 0x8B) {               // MOV r32, r/m32 - 读操作
         msg.type = MSG_REG_READ;
 
-        // 计算指令长度 - 8B指令的长度取决于ModR/M字节
-        if ((insn[1] & 0xC0) == 0x00) {       // mod = 00, no displacement
-            instruction_length = 2;
-        } else if ((insn[1] & 0xC0) == 0x40) { // mod = 01, 8-bit displacement  
-            instruction_length = 3;
-        } else if ((insn[1] & 0xC0) == 0x80) { // mod = 10, 32-bit displacement
-            instruction_length = 6;
-        } else {                              // mod = 11, register-to-register
-            instruction_length = 2;
-        }
-
-        if (handle_sim_message(&msg, &response) == 0) {
+        if (sim_trap_access(mapping, &msg, &response) == 0) {
             printf("[%s:%s] Register read completed: addr=0x%08X, 0x%08X\n", __FILE__, __func__, msg.address, response.data.response.result);
             
-            // 将读取的值设置到目标寄存器
-            // 从ModR/M字节解析目标寄存器
-            uint8_t reg = (insn[1] >> 3) & 0x07;
-            switch (reg) {
-                case 0: uc->uc_mcontext.gregs[REG_RAX] = response.data.response.result; break;
-                case 1: uc->uc_mcontext.gregs[REG_RCX] = response.data.response.result; break;
-                case 2: uc->uc_mcontext.gregs[REG_RDX] = response.data.response.result; break;
-                case 3: uc->uc_mcontext.gregs[REG_RBX] = response.data.response.result; break;
-                default: uc->uc_mcontext.gregs[REG_RAX] = response.data.response.result; break;
-            }
+            // 将读取的值设置到ModR/M reg字段指定的目标寄存器（32位写入清零高位）
+            *modrm_reg_operand(uc, rex, insn[1]) = (greg_t)response.data.response.result;
         } else {
             printf("[%s:%s] Failed to handle register read\n", __FILE__, __func__);
             exit(1);
         }
 
-        uc->uc_mcontext.gregs[REG_RIP] += instruction_length;
+        uc->uc_mcontext.gregs[REG_RIP] += prefix_length + 1 + modrm_operand_length(&insn[1]);
     } else if (insn[0] == 0x89) {        // MOV r/m32, r32 - 写寄存器操作
-        msg.value = uc->uc_mcontext.gregs[REG_RAX];
-        msg.type = MSG_REG_WRITE;
-
-        // 计算指令长度
-        if ((insn[1] & 0xC0) == 0x00) {       
-            instruction_length = 2;
-        } else if ((insn[1] & 0xC0) == 0x40) { 
-            instruction_length = 3;
-        } else if ((insn[1] & 0xC0) == 0x80) { 
-            instruction_length = 6;
-        } else {                              
-            instruction_length = 2;
-        }
-
-        if (handle_sim_message(&msg, &response) == 0) {
-            printf("[%s:%s] Register write completed: addr=0x%08X, 0x%08X\n", __FILE__, __func__, msg.address, response.data.response.result);
-        } else {
-            printf("[%s:%s] Failed to handle register write\n", __FILE__, __func__);
-            exit(1);
-        }
-
-        uc->uc_mcontext.gregs[REG_RIP] += instruction_length;
-    } else if (insn[0] == 0xC7) {        // MOV r/m32, imm32 - 写立即数操作
-        msg.value = *(uint32_t *)(rip + 2);
+        msg.value = (uint32_t)*modrm_reg_operand(uc, rex, insn[1]);
         msg.type = MSG_REG_WRITE;
 
-        if (handle_sim_message(&msg, &response) == 0) {
+        if (sim_trap_access(mapping, &msg, &response) == 0) {
             printf("[%s:%s] Register write completed: addr=0x%08X, 0x%08X\n", __FILE__, __func__, msg.address, response.data.response.result);
         } else {
             printf("[%s:%s] Failed to handle register write\n", __FILE__, __func__);
             exit(1);
         }
 
-        uc->uc_mcontext.gregs[REG_RIP] += 6; // next instruction
+        uc->uc_mcontext.gregs[REG_RIP] += prefix_length + 1 + modrm_operand_length(&insn[1]);
+    } else if (insn[0] == 0xC7) {        // MOV r/m32, imm32 - 写立即数操作
+        int operand_length = modrm_operand_length(&insn[1]);
+        memcpy(&msg.value, &insn[1 + operand_length], sizeof(msg.value));
+        msg.type = MSG_REG_WRITE;
+
+        if (sim_trap_access(mapping, &msg, &response) == 0) {
+            printf("[%s:%s] Register write completed: addr=0x%08X, 0x%08X\n", __FILE__, __func__, msg.address, response.data.response.result);
+        } else {
+            printf("[%s:%s] Failed to handle register write\n", __FILE__, __func__);
+            exit(1);
+        }
+
+        uc->uc_mcontext.gregs[REG_RIP] += prefix_length + 1 + operand_length + 4; // next instruction
     } else {                            // 对于其他不支持的指令，我们简化处理：
         printf("[%s:%s] Unsupported instruction: 0x%02X at RIP=0x%lx, treating as read\n", __FILE__, __func__, insn[0], rip);
         
         // 对于不支持的指令，默认作为读操作处理
         msg.type = MSG_REG_READ;
-        if (handle_sim_message(&msg, &response) == 0) {
+        if (sim_trap_access(mapping, &msg, &response) == 0) {
             printf("[%s:%s] Register read completed: addr=0x%08X, 0x%08X\n", __FILE__, __func__, msg.address, response.data.response.result);
             uc->uc_mcontext.gregs[REG_RAX] = response.data.response.result;
         } else {
@@ -160,6 +371,94 @@ static void segfault_handler(int sig, siginfo_t *si, void *ctx) {
         // For unsupported instructions, skip them carefully - assume 2 bytes for now
         uc->uc_mcontext.gregs[REG_RIP] += 2;
     }
+    sim_hotpath_exit();
+    sim_perf_end(SIM_PERF_TRAP);
+    
+    // 剖析器按陷入前的RIP归账（上面已经把RIP推进到下一条指令）
+    if (profile_start || vtime_profile_active()) {
+        greg_t next_rip = uc->uc_mcontext.gregs[REG_RIP];
+        uc->uc_mcontext.gregs[REG_RIP] = (greg_t)rip;
+        if (profile_start) {
+            trap_profile_record(uc, mapping->module, msg.type == MSG_REG_WRITE, sim_monotonic_ns() - profile_start);
+        }
+        vtime_profile_sample(uc, sim_vtime_now());
+        uc->uc_mcontext.gregs[REG_RIP] = next_rip;
+    }
+}
+
+static void atomic_max_u64(uint64_t *target, uint64_t value) {
+    uint64_t current = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (value > current &&
+           !__atomic_compare_exchange_n(target, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// 记录一次中断发出（任意线程），返回发出后的积压数
+static uint64_t irq_profile_raise(int index) {
+    irq_profile_t *prof = &g_irq_profile[index];
+    uint64_t seq = __atomic_fetch_add(&g_irq_raised[index], 1, __ATOMIC_RELAXED);
+    irq_raise_t *slot = &prof->ring[seq % IRQ_RAISE_RING];
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&slot->host_ns, sim_monotonic_ns(), __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->vtime_ns, sim_vtime_now(), __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+
+    uint64_t done = __atomic_load_n(&g_irq_delivered[index], __ATOMIC_RELAXED) +
+                    __atomic_load_n(&prof->lost, __ATOMIC_RELAXED);
+    return seq + 1 > done ? seq + 1 - done : 0;
+}
+
+// 进入ISR：按递送序号取出发出记录计算延迟，返回嵌套深度
+static int irq_profile_enter(int index, uint64_t now) {
+    irq_profile_t *prof = &g_irq_profile[index];
+    uint64_t seq = __atomic_fetch_add(&g_irq_delivered[index], 1, __ATOMIC_RELAXED) +
+                   __atomic_load_n(&prof->lost, __ATOMIC_RELAXED);
+    irq_raise_t *slot = &prof->ring[seq % IRQ_RAISE_RING];
+
+    uint64_t tag = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    uint64_t host_ns = __atomic_load_n(&slot->host_ns, __ATOMIC_RELAXED);
+    uint64_t vtime_ns = __atomic_load_n(&slot->vtime_ns, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (tag == seq + 1 && __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == tag) {
+        uint64_t latency = now > host_ns ? now - host_ns : 0;
+        uint64_t vtime_now = sim_vtime_now();
+        __atomic_store_n(&prof->latency_samples, prof->latency_samples + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&prof->latency_total_ns, prof->latency_total_ns + latency, __ATOMIC_RELAXED);
+        atomic_max_u64(&prof->latency_max_ns, latency);
+        atomic_max_u64(&prof->latency_max_vtime_ns, vtime_now > vtime_ns ? vtime_now - vtime_ns : 0);
+    }
+
+    if (g_irq_depth < MAX_SIGNAL_MAPPINGS) {
+        g_irq_depth++;
+    }
+    g_irq_child_ns[g_irq_depth] = 0;
+    if ((uint32_t)g_irq_depth > prof->max_nesting) {
+        __atomic_store_n(&prof->max_nesting, (uint32_t)g_irq_depth, __ATOMIC_RELAXED);
+    }
+    return g_irq_depth;
+}
+
+// 退出ISR：自身耗时扣除嵌套进来的ISR，积压清空后重新布防告警
+static void irq_profile_exit(int index, uint64_t elapsed) {
+    irq_profile_t *prof = &g_irq_profile[index];
+    uint64_t self = elapsed > g_irq_child_ns[g_irq_depth] ? elapsed - g_irq_child_ns[g_irq_depth] : 0;
+
+    if (g_irq_depth > 0) {
+        g_irq_depth--;
+    }
+    if (g_irq_depth > 0) {
+        g_irq_child_ns[g_irq_depth] += elapsed;
+    }
+    __atomic_store_n(&prof->handler_total_ns, prof->handler_total_ns + self, __ATOMIC_RELAXED);
+    atomic_max_u64(&prof->handler_max_ns, self);
+
+    uint64_t done = __atomic_load_n(&g_irq_delivered[index], __ATOMIC_RELAXED) +
+                    __atomic_load_n(&prof->lost, __ATOMIC_RELAXED);
+    if (done >= __atomic_load_n(&g_irq_raised[index], __ATOMIC_RELAXED)) {
+        __atomic_store_n(&prof->alarm_active, 0, __ATOMIC_RELAXED);
+    }
 }
 
 // 信号处理器（用于中断）
@@ -169,11 +468,21 @@ static void interrupt_signal_handler(int sig) {
     for (int i = 0; i < g_signal_mapping_count; i++) {
         if (g_signal_mappings[i].signal_num == sig) {
             signal_mapping_t *mapping = &g_signal_mappings[i];
-            printf("[%s:%s] Interrupt signal %d received for module %s (IRQ %d)\n", 
-                   __FILE__, __func__, sig, mapping->module, mapping->irq_num);
+            uint64_t entry_ns = sim_monotonic_ns();
+            int depth = irq_profile_enter(i, entry_ns);
+            printf("[%s:%s] Interrupt signal %d received for module %s (IRQ %d), nesting %d\n", 
+                   __FILE__, __func__, sig, mapping->module, mapping->irq_num, depth);
             
             // 使用interrupt_manager处理中断
+            sim_perf_begin(SIM_PERF_IRQ);
+            vtime_profile_irq_enter(mapping->module, mapping->irq_num);
+            replay_irq_enter(mapping->module, mapping->irq_num);
+            uint64_t handler_start = sim_monotonic_ns();
             handle_interrupt(mapping->irq_num);
+            irq_profile_exit(i, sim_monotonic_ns() - handler_start);
+            replay_irq_exit();
+            vtime_profile_irq_exit();
+            sim_perf_end(SIM_PERF_IRQ);
             break;
         }
     }
@@ -183,9 +492,11 @@ static void interrupt_signal_handler(int sig) {
 int sim_interface_init(void) {
 
     // 设置段错误信号处理器
+    // 处理期间屏蔽中断信号：一次寄存器访问不可被ISR打断，访问中发出的中断在访问完成后递送
     struct sigaction sa;
     sa.sa_flags = SA_SIGINFO;
-    sigemptyset(&sa.sa_mask);
+    sigfillset(&sa.sa_mask);
+    sigdelset(&sa.sa_mask, SIGSYS);     // 插桩构建在陷入中统计系统调用，见hotpath_check.c
     sa.sa_sigaction = segfault_handler;
     
     if (sigaction(SIGSEGV, &sa, NULL) == -1) {
@@ -220,13 +531,110 @@ int add_register_mapping(uint32_t start_addr, uint32_t end_addr, const char *mod
     strcpy(mapping->module, module);
     mapping->mapped_addr = mapped_addr;
     
-    g_reg_mapping_count++;
+    memset(&g_trap_stats[g_reg_mapping_count], 0, sizeof(g_trap_stats[0]));
+    memset(g_footprint[g_reg_mapping_count], 0, sizeof(g_footprint[0]));
+    
+    // 控制线程按计数读取映射表，条目填好后再发布
+    __atomic_store_n(&g_reg_mapping_count, g_reg_mapping_count + 1, __ATOMIC_RELEASE);
     
     printf("[%s:%s] Register mapping added: %s [0x%08X-0x%08X] -> %p\n", 
            __FILE__, __func__, module, start_addr, end_addr, mapped_addr);
     return 0;
 }
 
+// 添加内存区域映射
+int add_memory_mapping(uint32_t start_addr, uint32_t size, const char *name) {
+    if (g_mem_mapping_count >= MAX_MEM_MAPPINGS) {
+        printf("[%s:%s] Error: Maximum memory mappings reached\n", __FILE__, __func__);
+        return -1;
+    }
+    
+    // 映射到与物理地址相同的宿主地址，驱动中的32位地址可以直接当指针使用
+    void *hint = (void *)(uintptr_t)start_addr;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#ifdef MAP_FIXED_NOREPLACE
+    flags |= MAP_FIXED_NOREPLACE;
+#endif
+    void *mapped_addr = mmap(hint, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (mapped_addr == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    if (mapped_addr != hint) {
+        printf("[%s:%s] Error: %s [0x%08X] is already in use by the host\n", 
+               __FILE__, __func__, name, start_addr);
+        munmap(mapped_addr, size);
+        return -1;
+    }
+    
+    mem_mapping_t *mapping = &g_mem_mappings[g_mem_mapping_count];
+    mapping->start_addr = start_addr;
+    mapping->size = size;
+    strncpy(mapping->name, name, sizeof(mapping->name) - 1);
+    mapping->mapped_addr = mapped_addr;
+    
+    g_mem_mapping_count++;
+    
+    printf("[%s:%s] Memory mapping added: %s [0x%08X-0x%08X]\n", 
+           __FILE__, __func__, name, start_addr, start_addr + size);
+    return 0;
+}
+
+// 获取映射的虚拟地址
+void* get_mapped_address(uint32_t physical_addr) {
+    return get_mapped_range(physical_addr, 1);
+}
+
+// 获取内存区间的宿主指针
+void* get_mapped_range(uint32_t addr, uint32_t len) {
+    for (int i = 0; i < g_mem_mapping_count; i++) {
+        mem_mapping_t *mapping = &g_mem_mappings[i];
+        if (addr >= mapping->start_addr &&
+            (uint64_t)addr + len <= (uint64_t)mapping->start_addr + mapping->size) {
+            return (uint8_t *)mapping->mapped_addr + (addr - mapping->start_addr);
+        }
+    }
+    return NULL;
+}
+
+// 总线读：访问外设寄存器
+int sim_bus_read(uint32_t addr, uint32_t *value) {
+    reg_mapping_t *mapping = find_register_mapping((void *)(uintptr_t)addr);
+    if (!mapping) {
+        return -1;
+    }
+    
+    sim_message_t msg = {0};
+    sim_message_t response = {0};
+    msg.type = MSG_REG_READ;
+    strcpy(msg.module, mapping->module);
+    msg.address = addr;
+    footprint_mark(mapping, addr);
+    
+    if (handle_sim_message(&msg, &response) != 0) {
+        return -1;
+    }
+    *value = response.data.response.result;
+    return 0;
+}
+
+// 总线写：访问外设寄存器
+int sim_bus_write(uint32_t addr, uint32_t value) {
+    reg_mapping_t *mapping = find_register_mapping((void *)(uintptr_t)addr);
+    if (!mapping) {
+        return -1;
+    }
+    
+    sim_message_t msg = {0};
+    msg.type = MSG_REG_WRITE;
+    strcpy(msg.module, mapping->module);
+    msg.address = addr;
+    msg.value = value;
+    footprint_mark(mapping, addr);
+    
+    return handle_sim_message(&msg, NULL);
+}
+
 // 添加信号映射
 int add_signal_mapping(int signal_num, const char *module, uint32_t irq_num) {
     if (g_signal_mapping_count >= MAX_SIGNAL_MAPPINGS) {
@@ -242,21 +650,54 @@ int add_signal_mapping(int signal_num, const char *module, uint32_t irq_num) {
     // 注册信号处理器
     signal(signal_num, interrupt_signal_handler);
     
-    g_signal_mapping_count++;
+    g_irq_raised[g_signal_mapping_count] = 0;
+    g_irq_delivered[g_signal_mapping_count] = 0;
+    memset(&g_irq_profile[g_signal_mapping_count], 0, sizeof(g_irq_profile[0]));
+    __atomic_store_n(&g_signal_mapping_count, g_signal_mapping_count + 1, __ATOMIC_RELEASE);
     
     printf("[%s:%s] Signal mapping added: signal %d -> %s IRQ %d\n", 
            __FILE__, __func__, signal_num, module, irq_num);
     return 0;
 }
 
+// 积压告警：积压越过阈值时告警一次，ISR把积压清空后重新布防
+static void irq_profile_check_backlog(int index, uint64_t backlog) {
+    irq_profile_t *prof = &g_irq_profile[index];
+
+    uint32_t current = __atomic_load_n(&prof->max_backlog, __ATOMIC_RELAXED);
+    while (backlog > current &&
+           !__atomic_compare_exchange_n(&prof->max_backlog, &current, (uint32_t)backlog, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    if (backlog >= SIM_IRQ_BACKLOG_ALARM && !__atomic_exchange_n(&prof->alarm_active, 1, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&prof->backlog_alarms, 1, __ATOMIC_RELAXED);
+        printf("[%s:%s] ALARM: %s IRQ %d backlog %llu, device raises faster than its ISR drains\n",
+               __FILE__, __func__, g_signal_mappings[index].module, g_signal_mappings[index].irq_num,
+               (unsigned long long)backlog);
+    }
+}
+
 // 触发中断信号
 int trigger_interrupt(const char *module, uint32_t irq_num) {
+    // 锁步候选实现的中断只计数，不发信号
+    if (!lockstep_irq_raise(module, irq_num)) {
+        return 0;
+    }
     for (int i = 0; i < g_signal_mapping_count; i++) {
         signal_mapping_t *mapping = &g_signal_mappings[i];
         if (strcmp(mapping->module, module) == 0 && mapping->irq_num == irq_num) {
+            // 回放时中断由日志在记录的位置递送
+            uint64_t backlog = irq_profile_raise(i);
+            irq_profile_check_backlog(i, backlog);
+            if (!replay_irq_raise(module, irq_num)) {
+                return 0;
+            }
             printf("[%s:%s] Triggering interrupt: signal %d for %s IRQ %d\n", 
                    __FILE__, __func__, mapping->signal_num, module, irq_num);
-            kill(getpid(), mapping->signal_num);
+            if (kill(getpid(), mapping->signal_num) != 0) {
+                __atomic_fetch_add(&g_irq_profile[i].lost, 1, __ATOMIC_RELAXED);
+                printf("[%s:%s] Warning: %s IRQ %d lost: %s\n", __FILE__, __func__, module, irq_num, strerror(errno));
+            }
             return 0;
         }
     }
@@ -264,6 +705,223 @@ int trigger_interrupt(const char *module, uint32_t irq_num) {
     return -1;
 }
 
+// 查找模块中断对应的信号
+int sim_irq_signal(const char *module, uint32_t irq_num) {
+    for (int i = 0; i < g_signal_mapping_count; i++) {
+        signal_mapping_t *mapping = &g_signal_mappings[i];
+        if (strcmp(mapping->module, module) == 0 && mapping->irq_num == irq_num) {
+            return mapping->signal_num;
+        }
+    }
+    return -1;
+}
+
+// 芯片外部输入
+int sim_device_input(const char *module, uint32_t channel, uint32_t value) {
+    sim_message_t msg = {0};
+    if (lockstep_is_candidate(module)) {
+        return 0;
+    }
+    msg.type = MSG_INPUT;
+    strncpy(msg.module, module, sizeof(msg.module) - 1);
+    msg.value = value;
+    msg.data.input.channel = channel;
+    return replay_device_input(&msg);
+}
+
+// 虚拟时间
+uint64_t sim_vtime_now(void) {
+    return __atomic_load_n(&g_vtime_ns, __ATOMIC_ACQUIRE);
+}
+
+uint64_t sim_vtime_advance(uint64_t ns) {
+    return __atomic_add_fetch(&g_vtime_ns, ns, __ATOMIC_ACQ_REL);
+}
+
+void sim_vtime_set(uint64_t ns) {
+    __atomic_store_n(&g_vtime_ns, ns, __ATOMIC_RELEASE);
+}
+
+// 把g_vtimer_next降到deadline（不升高）
+static void sim_vtimer_lower_next(uint64_t deadline) {
+    uint64_t next = __atomic_load_n(&g_vtimer_next, __ATOMIC_RELAXED);
+    while (deadline < next &&
+           !__atomic_compare_exchange_n(&g_vtimer_next, &next, deadline, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+    }
+}
+
+int sim_vtimer_create(sim_vtimer_fn_t fn, void *ctx) {
+    if (!fn) {
+        return -1;
+    }
+    for (int i = 0; i < SIM_VTIMER_MAX; i++) {
+        if (!__atomic_exchange_n(&g_vtimers[i].used, true, __ATOMIC_ACQ_REL)) {
+            g_vtimers[i].fn = fn;
+            g_vtimers[i].ctx = ctx;
+            __atomic_store_n(&g_vtimers[i].deadline_ns, 0, __ATOMIC_RELEASE);
+            return i;
+        }
+    }
+    printf("[%s:%s] No free virtual-time timer\n", __FILE__, __func__);
+    return -1;
+}
+
+// 先写到期时刻再降低g_vtimer_next：扫描漏掉的定时器自己把next降下来
+void sim_vtimer_arm(int id, uint64_t deadline_ns) {
+    if (id < 0 || id >= SIM_VTIMER_MAX) {
+        return;
+    }
+    __atomic_store_n(&g_vtimers[id].deadline_ns, deadline_ns, __ATOMIC_RELEASE);
+    if (deadline_ns) {
+        sim_vtimer_lower_next(deadline_ns);
+    }
+}
+
+void sim_vtimer_destroy(int id) {
+    if (id < 0 || id >= SIM_VTIMER_MAX) {
+        return;
+    }
+    __atomic_store_n(&g_vtimers[id].deadline_ns, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_vtimers[id].used, false, __ATOMIC_RELEASE);
+}
+
+// 陷入路径：回调所有到期的定时器；到期时刻用CAS清零，并发的陷入不会重复回调
+void sim_vtimer_poll(uint64_t vtime_ns) {
+    if (vtime_ns < __atomic_load_n(&g_vtimer_next, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_store_n(&g_vtimer_next, UINT64_MAX, __ATOMIC_RELEASE);
+    
+    uint64_t next = UINT64_MAX;
+    for (int i = 0; i < SIM_VTIMER_MAX; i++) {
+        sim_vtimer_t *t = &g_vtimers[i];
+        uint64_t deadline = __atomic_load_n(&t->deadline_ns, __ATOMIC_ACQUIRE);
+        if (deadline == 0) {
+            continue;
+        }
+        if (deadline > vtime_ns) {
+            next = deadline < next ? deadline : next;
+        } else if (__atomic_compare_exchange_n(&t->deadline_ns, &deadline, 0, false,
+                                               __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            t->fn(t->ctx, vtime_ns);
+        }
+    }
+    sim_vtimer_lower_next(next);
+}
+
+// 读取各模块的访问统计（seqlock读端：写入进行中或读取期间被改写则重读）
+int sim_trap_stats(sim_trap_stats_t *stats, int max) {
+    int count = __atomic_load_n(&g_reg_mapping_count, __ATOMIC_ACQUIRE);
+    
+    if (count > max) {
+        count = max;
+    }
+    for (int i = 0; i < count; i++) {
+        trap_stats_slot_t *slot = &g_trap_stats[i];
+        sim_trap_stats_t *out = &stats[i];
+        uint32_t seq;
+        
+        strncpy(out->module, g_reg_mappings[i].module, sizeof(out->module) - 1);
+        out->module[sizeof(out->module) - 1] = '\0';
+        do {
+            seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (seq & 1) {
+                continue;
+            }
+            out->reads = __atomic_load_n(&slot->reads, __ATOMIC_RELAXED);
+            out->writes = __atomic_load_n(&slot->writes, __ATOMIC_RELAXED);
+            out->last_addr = __atomic_load_n(&slot->last_addr, __ATOMIC_RELAXED);
+            out->last_value = __atomic_load_n(&slot->last_value, __ATOMIC_RELAXED);
+            out->last_vtime_ns = __atomic_load_n(&slot->last_vtime_ns, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while ((seq & 1) || __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq);
+    }
+    return count;
+}
+
+// 清空访问足迹
+void sim_footprint_clear(void) {
+    for (int i = 0; i < MAX_REG_MAPPINGS; i++) {
+        for (int w = 0; w < SIM_FOOTPRINT_MAX_WORDS / 32; w++) {
+            __atomic_store_n(&g_footprint[i][w], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// 读取各映射的访问足迹
+int sim_footprint_get(sim_footprint_t *footprints, int max) {
+    int count = __atomic_load_n(&g_reg_mapping_count, __ATOMIC_ACQUIRE);
+    
+    if (count > max) {
+        count = max;
+    }
+    for (int i = 0; i < count; i++) {
+        sim_footprint_t *out = &footprints[i];
+        strncpy(out->module, g_reg_mappings[i].module, sizeof(out->module) - 1);
+        out->module[sizeof(out->module) - 1] = '\0';
+        out->start_addr = g_reg_mappings[i].start_addr;
+        for (int w = 0; w < SIM_FOOTPRINT_MAX_WORDS / 32; w++) {
+            out->words[w] = __atomic_load_n(&g_footprint[i][w], __ATOMIC_RELAXED);
+        }
+    }
+    return count;
+}
+
+// 读取各中断的统计
+int sim_irq_stats(sim_irq_stats_t *stats, int max) {
+    int count = __atomic_load_n(&g_signal_mapping_count, __ATOMIC_ACQUIRE);
+    
+    if (count > max) {
+        count = max;
+    }
+    for (int i = 0; i < count; i++) {
+        strncpy(stats[i].module, g_signal_mappings[i].module, sizeof(stats[i].module) - 1);
+        stats[i].module[sizeof(stats[i].module) - 1] = '\0';
+        stats[i].irq_num = g_signal_mappings[i].irq_num;
+        stats[i].signal_num = g_signal_mappings[i].signal_num;
+        stats[i].raised = __atomic_load_n(&g_irq_raised[i], __ATOMIC_RELAXED);
+        stats[i].delivered = __atomic_load_n(&g_irq_delivered[i], __ATOMIC_RELAXED);
+
+        irq_profile_t *prof = &g_irq_profile[i];
+        stats[i].lost = __atomic_load_n(&prof->lost, __ATOMIC_RELAXED);
+        stats[i].latency_samples = __atomic_load_n(&prof->latency_samples, __ATOMIC_RELAXED);
+        stats[i].latency_total_ns = __atomic_load_n(&prof->latency_total_ns, __ATOMIC_RELAXED);
+        stats[i].latency_max_ns = __atomic_load_n(&prof->latency_max_ns, __ATOMIC_RELAXED);
+        stats[i].latency_max_vtime_ns = __atomic_load_n(&prof->latency_max_vtime_ns, __ATOMIC_RELAXED);
+        stats[i].handler_total_ns = __atomic_load_n(&prof->handler_total_ns, __ATOMIC_RELAXED);
+        stats[i].handler_max_ns = __atomic_load_n(&prof->handler_max_ns, __ATOMIC_RELAXED);
+        stats[i].max_nesting = __atomic_load_n(&prof->max_nesting, __ATOMIC_RELAXED);
+        stats[i].max_backlog = __atomic_load_n(&prof->max_backlog, __ATOMIC_RELAXED);
+        stats[i].backlog_alarms = __atomic_load_n(&prof->backlog_alarms, __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+// 打印中断统计：平均值按参与统计的次数计算
+void sim_irq_report(void) {
+    sim_irq_stats_t stats[MAX_SIGNAL_MAPPINGS];
+    int count = sim_irq_stats(stats, MAX_SIGNAL_MAPPINGS);
+
+    printf("[%s:%s] ISR statistics (backlog alarm at %d):\n", __FILE__, __func__, SIM_IRQ_BACKLOG_ALARM);
+    printf("module    irq    raised delivered  lost  lat_avg_ns  lat_max_ns lat_max_vt  isr_avg_ns  isr_max_ns nest backlog alarms\n");
+    for (int i = 0; i < count; i++) {
+        const sim_irq_stats_t *s = &stats[i];
+        if (s->raised == 0 && s->delivered == 0) {
+            continue;
+        }
+        printf("%-8s %4u %9llu %9llu %5llu %11llu %11llu %10llu %11llu %11llu %4u %7u %6llu%s\n",
+               s->module, s->irq_num, (unsigned long long)s->raised, (unsigned long long)s->delivered,
+               (unsigned long long)s->lost,
+               (unsigned long long)(s->latency_samples ? s->latency_total_ns / s->latency_samples : 0),
+               (unsigned long long)s->latency_max_ns, (unsigned long long)s->latency_max_vtime_ns,
+               (unsigned long long)(s->delivered ? s->handler_total_ns / s->delivered : 0),
+               (unsigned long long)s->handler_max_ns, s->max_nesting, s->max_backlog,
+               (unsigned long long)s->backlog_alarms,
+               s->raised > s->delivered + s->lost ? "  (undelivered)" : "");
+    }
+}
+
 // 清理资源
 void sim_interface_cleanup(void) {
     // 释放映射的内存
@@ -276,6 +934,13 @@ void sim_interface_cleanup(void) {
     g_reg_mapping_count = 0;
     g_signal_mapping_count = 0;
     
+    // 先停止插件（DMA可能仍在访问内存区域），再释放内存区域
     cleanup_plugins();
+    
+    for (int i = 0; i < g_mem_mapping_count; i++) {
+        munmap(g_mem_mappings[i].mapped_addr, g_mem_mappings[i].size);
+    }
+    g_mem_mapping_count = 0;
+
     printf("[%s:%s] Sim interface cleaned up\n", __FILE__, __func__);
 }
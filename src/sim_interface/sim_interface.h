@@ -10,6 +10,9 @@
 #define UART_TX_SIGNAL 34  // SIGRTMIN
 #define UART_RX_SIGNAL 35  // SIGRTMIN+1
 
+// 虚拟时间：每次陷入的寄存器访问推进的纳秒数（约等于一次外设总线访问）
+#define SIM_VTIME_TRAP_NS 100
+
 // 寄存器映射条目
 typedef struct {
     uint32_t start_addr;
@@ -25,21 +28,119 @@ typedef struct {
     uint32_t irq_num;
 } signal_mapping_t;
 
+// 内存区域映射条目（SRAM等，按物理地址恒等映射到宿主地址空间）
+typedef struct {
+    uint32_t start_addr;
+    uint32_t size;
+    char name[32];
+    void *mapped_addr;
+} mem_mapping_t;
+
+// 模块寄存器访问统计快照（控制套接字读取，见sim_trap_stats）
+typedef struct {
+    char module[32];
+    uint64_t reads;             // 陷入的寄存器读次数
+    uint64_t writes;            // 陷入的寄存器写次数
+    uint32_t last_addr;         // 最近一次访问的地址和值
+    uint32_t last_value;
+    uint64_t last_vtime_ns;     // 最近一次访问时的虚拟时间
+} sim_trap_stats_t;
+
+// 中断统计快照
+typedef struct {
+    char module[32];
+    uint32_t irq_num;
+    int signal_num;
+    uint64_t raised;            // trigger_interrupt发出的次数
+    uint64_t delivered;         // 信号处理器执行ISR的次数
+    uint64_t lost;              // 信号发送失败（实时信号队列满）的次数
+    uint64_t latency_samples;   // 参与延迟统计的递送次数（发出记录被覆盖的不计）
+    uint64_t latency_total_ns;  // 发出到进入ISR的宿主时间
+    uint64_t latency_max_ns;
+    uint64_t latency_max_vtime_ns; // 发出到进入ISR期间推进的虚拟时间最大值
+    uint64_t handler_total_ns;  // ISR自身耗时，不含嵌套进来的其他ISR
+    uint64_t handler_max_ns;
+    uint32_t max_nesting;       // 进入ISR时的最大嵌套深度，1表示未嵌套
+    uint32_t max_backlog;       // 已发出未递送的最大积压
+    uint64_t backlog_alarms;    // 积压越过告警阈值的次数
+} sim_irq_stats_t;
+
+// 寄存器访问足迹：每个寄存器映射中访问过的字偏移（回归测试按足迹选择用例）
+#define SIM_FOOTPRINT_MAX_WORDS 256     // 每个映射记录的字数，覆盖0x400字节窗口
+
+typedef struct {
+    char module[32];
+    uint32_t start_addr;
+    uint32_t words[SIM_FOOTPRINT_MAX_WORDS / 32];  // 第n位表示偏移n*4被访问过
+} sim_footprint_t;
+
+// 中断积压告警阈值：发出未递送的中断达到此数时说明设备发中断快于ISR处理
+#define SIM_IRQ_BACKLOG_ALARM 8
+
 // Sim Interface初始化
 int sim_interface_init(void);
 
 // 设置寄存器映射
 int add_register_mapping(uint32_t start_addr, uint32_t end_addr, const char *module);
 
+// 设置内存区域映射（可读写，驱动和DMA插件可直接按地址访问）
+int add_memory_mapping(uint32_t start_addr, uint32_t size, const char *name);
+
 // 设置信号映射
 int add_signal_mapping(int signal_num, const char *module, uint32_t irq_num);
 
 // 触发中断信号
 int trigger_interrupt(const char *module, uint32_t irq_num);
 
+// 查找模块中断对应的信号，未映射返回-1
+int sim_irq_signal(const char *module, uint32_t irq_num);
+
+// 芯片外部输入（UART RX线等）：经记录/回放层交给插件的input方法
+int sim_device_input(const char *module, uint32_t channel, uint32_t value);
+
+// 虚拟时间（纳秒）
+uint64_t sim_vtime_now(void);
+uint64_t sim_vtime_advance(uint64_t ns);
+void sim_vtime_set(uint64_t ns);
+
+// 虚拟时间定时器：设备模型按虚拟时间安排的事件（UART接收空闲超时等）。
+// 陷入路径推进虚拟时间后检查，到期的定时器在陷入处理中回调一次（可在回调中重新启动）
+#define SIM_VTIMER_MAX 16
+typedef void (*sim_vtimer_fn_t)(void *ctx, uint64_t vtime_ns);
+int sim_vtimer_create(sim_vtimer_fn_t fn, void *ctx);     // 返回定时器编号，用尽返回-1
+void sim_vtimer_arm(int id, uint64_t deadline_ns);        // 重新设定到期时刻，0为取消
+void sim_vtimer_destroy(int id);
+void sim_vtimer_poll(uint64_t vtime_ns);
+
 // 获取映射的虚拟地址
 void* get_mapped_address(uint32_t physical_addr);
 
+// 获取[addr, addr+len)所在内存区域的宿主指针，不在同一内存区域内返回NULL
+void* get_mapped_range(uint32_t addr, uint32_t len);
+
+// 总线访问：按地址查找寄存器映射并分发给对应插件（供DMA访问外设寄存器）
+int sim_bus_read(uint32_t addr, uint32_t *value);
+int sim_bus_write(uint32_t addr, uint32_t value);
+
+// 控制面请求（控制套接字的poke/irq）：其他线程投递，在下一次陷入访问之前由陷入线程执行，
+// 与设备模型的陷入处理串行。地址不是设备寄存器或中断未映射返回-1，队列满返回-2
+#define SIM_POST_MAX 16
+int sim_post_bus_write(uint32_t addr, uint32_t value);
+int sim_post_irq(const char *module, uint32_t irq_num);
+
+// 读取各模块的访问统计，返回条目数；可在任意线程调用，不阻塞陷入路径
+int sim_trap_stats(sim_trap_stats_t *stats, int max);
+
+// 读取各中断的统计，返回条目数
+int sim_irq_stats(sim_irq_stats_t *stats, int max);
+
+// 清空访问足迹；读取各映射的足迹，返回条目数（驱动陷入和DMA总线访问都计入）
+void sim_footprint_clear(void);
+int sim_footprint_get(sim_footprint_t *footprints, int max);
+
+// 打印各中断的延迟、ISR耗时、嵌套和积压统计
+void sim_irq_report(void);
+
 // 清理资源
 void sim_interface_cleanup(void);
 
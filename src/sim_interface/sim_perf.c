@@ -0,0 +1,211 @@
+#define _GNU_SOURCE
+
+#include "sim_perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define PERF_MAX_DEPTH  16      // 阶段嵌套深度（中断嵌套 + 陷入 + 分发）
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char *name;
+} g_counter_defs[SIM_PERF_COUNTER_COUNT] = {
+    [SIM_PERF_CYCLES]           = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,      "cycles"},
+    [SIM_PERF_INSTRUCTIONS]     = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,    "instructions"},
+    [SIM_PERF_CACHE_MISSES]     = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,    "cache_misses"},
+    [SIM_PERF_CONTEXT_SWITCHES] = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context_switches"},
+    [SIM_PERF_PAGE_FAULTS]      = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,     "page_faults"},
+    [SIM_PERF_TASK_CLOCK]       = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,      "task_clock_ns"},
+};
+
+static const char *g_phase_names[SIM_PERF_PHASE_COUNT] = {
+    [SIM_PERF_TRAP]     = "trap",
+    [SIM_PERF_DISPATCH] = "dispatch",
+    [SIM_PERF_IRQ]      = "irq",
+};
+
+// 打开的计数器组成一个组，一次read读出全部计数（组内顺序见g_slot_counter）
+static int g_leader_fd = -1;
+static int g_fds[SIM_PERF_COUNTER_COUNT];
+static int g_slot_counter[SIM_PERF_COUNTER_COUNT];
+static int g_slot_count = 0;
+static char g_report_path[256];
+
+static sim_perf_report_t g_report;
+
+// 阶段栈：只由计数线程访问（包括其上的信号处理器）
+static __thread bool t_perf_owner = false;
+static __thread int t_depth = 0;
+static __thread uint64_t t_stack[PERF_MAX_DEPTH][SIM_PERF_COUNTER_COUNT];
+
+static int perf_open(sim_perf_counter_t counter, int group_fd) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = g_counter_defs[counter].type;
+    attr.config = g_counter_defs[counter].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_hv = 1;
+
+    // 内核部分（信号递送、缺页处理）也计入；perf_event_paranoid不允许时只计用户态
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+        attr.exclude_kernel = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+    }
+    return fd;
+}
+
+// 读取组内所有计数器，按计数器编号存放
+static void perf_read(uint64_t values[SIM_PERF_COUNTER_COUNT]) {
+    uint64_t buf[1 + SIM_PERF_COUNTER_COUNT];
+
+    if (g_leader_fd < 0 ||
+        read(g_leader_fd, buf, sizeof(uint64_t) * (1 + (size_t)g_slot_count)) <= 0) {
+        return;
+    }
+    for (int i = 0; i < g_slot_count && (uint64_t)i < buf[0]; i++) {
+        values[g_slot_counter[i]] = buf[1 + i];
+    }
+}
+
+// 打开计数器
+int sim_perf_start(const char *report_path) {
+    memset(&g_report, 0, sizeof(g_report));
+    g_slot_count = 0;
+    g_leader_fd = -1;
+
+    for (int c = 0; c < SIM_PERF_COUNTER_COUNT; c++) {
+        int fd = perf_open((sim_perf_counter_t)c, g_leader_fd);
+        g_fds[c] = fd;
+        if (fd < 0) {
+            continue;
+        }
+        if (g_leader_fd < 0) {
+            g_leader_fd = fd;
+        }
+        g_slot_counter[g_slot_count++] = c;
+        g_report.available[c] = true;
+    }
+
+    g_report_path[0] = '\0';
+    if (report_path) {
+        strncpy(g_report_path, report_path, sizeof(g_report_path) - 1);
+    }
+    t_depth = 0;
+    t_perf_owner = true;
+
+    printf("[%s:%s] Host perf counters:", __FILE__, __func__);
+    for (int c = 0; c < SIM_PERF_COUNTER_COUNT; c++) {
+        printf(" %s%s", g_counter_defs[c].name, g_report.available[c] ? "" : "(n/a)");
+    }
+    printf("\n");
+    return 0;
+}
+
+// 阶段开始：先占用栈槽再读计数，读之前被中断打断时嵌套阶段使用上面的槽
+void sim_perf_begin(sim_perf_phase_t phase) {
+    (void)phase;
+    if (!t_perf_owner) {
+        return;
+    }
+    int slot = t_depth++;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    if (slot < PERF_MAX_DEPTH) {
+        perf_read(t_stack[slot]);
+    }
+}
+
+// 阶段结束：累计本阶段（含嵌套子阶段）的计数增量
+void sim_perf_end(sim_perf_phase_t phase) {
+    if (!t_perf_owner || t_depth == 0) {
+        return;
+    }
+    int slot = t_depth - 1;
+    if (slot < PERF_MAX_DEPTH) {
+        uint64_t now[SIM_PERF_COUNTER_COUNT];
+        memcpy(now, t_stack[slot], sizeof(now));
+        perf_read(now);
+
+        sim_perf_phase_stats_t *stats = &g_report.phases[phase];
+        stats->count++;
+        for (int i = 0; i < g_slot_count; i++) {
+            int c = g_slot_counter[i];
+            stats->totals[c] += now[c] - t_stack[slot][c];
+        }
+    }
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    t_depth = slot;
+}
+
+// 读取当前累计值
+void sim_perf_get_report(sim_perf_report_t *report) {
+    *report = g_report;
+}
+
+// 写入CSV报告：每个阶段一行，不可用的计数器为空
+static void perf_write_csv(const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        perror("fopen");
+        return;
+    }
+    fprintf(fp, "phase,count");
+    for (int c = 0; c < SIM_PERF_COUNTER_COUNT; c++) {
+        fprintf(fp, ",%s", g_counter_defs[c].name);
+    }
+    fprintf(fp, "\n");
+    for (int p = 0; p < SIM_PERF_PHASE_COUNT; p++) {
+        fprintf(fp, "%s,%llu", g_phase_names[p], (unsigned long long)g_report.phases[p].count);
+        for (int c = 0; c < SIM_PERF_COUNTER_COUNT; c++) {
+            if (g_report.available[c]) {
+                fprintf(fp, ",%llu", (unsigned long long)g_report.phases[p].totals[c]);
+            } else {
+                fprintf(fp, ",");
+            }
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+}
+
+// 关闭计数器并报告
+void sim_perf_stop(void) {
+    if (!t_perf_owner) {
+        return;
+    }
+    t_perf_owner = false;
+
+    for (int c = 0; c < SIM_PERF_COUNTER_COUNT; c++) {
+        if (g_fds[c] >= 0) {
+            close(g_fds[c]);
+            g_fds[c] = -1;
+        }
+    }
+    g_leader_fd = -1;
+
+    printf("[%s:%s] Host cost per simulated operation (inclusive of nested phases):\n", __FILE__, __func__);
+    for (int p = 0; p < SIM_PERF_PHASE_COUNT; p++) {
+        const sim_perf_phase_stats_t *stats = &g_report.phases[p];
+        printf("[%s:%s]   %-8s %10llu ops", __FILE__, __func__, g_phase_names[p],
+               (unsigned long long)stats->count);
+        for (int c = 0; c < SIM_PERF_COUNTER_COUNT; c++) {
+            if (g_report.available[c] && stats->count) {
+                printf("  %s %.1f", g_counter_defs[c].name, (double)stats->totals[c] / (double)stats->count);
+            }
+        }
+        printf("\n");
+    }
+
+    if (g_report_path[0]) {
+        perf_write_csv(g_report_path);
+        printf("[%s:%s] Perf counters written to %s\n", __FILE__, __func__, g_report_path);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SIM_PERF_H
+#define SIM_PERF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 宿主性能计数器 - 把perf_event_open计数按仿真阶段归账
+//
+// 阶段（可嵌套，计数包含嵌套在内的子阶段）：
+//   SIM_PERF_TRAP      一次陷入的完整处理：指令解码、分发、写回寄存器
+//   SIM_PERF_DISPATCH  其中交给插件的部分（记录/回放层 + 插件reg_read/reg_write）
+//   SIM_PERF_IRQ       中断信号的递送和ISR执行（ISR里的陷入同时计入TRAP）
+//
+// 计数器在调用sim_perf_start的线程（仿真线程）上打开，只统计该线程上的阶段。
+// 硬件计数器（cycles/instructions/cache-misses）不可用时（虚拟机、容器、
+// perf_event_paranoid限制）自动跳过，只保留软件计数器；全部不可用时各阶段只计次数。
+// 未启动时sim_perf_begin/end只检查一个线程局部标志。
+
+typedef enum {
+    SIM_PERF_TRAP = 0,
+    SIM_PERF_DISPATCH,
+    SIM_PERF_IRQ,
+    SIM_PERF_PHASE_COUNT
+} sim_perf_phase_t;
+
+typedef enum {
+    SIM_PERF_CYCLES = 0,
+    SIM_PERF_INSTRUCTIONS,
+    SIM_PERF_CACHE_MISSES,
+    SIM_PERF_CONTEXT_SWITCHES,
+    SIM_PERF_PAGE_FAULTS,
+    SIM_PERF_TASK_CLOCK,            // 线程CPU时间（纳秒），硬件计数器不可用时代替cycles
+    SIM_PERF_COUNTER_COUNT
+} sim_perf_counter_t;
+
+typedef struct {
+    uint64_t count;                                 // 阶段执行次数
+    uint64_t totals[SIM_PERF_COUNTER_COUNT];        // 各计数器累计值
+} sim_perf_phase_stats_t;
+
+typedef struct {
+    bool available[SIM_PERF_COUNTER_COUNT];         // 计数器是否成功打开
+    sim_perf_phase_stats_t phases[SIM_PERF_PHASE_COUNT];
+} sim_perf_report_t;
+
+// 在调用线程上打开计数器；report_path非NULL时停止时写入CSV报告
+// 一个计数器都打不开时仍返回0（只统计次数）
+int sim_perf_start(const char *report_path);
+
+// 阶段开始/结束，可在信号处理器中调用
+void sim_perf_begin(sim_perf_phase_t phase);
+void sim_perf_end(sim_perf_phase_t phase);
+
+// 读取当前累计值
+void sim_perf_get_report(sim_perf_report_t *report);
+
+// 关闭计数器，打印各阶段的每次平均值并写入CSV报告
+void sim_perf_stop(void);
+
+#endif // SIM_PERF_H
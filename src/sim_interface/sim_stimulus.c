@@ -0,0 +1,341 @@
+#include "sim_stimulus.h"
+#include "sim_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SIM_STIM_NEVER  UINT64_MAX
+
+typedef struct {
+    uint64_t delay_ns;
+    uint32_t value;
+} stim_file_event_t;
+
+typedef struct {
+    sim_stim_config_t cfg;
+    uint64_t rng;               // 到达时刻的随机流
+    uint64_t payload_rng;       // 负载的随机流，与到达时刻互不影响
+    uint64_t next_ns;           // 下一个事件的计划时刻
+    uint64_t burst_end_ns;      // burst：当前开启期的结束时刻
+    uint64_t seq;
+    stim_file_event_t *events;  // file
+    size_t event_count;
+    sim_stim_stats_t stats;
+} stim_gen_t;
+
+static stim_gen_t g_gens[SIM_STIM_MAX];
+static int g_gen_count = 0;
+static uint64_t g_next_due = SIM_STIM_NEVER;   // 所有发生器中最早的计划时刻
+static int g_busy = 0;                         // 注入中，其他陷入（含ISR中的陷入）直接跳过
+
+static const char *g_kind_names[SIM_STIM_KIND_COUNT] = { "const", "poisson", "burst", "file" };
+
+// splitmix64：种子相同则序列相同
+static uint64_t stim_rand(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 指数分布的间隔，均值为mean_ns
+static uint64_t stim_exponential(uint64_t *state, uint64_t mean_ns) {
+    double u = (double)((stim_rand(state) >> 11) + 1) / 9007199254740993.0;   // (0, 1]
+    return (uint64_t)(-log(u) * (double)mean_ns);
+}
+
+// 计算下一个事件的计划时刻，没有下一个事件时返回SIM_STIM_NEVER
+static uint64_t stim_schedule(stim_gen_t *g, uint64_t from_ns) {
+    if (g->cfg.count && g->seq >= g->cfg.count) {
+        return SIM_STIM_NEVER;
+    }
+    switch (g->cfg.kind) {
+        case SIM_STIM_CONST:
+            return from_ns + g->cfg.interval_ns;
+        case SIM_STIM_POISSON:
+            return from_ns + stim_exponential(&g->rng, g->cfg.interval_ns);
+        case SIM_STIM_BURST: {
+            uint64_t t = from_ns + g->cfg.interval_ns;
+            if (t >= g->burst_end_ns) {
+                t = g->burst_end_ns + g->cfg.off_ns;
+                g->burst_end_ns = t + g->cfg.on_ns;
+            }
+            return t;
+        }
+        case SIM_STIM_FILE:
+            return g->seq < g->event_count ? from_ns + g->events[g->seq].delay_ns : SIM_STIM_NEVER;
+        default:
+            return SIM_STIM_NEVER;
+    }
+}
+
+static uint32_t stim_payload(stim_gen_t *g) {
+    uint32_t value;
+    if (g->cfg.kind == SIM_STIM_FILE) {
+        value = g->events[g->seq].value;
+    } else if (g->cfg.payload == SIM_STIM_PAYLOAD_RANDOM) {
+        value = (uint32_t)stim_rand(&g->payload_rng);
+    } else {
+        value = (uint32_t)g->seq;
+    }
+    return value & g->cfg.value_mask;
+}
+
+static int stim_load_file(stim_gen_t *g) {
+    FILE *fp = fopen(g->cfg.path, "r");
+    if (!fp) {
+        printf("[%s:%s] Cannot open stimulus file %s\n", __FILE__, __func__, g->cfg.path);
+        return -1;
+    }
+    g->events = malloc(SIM_STIM_MAX_FILE_EVENTS * sizeof(stim_file_event_t));
+    if (!g->events) {
+        fclose(fp);
+        return -1;
+    }
+
+    char line[128];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp) && g->event_count < SIM_STIM_MAX_FILE_EVENTS) {
+        char *p = line, *end;
+        line_no++;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        uint64_t delay = strtoull(p, &end, 0);
+        if (end == p) {
+            printf("[%s:%s] %s:%d: expected \"delay_ns value\"\n", __FILE__, __func__, g->cfg.path, line_no);
+            fclose(fp);
+            return -1;
+        }
+        p = end;
+        uint32_t value = (uint32_t)strtoul(p, &end, 0);
+        if (end == p) {
+            printf("[%s:%s] %s:%d: expected \"delay_ns value\"\n", __FILE__, __func__, g->cfg.path, line_no);
+            fclose(fp);
+            return -1;
+        }
+        g->events[g->event_count].delay_ns = delay;
+        g->events[g->event_count].value = value;
+        g->event_count++;
+    }
+    fclose(fp);
+    return 0;
+}
+
+static void stim_lock(void) {
+    while (__atomic_exchange_n(&g_busy, 1, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void stim_unlock(void) {
+    __atomic_store_n(&g_busy, 0, __ATOMIC_RELEASE);
+}
+
+static void stim_update_due(void) {
+    uint64_t due = SIM_STIM_NEVER;
+    for (int i = 0; i < g_gen_count; i++) {
+        if (g_gens[i].next_ns < due) {
+            due = g_gens[i].next_ns;
+        }
+    }
+    __atomic_store_n(&g_next_due, due, __ATOMIC_RELEASE);
+}
+
+int sim_stim_parse(const char *spec, sim_stim_config_t *cfg) {
+    char buf[512];
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->interval_ns = 1000000;     // 默认每毫秒一个事件
+    cfg->value_mask = 0xFF;
+    cfg->seed = 1;
+
+    if (strlen(spec) >= sizeof(buf)) {
+        return -1;
+    }
+    strcpy(buf, spec);
+
+    char *kind = strchr(buf, ':');
+    if (!kind || kind == buf || (size_t)(kind - buf) >= sizeof(cfg->module)) {
+        printf("[%s:%s] Stimulus \"%s\": expected MODULE:KIND[:key=value,...]\n", __FILE__, __func__, spec);
+        return -1;
+    }
+    *kind++ = '\0';
+    strcpy(cfg->module, buf);
+    char *params = strchr(kind, ':');
+    if (params) {
+        *params++ = '\0';
+    }
+
+    int k;
+    for (k = 0; k < SIM_STIM_KIND_COUNT; k++) {
+        if (strcmp(kind, g_kind_names[k]) == 0) {
+            break;
+        }
+    }
+    if (k == SIM_STIM_KIND_COUNT) {
+        printf("[%s:%s] Unknown stimulus kind \"%s\" (const, poisson, burst, file)\n", __FILE__, __func__, kind);
+        return -1;
+    }
+    cfg->kind = (sim_stim_kind_t)k;
+
+    for (char *item = params ? strtok(params, ",") : NULL; item; item = strtok(NULL, ",")) {
+        char *value = strchr(item, '=');
+        if (!value) {
+            printf("[%s:%s] Stimulus parameter \"%s\" has no value\n", __FILE__, __func__, item);
+            return -1;
+        }
+        *value++ = '\0';
+        uint64_t v = strtoull(value, NULL, 0);
+        if (strcmp(item, "rate") == 0 && v) {
+            cfg->interval_ns = 1000000000ULL / v;
+        } else if (strcmp(item, "baud") == 0 && v) {
+            cfg->interval_ns = 10ULL * 1000000000ULL / v;   // 起始位 + 8数据位 + 停止位
+        } else if (strcmp(item, "interval") == 0) {
+            cfg->interval_ns = v;
+        } else if (strcmp(item, "seed") == 0) {
+            cfg->seed = v;
+        } else if (strcmp(item, "count") == 0) {
+            cfg->count = v;
+        } else if (strcmp(item, "start") == 0) {
+            cfg->start_ns = v;
+        } else if (strcmp(item, "on") == 0) {
+            cfg->on_ns = v;
+        } else if (strcmp(item, "off") == 0) {
+            cfg->off_ns = v;
+        } else if (strcmp(item, "channel") == 0) {
+            cfg->channel = (uint32_t)v;
+        } else if (strcmp(item, "mask") == 0) {
+            cfg->value_mask = (uint32_t)v;
+        } else if (strcmp(item, "payload") == 0 && strcmp(value, "seq") == 0) {
+            cfg->payload = SIM_STIM_PAYLOAD_SEQ;
+        } else if (strcmp(item, "payload") == 0 && strcmp(value, "random") == 0) {
+            cfg->payload = SIM_STIM_PAYLOAD_RANDOM;
+        } else if (strcmp(item, "path") == 0 && strlen(value) < sizeof(cfg->path)) {
+            strcpy(cfg->path, value);
+        } else {
+            printf("[%s:%s] Bad stimulus parameter %s=%s\n", __FILE__, __func__, item, value);
+            return -1;
+        }
+    }
+    if (cfg->kind == SIM_STIM_BURST && cfg->on_ns == 0) {
+        cfg->on_ns = 10 * cfg->interval_ns;
+        cfg->off_ns = cfg->off_ns ? cfg->off_ns : cfg->on_ns;
+    }
+    return 0;
+}
+
+int sim_stim_add(const sim_stim_config_t *cfg) {
+    if (g_gen_count >= SIM_STIM_MAX || cfg->kind >= SIM_STIM_KIND_COUNT) {
+        return -1;
+    }
+    if (cfg->kind != SIM_STIM_FILE && cfg->interval_ns == 0) {
+        printf("[%s:%s] %s %s stimulus needs a nonzero interval\n", __FILE__, __func__,
+               cfg->module, g_kind_names[cfg->kind]);
+        return -1;
+    }
+
+    stim_gen_t *g = &g_gens[g_gen_count];
+    memset(g, 0, sizeof(*g));
+    g->cfg = *cfg;
+    g->cfg.module[sizeof(g->cfg.module) - 1] = '\0';
+    if (g->cfg.value_mask == 0) {
+        g->cfg.value_mask = 0xFF;
+    }
+    if (cfg->kind == SIM_STIM_FILE && stim_load_file(g) != 0) {
+        free(g->events);
+        g->events = NULL;
+        return -1;
+    }
+    g->rng = cfg->seed;
+    g->payload_rng = cfg->seed ^ 0x5DEECE66DULL;
+    strcpy(g->stats.module, g->cfg.module);
+    g->stats.kind = cfg->kind;
+
+    // 第一个事件：开始时刻之后的一个间隔（file为第一行的间隔）
+    uint64_t start = cfg->start_ns > sim_vtime_now() ? cfg->start_ns : sim_vtime_now();
+    g->burst_end_ns = start + cfg->on_ns;
+    g->next_ns = stim_schedule(g, start);
+    g->stats.done = g->next_ns == SIM_STIM_NEVER;
+
+    stim_lock();
+    g_gen_count++;
+    stim_update_due();
+    stim_unlock();
+
+    printf("[%s:%s] %s %s stimulus on channel %u: interval %llu ns, seed %llu, %s payload\n",
+           __FILE__, __func__, g->cfg.module, g_kind_names[cfg->kind], cfg->channel,
+           (unsigned long long)cfg->interval_ns, (unsigned long long)cfg->seed,
+           cfg->kind == SIM_STIM_FILE ? "file" : (cfg->payload == SIM_STIM_PAYLOAD_RANDOM ? "random" : "seq"));
+    return 0;
+}
+
+void sim_stim_poll(uint64_t vtime_ns) {
+    if (vtime_ns < __atomic_load_n(&g_next_due, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    if (__atomic_exchange_n(&g_busy, 1, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    for (int i = 0; i < g_gen_count; i++) {
+        stim_gen_t *g = &g_gens[i];
+        for (int n = 0; n < SIM_STIM_MAX_PER_POLL && g->next_ns <= vtime_ns; n++) {
+            uint64_t late = vtime_ns - g->next_ns;
+            if (sim_device_input(g->cfg.module, g->cfg.channel, stim_payload(g)) == 0) {
+                g->stats.injected++;
+            } else {
+                g->stats.rejected++;
+            }
+            if (late > g->stats.max_late_ns) {
+                g->stats.max_late_ns = late;
+            }
+            g->stats.last_vtime = vtime_ns;
+            g->seq++;
+            g->next_ns = stim_schedule(g, g->next_ns);
+            g->stats.done = g->next_ns == SIM_STIM_NEVER;
+        }
+    }
+
+    stim_update_due();
+    stim_unlock();
+}
+
+int sim_stim_stats(sim_stim_stats_t *stats, int max) {
+    int count = 0;
+    stim_lock();
+    for (int i = 0; i < g_gen_count && count < max; i++) {
+        stats[count++] = g_gens[i].stats;
+    }
+    stim_unlock();
+    return count;
+}
+
+void sim_stim_report(void) {
+    sim_stim_stats_t stats[SIM_STIM_MAX];
+    int count = sim_stim_stats(stats, SIM_STIM_MAX);
+    for (int i = 0; i < count; i++) {
+        printf("[%s:%s] %s %s stimulus: %llu injected, %llu rejected, last at vtime %llu, max %llu ns late%s\n",
+               __FILE__, __func__, stats[i].module, g_kind_names[stats[i].kind],
+               (unsigned long long)stats[i].injected, (unsigned long long)stats[i].rejected,
+               (unsigned long long)stats[i].last_vtime, (unsigned long long)stats[i].max_late_ns,
+               stats[i].done ? ", done" : "");
+    }
+}
+
+void sim_stim_clear(void) {
+    stim_lock();
+    for (int i = 0; i < g_gen_count; i++) {
+        free(g_gens[i].events);
+        g_gens[i].events = NULL;
+    }
+    g_gen_count = 0;
+    __atomic_store_n(&g_next_due, SIM_STIM_NEVER, __ATOMIC_RELEASE);
+    stim_unlock();
+}
+
+const char* sim_stim_kind_name(sim_stim_kind_t kind) {
+    return kind < SIM_STIM_KIND_COUNT ? g_kind_names[kind] : "?";
+}
@@ -0,0 +1,85 @@
+#ifndef SIM_STIMULUS_H
+#define SIM_STIMULUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 激励发生器 - 按虚拟时间向设备的外部输入通道注入数据（UART RX线上的字节等）
+//
+// 到达过程：
+//   const    固定间隔
+//   poisson  泊松到达，间隔服从均值为interval的指数分布
+//   burst    开/关突发：开启on纳秒内按固定间隔到达，随后静默off纳秒
+//   file     从文本文件回放，每行"间隔纳秒 值"，'#'开头为注释
+// 负载：seq为递增序号（接收方据此发现丢失），random为随机字节
+//
+// 每个发生器有自己的种子，同一种子、同一配置产生完全相同的到达时刻和负载。
+// 调度按虚拟时间：陷入路径推进虚拟时间后调用sim_stim_poll，到期的事件经
+// sim_device_input注入，记录时与其他外部输入一样写入日志；回放时输入由日志提供。
+// 虚拟时间只随陷入推进，驱动不访问外设时事件顺延到下一次陷入（统计最大延迟）。
+
+#define SIM_STIM_MAX                8
+#define SIM_STIM_MAX_FILE_EVENTS    65536
+#define SIM_STIM_MAX_PER_POLL       64      // 单次陷入最多注入的事件数，其余留到下一次
+
+typedef enum {
+    SIM_STIM_CONST = 0,
+    SIM_STIM_POISSON,
+    SIM_STIM_BURST,
+    SIM_STIM_FILE,
+    SIM_STIM_KIND_COUNT
+} sim_stim_kind_t;
+
+typedef enum {
+    SIM_STIM_PAYLOAD_SEQ = 0,
+    SIM_STIM_PAYLOAD_RANDOM
+} sim_stim_payload_t;
+
+typedef struct {
+    sim_stim_kind_t kind;
+    char module[32];
+    uint32_t channel;           // 设备输入通道（UART为0：RX）
+    uint64_t seed;
+    uint64_t interval_ns;       // 平均到达间隔（burst为开启期内的间隔）
+    uint64_t on_ns;             // burst：开启时长
+    uint64_t off_ns;            // burst：静默时长
+    uint64_t start_ns;          // 第一个事件不早于此虚拟时间
+    uint64_t count;             // 事件总数上限，0表示不限（file为文件中的事件数）
+    sim_stim_payload_t payload;
+    uint32_t value_mask;        // 负载掩码，UART为0xFF
+    char path[256];             // file
+} sim_stim_config_t;
+
+typedef struct {
+    char module[32];
+    sim_stim_kind_t kind;
+    uint64_t injected;          // 已注入的事件数
+    uint64_t rejected;          // 设备不接受的事件数
+    uint64_t last_vtime;        // 最后一次注入时的虚拟时间
+    uint64_t max_late_ns;       // 注入时刻晚于计划时刻的最大值
+    bool done;                  // 已达到count或文件结束
+} sim_stim_stats_t;
+
+// 解析命令行描述 "模块:类型[:键=值,...]"，键为rate（每秒事件数）、interval（纳秒）、
+// baud（按10位一帧换算间隔）、seed、count、start、on、off、channel、payload（seq|random）、
+// mask、path；未给出的项取默认值
+int sim_stim_parse(const char *spec, sim_stim_config_t *cfg);
+
+// 添加发生器，在驱动开始访问外设之前调用；file类型在此读入整个文件
+int sim_stim_add(const sim_stim_config_t *cfg);
+
+// 陷入路径：虚拟时间推进后调用，注入所有到期的事件；不分配内存，可在信号处理器中调用
+void sim_stim_poll(uint64_t vtime_ns);
+
+// 读取各发生器的统计，返回条目数
+int sim_stim_stats(sim_stim_stats_t *stats, int max);
+
+// 打印各发生器的统计
+void sim_stim_report(void);
+
+// 移除所有发生器
+void sim_stim_clear(void);
+
+const char* sim_stim_kind_name(sim_stim_kind_t kind);
+
+#endif // SIM_STIMULUS_H
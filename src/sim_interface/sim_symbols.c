@@ -0,0 +1,159 @@
+#define _GNU_SOURCE
+
+#include "sim_symbols.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dlfcn.h>
+#include <elf.h>
+
+// 回溯线程的栈范围
+static __thread uintptr_t t_stack_lo = 0;
+static __thread uintptr_t t_stack_hi = 0;
+
+// 记录调用线程的栈范围
+int sim_stack_bounds_init(void) {
+    pthread_attr_t attr;
+    void *addr = NULL;
+    size_t size = 0;
+
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return -1;
+    }
+    pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+
+    t_stack_lo = (uintptr_t)addr;
+    t_stack_hi = (uintptr_t)addr + size;
+    return 0;
+}
+
+// 沿帧指针链回溯：每一帧的[rbp]是上一帧的rbp，[rbp+8]是返回地址
+int sim_stack_walk(const ucontext_t *uc, uintptr_t *pcs, int max) {
+    int depth = 0;
+
+    if (max <= 0) {
+        return 0;
+    }
+    pcs[depth++] = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+
+    uintptr_t fp = (uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+    while (depth < max) {
+        // 帧指针必须在栈内、对齐，并且向栈底单调增长，否则链已断开（省略帧指针的代码）
+        if (fp < t_stack_lo || fp + 2 * sizeof(uintptr_t) > t_stack_hi || (fp & (sizeof(uintptr_t) - 1))) {
+            break;
+        }
+        const uintptr_t *frame = (const uintptr_t *)fp;
+        uintptr_t ret = frame[1];
+        uintptr_t next = frame[0];
+        if (ret == 0) {
+            break;
+        }
+        pcs[depth++] = ret;
+        if (next <= fp) {
+            break;
+        }
+        fp = next;
+    }
+    return depth;
+}
+
+static const char* path_basename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// 用addr2line从DWARF行号信息符号化主程序中的地址，offsets为相对加载基址的偏移
+static void symbolize_dwarf(const char *object, const uintptr_t *offsets, const size_t *index,
+                            size_t count, sim_symbol_t *symbols) {
+    char list_path[] = "/tmp/ic_sim_symbolsXXXXXX";
+    char command[512];
+    char function[256];
+    char location[512];
+
+    int fd = mkstemp(list_path);
+    if (fd < 0) {
+        return;
+    }
+    FILE *list = fdopen(fd, "w");
+    if (!list) {
+        close(fd);
+        unlink(list_path);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        fprintf(list, "0x%lx\n", (unsigned long)offsets[i]);
+    }
+    fclose(list);
+
+    snprintf(command, sizeof(command), "addr2line -f -e '%s' < '%s' 2>/dev/null", object, list_path);
+    FILE *out = popen(command, "r");
+    if (out) {
+        for (size_t i = 0; i < count; i++) {
+            if (!fgets(function, sizeof(function), out) || !fgets(location, sizeof(location), out)) {
+                break;
+            }
+            function[strcspn(function, "\n")] = '\0';
+            location[strcspn(location, "\n (")] = '\0';
+
+            sim_symbol_t *sym = &symbols[index[i]];
+            if (strcmp(function, "??") != 0) {
+                snprintf(sym->function, sizeof(sym->function), "%.63s", function);
+            }
+            if (strncmp(location, "??", 2) != 0) {
+                snprintf(sym->location, sizeof(sym->location), "%.95s", path_basename(location));
+            }
+        }
+        pclose(out);
+    }
+    unlink(list_path);
+}
+
+// 批量符号化
+void sim_symbolize(const uintptr_t *pcs, size_t count, sim_symbol_t *symbols) {
+    Dl_info self;
+    bool have_self = dladdr((void *)sim_symbolize, &self) != 0;
+    uintptr_t *offsets = malloc(count * sizeof(*offsets));
+    size_t *index = malloc(count * sizeof(*index));
+    size_t dwarf_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        Dl_info info;
+        sim_symbol_t *sym = &symbols[i];
+
+        snprintf(sym->function, sizeof(sym->function), "0x%lx", (unsigned long)pcs[i]);
+        snprintf(sym->location, sizeof(sym->location), "??");
+        if (!dladdr((void *)pcs[i], &info) || !info.dli_fname) {
+            continue;
+        }
+        // 未导出的函数（如libc内部）只能给出所在的库
+        if (info.dli_sname) {
+            snprintf(sym->function, sizeof(sym->function), "%s", info.dli_sname);
+        } else {
+            snprintf(sym->function, sizeof(sym->function), "[%s]", path_basename(info.dli_fname));
+        }
+        uintptr_t offset = pcs[i] - (uintptr_t)info.dli_fbase;
+        snprintf(sym->location, sizeof(sym->location), "%s+0x%lx",
+                 path_basename(info.dli_fname), (unsigned long)offset);
+
+        // 主程序的地址交给addr2line：位置无关可执行文件按偏移查询，否则按绝对地址
+        if (have_self && offsets && index && info.dli_fbase == self.dli_fbase) {
+            const Elf64_Ehdr *ehdr = (const Elf64_Ehdr *)info.dli_fbase;
+            offsets[dwarf_count] = ehdr->e_type == ET_DYN ? offset : pcs[i];
+            index[dwarf_count++] = i;
+        }
+    }
+
+    // 主程序的dli_fname可能为空或是相对路径，按/proc/self/exe解析出实际文件
+    char exe[256];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (dwarf_count > 0 && len > 0) {
+        exe[len] = '\0';
+        symbolize_dwarf(exe, offsets, index, dwarf_count, symbols);
+    }
+    free(offsets);
+    free(index);
+}
@@ -0,0 +1,32 @@
+#ifndef SIM_SYMBOLS_H
+#define SIM_SYMBOLS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ucontext.h>
+
+// 驱动代码的调用栈回溯和符号化（剖析器使用）
+//
+// 回溯沿帧指针链进行，只在陷入/中断的信号上下文中调用，不分配内存；
+// 要求驱动代码保留帧指针（-O0或-fno-omit-frame-pointer），链上地址越出
+// 线程栈范围时停止，不会在信号处理器里再次触发段错误。
+// 符号化在退出时批量进行：dladdr给出函数名（主程序需以-rdynamic链接），
+// 有addr2line时再从DWARF行号信息得到静态函数名和源文件行号。
+
+#define SIM_STACK_MAX_DEPTH  16
+
+typedef struct {
+    char function[64];
+    char location[96];          // "file.c:123"，无行号信息时为"模块+偏移"
+} sim_symbol_t;
+
+// 记录调用线程的栈范围，之后该线程上的sim_stack_walk才会回溯调用者
+int sim_stack_bounds_init(void);
+
+// 回溯信号上下文的调用栈：pcs[0]为被打断的指令地址，其后为返回地址（由近及远）
+int sim_stack_walk(const ucontext_t *uc, uintptr_t *pcs, int max);
+
+// 批量符号化；返回地址应先减1，得到调用指令所在的行
+void sim_symbolize(const uintptr_t *pcs, size_t count, sim_symbol_t *symbols);
+
+#endif // SIM_SYMBOLS_H
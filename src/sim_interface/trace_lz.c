@@ -0,0 +1,153 @@
+#include "trace_lz.h"
+#include <string.h>
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t lz_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - TRACE_LZ_HASH_BITS);
+}
+
+// 写长度扩展字节：n为扣除令牌中15之后的剩余值
+static int put_length(uint8_t *dst, size_t *o, size_t cap, size_t n) {
+    while (n >= 255) {
+        if (*o >= cap) {
+            return -1;
+        }
+        dst[(*o)++] = 255;
+        n -= 255;
+    }
+    if (*o >= cap) {
+        return -1;
+    }
+    dst[(*o)++] = (uint8_t)n;
+    return 0;
+}
+
+// 输出一个序列；match_len为0表示最后的纯字面量序列
+static int put_sequence(uint8_t *dst, size_t *o, size_t cap, const uint8_t *lit, size_t lit_len,
+                        uint32_t offset, size_t match_len) {
+    size_t m = match_len ? match_len - TRACE_LZ_MIN_MATCH : 0;
+    if (*o >= cap) {
+        return -1;
+    }
+    dst[(*o)++] = (uint8_t)(((lit_len < 15 ? lit_len : 15) << 4) | (m < 15 ? m : 15));
+    if (lit_len >= 15 && put_length(dst, o, cap, lit_len - 15) != 0) {
+        return -1;
+    }
+    if (*o + lit_len > cap) {
+        return -1;
+    }
+    memcpy(dst + *o, lit, lit_len);
+    *o += lit_len;
+    if (!match_len) {
+        return 0;
+    }
+    if (*o + 2 > cap) {
+        return -1;
+    }
+    dst[(*o)++] = (uint8_t)offset;
+    dst[(*o)++] = (uint8_t)(offset >> 8);
+    if (m >= 15 && put_length(dst, o, cap, m - 15) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+size_t trace_lz_compress(trace_lz_state_t *state, const uint8_t *src, size_t len,
+                         uint8_t *dst, size_t cap) {
+    size_t o = 0;
+    size_t anchor = 0;
+    size_t i = 0;
+
+    memset(state->table, 0xFF, sizeof(state->table));
+    if (len >= TRACE_LZ_MIN_MATCH) {
+        size_t limit = len - TRACE_LZ_MIN_MATCH;
+        while (i <= limit) {
+            uint32_t seq = read32(src + i);
+            uint32_t h = lz_hash(seq);
+            uint32_t candidate = state->table[h];
+            state->table[h] = (uint32_t)i;
+
+            if (candidate != UINT32_MAX && i - candidate <= TRACE_LZ_MAX_OFFSET &&
+                read32(src + candidate) == seq) {
+                size_t match = TRACE_LZ_MIN_MATCH;
+                while (i + match < len && src[candidate + match] == src[i + match]) {
+                    match++;
+                }
+                if (put_sequence(dst, &o, cap, src + anchor, i - anchor,
+                                 (uint32_t)(i - candidate), match) != 0) {
+                    return 0;
+                }
+                i += match;
+                anchor = i;
+                continue;
+            }
+            // 长时间没有匹配时加大步长，不可压缩数据不拖慢记录
+            i += 1 + ((i - anchor) >> 6);
+        }
+    }
+    if (put_sequence(dst, &o, cap, src + anchor, len - anchor, 0, 0) != 0) {
+        return 0;
+    }
+    return o;
+}
+
+// 读长度扩展字节
+static int get_length(const uint8_t *src, size_t len, size_t *i, size_t *n) {
+    uint8_t b;
+    do {
+        if (*i >= len) {
+            return -1;
+        }
+        b = src[(*i)++];
+        *n += b;
+    } while (b == 255);
+    return 0;
+}
+
+long trace_lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < len) {
+        uint8_t token = src[i++];
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && get_length(src, len, &i, &lit_len) != 0) {
+            return -1;
+        }
+        if (lit_len > len - i || lit_len > cap - o) {
+            return -1;
+        }
+        memcpy(dst + o, src + i, lit_len);
+        i += lit_len;
+        o += lit_len;
+        if (i == len) {
+            break;          // 最后的纯字面量序列
+        }
+
+        if (i + 2 > len) {
+            return -1;
+        }
+        size_t offset = (size_t)src[i] | ((size_t)src[i + 1] << 8);
+        i += 2;
+        size_t match = token & 0x0F;
+        if (match == 15 && get_length(src, len, &i, &match) != 0) {
+            return -1;
+        }
+        match += TRACE_LZ_MIN_MATCH;
+        if (offset == 0 || offset > o || match > cap - o) {
+            return -1;
+        }
+        // 偏移可能小于长度（重复模式），逐字节复制
+        const uint8_t *from = dst + o - offset;
+        for (size_t k = 0; k < match; k++) {
+            dst[o + k] = from[k];
+        }
+        o += match;
+    }
+    return (long)o;
+}
@@ -0,0 +1,35 @@
+#ifndef TRACE_LZ_H
+#define TRACE_LZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 内置的LZ块压缩（LZ4风格序列，无外部依赖），用于记录日志的分块压缩
+//
+//   序列 = 令牌字节(高4位字面量长度，低4位匹配长度-4)
+//          + 字面量长度扩展(值为15时续接255...的字节) + 字面量
+//          + 回溯偏移(u16 LE) + 匹配长度扩展
+//   最后一个序列只有字面量，没有偏移。
+//
+// 每块独立压缩，解压不依赖其他块，记录文件可以从任一块开始读取。
+
+#define TRACE_LZ_HASH_BITS  12
+#define TRACE_LZ_MIN_MATCH  4
+#define TRACE_LZ_MAX_OFFSET 65535u
+
+// 压缩输出的上界：不可压缩数据每255字节字面量多一个长度字节
+#define TRACE_LZ_BOUND(len) ((len) + (len) / 255 + 16)
+
+// 压缩状态（哈希表），由调用方提供，压缩时不分配内存
+typedef struct {
+    uint32_t table[1u << TRACE_LZ_HASH_BITS];
+} trace_lz_state_t;
+
+// 压缩src到dst，返回压缩后的字节数；cap不足时返回0
+size_t trace_lz_compress(trace_lz_state_t *state, const uint8_t *src, size_t len,
+                         uint8_t *dst, size_t cap);
+
+// 解压src到dst，返回解压后的字节数；数据损坏或cap不足时返回-1
+long trace_lz_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+#endif // TRACE_LZ_H
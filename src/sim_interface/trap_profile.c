@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+
+#include "trap_profile.h"
+#include "sim_symbols.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRAP_PROFILE_TOP  20     // 退出时打印的访问点数（报告文件包含全部）
+
+typedef struct {
+    uintptr_t rip;
+    uint64_t traps;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t handling_ns;
+    char module[16];
+} trap_site_t;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t traps;
+    uint32_t depth;
+    char module[16];
+    uintptr_t pcs[SIM_STACK_MAX_DEPTH];
+} trap_stack_t;
+
+// 哈希表只由驱动线程（段错误处理器）写入，退出时在同一线程上读取
+static trap_site_t g_sites[TRAP_PROFILE_MAX_SITES];
+static trap_stack_t g_stacks[TRAP_PROFILE_MAX_STACKS];
+static uint64_t g_total_traps = 0;
+static uint64_t g_site_overflow = 0;
+static uint64_t g_stack_overflow = 0;
+static char g_report_path[256];
+static __thread bool t_active = false;
+
+static uint64_t hash_pcs(const uintptr_t *pcs, int depth) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int i = 0; i < depth; i++) {
+        h = (h ^ (uint64_t)pcs[i]) * 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+// 开始剖析
+int trap_profile_start(const char *report_path) {
+    memset(g_sites, 0, sizeof(g_sites));
+    memset(g_stacks, 0, sizeof(g_stacks));
+    g_total_traps = 0;
+    g_site_overflow = 0;
+    g_stack_overflow = 0;
+    snprintf(g_report_path, sizeof(g_report_path), "%s", report_path);
+
+    if (sim_stack_bounds_init() != 0) {
+        printf("[%s:%s] Warning: stack bounds unavailable, call stacks disabled\n", __FILE__, __func__);
+    }
+    t_active = true;
+    printf("[%s:%s] Trap access-site profiling enabled, report: %s\n", __FILE__, __func__, g_report_path);
+    return 0;
+}
+
+bool trap_profile_active(void) {
+    return t_active;
+}
+
+// 记录一次陷入：按RIP和按调用栈分别累计
+void trap_profile_record(const ucontext_t *uc, const char *module, bool is_write, uint64_t handling_ns) {
+    uintptr_t pcs[SIM_STACK_MAX_DEPTH];
+
+    if (!t_active) {
+        return;
+    }
+    g_total_traps++;
+
+    int depth = sim_stack_walk(uc, pcs, SIM_STACK_MAX_DEPTH);
+    uintptr_t rip = pcs[0];
+
+    // 访问点：按RIP线性探测
+    size_t slot = (size_t)((rip >> 2) * 0x9E3779B97F4A7C15ULL) & (TRAP_PROFILE_MAX_SITES - 1);
+    trap_site_t *site = NULL;
+    for (size_t probe = 0; probe < TRAP_PROFILE_MAX_SITES; probe++) {
+        trap_site_t *s = &g_sites[(slot + probe) & (TRAP_PROFILE_MAX_SITES - 1)];
+        if (s->rip == rip || s->rip == 0) {
+            site = s;
+            break;
+        }
+    }
+    if (site) {
+        if (site->rip == 0) {
+            site->rip = rip;
+            strncpy(site->module, module, sizeof(site->module) - 1);
+        }
+        site->traps++;
+        if (is_write) {
+            site->writes++;
+        } else {
+            site->reads++;
+        }
+        site->handling_ns += handling_ns;
+    } else {
+        g_site_overflow++;
+    }
+
+    // 调用栈：按完整栈的哈希线性探测
+    uint64_t hash = hash_pcs(pcs, depth);
+    trap_stack_t *stack = NULL;
+    for (size_t probe = 0; probe < TRAP_PROFILE_MAX_STACKS; probe++) {
+        trap_stack_t *s = &g_stacks[(hash + probe) & (TRAP_PROFILE_MAX_STACKS - 1)];
+        if (s->hash == 0 ||
+            (s->hash == hash && s->depth == (uint32_t)depth && memcmp(s->pcs, pcs, (size_t)depth * sizeof(pcs[0])) == 0)) {
+            stack = s;
+            break;
+        }
+    }
+    if (stack) {
+        if (stack->hash == 0) {
+            stack->hash = hash;
+            stack->depth = (uint32_t)depth;
+            memcpy(stack->pcs, pcs, (size_t)depth * sizeof(pcs[0]));
+            strncpy(stack->module, module, sizeof(stack->module) - 1);
+        }
+        stack->traps++;
+    } else {
+        g_stack_overflow++;
+    }
+}
+
+static int compare_sites(const void *a, const void *b) {
+    const trap_site_t *sa = (const trap_site_t *)a;
+    const trap_site_t *sb = (const trap_site_t *)b;
+    if (sa->traps != sb->traps) {
+        return sa->traps < sb->traps ? 1 : -1;
+    }
+    return sa->rip < sb->rip ? -1 : sa->rip > sb->rip;
+}
+
+static int compare_pcs(const void *a, const void *b) {
+    uintptr_t pa = *(const uintptr_t *)a;
+    uintptr_t pb = *(const uintptr_t *)b;
+    return pa < pb ? -1 : pa > pb;
+}
+
+// 在已排序去重的地址表中查找符号
+static const sim_symbol_t* lookup_symbol(const uintptr_t *pcs, const sim_symbol_t *symbols, size_t count, uintptr_t pc) {
+    const uintptr_t *found = bsearch(&pc, pcs, count, sizeof(pcs[0]), compare_pcs);
+    return found ? &symbols[found - pcs] : NULL;
+}
+
+// 打印或写入一个访问点
+static void print_site(FILE *fp, int rank, const trap_site_t *site, const sim_symbol_t *sym) {
+    fprintf(fp, "%4d %10llu %6.2f%% %9llu %9llu %8.0f  %-8s %-28s %-24s 0x%lx\n", rank,
+            (unsigned long long)site->traps, 100.0 * (double)site->traps / (double)g_total_traps,
+            (unsigned long long)site->reads, (unsigned long long)site->writes,
+            (double)site->handling_ns / (double)site->traps, site->module,
+            sym ? sym->function : "?", sym ? sym->location : "?", (unsigned long)site->rip);
+}
+
+// 停止剖析并输出报告
+void trap_profile_stop(void) {
+    if (!t_active) {
+        return;
+    }
+    t_active = false;
+
+    // 收集访问点和栈帧地址（返回地址减1，落在调用指令上），排序去重后一次符号化
+    size_t site_count = 0;
+    size_t pc_count = 0;
+    for (size_t i = 0; i < TRAP_PROFILE_MAX_SITES; i++) {
+        if (g_sites[i].rip) {
+            g_sites[site_count++] = g_sites[i];
+        }
+    }
+    for (size_t i = site_count; i < TRAP_PROFILE_MAX_SITES; i++) {
+        g_sites[i].rip = 0;
+    }
+    size_t max_pcs = site_count + (size_t)TRAP_PROFILE_MAX_STACKS * SIM_STACK_MAX_DEPTH;
+    uintptr_t *pcs = malloc(max_pcs * sizeof(*pcs));
+    if (!pcs) {
+        return;
+    }
+    for (size_t i = 0; i < site_count; i++) {
+        pcs[pc_count++] = g_sites[i].rip;
+    }
+    for (size_t i = 0; i < TRAP_PROFILE_MAX_STACKS; i++) {
+        for (uint32_t d = 0; g_stacks[i].hash && d < g_stacks[i].depth; d++) {
+            pcs[pc_count++] = d == 0 ? g_stacks[i].pcs[0] : g_stacks[i].pcs[d] - 1;
+        }
+    }
+    qsort(pcs, pc_count, sizeof(pcs[0]), compare_pcs);
+    size_t unique = 0;
+    for (size_t i = 0; i < pc_count; i++) {
+        if (unique == 0 || pcs[unique - 1] != pcs[i]) {
+            pcs[unique++] = pcs[i];
+        }
+    }
+    sim_symbol_t *symbols = calloc(unique ? unique : 1, sizeof(*symbols));
+    if (!symbols) {
+        free(pcs);
+        return;
+    }
+    sim_symbolize(pcs, unique, symbols);
+
+    qsort(g_sites, site_count, sizeof(g_sites[0]), compare_sites);
+
+    // 排序报告：终端只打印前几名
+    const char *header = "rank      traps  share     reads    writes   avg_ns  module   function                     location                 rip\n";
+    printf("[%s:%s] %llu trapped accesses from %zu sites (%llu sites, %llu stacks dropped)\n", __FILE__, __func__,
+           (unsigned long long)g_total_traps, site_count,
+           (unsigned long long)g_site_overflow, (unsigned long long)g_stack_overflow);
+    printf("%s", header);
+    for (size_t i = 0; i < site_count && i < TRAP_PROFILE_TOP; i++) {
+        print_site(stdout, (int)i + 1, &g_sites[i], lookup_symbol(pcs, symbols, unique, g_sites[i].rip));
+    }
+
+    FILE *fp = fopen(g_report_path, "w");
+    if (fp) {
+        fprintf(fp, "# %llu trapped accesses from %zu sites\n", (unsigned long long)g_total_traps, site_count);
+        fprintf(fp, "%s", header);
+        for (size_t i = 0; i < site_count; i++) {
+            print_site(fp, (int)i + 1, &g_sites[i], lookup_symbol(pcs, symbols, unique, g_sites[i].rip));
+        }
+        fclose(fp);
+    } else {
+        perror("fopen");
+    }
+
+    // 折叠栈：由外向内，叶子帧为触发陷入的函数，再附上被访问的设备
+    char folded_path[300];
+    snprintf(folded_path, sizeof(folded_path), "%s.folded", g_report_path);
+    fp = fopen(folded_path, "w");
+    if (fp) {
+        for (size_t i = 0; i < TRAP_PROFILE_MAX_STACKS; i++) {
+            const trap_stack_t *stack = &g_stacks[i];
+            if (!stack->hash) {
+                continue;
+            }
+            for (int d = (int)stack->depth - 1; d >= 0; d--) {
+                uintptr_t pc = d == 0 ? stack->pcs[0] : stack->pcs[d] - 1;
+                const sim_symbol_t *sym = lookup_symbol(pcs, symbols, unique, pc);
+                fprintf(fp, "%s;", sym ? sym->function : "?");
+            }
+            fprintf(fp, "[%s] %llu\n", stack->module, (unsigned long long)stack->traps);
+        }
+        fclose(fp);
+    } else {
+        perror("fopen");
+    }
+    printf("[%s:%s] Trap profile written to %s and %s\n", __FILE__, __func__, g_report_path, folded_path);
+
+    free(symbols);
+    free(pcs);
+}
@@ -0,0 +1,32 @@
+#ifndef TRAP_PROFILE_H
+#define TRAP_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ucontext.h>
+
+// 访问点剖析器 - 按驱动中触发陷入的指令地址（RIP）统计寄存器访问
+//
+// 每次陷入按RIP累计次数、读/写次数和处理耗时，同时按完整调用栈累计次数；
+// 退出时符号化为驱动函数和源文件行号（见sim_symbols.h），输出：
+//   - 排序报告：访问点按陷入次数从多到少，含模块、函数、行号、平均处理耗时
+//   - 折叠栈文件（report_path.folded）：每行"调用者;...;被调用者 陷入次数"，
+//     可直接交给flamegraph.pl等火焰图工具
+// 记录只在启动剖析器的线程（驱动线程）上进行，表满后的访问点计入溢出计数。
+
+#define TRAP_PROFILE_MAX_SITES   1024
+#define TRAP_PROFILE_MAX_STACKS  4096
+
+// 开始剖析，需在驱动线程上调用
+int trap_profile_start(const char *report_path);
+
+// 是否在当前线程上剖析（陷入路径据此决定是否计时）
+bool trap_profile_active(void);
+
+// 记录一次陷入，在段错误处理器中调用
+void trap_profile_record(const ucontext_t *uc, const char *module, bool is_write, uint64_t handling_ns);
+
+// 停止剖析，打印排序报告并写入报告文件和折叠栈文件
+void trap_profile_stop(void);
+
+#endif // TRAP_PROFILE_H
@@ -0,0 +1,239 @@
+#define _GNU_SOURCE
+
+#include "vtime_profile.h"
+#include "sim_symbols.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VTIME_PROFILE_TOP        15      // 退出时打印的函数数
+#define VTIME_PROFILE_MAX_IRQ    8       // 中断嵌套深度
+
+typedef struct {
+    uint64_t hash;
+    uint64_t samples;
+    uint32_t depth;
+    char context[32];
+    uintptr_t pcs[SIM_STACK_MAX_DEPTH];
+} vtime_stack_t;
+
+// 样本表只由驱动线程（陷入和中断处理器）写入，退出时在同一线程上读取
+static vtime_stack_t g_stacks[VTIME_PROFILE_MAX_STACKS];
+static uint64_t g_interval_ns = VTIME_PROFILE_DEFAULT_INTERVAL_NS;
+static uint64_t g_next_sample_ns = 0;
+static uint64_t g_total_samples = 0;
+static uint64_t g_irq_samples = 0;
+static uint64_t g_dropped = 0;
+static char g_folded_path[256];
+static __thread bool t_active = false;
+
+// 当前中断上下文栈（ISR中可能再被其他中断打断）
+static char g_irq_context[VTIME_PROFILE_MAX_IRQ][32];
+static int g_irq_depth = 0;
+
+// 开始剖析
+int vtime_profile_start(const char *folded_path, uint64_t interval_ns) {
+    memset(g_stacks, 0, sizeof(g_stacks));
+    g_interval_ns = interval_ns ? interval_ns : VTIME_PROFILE_DEFAULT_INTERVAL_NS;
+    g_next_sample_ns = 0;
+    g_total_samples = 0;
+    g_irq_samples = 0;
+    g_dropped = 0;
+    g_irq_depth = 0;
+    snprintf(g_folded_path, sizeof(g_folded_path), "%s", folded_path);
+
+    if (sim_stack_bounds_init() != 0) {
+        printf("[%s:%s] Warning: stack bounds unavailable, call stacks disabled\n", __FILE__, __func__);
+    }
+    t_active = true;
+    printf("[%s:%s] Virtual-time sampling every %llu ns, folded stacks: %s\n", __FILE__, __func__,
+           (unsigned long long)g_interval_ns, g_folded_path);
+    return 0;
+}
+
+bool vtime_profile_active(void) {
+    return t_active;
+}
+
+void vtime_profile_irq_enter(const char *module, uint32_t irq_num) {
+    if (!t_active) {
+        return;
+    }
+    if (g_irq_depth < VTIME_PROFILE_MAX_IRQ) {
+        snprintf(g_irq_context[g_irq_depth], sizeof(g_irq_context[0]), "[irq %s:%u]", module, irq_num);
+    }
+    g_irq_depth++;
+}
+
+void vtime_profile_irq_exit(void) {
+    if (t_active && g_irq_depth > 0) {
+        g_irq_depth--;
+    }
+}
+
+static uint64_t hash_sample(const char *context, const uintptr_t *pcs, int depth) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const char *c = context; *c; c++) {
+        h = (h ^ (uint64_t)(unsigned char)*c) * 1099511628211ULL;
+    }
+    for (int i = 0; i < depth; i++) {
+        h = (h ^ (uint64_t)pcs[i]) * 1099511628211ULL;
+    }
+    return h ? h : 1;
+}
+
+// 虚拟时间越过采样点时记录调用栈，权重为越过的间隔数
+void vtime_profile_sample(const ucontext_t *uc, uint64_t vtime_ns) {
+    uintptr_t pcs[SIM_STACK_MAX_DEPTH];
+
+    if (!t_active || vtime_ns < g_next_sample_ns) {
+        return;
+    }
+    uint64_t weight = g_next_sample_ns ? (vtime_ns - g_next_sample_ns) / g_interval_ns + 1 : 1;
+    g_next_sample_ns = (vtime_ns / g_interval_ns + 1) * g_interval_ns;
+    g_total_samples += weight;
+
+    const char *context = "[thread]";
+    if (g_irq_depth > 0) {
+        int top = g_irq_depth <= VTIME_PROFILE_MAX_IRQ ? g_irq_depth - 1 : VTIME_PROFILE_MAX_IRQ - 1;
+        context = g_irq_context[top];
+        g_irq_samples += weight;
+    }
+
+    int depth = sim_stack_walk(uc, pcs, SIM_STACK_MAX_DEPTH);
+    uint64_t hash = hash_sample(context, pcs, depth);
+    for (size_t probe = 0; probe < VTIME_PROFILE_MAX_STACKS; probe++) {
+        vtime_stack_t *s = &g_stacks[(hash + probe) & (VTIME_PROFILE_MAX_STACKS - 1)];
+        if (s->hash == 0) {
+            s->hash = hash;
+            s->depth = (uint32_t)depth;
+            memcpy(s->pcs, pcs, (size_t)depth * sizeof(pcs[0]));
+            snprintf(s->context, sizeof(s->context), "%s", context);
+        } else if (s->hash != hash || s->depth != (uint32_t)depth || strcmp(s->context, context) != 0 ||
+                   memcmp(s->pcs, pcs, (size_t)depth * sizeof(pcs[0])) != 0) {
+            continue;
+        }
+        s->samples += weight;
+        return;
+    }
+    g_dropped += weight;
+}
+
+static int compare_pcs(const void *a, const void *b) {
+    uintptr_t pa = *(const uintptr_t *)a;
+    uintptr_t pb = *(const uintptr_t *)b;
+    return pa < pb ? -1 : pa > pb;
+}
+
+// 栈帧地址：叶子帧是被打断的指令，其余是返回地址（减1落在调用指令上）
+static uintptr_t frame_pc(const vtime_stack_t *stack, uint32_t d) {
+    return d == 0 ? stack->pcs[0] : stack->pcs[d] - 1;
+}
+
+static const sim_symbol_t* lookup_symbol(const uintptr_t *pcs, const sim_symbol_t *symbols, size_t count, uintptr_t pc) {
+    const uintptr_t *found = bsearch(&pc, pcs, count, sizeof(pcs[0]), compare_pcs);
+    return found ? &symbols[found - pcs] : NULL;
+}
+
+typedef struct {
+    const char *function;
+    uint64_t self;
+} function_samples_t;
+
+static int compare_functions(const void *a, const void *b) {
+    const function_samples_t *fa = (const function_samples_t *)a;
+    const function_samples_t *fb = (const function_samples_t *)b;
+    if (fa->self != fb->self) {
+        return fa->self < fb->self ? 1 : -1;
+    }
+    return strcmp(fa->function, fb->function);
+}
+
+// 停止剖析并输出
+void vtime_profile_stop(void) {
+    if (!t_active) {
+        return;
+    }
+    t_active = false;
+
+    // 收集所有栈帧地址，排序去重后一次符号化
+    size_t pc_count = 0;
+    uintptr_t *pcs = malloc((size_t)VTIME_PROFILE_MAX_STACKS * SIM_STACK_MAX_DEPTH * sizeof(*pcs));
+    function_samples_t *functions = calloc(VTIME_PROFILE_MAX_STACKS, sizeof(*functions));
+    if (!pcs || !functions) {
+        free(pcs);
+        free(functions);
+        return;
+    }
+    for (size_t i = 0; i < VTIME_PROFILE_MAX_STACKS; i++) {
+        for (uint32_t d = 0; g_stacks[i].hash && d < g_stacks[i].depth; d++) {
+            pcs[pc_count++] = frame_pc(&g_stacks[i], d);
+        }
+    }
+    qsort(pcs, pc_count, sizeof(pcs[0]), compare_pcs);
+    size_t unique = 0;
+    for (size_t i = 0; i < pc_count; i++) {
+        if (unique == 0 || pcs[unique - 1] != pcs[i]) {
+            pcs[unique++] = pcs[i];
+        }
+    }
+    sim_symbol_t *symbols = calloc(unique ? unique : 1, sizeof(*symbols));
+    if (!symbols) {
+        free(pcs);
+        free(functions);
+        return;
+    }
+    sim_symbolize(pcs, unique, symbols);
+
+    // 折叠栈：根帧为执行上下文，其后由外向内
+    FILE *fp = fopen(g_folded_path, "w");
+    size_t function_count = 0;
+    for (size_t i = 0; i < VTIME_PROFILE_MAX_STACKS; i++) {
+        const vtime_stack_t *stack = &g_stacks[i];
+        if (!stack->hash) {
+            continue;
+        }
+        if (fp) {
+            fprintf(fp, "%s", stack->context);
+            for (int d = (int)stack->depth - 1; d >= 0; d--) {
+                const sim_symbol_t *sym = lookup_symbol(pcs, symbols, unique, frame_pc(stack, (uint32_t)d));
+                fprintf(fp, ";%s", sym ? sym->function : "?");
+            }
+            fprintf(fp, " %llu\n", (unsigned long long)stack->samples);
+        }
+
+        // 自身样本按叶子函数汇总
+        const sim_symbol_t *leaf = stack->depth ? lookup_symbol(pcs, symbols, unique, stack->pcs[0]) : NULL;
+        const char *name = leaf ? leaf->function : "?";
+        size_t f = 0;
+        while (f < function_count && strcmp(functions[f].function, name) != 0) {
+            f++;
+        }
+        if (f == function_count) {
+            functions[function_count++].function = name;
+        }
+        functions[f].self += stack->samples;
+    }
+    if (fp) {
+        fclose(fp);
+    } else {
+        perror("fopen");
+    }
+
+    qsort(functions, function_count, sizeof(functions[0]), compare_functions);
+    printf("[%s:%s] %llu samples over %llu ns of virtual time (%llu in IRQ context, %llu dropped)\n",
+           __FILE__, __func__, (unsigned long long)g_total_samples,
+           (unsigned long long)(g_total_samples * g_interval_ns),
+           (unsigned long long)g_irq_samples, (unsigned long long)g_dropped);
+    printf("   self  share  function\n");
+    for (size_t f = 0; f < function_count && f < VTIME_PROFILE_TOP; f++) {
+        printf("%7llu %5.1f%%  %s\n", (unsigned long long)functions[f].self,
+               g_total_samples ? 100.0 * (double)functions[f].self / (double)g_total_samples : 0.0,
+               functions[f].function);
+    }
+    printf("[%s:%s] Folded stacks written to %s\n", __FILE__, __func__, g_folded_path);
+
+    free(functions);
+    free(symbols);
+    free(pcs);
+}
@@ -0,0 +1,35 @@
+#ifndef VTIME_PROFILE_H
+#define VTIME_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ucontext.h>
+
+// 虚拟时间采样剖析器 - 按仿真时钟而不是宿主CPU时间对驱动线程采样
+//
+// 虚拟时钟每越过一个采样间隔，就在当前陷入的信号上下文中记录驱动线程的
+// RIP和调用栈（见sim_symbols.h），越过多个间隔时按间隔数加权。栈的根帧标明
+// 执行上下文："[thread]"或"[irq 模块:中断号]"，中断中的样本归到对应ISR。
+// 结果反映仿真时序：宿主上慢的代码（如printf）不会多占样本，
+// 访问外设越多的代码在真实硬件上占用的时间越多。
+// 退出时打印自身样本最多的函数，并写出折叠栈文件供火焰图工具使用。
+
+#define VTIME_PROFILE_DEFAULT_INTERVAL_NS  1000ULL
+#define VTIME_PROFILE_MAX_STACKS           4096
+
+// 开始剖析，需在驱动线程上调用；interval_ns为0时使用默认间隔
+int vtime_profile_start(const char *folded_path, uint64_t interval_ns);
+
+bool vtime_profile_active(void);
+
+// 陷入路径：虚拟时间推进后调用，越过采样点时记录uc对应的调用栈
+void vtime_profile_sample(const ucontext_t *uc, uint64_t vtime_ns);
+
+// 中断信号处理器进入/退出ISR时调用，用于标记样本的执行上下文
+void vtime_profile_irq_enter(const char *module, uint32_t irq_num);
+void vtime_profile_irq_exit(void);
+
+// 停止剖析，打印自身样本最多的函数并写入折叠栈文件
+void vtime_profile_stop(void);
+
+#endif // VTIME_PROFILE_H
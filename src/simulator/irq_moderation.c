@@ -0,0 +1,206 @@
+// sem_timedwait/clock_gettime/pthread_sigmask需要POSIX声明
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "irq_moderation.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+// 事件路径（irq_mod_event）只用原子操作，不加锁：它在陷入的寄存器访问里被调用，
+// 而中断信号可能在任意线程上打断正在记录事件的代码并在ISR里再次访问寄存器。
+// 调节器链表只由登记/注销和定时线程访问，用互斥锁保护。
+static pthread_mutex_t g_mod_lock = PTHREAD_MUTEX_INITIALIZER;
+static irq_moderation_t *g_mod_list = NULL;
+static sem_t g_mod_wakeup;                // 有新的时间阈值开始计时（sem_post可在信号上下文中调用）
+static pthread_t g_mod_thread;
+static bool g_mod_thread_running = false;
+static bool g_mod_thread_stop = false;
+
+static uint64_t irq_mod_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 上报count个累积事件并计入统计
+static void irq_mod_flush(irq_moderation_t *mod, uint32_t count) {
+    bool delivered = mod->raise(mod->ctx);
+
+    if (delivered) {
+        __atomic_fetch_add(&mod->stats.raised, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&mod->stats.suppressed, count - 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_add(&mod->stats.suppressed, count, __ATOMIC_RELAXED);
+    }
+}
+
+// 开始时间阈值计时并唤醒定时线程
+static void irq_mod_arm(irq_moderation_t *mod, uint32_t time_us) {
+    __atomic_store_n(&mod->deadline_ns, irq_mod_now_ns() + (uint64_t)time_us * 1000ULL, __ATOMIC_RELEASE);
+    sem_post(&g_mod_wakeup);
+}
+
+// 定时线程：上报到期调节器的累积事件，然后睡到最近的截止时间
+static void* irq_mod_thread(void *arg) {
+    (void)arg;
+
+    // 中断信号不在本线程上执行ISR
+    sigset_t all;
+    sigfillset(&all);
+    sigdelset(&all, SIGSYS);    // hotpath-check经SIGSYS统计系统调用
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    for (;;) {
+        uint64_t now = irq_mod_now_ns();
+        uint64_t next = 0;
+
+        pthread_mutex_lock(&g_mod_lock);
+        if (g_mod_thread_stop) {
+            pthread_mutex_unlock(&g_mod_lock);
+            break;
+        }
+        for (irq_moderation_t *m = g_mod_list; m; m = m->next) {
+            uint64_t deadline = __atomic_load_n(&m->deadline_ns, __ATOMIC_ACQUIRE);
+            if (deadline == 0 || __atomic_load_n(&m->pending, __ATOMIC_ACQUIRE) == 0) {
+                continue;
+            }
+            if (deadline <= now) {
+                __atomic_store_n(&m->deadline_ns, 0, __ATOMIC_RELAXED);
+                uint32_t count = __atomic_exchange_n(&m->pending, 0, __ATOMIC_ACQ_REL);
+                if (count) {
+                    irq_mod_flush(m, count);
+                }
+            } else if (next == 0 || deadline < next) {
+                next = deadline;
+            }
+        }
+        pthread_mutex_unlock(&g_mod_lock);
+
+        if (next == 0) {
+            sem_wait(&g_mod_wakeup);
+        } else {
+            // sem_timedwait只接受CLOCK_REALTIME绝对时间
+            uint64_t wait_ns = next - now;
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += (time_t)(wait_ns / 1000000000ULL);
+            ts.tv_nsec += (long)(wait_ns % 1000000000ULL);
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            while (sem_timedwait(&g_mod_wakeup, &ts) != 0 && errno == EINTR) {
+            }
+        }
+    }
+    return NULL;
+}
+
+int irq_mod_init(irq_moderation_t *mod, const char *name, irq_mod_raise_t raise, void *ctx) {
+    memset(mod, 0, sizeof(*mod));
+    strncpy(mod->name, name, sizeof(mod->name) - 1);
+    mod->raise = raise;
+    mod->ctx = ctx;
+
+    pthread_mutex_lock(&g_mod_lock);
+    if (!g_mod_thread_running) {
+        sem_init(&g_mod_wakeup, 0, 0);
+        g_mod_thread_stop = false;
+        if (pthread_create(&g_mod_thread, NULL, irq_mod_thread, NULL) != 0) {
+            printf("[%s:%s] Failed to create IRQ moderation timer thread\n", __FILE__, __func__);
+            sem_destroy(&g_mod_wakeup);
+            pthread_mutex_unlock(&g_mod_lock);
+            return -1;
+        }
+        g_mod_thread_running = true;
+    }
+    mod->next = g_mod_list;
+    g_mod_list = mod;
+    pthread_mutex_unlock(&g_mod_lock);
+    return 0;
+}
+
+void irq_mod_destroy(irq_moderation_t *mod) {
+    bool stop_thread = false;
+
+    // 定时线程持锁上报，拿到锁后该调节器不会再被访问
+    pthread_mutex_lock(&g_mod_lock);
+    for (irq_moderation_t **pp = &g_mod_list; *pp; pp = &(*pp)->next) {
+        if (*pp == mod) {
+            *pp = mod->next;
+            break;
+        }
+    }
+    mod->next = NULL;
+    mod->pending = 0;
+    mod->deadline_ns = 0;
+    if (g_mod_list == NULL && g_mod_thread_running) {
+        g_mod_thread_stop = true;
+        g_mod_thread_running = false;
+        stop_thread = true;
+    }
+    pthread_mutex_unlock(&g_mod_lock);
+
+    if (stop_thread) {
+        sem_post(&g_mod_wakeup);
+        pthread_join(g_mod_thread, NULL);
+        sem_destroy(&g_mod_wakeup);
+    }
+}
+
+void irq_mod_configure(irq_moderation_t *mod, uint32_t count_threshold, uint32_t time_threshold_us) {
+    __atomic_store_n(&mod->count_threshold, count_threshold, __ATOMIC_RELEASE);
+    __atomic_store_n(&mod->time_threshold_us, time_threshold_us, __ATOMIC_RELEASE);
+
+    if (__atomic_load_n(&mod->pending, __ATOMIC_ACQUIRE) == 0) {
+        return;
+    }
+    if (count_threshold <= 1 && time_threshold_us == 0) {
+        // 切换为立即上报：不能让累积的事件悬空
+        uint32_t count = __atomic_exchange_n(&mod->pending, 0, __ATOMIC_ACQ_REL);
+        if (count) {
+            irq_mod_flush(mod, count);
+        }
+    } else if (time_threshold_us) {
+        irq_mod_arm(mod, time_threshold_us);
+    }
+}
+
+void irq_mod_event(irq_moderation_t *mod) {
+    uint32_t count_threshold = __atomic_load_n(&mod->count_threshold, __ATOMIC_ACQUIRE);
+    uint32_t time_us = __atomic_load_n(&mod->time_threshold_us, __ATOMIC_ACQUIRE);
+
+    __atomic_fetch_add(&mod->stats.events, 1, __ATOMIC_RELAXED);
+    uint32_t pending = __atomic_add_fetch(&mod->pending, 1, __ATOMIC_ACQ_REL);
+
+    if ((count_threshold == 0 && time_us == 0) ||
+        (count_threshold > 0 && pending >= count_threshold)) {
+        // 可能与定时线程同时取走，交换保证只有一方拿到非零计数
+        uint32_t count = __atomic_exchange_n(&mod->pending, 0, __ATOMIC_ACQ_REL);
+        if (count) {
+            irq_mod_flush(mod, count);
+        }
+    } else if (pending == 1 && time_us) {
+        // 第一个被推迟的事件开始计时
+        irq_mod_arm(mod, time_us);
+    }
+}
+
+void irq_mod_get_stats(irq_moderation_t *mod, irq_mod_stats_t *stats) {
+    stats->events = __atomic_load_n(&mod->stats.events, __ATOMIC_RELAXED);
+    stats->raised = __atomic_load_n(&mod->stats.raised, __ATOMIC_RELAXED);
+    stats->suppressed = __atomic_load_n(&mod->stats.suppressed, __ATOMIC_RELAXED);
+    stats->pending = __atomic_load_n(&mod->pending, __ATOMIC_RELAXED);
+}
+
+void irq_mod_reset_stats(irq_moderation_t *mod) {
+    __atomic_store_n(&mod->stats.events, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&mod->stats.raised, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&mod->stats.suppressed, 0, __ATOMIC_RELAXED);
+}
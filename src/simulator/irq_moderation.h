@@ -0,0 +1,59 @@
+#ifndef IRQ_MODERATION_H
+#define IRQ_MODERATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 中断调节（interrupt moderation）- 类似网卡的rx-frames/rx-usecs
+//
+// 每个中断源累积事件，满足任一条件时才真正上报一次中断：
+//   - 计数阈值：累积的事件数达到count_threshold
+//   - 时间阈值：距第一个未上报事件已过time_threshold_us微秒（由后台定时线程上报）
+// 两个阈值都为0（或计数阈值为1）时每个事件立即上报，与未调节时的行为一致。
+// 只设置计数阈值时，不足阈值的尾部事件要等下一批事件才会上报。
+
+// 上报回调：返回true表示确实发出了中断，false表示被设备自身合并
+typedef bool (*irq_mod_raise_t)(void *ctx);
+
+// 调节统计
+typedef struct {
+    uint64_t events;        // 中断事件总数
+    uint64_t raised;        // 实际发出的中断数
+    uint64_t suppressed;    // 被合并到其他中断中的事件数
+    uint32_t pending;       // 当前累积、尚未上报的事件数
+} irq_mod_stats_t;
+
+typedef struct irq_moderation {
+    char name[32];
+    irq_mod_raise_t raise;
+    void *ctx;
+
+    uint32_t count_threshold;
+    uint32_t time_threshold_us;
+
+    uint32_t pending;
+    uint64_t deadline_ns;         // 时间阈值到期时刻（CLOCK_MONOTONIC）
+    irq_mod_stats_t stats;
+
+    struct irq_moderation *next;  // 定时线程的调节器链表
+} irq_moderation_t;
+
+// 初始化并登记到定时线程（首个调节器登记时启动线程）
+int irq_mod_init(irq_moderation_t *mod, const char *name, irq_mod_raise_t raise, void *ctx);
+
+// 注销调节器，丢弃未上报的事件（最后一个调节器注销时停止线程）
+void irq_mod_destroy(irq_moderation_t *mod);
+
+// 设置阈值；改为立即上报时会先上报已累积的事件
+void irq_mod_configure(irq_moderation_t *mod, uint32_t count_threshold, uint32_t time_threshold_us);
+
+// 记录一个中断事件，按阈值决定是否立即上报
+void irq_mod_event(irq_moderation_t *mod);
+
+// 读取统计信息
+void irq_mod_get_stats(irq_moderation_t *mod, irq_mod_stats_t *stats);
+
+// 清零统计信息
+void irq_mod_reset_stats(irq_moderation_t *mod);
+
+#endif // IRQ_MODERATION_H
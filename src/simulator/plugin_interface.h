@@ -2,6 +2,46 @@
 #define SIMULATOR_PLUGIN_H
 
 #include "../common/protocol.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// 运行时观测条目（控制套接字显示的寄存器状态和队列深度）
+typedef enum {
+    PLUGIN_INSPECT_REG = 0,     // 寄存器：address为总线地址，value为当前值
+    PLUGIN_INSPECT_QUEUE        // 队列：value为当前深度，capacity为容量
+} plugin_inspect_kind_t;
+
+typedef struct {
+    plugin_inspect_kind_t kind;
+    char name[24];
+    uint32_t address;
+    uint32_t value;
+    uint32_t capacity;
+} plugin_inspect_item_t;
+
+// 追加一个观测条目，items已满时忽略（供各插件的inspect使用，定义在plugin_manager.c）
+void plugin_inspect_add(plugin_inspect_item_t *items, int max, int *count, plugin_inspect_kind_t kind,
+                        const char *name, uint32_t address, uint32_t value, uint32_t capacity);
+
+// 总线主设备（DMA等）访问系统内存和外设寄存器的入口
+// map返回[addr, addr+len)的宿主指针（不是内存区域时返回NULL，改走read/write），
+// 用完后必须以相同参数调用unmap；write表示将写入该区域
+typedef struct plugin_bus_ops {
+    void *ctx;
+    void* (*map)(void *ctx, uint32_t addr, uint32_t len, bool write);
+    void (*unmap)(void *ctx, void *ptr, uint32_t addr, uint32_t len, bool write);
+    int (*read)(void *ctx, uint32_t addr, uint32_t *value);
+    int (*write)(void *ctx, uint32_t addr, uint32_t value);
+} plugin_bus_ops_t;
+
+// 虚拟时间和虚拟时间定时器的入口（语义同sim_vtime_now/sim_vtimer_*）
+typedef struct plugin_vtime_ops {
+    void *ctx;
+    uint64_t (*now)(void *ctx);
+    int (*timer_create)(void *ctx, void (*fn)(void *fn_ctx, uint64_t vtime_ns), void *fn_ctx);
+    void (*timer_arm)(void *ctx, int id, uint64_t deadline_ns);
+    void (*timer_destroy)(void *ctx, int id);
+} plugin_vtime_ops_t;
 
 // 插件接口定义
 typedef struct simulator_plugin {
@@ -14,10 +54,28 @@ typedef struct simulator_plugin {
     int (*reg_write)(struct simulator_plugin *plugin, uint32_t address, uint32_t value);
     int (*interrupt)(struct simulator_plugin *plugin, uint32_t irq_num);
     
+    // 可选：芯片外部输入（如UART RX线上到达的字节），经sim_device_input分发
+    int (*input)(struct simulator_plugin *plugin, uint32_t channel, uint32_t value);
+    
     // 插件初始化和清理
     int (*init)(struct simulator_plugin *plugin);
     void (*cleanup)(struct simulator_plugin *plugin);
     
+    // 可选：设备状态保存/恢复（记录回放的快照）
+    // save_state返回状态字节数，空间不足时返回0；load_state在设备空闲时调用
+    size_t (*save_state)(struct simulator_plugin *plugin, void *buf, size_t size);
+    int (*load_state)(struct simulator_plugin *plugin, const void *buf, size_t size);
+    
+    // 可选：运行时观测，由控制线程在设备运行时调用
+    // 只读取状态（不得像读DR那样有副作用），不加锁，返回写入的条目数
+    int (*inspect)(struct simulator_plugin *plugin, plugin_inspect_item_t *items, int max);
+    
+    // 可选：总线入口，在init之前设置（锁步候选实现等）；NULL时使用仿真器的全局总线
+    const plugin_bus_ops_t *bus;
+    
+    // 可选：虚拟时间入口，在init之前设置（锁步插件等）；NULL时使用仿真器的虚拟时间和定时器
+    const plugin_vtime_ops_t *vtime;
+    
     // 私有数据
     void *private_data;
 } simulator_plugin_t;
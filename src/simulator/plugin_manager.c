@@ -1,4 +1,5 @@
 #include "plugin_interface.h"
+#include "../sim_interface/sim_hotpath.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,6 +52,34 @@ simulator_plugin_t* find_plugin(const char *name) {
     return NULL;
 }
 
+// 已注册插件数量
+int get_plugin_count(void) {
+    return g_plugin_manager.plugin_count;
+}
+
+// 按注册顺序取插件
+simulator_plugin_t* get_plugin_at(int index) {
+    if (index < 0 || index >= g_plugin_manager.plugin_count) {
+        return NULL;
+    }
+    return g_plugin_manager.plugins[index];
+}
+
+// 追加一个观测条目
+void plugin_inspect_add(plugin_inspect_item_t *items, int max, int *count, plugin_inspect_kind_t kind,
+                        const char *name, uint32_t address, uint32_t value, uint32_t capacity) {
+    if (*count >= max) {
+        return;
+    }
+    plugin_inspect_item_t *item = &items[(*count)++];
+    item->kind = kind;
+    strncpy(item->name, name, sizeof(item->name) - 1);
+    item->name[sizeof(item->name) - 1] = '\0';
+    item->address = address;
+    item->value = value;
+    item->capacity = capacity;
+}
+
 // 加载动态库插件
 int load_plugin_from_lib(const char *lib_path, const char *create_func_name) {
     void *handle = dlopen(lib_path, RTLD_LAZY);
@@ -92,6 +121,7 @@ int handle_sim_message(const sim_message_t *msg, sim_message_t *response) {
     int result = 0;
     uint32_t reg_value = 0;
     
+    sim_hotpath_enter(SIM_HOTPATH_DISPATCH);
     switch (msg->type) {
         case MSG_CLOCK:
             if (plugin->clock) {
@@ -124,10 +154,17 @@ int handle_sim_message(const sim_message_t *msg, sim_message_t *response) {
             }
             break;
             
+        case MSG_INPUT:
+            if (plugin->input) {
+                result = plugin->input(plugin, msg->data.input.channel, msg->value);
+            }
+            break;
+            
         default:
             result = -1;
             break;
     }
+    sim_hotpath_exit();
     
     // 构造响应消息
     if (response) {
@@ -0,0 +1,150 @@
+#include "dma_kernels.h"
+#include <string.h>
+
+// 按元素类型生成跨步内核：
+//   gather  - 源跨步，目标连续（如从交织采样中抽取一个声道）
+//   scatter - 源连续，目标跨步（如把单声道写回交织缓冲区）
+//   strided - 源和目标都跨步
+// 固定大小的memcpy会被编译成单条load/store，连续一侧可向量化
+#define DMA_DEFINE_STRIDED_KERNELS(suffix, type)                                        \
+static void dma_gather_##suffix(uint8_t *dst, const uint8_t *src,                       \
+                                uint32_t count, size_t src_stride) {                    \
+    for (uint32_t i = 0; i < count; i++) {                                              \
+        type v;                                                                         \
+        memcpy(&v, src + i * src_stride, sizeof(type));                                 \
+        memcpy(dst + i * sizeof(type), &v, sizeof(type));                               \
+    }                                                                                   \
+}                                                                                       \
+static void dma_scatter_##suffix(uint8_t *dst, const uint8_t *src,                      \
+                                 uint32_t count, size_t dst_stride) {                   \
+    for (uint32_t i = 0; i < count; i++) {                                              \
+        type v;                                                                         \
+        memcpy(&v, src + i * sizeof(type), sizeof(type));                               \
+        memcpy(dst + i * dst_stride, &v, sizeof(type));                                 \
+    }                                                                                   \
+}                                                                                       \
+static void dma_strided_##suffix(uint8_t *dst, const uint8_t *src, uint32_t count,      \
+                                 size_t src_stride, size_t dst_stride) {                \
+    for (uint32_t i = 0; i < count; i++) {                                              \
+        type v;                                                                         \
+        memcpy(&v, src + i * src_stride, sizeof(type));                                 \
+        memcpy(dst + i * dst_stride, &v, sizeof(type));                                 \
+    }                                                                                   \
+}
+
+DMA_DEFINE_STRIDED_KERNELS(8, uint8_t)
+DMA_DEFINE_STRIDED_KERNELS(16, uint16_t)
+DMA_DEFINE_STRIDED_KERNELS(32, uint32_t)
+DMA_DEFINE_STRIDED_KERNELS(64, uint64_t)
+
+// 把pattern复制成64位字，元素大小1/2/4都能整除8字节（填充模式没有8字节元素）
+static uint64_t dma_replicate_pattern(uint32_t pattern, uint32_t elem_size) {
+    switch (elem_size) {
+        case 1:  pattern &= 0xFF;   pattern |= pattern << 8;  pattern |= pattern << 16; break;
+        case 2:  pattern &= 0xFFFF; pattern |= pattern << 16; break;
+        default: break;
+    }
+    return ((uint64_t)pattern << 32) | pattern;
+}
+
+// 连续拷贝 - 交给libc的向量化memmove（允许重叠）
+void dma_kernel_copy(void *dst, const void *src, size_t len) {
+    memmove(dst, src, len);
+}
+
+// 单元素行的跨步拷贝
+static void dma_copy_elements(uint8_t *dst, const uint8_t *src, const dma_2d_desc_t *desc) {
+    size_t es = desc->elem_size;
+    size_t ss = desc->src_stride;
+    size_t ds = desc->dst_stride;
+    uint32_t n = desc->rows;
+
+    if (ds == es) {
+        switch (es) {
+            case 1: dma_gather_8(dst, src, n, ss);  return;
+            case 2: dma_gather_16(dst, src, n, ss); return;
+            case 4: dma_gather_32(dst, src, n, ss); return;
+            case 8: dma_gather_64(dst, src, n, ss); return;
+        }
+    } else if (ss == es) {
+        switch (es) {
+            case 1: dma_scatter_8(dst, src, n, ds);  return;
+            case 2: dma_scatter_16(dst, src, n, ds); return;
+            case 4: dma_scatter_32(dst, src, n, ds); return;
+            case 8: dma_scatter_64(dst, src, n, ds); return;
+        }
+    }
+
+    switch (es) {
+        case 1: dma_strided_8(dst, src, n, ss, ds);  break;
+        case 2: dma_strided_16(dst, src, n, ss, ds); break;
+        case 4: dma_strided_32(dst, src, n, ss, ds); break;
+        case 8: dma_strided_64(dst, src, n, ss, ds); break;
+    }
+}
+
+// 二维跨步拷贝
+void dma_kernel_copy_2d(void *dst, const void *src, const dma_2d_desc_t *desc) {
+    uint8_t *d = (uint8_t *)dst;
+    const uint8_t *s = (const uint8_t *)src;
+
+    // 行宽就是一个元素：抽取/交织，走gather/scatter内核
+    if (desc->row_bytes == desc->elem_size) {
+        dma_copy_elements(d, s, desc);
+        return;
+    }
+
+    // 行紧密排列：退化为一次连续拷贝
+    if (desc->src_stride == desc->row_bytes && desc->dst_stride == desc->row_bytes) {
+        memmove(d, s, (size_t)desc->row_bytes * desc->rows);
+        return;
+    }
+
+    // 子矩形拷贝：逐行memcpy
+    for (uint32_t r = 0; r < desc->rows; r++) {
+        memmove(d + (size_t)r * desc->dst_stride, s + (size_t)r * desc->src_stride, desc->row_bytes);
+    }
+}
+
+// 常量填充
+void dma_kernel_fill(void *dst, uint32_t pattern, uint32_t elem_size, size_t len) {
+    uint8_t *d = (uint8_t *)dst;
+
+    if (elem_size == 1) {
+        memset(d, (int)(pattern & 0xFF), len);
+        return;
+    }
+
+    uint64_t word = dma_replicate_pattern(pattern, elem_size);
+    size_t words = len / sizeof(word);
+    for (size_t i = 0; i < words; i++) {
+        memcpy(d + i * sizeof(word), &word, sizeof(word));
+    }
+    memcpy(d + words * sizeof(word), &word, len % sizeof(word));
+}
+
+// 二维常量填充
+void dma_kernel_fill_2d(void *dst, uint32_t pattern, const dma_2d_desc_t *desc) {
+    uint8_t *d = (uint8_t *)dst;
+
+    if (desc->dst_stride == desc->row_bytes) {
+        dma_kernel_fill(d, pattern, desc->elem_size, (size_t)desc->row_bytes * desc->rows);
+        return;
+    }
+
+    // 单元素行：按元素写（scatter）
+    if (desc->row_bytes == desc->elem_size) {
+        uint64_t word = dma_replicate_pattern(pattern, desc->elem_size);
+        const uint8_t *src = (const uint8_t *)&word;
+        switch (desc->elem_size) {
+            case 1: dma_strided_8(d, src, desc->rows, 0, desc->dst_stride);  return;
+            case 2: dma_strided_16(d, src, desc->rows, 0, desc->dst_stride); return;
+            case 4: dma_strided_32(d, src, desc->rows, 0, desc->dst_stride); return;
+            case 8: dma_strided_64(d, src, desc->rows, 0, desc->dst_stride); return;
+        }
+    }
+
+    for (uint32_t r = 0; r < desc->rows; r++) {
+        dma_kernel_fill(d + (size_t)r * desc->dst_stride, pattern, desc->elem_size, desc->row_bytes);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef DMA_KERNELS_H
+#define DMA_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// DMA数据搬运内核 - 由DMA插件在宿主内存上执行实际拷贝/填充
+// 该文件以 -O3 编译（见Makefile），循环由编译器自动向量化
+
+// 二维（跨步）传输描述
+typedef struct {
+    uint32_t row_bytes;   // 每行字节数（Control寄存器）
+    uint32_t rows;        // 行数
+    uint32_t src_stride;  // 源行起始地址间距（字节）
+    uint32_t dst_stride;  // 目标行起始地址间距（字节）
+    uint32_t elem_size;   // 元素大小：1/2/4/8
+} dma_2d_desc_t;
+
+// 连续拷贝
+void dma_kernel_copy(void *dst, const void *src, size_t len);
+
+// 二维跨步拷贝：row_bytes == elem_size 时走gather/scatter内核
+void dma_kernel_copy_2d(void *dst, const void *src, const dma_2d_desc_t *desc);
+
+// 常量填充：32位pattern按elem_size（1/2/4）复制
+void dma_kernel_fill(void *dst, uint32_t pattern, uint32_t elem_size, size_t len);
+
+// 二维常量填充（只使用dst_stride）
+void dma_kernel_fill_2d(void *dst, uint32_t pattern, const dma_2d_desc_t *desc);
+
+#endif // DMA_KERNELS_H
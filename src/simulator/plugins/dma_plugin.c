@@ -1,3 +1,8 @@
+// 解决usleep在一些系统上的声明问题
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "../plugin_interface.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -5,23 +10,69 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <errno.h>
 #include <ctype.h>
 #include "../../common/register_map.h"
+#include "dma_kernels.h"
+#include "dma_workers.h"
+#include "../irq_moderation.h"
+#include "../../sim_interface/sim_hotpath.h"
 
-// 解决usleep在一些系统上的声明问题
-#ifndef _GNU_SOURCE
-#define _GNU_SOURCE
+#define DMA_PLUGIN_CHANNELS 16
+#define DMA_IRQ_NUM         8       // 控制器合并中断：所有通道的完成/错误共用一个中断
+#define DMA_CH_SHIFT        5       // log2(DMA_CH_OFFSET)，通道号 = 通道窗口偏移 >> 5
+#define DMA_CH_WINDOW       (DMA_PLUGIN_CHANNELS << DMA_CH_SHIFT)
+#define DMA_LLI_MAX_ITEMS   4096    // 一次传输最多跟随的链表项数，防止环形链表使监控线程不能结束
+
+// 通道寄存器索引 = 通道内偏移 >> 2
+enum {
+    DMA_CH_REG_SRC = 0,     // 0x00 源地址（填充模式下为填充值）
+    DMA_CH_REG_DST,         // 0x04 目标地址
+    DMA_CH_REG_LLI,         // 0x08 链表项地址
+    DMA_CH_REG_CTRL,        // 0x0C 传输大小（二维模式下为每行字节数）
+    DMA_CH_REG_CONFIG,      // 0x10 配置寄存器
+    DMA_CH_REG_STATUS,      // 0x14 状态寄存器（写1清除）
+    DMA_CH_REG_STRIDE,      // 0x18 二维行间距
+    DMA_CH_REG_ROWS,        // 0x1C 二维行数
+    DMA_CH_REG_COUNT
+};
+
+// 全局寄存器相对控制器基地址的偏移
+#define DMA_GREG_INT_STATUS      0x00
+#define DMA_GREG_INT_TC_STATUS   0x04
+#define DMA_GREG_INT_TC_CLEAR    0x08
+#define DMA_GREG_INT_ERR_STATUS  0x0C
+#define DMA_GREG_INT_ERR_CLEAR   0x10
+#define DMA_GREG_ENBLD_CHNS      0x1C
+#define DMA_GREG_CONFIG          0x30
+#define DMA_GREG_INT_MOD_CNT     0x38
+#define DMA_GREG_INT_MOD_TIME    0x3C
+#define DMA_GREG_IRQ_RAISED      0x40
+#define DMA_GREG_IRQ_SUPPRESSED  0x44
+
+// 逐次寄存器访问日志，默认关闭（每次访问printf会让寄存器访问慢一个数量级）
+#ifdef DMA_PLUGIN_TRACE
+#define DMA_TRACE(...) printf(__VA_ARGS__)
+#else
+#define DMA_TRACE(...) ((void)0)
 #endif
 
 // 声明外部函数
 extern int trigger_interrupt(const char *module, uint32_t irq_num);
+extern void* get_mapped_range(uint32_t addr, uint32_t len);
+extern int sim_bus_read(uint32_t addr, uint32_t *value);
+extern int sim_bus_write(uint32_t addr, uint32_t value);
 
 // 前向声明
 static simulator_plugin_t* create_dma_plugin_instance(const char *instance_name, int instance_id);
 
 // DMA实例私有数据
 typedef struct {
-    dma_channel_regs_t channels[16];  // 16个DMA通道
+    // 通道寄存器按struct-of-arrays紧密存放：regs[寄存器索引][通道号]
+    uint32_t regs[DMA_CH_REG_COUNT][DMA_PLUGIN_CHANNELS];
+    uint32_t active_mask;         // 已使能（E=1）的通道位图（EnbldChns）
     bool enabled;
     uint32_t transfer_count;
     bool simulation_running;
@@ -30,7 +81,22 @@ typedef struct {
     // 实例化的寄存器状态（之前是全局的）
     uint32_t dma_global_ctrl;
     uint32_t dma_global_status;
-    uint32_t dma_int_status;
+    uint32_t dma_int_status;      // 传输完成中断状态（IntTCStatus）
+    uint32_t dma_int_err_status;  // 传输错误中断状态（IntErrorStatus）
+    bool irq_asserted;            // 已发出中断、ISR尚未读取IntStatus（跨线程原子访问）
+    irq_moderation_t irq_mod;     // 完成中断的计数/时间阈值调节
+    uint32_t int_mod_cnt;
+    uint32_t int_mod_time;
+    
+    // 已启动、等待监控线程执行的通道位图（跨线程原子访问）
+    uint32_t pending_mask;
+    sem_t work_sem;
+    
+    // 大块内存到内存传输的宿主并行执行池
+    dma_pool_t *pool;
+    
+    // 插件指定的总线入口（锁步候选实现等），NULL时直接访问仿真器总线
+    const plugin_bus_ops_t *bus;
     
     // 实例标识和地址配置
     int instance_id;
@@ -39,6 +105,264 @@ typedef struct {
     uint32_t channel_base_addr;   // DMA通道寄存器基地址
 } dma_private_t;
 
+// 可保存/恢复的设备状态（不含监控线程、执行池等宿主资源）
+typedef struct {
+    uint32_t regs[DMA_CH_REG_COUNT][DMA_PLUGIN_CHANNELS];
+    uint32_t active_mask;
+    uint32_t pending_mask;
+    bool enabled;
+    bool irq_asserted;
+    uint32_t transfer_count;
+    uint32_t dma_global_ctrl;
+    uint32_t dma_global_status;
+    uint32_t dma_int_status;
+    uint32_t dma_int_err_status;
+    uint32_t int_mod_cnt;
+    uint32_t int_mod_time;
+} dma_state_t;
+
+// ---- 总线访问：所有内存和外设访问经这里，插件指定了总线入口时改走该入口 ----
+
+static void* dma_map(dma_private_t *priv, uint32_t addr, uint32_t len, bool write) {
+    return priv->bus ? priv->bus->map(priv->bus->ctx, addr, len, write) : get_mapped_range(addr, len);
+}
+
+// 与每次成功的dma_map配对
+static void dma_unmap(dma_private_t *priv, const void *ptr, uint32_t addr, uint32_t len, bool write) {
+    if (priv->bus) {
+        priv->bus->unmap(priv->bus->ctx, (void*)ptr, addr, len, write);
+    }
+}
+
+static int dma_bus_read(dma_private_t *priv, uint32_t addr, uint32_t *value) {
+    return priv->bus ? priv->bus->read(priv->bus->ctx, addr, value) : sim_bus_read(addr, value);
+}
+
+static int dma_bus_write(dma_private_t *priv, uint32_t addr, uint32_t value) {
+    return priv->bus ? priv->bus->write(priv->bus->ctx, addr, value) : sim_bus_write(addr, value);
+}
+
+// 读取一个元素：内存直接访问，否则走总线访问外设寄存器
+static int dma_read_element(dma_private_t *priv, uint32_t addr, uint32_t size, uint64_t *value) {
+    void *ptr = dma_map(priv, addr, size, false);
+    *value = 0;
+    if (ptr) {
+        memcpy(value, ptr, size);
+        dma_unmap(priv, ptr, addr, size, false);
+        return 0;
+    }
+    uint32_t reg = 0;
+    if (size > sizeof(reg) || dma_bus_read(priv, addr, &reg) != 0) {
+        return -1;
+    }
+    *value = reg;
+    return 0;
+}
+
+// 写入一个元素
+static int dma_write_element(dma_private_t *priv, uint32_t addr, uint32_t size, uint64_t value) {
+    void *ptr = dma_map(priv, addr, size, true);
+    if (ptr) {
+        memcpy(ptr, &value, size);
+        dma_unmap(priv, ptr, addr, size, true);
+        return 0;
+    }
+    if (size > sizeof(uint32_t)) {
+        return -1;
+    }
+    return dma_bus_write(priv, addr, (uint32_t)value);
+}
+
+// 逐元素传输：外设端点或固定地址（不递增）时使用
+static int dma_transfer_elements(dma_private_t *priv, const dma_channel_regs_t *c, const dma_2d_desc_t *desc,
+                                 bool fill, bool src_inc, bool dst_inc) {
+    uint32_t es = desc->elem_size;
+    
+    for (uint32_t r = 0; r < desc->rows; r++) {
+        for (uint32_t off = 0; off < desc->row_bytes; off += es) {
+            uint32_t src = c->src_addr + (src_inc ? r * desc->src_stride + off : 0);
+            uint32_t dst = c->dst_addr + (dst_inc ? r * desc->dst_stride + off : 0);
+            uint64_t value = 0;
+            
+            if (fill) {
+                value = c->src_addr;
+            } else if (dma_read_element(priv, src, es, &value) != 0) {
+                return -1;
+            }
+            if (dma_write_element(priv, dst, es, value) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// 执行一个通道的传输（线性/二维/填充）
+static int dma_execute_transfer(dma_private_t *priv, const dma_channel_regs_t *c) {
+    uint32_t config = c->config;
+    bool is_2d = (config & DMA_CCFG_2D) != 0;
+    bool fill = (config & DMA_CCFG_FILL) != 0;
+    bool src_inc = (config & DMA_CCFG_SINC) != 0;
+    bool dst_inc = (config & DMA_CCFG_DINC) != 0;
+    
+    dma_2d_desc_t desc;
+    desc.elem_size = 1u << ((config & DMA_CCFG_ESIZE_Msk) >> DMA_CCFG_ESIZE_Pos);
+    desc.row_bytes = c->size;
+    desc.rows = (is_2d && c->rows) ? c->rows : 1;
+    desc.src_stride = (c->stride & DMA_CSTRIDE_SRC_Msk) >> DMA_CSTRIDE_SRC_Pos;
+    desc.dst_stride = (c->stride & DMA_CSTRIDE_DST_Msk) >> DMA_CSTRIDE_DST_Pos;
+    if (!is_2d || desc.src_stride == 0) desc.src_stride = desc.row_bytes;
+    if (!is_2d || desc.dst_stride == 0) desc.dst_stride = desc.row_bytes;
+    
+    // 行紧密排列的二维传输等价于一次线性传输
+    bool packed = desc.src_stride == desc.row_bytes && desc.dst_stride == desc.row_bytes;
+    
+    if (desc.row_bytes == 0) {
+        return 0;
+    }
+    if (desc.row_bytes % desc.elem_size != 0) {
+        return -1;
+    }
+    // 填充图案只有32位（放在SrcAddr），不支持8字节元素
+    if (fill && desc.elem_size > 4) {
+        return -1;
+    }
+    
+    // 传输覆盖的地址范围
+    uint64_t src_span = (uint64_t)(desc.rows - 1) * desc.src_stride + desc.row_bytes;
+    uint64_t dst_span = (uint64_t)(desc.rows - 1) * desc.dst_stride + desc.row_bytes;
+    if (src_span > UINT32_MAX || dst_span > UINT32_MAX) {
+        return -1;
+    }
+    
+    // 快速路径：目标（和源）都是递增的内存区域，使用向量化内核
+    // 线性传输交给执行池，大块传输按缓存大小分块在多个宿主核上并行执行
+    void *dst = dst_inc ? dma_map(priv, c->dst_addr, (uint32_t)dst_span, true) : NULL;
+    if (dst && fill) {
+        if (desc.dst_stride == desc.row_bytes) {
+            dma_pool_fill(priv->pool, dst, c->src_addr, desc.elem_size, (size_t)dst_span);
+        } else {
+            dma_kernel_fill_2d(dst, c->src_addr, &desc);
+        }
+        dma_unmap(priv, dst, c->dst_addr, (uint32_t)dst_span, true);
+        return 0;
+    }
+    const void *src = (dst && src_inc) ? dma_map(priv, c->src_addr, (uint32_t)src_span, false) : NULL;
+    if (dst && src) {
+        if (packed) {
+            dma_pool_copy(priv->pool, dst, src, (size_t)dst_span);
+        } else {
+            dma_kernel_copy_2d(dst, src, &desc);
+        }
+        dma_unmap(priv, src, c->src_addr, (uint32_t)src_span, false);
+        dma_unmap(priv, dst, c->dst_addr, (uint32_t)dst_span, true);
+        return 0;
+    }
+    if (dst) {
+        dma_unmap(priv, dst, c->dst_addr, (uint32_t)dst_span, true);
+    }
+    
+    return dma_transfer_elements(priv, c, &desc, fill, src_inc, dst_inc);
+}
+
+// 执行通道传输并锁存完成/错误状态，返回是否需要上报中断
+static bool dma_run_channel(dma_private_t *priv, int ch) {
+    uint32_t (*regs)[DMA_PLUGIN_CHANNELS] = priv->regs;
+    
+    if (!(regs[DMA_CH_REG_CONFIG][ch] & DMA_CCFG_E)) {
+        return false;  // 传输已被软件中止
+    }
+    
+    // 传输开始时的寄存器快照
+    dma_channel_regs_t c;
+    memset(&c, 0, sizeof(c));
+    c.src_addr = regs[DMA_CH_REG_SRC][ch];
+    c.dst_addr = regs[DMA_CH_REG_DST][ch];
+    c.lli = regs[DMA_CH_REG_LLI][ch];
+    c.size = regs[DMA_CH_REG_CTRL][ch];
+    c.config = regs[DMA_CH_REG_CONFIG][ch];
+    c.stride = regs[DMA_CH_REG_STRIDE][ch];
+    c.rows = regs[DMA_CH_REG_ROWS][ch];
+    
+    int result = dma_execute_transfer(priv, &c);
+    
+    // 分散/聚集：一块完成后从内存装入下一个链表项（配置不变），整条链结束才锁存状态、上报中断
+    for (uint32_t items = 0; result == 0 && c.lli != 0; items++) {
+        uint32_t lli = c.lli;
+        const DMA_LLI_TypeDef *item = ((lli & 3u) || items >= DMA_LLI_MAX_ITEMS) ? NULL :
+                                      (const DMA_LLI_TypeDef*)dma_map(priv, lli, sizeof(*item), false);
+        if (!item) {
+            result = -1;
+            break;
+        }
+        if (!(regs[DMA_CH_REG_CONFIG][ch] & DMA_CCFG_E)) {
+            dma_unmap(priv, item, lli, sizeof(*item), false);
+            return false;  // 链中途被软件中止
+        }
+        c.src_addr = item->SrcAddr;
+        c.dst_addr = item->DestAddr;
+        c.size = item->Control;
+        c.lli = item->LLI;
+        dma_unmap(priv, item, lli, sizeof(*item), false);
+        result = dma_execute_transfer(priv, &c);
+    }
+    
+    regs[DMA_CH_REG_CONFIG][ch] &= ~DMA_CCFG_E;  // 硬件在传输结束时清除使能位
+    __atomic_fetch_and(&priv->active_mask, ~(1u << ch), __ATOMIC_RELEASE);
+    priv->transfer_count++;
+    
+    // 中断状态只为使能了中断的通道锁存（屏蔽后的IntTCStatus/IntErrorStatus）
+    if (result == 0) {
+        regs[DMA_CH_REG_STATUS][ch] = DMA_CSTAT_DONE;
+        printf("[%s:%s] %s DMA channel %d transfer completed!\n", 
+               __FILE__, __func__, priv->instance_name, ch);
+        if (c.config & DMA_CCFG_ITC) {
+            __atomic_fetch_or(&priv->dma_int_status, 1u << ch, __ATOMIC_RELEASE);
+            return true;
+        }
+    } else {
+        regs[DMA_CH_REG_STATUS][ch] = DMA_CSTAT_ERR;
+        printf("[%s:%s] %s DMA channel %d transfer error: src=0x%08X, dst=0x%08X, size=%u\n", 
+               __FILE__, __func__, priv->instance_name, ch, c.src_addr, c.dst_addr, c.size);
+        if (c.config & DMA_CCFG_IE) {
+            __atomic_fetch_or(&priv->dma_int_err_status, 1u << ch, __ATOMIC_RELEASE);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 中断调节的上报回调：ISR读取IntStatus之前的新完成只并入状态位，不再重复发信号
+static bool dma_raise_irq(void *ctx) {
+    dma_private_t *priv = (dma_private_t*)ctx;
+    if (!__atomic_exchange_n(&priv->irq_asserted, true, __ATOMIC_ACQ_REL)) {
+        return trigger_interrupt(priv->instance_name, DMA_IRQ_NUM) == 0;
+    }
+    return false;
+}
+
+// 执行所有已启动的通道：只遍历位图中置位的通道，按通道号从小到大执行
+// 一批完成的通道只上报一次中断
+static void dma_process_pending(dma_private_t *priv) {
+    uint32_t pending = __atomic_exchange_n(&priv->pending_mask, 0, __ATOMIC_ACQ_REL);
+    bool raise = false;
+    
+    if (!pending) {
+        return;
+    }
+    sim_hotpath_enter(SIM_HOTPATH_DMA);
+    while (pending) {
+        int ch = __builtin_ctz(pending);
+        pending &= pending - 1;
+        raise |= dma_run_channel(priv, ch);
+    }
+    
+    if (raise) {
+        irq_mod_event(&priv->irq_mod);
+    }
+    sim_hotpath_exit();
+}
+
 // DMA监控线程
 static void* dma_monitor_thread(void *arg) {
     simulator_plugin_t *plugin = (simulator_plugin_t*)arg;
@@ -48,47 +372,21 @@ static void* dma_monitor_thread(void *arg) {
     
     int cycle_count = 0;
     while (priv->simulation_running) {
-        sleep(1);  // 每1秒检查一次（简化）
-        cycle_count++;
-        
-        // 检查所有通道的传输状态
-        for (int i = 0; i < 16; i++) {
-            if (priv->channels[i].ctrl & 0x01) {  // 通道启用
-                printf("[%s:%s] %s DMA channel %d active, size=%d, cycle=%d\n", 
-                       __FILE__, __func__, priv->instance_name, i, priv->channels[i].size, cycle_count);
-                
-                // 简化的DMA传输仿真 - 模拟传输需要一定时间
-                if (priv->channels[i].size > 0) {
-                    // 每次检查减少一部分传输大小，加快传输速度
-                    uint32_t transfer_amount = (priv->channels[i].size > 512) ? 512 : priv->channels[i].size;
-                    priv->channels[i].size -= transfer_amount;
-                    
-                    printf("[%s:%s] %s DMA channel %d transferring %d bytes, remaining=%d\n", 
-                           __FILE__, __func__, priv->instance_name, i, transfer_amount, priv->channels[i].size);
-                    
-                    if (priv->channels[i].size == 0) {
-                        // 传输完成
-                        priv->channels[i].ctrl &= ~0x01;  // 清除启用位
-                        priv->channels[i].status |= 0x02; // 设置完成位
-                        
-                        printf("[%s:%s] %s DMA channel %d transfer completed!\n", 
-                               __FILE__, __func__, priv->instance_name, i);
-                        
-                        // 触发DMA完成中断
-                        priv->dma_int_status |= (1 << i);  // 设置中断状态位
-                        printf("[%s:%s] %s triggering DMA interrupt for channel %d\n", 
-                               __FILE__, __func__, priv->instance_name, i);
-                        trigger_interrupt(priv->instance_name, 10 + i);
-                    }
-                }
+        // 有通道启动时立即唤醒，否则每1秒醒来一次做心跳
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += 1;
+        if (sem_timedwait(&priv->work_sem, &deadline) != 0 && errno == ETIMEDOUT) {
+            cycle_count++;
+            
+            // 每10秒打印一次状态信息
+            if (cycle_count % 10 == 0) {
+                printf("[%s:%s] %s DMA monitor heartbeat - cycle %d\n", 
+                       __FILE__, __func__, priv->instance_name, cycle_count);
             }
         }
         
-        // 每10秒打印一次状态信息
-        if (cycle_count % 10 == 0) {
-            printf("[%s:%s] %s DMA monitor heartbeat - cycle %d\n", 
-                   __FILE__, __func__, priv->instance_name, cycle_count);
-        }
+        dma_process_pending(priv);
     }
     
     printf("[dma_plugin.c:%s] %s DMA monitor thread stopped\n", __func__, priv->instance_name);
@@ -101,32 +399,27 @@ static int dma_clock(simulator_plugin_t *plugin, clock_action_t action, uint32_t
     (void)cycles; // 避免警告
     
     if (action == CLOCK_TICK) {
-        // 检查所有通道的传输状态
-        for (int i = 0; i < 16; i++) {
-            if (priv->channels[i].ctrl & 0x01) {  // 通道启用
-                // 简化的DMA传输仿真
-                if (priv->channels[i].size > 0) {
-                    priv->channels[i].size--;
-                    if (priv->channels[i].size == 0) {
-                        // 传输完成
-                        priv->channels[i].ctrl &= ~0x01;  // 清除启用位
-                        priv->channels[i].status |= 0x02; // 设置完成位
-                        
-                        printf("[%s:%s] DMA channel %d transfer completed\n", __FILE__, __func__, i);
-                        
-                        // 触发DMA完成中断
-                        if (priv->channels[i].config & 0x100) {  // 中断使能
-                            trigger_interrupt("dma", 10 + i);
-                        }
-                    }
-                }
-            }
-        }
+        // 时钟驱动时在调用线程上同步执行已启动的传输
+        dma_process_pending(priv);
     }
     
     return 0;
 }
 
+// 启动监控线程
+static void dma_start_monitor(simulator_plugin_t *plugin) {
+    dma_private_t *priv = (dma_private_t*)plugin->private_data;
+    
+    priv->simulation_running = true;
+    if (pthread_create(&priv->monitor_thread, NULL, dma_monitor_thread, plugin) == 0) {
+        printf("[%s:%s] %s DMA monitor thread started\n", __FILE__, __func__, priv->instance_name);
+    } else {
+        printf("[%s:%s] Failed to create %s DMA monitor thread\n", __FILE__, __func__, priv->instance_name);
+        priv->simulation_running = false;
+        priv->monitor_thread = 0;
+    }
+}
+
 // DMA复位
 static int dma_reset(simulator_plugin_t *plugin, reset_action_t action) {
     dma_private_t *priv = (dma_private_t*)plugin->private_data;
@@ -136,17 +429,32 @@ static int dma_reset(simulator_plugin_t *plugin, reset_action_t action) {
         // 停止监控线程
         priv->simulation_running = false;
         if (priv->monitor_thread) {
+            sem_post(&priv->work_sem);
             pthread_join(priv->monitor_thread, NULL);
+            priv->monitor_thread = 0;
             printf("[%s:%s] DMA monitor thread joined\n", __FILE__, __func__);
         }
         
         // 复位所有通道
-        memset(priv->channels, 0, sizeof(priv->channels));
+        memset(priv->regs, 0, sizeof(priv->regs));
+        priv->active_mask = 0;
         priv->enabled = false;
         priv->transfer_count = 0;
         priv->dma_global_ctrl = 0;
         priv->dma_global_status = 0;
         priv->dma_int_status = 0;
+        priv->dma_int_err_status = 0;
+        priv->irq_asserted = false;
+        priv->pending_mask = 0;
+        priv->int_mod_cnt = 0;
+        priv->int_mod_time = 0;
+        irq_mod_configure(&priv->irq_mod, 0, 0);
+        // 丢弃复位前排队的唤醒，释放复位后监控线程不会空转
+        while (sem_trywait(&priv->work_sem) == 0) {
+        }
+    } else if (action == RESET_DEASSERT && !priv->monitor_thread) {
+        // 释放复位：恢复监控线程
+        dma_start_monitor(plugin);
     }
     
     return 0;
@@ -156,119 +464,129 @@ static int dma_reset(simulator_plugin_t *plugin, reset_action_t action) {
 static uint32_t dma_reg_read(simulator_plugin_t *plugin, uint32_t address) {
     dma_private_t *priv = (dma_private_t*)plugin->private_data;
     
-    printf("[%s:%s] %s DMA register read: 0x%08X (base: 0x%08X)\n", 
-           __FILE__, __func__, priv->instance_name, address, priv->base_addr);
-    
-    // 全局寄存器 - 使用相对于基地址的偏移
-    uint32_t global_ctrl_addr = priv->base_addr + (DMA_GLOBAL_CTRL_REG - DMA_BASE_ADDR);
-    uint32_t global_status_addr = priv->base_addr + (DMA_GLOBAL_STATUS_REG - DMA_BASE_ADDR);
-    uint32_t int_status_addr = priv->base_addr + (DMA_INT_STATUS_REG - DMA_BASE_ADDR);
-    
-    if (address == global_ctrl_addr) {
-        return priv->dma_global_ctrl;
-    } else if (address == global_status_addr) {
-        return priv->dma_global_status;
-    } else if (address == int_status_addr) {
-        return priv->dma_int_status;
-    }
-    
-    // 通道寄存器 - 使用可配置的通道基地址
-    for (int ch = 0; ch < 16; ch++) {
-        uint32_t ch_base = priv->channel_base_addr + ch * DMA_CH_OFFSET;
-        if (address >= ch_base && address < ch_base + DMA_CH_OFFSET) {
-            uint32_t offset = address - ch_base;
-            switch (offset) {
-                case 0x00: return priv->channels[ch].ctrl;
-                case 0x04: return priv->channels[ch].status;
-                case 0x08: return priv->channels[ch].src_addr;
-                case 0x0C: return priv->channels[ch].dst_addr;
-                case 0x10: return priv->channels[ch].size;
-                case 0x14: return priv->channels[ch].config;
-                default: return 0;
-            }
-        }
+    DMA_TRACE("[%s:%s] %s DMA register read: 0x%08X (base: 0x%08X)\n", 
+              __FILE__, __func__, priv->instance_name, address, priv->base_addr);
+    
+    // 通道寄存器：通道号和寄存器索引直接由偏移移位得到
+    uint32_t ch_off = address - priv->channel_base_addr;
+    if (ch_off < DMA_CH_WINDOW) {
+        return priv->regs[(ch_off & (DMA_CH_OFFSET - 1)) >> 2][ch_off >> DMA_CH_SHIFT];
     }
     
-    return 0;
+    // 全局寄存器
+    switch (address - priv->base_addr) {
+        case DMA_GREG_INT_STATUS:
+            // ISR读取状态即视为已响应，此后的完成需要重新发出中断
+            __atomic_store_n(&priv->irq_asserted, false, __ATOMIC_RELEASE);
+            return __atomic_load_n(&priv->dma_int_status, __ATOMIC_ACQUIRE) |
+                   __atomic_load_n(&priv->dma_int_err_status, __ATOMIC_ACQUIRE);
+        case DMA_GREG_INT_TC_STATUS:
+            return __atomic_load_n(&priv->dma_int_status, __ATOMIC_ACQUIRE);
+        case DMA_GREG_INT_ERR_STATUS:
+            return __atomic_load_n(&priv->dma_int_err_status, __ATOMIC_ACQUIRE);
+        case DMA_GREG_ENBLD_CHNS:
+            return __atomic_load_n(&priv->active_mask, __ATOMIC_ACQUIRE);
+        case DMA_GREG_CONFIG:
+            return priv->dma_global_ctrl;
+        case DMA_GREG_INT_MOD_CNT:
+            return priv->int_mod_cnt;
+        case DMA_GREG_INT_MOD_TIME:
+            return priv->int_mod_time;
+        case DMA_GREG_IRQ_RAISED:
+        case DMA_GREG_IRQ_SUPPRESSED: {
+            irq_mod_stats_t stats;
+            irq_mod_get_stats(&priv->irq_mod, &stats);
+            return (uint32_t)(address - priv->base_addr == DMA_GREG_IRQ_RAISED ?
+                              stats.raised : stats.suppressed);
+        }
+        default:
+            return 0;
+    }
+}
+
+// 通道配置寄存器写入：E位上升沿启动传输，软件清除E位中止传输
+static void dma_write_channel_config(dma_private_t *priv, int ch, uint32_t value) {
+    uint32_t old = priv->regs[DMA_CH_REG_CONFIG][ch];
+    
+    priv->regs[DMA_CH_REG_CONFIG][ch] = value;
+    
+    if (!(old & DMA_CCFG_E) && (value & DMA_CCFG_E)) {
+        DMA_TRACE("[%s:%s] %s DMA channel %d started, size=%u, rows=%u\n", 
+                  __FILE__, __func__, priv->instance_name, ch,
+                  priv->regs[DMA_CH_REG_CTRL][ch], priv->regs[DMA_CH_REG_ROWS][ch]);
+        priv->regs[DMA_CH_REG_STATUS][ch] = DMA_CSTAT_BUSY;
+        __atomic_fetch_or(&priv->active_mask, 1u << ch, __ATOMIC_RELEASE);
+        __atomic_fetch_or(&priv->pending_mask, 1u << ch, __ATOMIC_RELEASE);
+        sem_post(&priv->work_sem);
+    } else if ((old & DMA_CCFG_E) && !(value & DMA_CCFG_E)) {
+        __atomic_fetch_and(&priv->pending_mask, ~(1u << ch), __ATOMIC_RELEASE);
+        __atomic_fetch_and(&priv->active_mask, ~(1u << ch), __ATOMIC_RELEASE);
+        priv->regs[DMA_CH_REG_STATUS][ch] &= ~DMA_CSTAT_BUSY;
+    }
 }
 
 // DMA寄存器写入
 static int dma_reg_write(simulator_plugin_t *plugin, uint32_t address, uint32_t value) {
     dma_private_t *priv = (dma_private_t*)plugin->private_data;
     
-    printf("[%s:%s] %s DMA register write: 0x%08X = 0x%08X (base: 0x%08X)\n", 
-           __FILE__, __func__, priv->instance_name, address, value, priv->base_addr);
-    
-    // 全局寄存器 - 使用相对于基地址的偏移
-    uint32_t global_ctrl_addr = priv->base_addr + (DMA_GLOBAL_CTRL_REG - DMA_BASE_ADDR);
-    uint32_t global_status_addr = priv->base_addr + (DMA_GLOBAL_STATUS_REG - DMA_BASE_ADDR);
-    uint32_t int_clear_addr = priv->base_addr + (DMA_INT_CLEAR_REG - DMA_BASE_ADDR);
-    
-    if (address == global_ctrl_addr) {
-        priv->dma_global_ctrl = value;
-        priv->enabled = (value & 0x01) != 0;
-        printf("[%s:%s] %s DMA global control: enabled=%d\n", __FILE__, __func__, priv->instance_name, priv->enabled);
-        return 0;
-    } else if (address == global_status_addr) {
-        priv->dma_global_status = value;
-        return 0;
-    } else if (address == int_clear_addr) {
-        priv->dma_int_status &= ~value;  // 清除中断状态
+    DMA_TRACE("[%s:%s] %s DMA register write: 0x%08X = 0x%08X (base: 0x%08X)\n", 
+              __FILE__, __func__, priv->instance_name, address, value, priv->base_addr);
+    
+    // 通道寄存器：通道号和寄存器索引直接由偏移移位得到
+    uint32_t ch_off = address - priv->channel_base_addr;
+    if (ch_off < DMA_CH_WINDOW) {
+        int ch = (int)(ch_off >> DMA_CH_SHIFT);
+        uint32_t reg = (ch_off & (DMA_CH_OFFSET - 1)) >> 2;
+        switch (reg) {
+            case DMA_CH_REG_CONFIG:
+                dma_write_channel_config(priv, ch, value);
+                break;
+            case DMA_CH_REG_STATUS:
+                priv->regs[DMA_CH_REG_STATUS][ch] &= ~value;
+                break;
+            default:
+                priv->regs[reg][ch] = value;
+                break;
+        }
         return 0;
     }
     
-    // 通道寄存器 - 使用可配置的通道基地址
-    for (int ch = 0; ch < 16; ch++) {
-        uint32_t ch_base = priv->channel_base_addr + ch * DMA_CH_OFFSET;
-        if (address >= ch_base && address < ch_base + DMA_CH_OFFSET) {
-            uint32_t offset = address - ch_base;
-            switch (offset) {
-                case 0x00: // 控制寄存器
-                    priv->channels[ch].ctrl = value;
-                    if (value & 0x01) {
-                        printf("[%s:%s] %s DMA channel %d started, size=%d\n", 
-                               __FILE__, __func__, priv->instance_name, ch, priv->channels[ch].size);
-                        // 如果传输大小为0，设置默认值用于测试
-                        if (priv->channels[ch].size == 0) {
-                            priv->channels[ch].size = 1024;  // 默认1KB用于测试
-                            printf("[%s:%s] %s DMA channel %d: set default size to %d bytes\n", 
-                                   __FILE__, __func__, priv->instance_name, ch, priv->channels[ch].size);
-                        }
-                    }
-                    break;
-                case 0x04: // 状态寄存器
-                    priv->channels[ch].status = value;
-                    break;
-                case 0x08: // 源地址
-                    priv->channels[ch].src_addr = value;
-                    break;
-                case 0x0C: // 目标地址
-                    priv->channels[ch].dst_addr = value;
-                    break;
-                case 0x10: // 传输大小
-                    priv->channels[ch].size = value;
-                    break;
-                case 0x14: // 配置寄存器
-                    priv->channels[ch].config = value;
-                    break;
-            }
-            return 0;
-        }
+    // 全局寄存器
+    switch (address - priv->base_addr) {
+        case DMA_GREG_CONFIG:
+            priv->dma_global_ctrl = value;
+            priv->enabled = (value & 0x01) != 0;
+            printf("[%s:%s] %s DMA global control: enabled=%d\n", __FILE__, __func__, priv->instance_name, priv->enabled);
+            break;
+        case DMA_GREG_INT_TC_CLEAR:
+            __atomic_fetch_and(&priv->dma_int_status, ~value, __ATOMIC_RELEASE);  // 清除中断状态
+            break;
+        case DMA_GREG_INT_ERR_CLEAR:
+            __atomic_fetch_and(&priv->dma_int_err_status, ~value, __ATOMIC_RELEASE);
+            break;
+        case DMA_GREG_INT_MOD_CNT:
+            priv->int_mod_cnt = value;
+            irq_mod_configure(&priv->irq_mod, priv->int_mod_cnt, priv->int_mod_time);
+            break;
+        case DMA_GREG_INT_MOD_TIME:
+            priv->int_mod_time = value;
+            irq_mod_configure(&priv->irq_mod, priv->int_mod_cnt, priv->int_mod_time);
+            break;
+        case DMA_GREG_IRQ_RAISED:
+            // 写任意值清零统计
+            irq_mod_reset_stats(&priv->irq_mod);
+            break;
+        default:
+            break;
     }
     
     return 0;
 }
 
-// DMA中断处理
+// DMA中断处理：状态位只由通道完成锁存，经合并的DMA_IRQ_NUM上报，外部中断消息不改变状态
 static int dma_interrupt(simulator_plugin_t *plugin, uint32_t irq_num) {
     dma_private_t *priv = (dma_private_t*)plugin->private_data;
     printf("[%s:%s] %s DMA interrupt %d handled\n", __FILE__, __func__, priv->instance_name, irq_num);
-    
-    // 根据中断号设置相应的中断状态位
-    if (irq_num >= 10 && irq_num <= 25) {
-        priv->dma_int_status |= (1 << (irq_num - 10));
-    }
-    
     return 0;
 }
 
@@ -282,11 +600,11 @@ static int dma_init(simulator_plugin_t *plugin) {
     
     memset(priv, 0, sizeof(dma_private_t));
     priv->enabled = false;
-    priv->simulation_running = true;  // 立即启动监控线程
     
     // 从插件名称中提取实例信息
     priv->instance_id = 0;  // 默认实例ID
     strncpy(priv->instance_name, plugin->name, sizeof(priv->instance_name) - 1);
+    priv->bus = plugin->bus;
     
     // 从插件名称中提取实例ID（如果包含数字）
     const char *name_ptr = plugin->name;
@@ -303,29 +621,144 @@ static int dma_init(simulator_plugin_t *plugin) {
            __FILE__, __func__, priv->instance_name, priv->base_addr, priv->channel_base_addr);
     
     plugin->private_data = priv;
+    sem_init(&priv->work_sem, 0, 0);
     
-    // 启动监控线程
-    if (pthread_create(&priv->monitor_thread, NULL, dma_monitor_thread, plugin) == 0) {
-        printf("[%s:%s] %s DMA monitor thread started\n", __FILE__, __func__, priv->instance_name);
-    } else {
-        printf("[%s:%s] Failed to create %s DMA monitor thread\n", __FILE__, __func__, priv->instance_name);
-        priv->simulation_running = false;
+    // 默认不调节：每批完成立即上报
+    if (irq_mod_init(&priv->irq_mod, priv->instance_name, dma_raise_irq, priv) != 0) {
+        sem_destroy(&priv->work_sem);
+        free(priv);
+        plugin->private_data = NULL;
+        return -1;
     }
     
-    // 添加一个测试传输用于验证监控线程
-    printf("[%s:%s] Setting up test DMA transfer on %s channel 0\n", __FILE__, __func__, priv->instance_name);
-    priv->channels[0].src_addr = 0x20000000;
-    priv->channels[0].dst_addr = 0x40001000;  // UART_TX_REG
-    priv->channels[0].size = 17;  // "Hello DMA Thread!" length
-    priv->channels[0].config = 0x100;  // 中断使能
-    priv->channels[0].ctrl = 0x01;     // 启用通道
-    priv->channels[0].status = 0x00;   // 初始状态
-    printf("[%s:%s] Test DMA transfer configured and started for %s\n", __FILE__, __func__, priv->instance_name);
+    // 创建并行执行池（失败时退化为在监控线程上单线程执行）
+    priv->pool = dma_pool_create(0, 0);
+    if (priv->pool) {
+        dma_pool_stats_t stats;
+        dma_pool_get_stats(priv->pool, &stats);
+        printf("[%s:%s] %s DMA worker pool: %u workers, chunk %zu bytes, parallel from %zu bytes\n", 
+               __FILE__, __func__, priv->instance_name, stats.threads, stats.chunk_size, stats.parallel_min);
+    }
+    
+    // 立即启动监控线程
+    dma_start_monitor(plugin);
     
     printf("[%s:%s] %s DMA plugin initialized\n", __FILE__, __func__, priv->instance_name);
     return 0;
 }
 
+// 保存设备状态
+static size_t dma_save_state(simulator_plugin_t *plugin, void *buf, size_t size) {
+    dma_private_t *priv = (dma_private_t*)plugin->private_data;
+    dma_state_t state;
+    
+    if (size < sizeof(state)) {
+        return 0;
+    }
+    memset(&state, 0, sizeof(state));
+    memcpy(state.regs, priv->regs, sizeof(state.regs));
+    state.active_mask = __atomic_load_n(&priv->active_mask, __ATOMIC_ACQUIRE);
+    state.pending_mask = __atomic_load_n(&priv->pending_mask, __ATOMIC_ACQUIRE);
+    state.enabled = priv->enabled;
+    state.irq_asserted = __atomic_load_n(&priv->irq_asserted, __ATOMIC_ACQUIRE);
+    state.transfer_count = priv->transfer_count;
+    state.dma_global_ctrl = priv->dma_global_ctrl;
+    state.dma_global_status = priv->dma_global_status;
+    state.dma_int_status = __atomic_load_n(&priv->dma_int_status, __ATOMIC_ACQUIRE);
+    state.dma_int_err_status = __atomic_load_n(&priv->dma_int_err_status, __ATOMIC_ACQUIRE);
+    state.int_mod_cnt = priv->int_mod_cnt;
+    state.int_mod_time = priv->int_mod_time;
+    memcpy(buf, &state, sizeof(state));
+    return sizeof(state);
+}
+
+// 恢复设备状态：已启动未执行的通道交给监控线程继续执行
+static int dma_load_state(simulator_plugin_t *plugin, const void *buf, size_t size) {
+    dma_private_t *priv = (dma_private_t*)plugin->private_data;
+    dma_state_t state;
+    
+    if (size != sizeof(state)) {
+        return -1;
+    }
+    memcpy(&state, buf, sizeof(state));
+    memcpy(priv->regs, state.regs, sizeof(priv->regs));
+    priv->enabled = state.enabled;
+    priv->transfer_count = state.transfer_count;
+    priv->dma_global_ctrl = state.dma_global_ctrl;
+    priv->dma_global_status = state.dma_global_status;
+    priv->int_mod_cnt = state.int_mod_cnt;
+    priv->int_mod_time = state.int_mod_time;
+    irq_mod_configure(&priv->irq_mod, priv->int_mod_cnt, priv->int_mod_time);
+    __atomic_store_n(&priv->dma_int_status, state.dma_int_status, __ATOMIC_RELEASE);
+    __atomic_store_n(&priv->dma_int_err_status, state.dma_int_err_status, __ATOMIC_RELEASE);
+    __atomic_store_n(&priv->irq_asserted, state.irq_asserted, __ATOMIC_RELEASE);
+    __atomic_store_n(&priv->active_mask, state.active_mask, __ATOMIC_RELEASE);
+    __atomic_store_n(&priv->pending_mask, state.pending_mask, __ATOMIC_RELEASE);
+    if (state.pending_mask) {
+        sem_post(&priv->work_sem);
+    }
+    return 0;
+}
+
+// 运行时观测：全局寄存器、已配置通道的寄存器，以及待执行通道和未上报中断的深度
+static int dma_inspect(simulator_plugin_t *plugin, plugin_inspect_item_t *items, int max) {
+    static const struct {
+        int reg;
+        const char *name;
+    } channel_regs[] = {
+        {DMA_CH_REG_SRC, "SRC"}, {DMA_CH_REG_DST, "DST"}, {DMA_CH_REG_CTRL, "CTRL"},
+        {DMA_CH_REG_CONFIG, "CONFIG"}, {DMA_CH_REG_STATUS, "STATUS"},
+    };
+    dma_private_t *priv = (dma_private_t*)plugin->private_data;
+    irq_mod_stats_t mod;
+    char name[24];
+    int count = 0;
+    
+    if (!priv) {
+        return 0;
+    }
+    uint32_t tc_status = __atomic_load_n(&priv->dma_int_status, __ATOMIC_ACQUIRE);
+    uint32_t err_status = __atomic_load_n(&priv->dma_int_err_status, __ATOMIC_ACQUIRE);
+    uint32_t active = __atomic_load_n(&priv->active_mask, __ATOMIC_ACQUIRE);
+    uint32_t pending = __atomic_load_n(&priv->pending_mask, __ATOMIC_ACQUIRE);
+    irq_mod_get_stats(&priv->irq_mod, &mod);
+    
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IntStatus", priv->base_addr + DMA_GREG_INT_STATUS,
+                       tc_status | err_status, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IntTCStatus", priv->base_addr + DMA_GREG_INT_TC_STATUS,
+                       tc_status, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IntErrStatus", priv->base_addr + DMA_GREG_INT_ERR_STATUS,
+                       err_status, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "EnbldChns", priv->base_addr + DMA_GREG_ENBLD_CHNS,
+                       active, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "Config", priv->base_addr + DMA_GREG_CONFIG,
+                       priv->dma_global_ctrl, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IntModCnt", priv->base_addr + DMA_GREG_INT_MOD_CNT,
+                       priv->int_mod_cnt, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IntModTime", priv->base_addr + DMA_GREG_INT_MOD_TIME,
+                       priv->int_mod_time, 0);
+    
+    // 只列出配置过的通道，16个通道全部展开会淹没有用的信息
+    for (int ch = 0; ch < DMA_PLUGIN_CHANNELS; ch++) {
+        if (priv->regs[DMA_CH_REG_CONFIG][ch] == 0 && priv->regs[DMA_CH_REG_STATUS][ch] == 0) {
+            continue;
+        }
+        for (size_t r = 0; r < sizeof(channel_regs) / sizeof(channel_regs[0]); r++) {
+            snprintf(name, sizeof(name), "ch%d.%s", ch, channel_regs[r].name);
+            plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, name,
+                               priv->channel_base_addr + ((uint32_t)ch << DMA_CH_SHIFT) + ((uint32_t)channel_regs[r].reg << 2),
+                               priv->regs[channel_regs[r].reg][ch], 0);
+        }
+    }
+    
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_QUEUE, "pending_channels", 0,
+                       (uint32_t)__builtin_popcount(pending), DMA_PLUGIN_CHANNELS);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_QUEUE, "active_channels", 0,
+                       (uint32_t)__builtin_popcount(active), DMA_PLUGIN_CHANNELS);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_QUEUE, "irq_pending", 0, mod.pending, priv->int_mod_cnt);
+    return count;
+}
+
 // DMA清理
 static void dma_cleanup(simulator_plugin_t *plugin) {
     if (plugin && plugin->private_data) {
@@ -335,11 +768,21 @@ static void dma_cleanup(simulator_plugin_t *plugin) {
         if (priv->simulation_running) {
             priv->simulation_running = false;
             if (priv->monitor_thread) {
+                sem_post(&priv->work_sem);
                 pthread_join(priv->monitor_thread, NULL);
                 printf("[%s:%s] %s DMA monitor thread joined\n", __FILE__, __func__, priv->instance_name);
             }
         }
         
+        irq_mod_stats_t stats;
+        irq_mod_get_stats(&priv->irq_mod, &stats);
+        printf("[%s:%s] %s DMA interrupts: %llu events, %llu raised, %llu suppressed\n", 
+               __FILE__, __func__, priv->instance_name, (unsigned long long)stats.events,
+               (unsigned long long)stats.raised, (unsigned long long)stats.suppressed);
+        irq_mod_destroy(&priv->irq_mod);
+        
+        dma_pool_destroy(priv->pool);
+        sem_destroy(&priv->work_sem);
         free(plugin->private_data);
         plugin->private_data = NULL;
     }
@@ -375,6 +818,9 @@ static simulator_plugin_t* create_dma_plugin_instance(const char *instance_name,
     plugin->reg_read = dma_reg_read;
     plugin->reg_write = dma_reg_write;
     plugin->interrupt = dma_interrupt;
+    plugin->save_state = dma_save_state;
+    plugin->load_state = dma_load_state;
+    plugin->inspect = dma_inspect;
     
     printf("[%s:%s] DMA plugin '%s' created\n", __FILE__, __func__, plugin->name);
     return plugin;
@@ -0,0 +1,293 @@
+// sysconf(_SC_LEVEL2_CACHE_SIZE)是glibc扩展
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dma_workers.h"
+#include "dma_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define DMA_POOL_MAX_THREADS     32
+#define DMA_POOL_DEFAULT_CHUNK   (256u * 1024u)   // 取不到缓存大小时的分块大小
+#define DMA_POOL_MIN_CHUNK       (64u * 1024u)
+#define DMA_POOL_PARALLEL_CHUNKS 4                // 至少4个分块才值得唤醒工作线程
+
+// 一个分块化的传输任务
+typedef struct {
+    uint8_t *dst;
+    const uint8_t *src;      // 填充任务时为NULL
+    size_t len;
+    size_t chunk_size;
+    size_t chunk_count;
+    uint32_t pattern;
+    uint32_t elem_size;
+    size_t next_chunk;       // 下一个待领取的分块（原子）
+    size_t chunks_left;      // 未完成的分块数（原子）
+} dma_pool_job_t;
+
+struct dma_pool {
+    pthread_t threads[DMA_POOL_MAX_THREADS];
+    uint32_t thread_count;
+    size_t chunk_size;
+    size_t parallel_min;
+
+    pthread_mutex_t submit_lock;   // 串行化提交者，保证传输之间的顺序
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;      // 新任务到达
+    pthread_cond_t done_cond;      // 任务全部完成
+    dma_pool_job_t *job;
+    uint64_t generation;
+    uint32_t active_workers;       // 仍在访问当前任务的工作线程数
+    bool stopping;
+
+    dma_pool_stats_t stats;
+};
+
+// 执行一个分块
+static void dma_pool_run_chunk(dma_pool_job_t *job, size_t index) {
+    size_t off = index * job->chunk_size;
+    size_t len = job->len - off < job->chunk_size ? job->len - off : job->chunk_size;
+
+    if (job->src) {
+        // 波内各分块互不重叠，可以直接memcpy语义执行
+        dma_kernel_copy(job->dst + off, job->src + off, len);
+    } else {
+        // 分块大小是8的倍数，模式在块边界处保持连续
+        dma_kernel_fill(job->dst + off, job->pattern, job->elem_size, len);
+    }
+}
+
+// 领取并执行分块，直到任务的分块被领完
+static size_t dma_pool_drain(dma_pool_job_t *job) {
+    size_t done = 0;
+    for (;;) {
+        size_t index = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED);
+        if (index >= job->chunk_count) {
+            break;
+        }
+        dma_pool_run_chunk(job, index);
+        done++;
+    }
+    return done;
+}
+
+// 工作线程
+static void* dma_pool_worker(void *arg) {
+    dma_pool_t *pool = (dma_pool_t*)arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        seen = pool->generation;
+        dma_pool_job_t *job = pool->job;
+        if (!job) {
+            continue;  // 醒得太晚，任务已由其他线程完成
+        }
+        pool->active_workers++;
+        pthread_mutex_unlock(&pool->lock);
+
+        size_t done = dma_pool_drain(job);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->active_workers--;
+        if (done) {
+            job->chunks_left -= done;
+        }
+        if (job->chunks_left == 0 && pool->active_workers == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// 把一个无内部重叠的区间交给工作线程执行，提交线程也参与执行，全部完成后返回
+static void dma_pool_run_job(dma_pool_t *pool, dma_pool_job_t *job) {
+    job->chunk_size = pool->chunk_size;
+    job->chunk_count = (job->len + job->chunk_size - 1) / job->chunk_size;
+    job->next_chunk = 0;
+    job->chunks_left = job->chunk_count;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->generation++;
+    pool->stats.jobs_parallel++;
+    pool->stats.chunks += job->chunk_count;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    size_t done = dma_pool_drain(job);
+
+    // 等待所有分块完成，且没有工作线程再引用job（job在调用者栈上）
+    pthread_mutex_lock(&pool->lock);
+    job->chunks_left -= done;
+    while (job->chunks_left != 0 || pool->active_workers != 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pool->job = NULL;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// 读取L2缓存大小作为分块大小，留一半给源数据
+static size_t dma_pool_default_chunk(void) {
+    size_t chunk = DMA_POOL_DEFAULT_CHUNK;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 > 0) {
+        chunk = (size_t)l2 / 2;
+    }
+#endif
+    if (chunk < DMA_POOL_MIN_CHUNK) {
+        chunk = DMA_POOL_MIN_CHUNK;
+    }
+    return chunk & ~(size_t)63;  // 按缓存行对齐，同时保证是8的倍数
+}
+
+dma_pool_t* dma_pool_create(uint32_t threads, size_t chunk_size) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        // 提交线程本身也参与执行
+        threads = cpus > 1 ? (uint32_t)(cpus - 1) : 0;
+    }
+    if (threads > DMA_POOL_MAX_THREADS) {
+        threads = DMA_POOL_MAX_THREADS;
+    }
+    if (chunk_size == 0) {
+        chunk_size = dma_pool_default_chunk();
+    }
+    chunk_size = (chunk_size + 7) & ~(size_t)7;
+
+    dma_pool_t *pool = malloc(sizeof(dma_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    memset(pool, 0, sizeof(dma_pool_t));
+    pool->chunk_size = chunk_size;
+    pool->parallel_min = chunk_size * DMA_POOL_PARALLEL_CHUNKS;
+    pthread_mutex_init(&pool->submit_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (uint32_t i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, dma_pool_worker, pool) != 0) {
+            printf("[%s:%s] Failed to create DMA worker %u, continuing with %u workers\n",
+                   __FILE__, __func__, i, i);
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    pool->stats.threads = pool->thread_count;
+    pool->stats.chunk_size = pool->chunk_size;
+    pool->stats.parallel_min = pool->parallel_min;
+    return pool;
+}
+
+void dma_pool_destroy(dma_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (uint32_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->submit_lock);
+    free(pool);
+}
+
+// 是否值得并行执行
+static bool dma_pool_use_workers(dma_pool_t *pool, size_t len) {
+    return pool && pool->thread_count > 0 && len >= pool->parallel_min;
+}
+
+void dma_pool_copy(dma_pool_t *pool, void *dst, const void *src, size_t len) {
+    uint8_t *d = (uint8_t*)dst;
+    const uint8_t *s = (const uint8_t*)src;
+    size_t gap = d > s ? (size_t)(d - s) : (size_t)(s - d);
+
+    // 重叠距离不足以切出足够的分块时，直接memmove
+    size_t wave = gap < len ? gap : len;
+    if (!dma_pool_use_workers(pool, wave) || d == s) {
+        if (pool) {
+            __atomic_fetch_add(&pool->stats.jobs_inline, 1, __ATOMIC_RELAXED);
+        }
+        dma_kernel_copy(d, s, len);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit_lock);
+
+    // 重叠时按距离分波：每一波写入的范围只覆盖已被前面的波读完的源数据
+    // d < s 从低地址向高地址推进，d > s 从高地址向低地址推进
+    size_t done = 0;
+    while (done < len) {
+        size_t n = len - done < wave ? len - done : wave;
+        size_t off = d < s ? done : len - done - n;
+        dma_pool_job_t job;
+        memset(&job, 0, sizeof(job));
+        job.dst = d + off;
+        job.src = s + off;
+        job.len = n;
+        if (n >= pool->parallel_min) {
+            dma_pool_run_job(pool, &job);
+        } else {
+            dma_kernel_copy(job.dst, job.src, n);
+        }
+        done += n;
+    }
+
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+void dma_pool_fill(dma_pool_t *pool, void *dst, uint32_t pattern, uint32_t elem_size, size_t len) {
+    if (!dma_pool_use_workers(pool, len)) {
+        if (pool) {
+            __atomic_fetch_add(&pool->stats.jobs_inline, 1, __ATOMIC_RELAXED);
+        }
+        dma_kernel_fill(dst, pattern, elem_size, len);
+        return;
+    }
+
+    dma_pool_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.dst = (uint8_t*)dst;
+    job.len = len;
+    job.pattern = pattern;
+    job.elem_size = elem_size;
+
+    pthread_mutex_lock(&pool->submit_lock);
+    dma_pool_run_job(pool, &job);
+    pthread_mutex_unlock(&pool->submit_lock);
+}
+
+void dma_pool_get_stats(dma_pool_t *pool, dma_pool_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    *stats = pool->stats;
+    stats->jobs_inline = __atomic_load_n(&pool->stats.jobs_inline, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&pool->lock);
+}
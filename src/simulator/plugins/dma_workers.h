@@ -0,0 +1,41 @@
+#ifndef DMA_WORKERS_H
+#define DMA_WORKERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// DMA宿主并行执行池 - 把大块内存到内存传输切成适合缓存的分块，由多个工作线程并行执行
+//
+// 语义保证：
+//   - dma_pool_copy/dma_pool_fill 在全部分块完成后才返回，调用者据此设置DONE并上报中断
+//   - 源和目标重叠时结果与memmove一致：按"重叠距离"分波执行，波内并行、波间串行
+//   - 同一时刻池中只执行一个传输，多线程提交时按提交顺序串行化
+
+typedef struct dma_pool dma_pool_t;
+
+// 执行池统计
+typedef struct {
+    uint32_t threads;        // 工作线程数（不含提交线程）
+    size_t chunk_size;       // 分块大小（字节）
+    size_t parallel_min;     // 达到该大小才并行执行
+    uint64_t jobs_parallel;  // 并行执行的传输数
+    uint64_t jobs_inline;    // 在提交线程上直接执行的传输数
+    uint64_t chunks;         // 执行的分块总数
+} dma_pool_stats_t;
+
+// 创建执行池：threads为0时按在线CPU数自动选择，chunk_size为0时按L2缓存大小选择
+dma_pool_t* dma_pool_create(uint32_t threads, size_t chunk_size);
+
+// 停止工作线程并释放执行池
+void dma_pool_destroy(dma_pool_t *pool);
+
+// 内存到内存拷贝（允许重叠），pool为NULL时退化为单线程拷贝
+void dma_pool_copy(dma_pool_t *pool, void *dst, const void *src, size_t len);
+
+// 常量填充，pattern按elem_size复制
+void dma_pool_fill(dma_pool_t *pool, void *dst, uint32_t pattern, uint32_t elem_size, size_t len);
+
+// 读取统计信息
+void dma_pool_get_stats(dma_pool_t *pool, dma_pool_stats_t *stats);
+
+#endif // DMA_WORKERS_H
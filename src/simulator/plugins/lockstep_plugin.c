@@ -0,0 +1,982 @@
+#define _GNU_SOURCE
+
+#include "lockstep_plugin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#define LOCKSTEP_RING            4096                   // 访问队列长度（2的幂）
+#define LOCKSTEP_BATCH           64                     // 攒够一批再唤醒候选线程
+#define LOCKSTEP_HISTORY         16                     // 分歧时打印的最近访问数
+#define LOCKSTEP_POLL_NS         1000000ULL             // 不足一批时候选线程最多等1ms
+#define LOCKSTEP_DRAIN_NS        (5ULL * 1000000000ULL) // 等待候选线程追上的上限
+#define LOCKSTEP_STATE_SIZE      4096
+#define LOCKSTEP_MAX_INSTANCES   8
+#define LOCKSTEP_MAX_TIMERS      4                      // 每个实现可创建的虚拟时间定时器数
+
+typedef enum {
+    LOCKSTEP_OP_READ = 0,
+    LOCKSTEP_OP_WRITE,
+    LOCKSTEP_OP_CLOCK,
+    LOCKSTEP_OP_RESET,
+    LOCKSTEP_OP_INTERRUPT,
+    LOCKSTEP_OP_INPUT,
+    LOCKSTEP_OP_TIMER
+} lockstep_op_type_t;
+
+static const char *const g_op_names[] = { "read", "write", "clock", "reset", "interrupt", "input", "timer" };
+
+// 总线主设备（DMA）的一次总线访问
+typedef enum {
+    LOCKSTEP_BUS_MAP_R = 0,     // 映射内存用于读
+    LOCKSTEP_BUS_MAP_W,         // 映射内存用于写
+    LOCKSTEP_BUS_READ,          // 外设寄存器读
+    LOCKSTEP_BUS_WRITE          // 外设寄存器写
+} lockstep_bus_kind_t;
+
+static const char *const g_bus_names[] = { "mapped for read", "mapped for write", "read", "wrote" };
+
+// 参考实现的一次总线访问及其结果，候选实现的同一访问按它比对和回放
+typedef struct lockstep_bus_entry {
+    struct lockstep_bus_entry *next;
+    uint8_t kind;
+    uint32_t addr;
+    uint32_t len;           // 映射长度（寄存器访问为0）
+    uint32_t value;         // 读出值/写入值
+    int result;             // 寄存器访问的返回码
+    bool mapped;            // 映射得到了内存（否则DMA改走寄存器访问）
+    bool complete;          // 结果已全部记录（用于写的映射要等到unmap）
+    bool consumed;          // 候选实现已取走
+    bool held;              // 候选实现仍在使用（用于写的映射在unmap时比对）
+    const void *ref_ptr;
+    uint8_t *before;        // 映射时的内存内容
+    uint8_t *after;         // 用于写的映射在unmap时的内存内容
+} lockstep_bus_entry_t;
+
+// 候选实现映射到的私有副本
+typedef struct {
+    lockstep_bus_entry_t *entry;
+    uint8_t data[];
+} lockstep_shadow_t;
+
+// 一次访问：arg0为地址/时钟动作/复位动作/中断号/输入通道/定时器号，arg1为写入值/周期数/输入值
+typedef struct {
+    uint64_t seq;
+    uint64_t vtime;         // 参考实现执行时的虚拟时间
+    uint8_t type;
+    uint32_t arg0;
+    uint32_t arg1;
+    uint32_t ref_result;    // 读出值或返回码
+    uint32_t cand_result;
+} lockstep_op_t;
+
+// 虚拟时间定时器：参考实现的定时器是仿真器的全局定时器，候选实现的只记下到期时刻
+typedef struct {
+    void (*fn)(void *fn_ctx, uint64_t vtime_ns);
+    void *fn_ctx;
+    bool used;
+    int id;                         // 参考实现：全局定时器编号
+    uint64_t deadline_ns;           // 候选实现：到期时刻，0为未启动
+    simulator_plugin_t *lockstep;   // 参考实现：到期时回到包装插件
+} lockstep_timer_t;
+
+typedef struct {
+    simulator_plugin_t *ref;
+    simulator_plugin_t *cand;
+
+    // 参考执行和入队在同一把锁内完成，队列顺序即参考实现看到的顺序
+    pthread_mutex_t lock;
+    lockstep_op_t ring[LOCKSTEP_RING];
+    uint64_t head;          // 生产者写入位置（持锁修改）
+    uint64_t tail;          // 候选线程比对位置
+    uint64_t signaled;      // 上次唤醒时的head
+    sem_t wakeup;
+    pthread_t thread;
+    bool thread_running;
+    bool stop;
+
+    // 参考实现的总线访问日志：候选实现的总线访问只和日志比对、从日志取数，不接触真实内存和外设
+    pthread_mutex_t bus_lock;
+    pthread_cond_t bus_cond;
+    lockstep_bus_entry_t *bus_head;
+    lockstep_bus_entry_t *bus_tail;
+    plugin_bus_ops_t ref_bus;
+    plugin_bus_ops_t cand_bus;
+
+    // 参考实现的定时器到期作为一次访问入队，候选实现的同号定时器在队列中的同一位置到期；
+    // 候选实现看到的虚拟时间是它正在执行的访问入队时的值（只在候选线程上读写）
+    plugin_vtime_ops_t ref_vtime;
+    plugin_vtime_ops_t cand_vtime;
+    lockstep_timer_t ref_timers[LOCKSTEP_MAX_TIMERS];
+    lockstep_timer_t cand_timers[LOCKSTEP_MAX_TIMERS];
+    uint64_t cand_now;
+
+    lockstep_op_t history[LOCKSTEP_HISTORY];
+    pthread_mutex_t report_lock;    // 分歧可能同时在候选线程和候选实现的后台线程上发现
+    lockstep_report_t report;
+} lockstep_private_t;
+
+static simulator_plugin_t *g_instances[LOCKSTEP_MAX_INSTANCES];
+static int g_instance_count = 0;
+
+extern void* get_mapped_range(uint32_t addr, uint32_t len);
+extern int sim_bus_read(uint32_t addr, uint32_t *value);
+extern int sim_bus_write(uint32_t addr, uint32_t value);
+extern uint64_t sim_vtime_now(void);
+extern int sim_vtimer_create(void (*fn)(void *ctx, uint64_t vtime_ns), void *ctx);
+extern void sim_vtimer_arm(int id, uint64_t deadline_ns);
+extern void sim_vtimer_destroy(int id);
+
+static uint64_t lockstep_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// bus_cond按CLOCK_MONOTONIC计时
+static struct timespec lockstep_deadline(uint64_t ns) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec += (long)(ns % 1000000000ULL);
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// ---- 候选线程 ----
+
+static uint32_t lockstep_exec(simulator_plugin_t *plugin, const lockstep_op_t *op) {
+    switch (op->type) {
+        case LOCKSTEP_OP_READ:
+            // 读之前走一个时钟节拍，让后台线程上已启动的工作（如DMA传输）在当前线程完成，
+            // 两个实现在同一访问点上看到的设备进度一致
+            if (plugin->clock) {
+                plugin->clock(plugin, CLOCK_TICK, 0);
+            }
+            return plugin->reg_read ? plugin->reg_read(plugin, op->arg0) : 0;
+        case LOCKSTEP_OP_WRITE:
+            return plugin->reg_write ? (uint32_t)plugin->reg_write(plugin, op->arg0, op->arg1) : 0;
+        case LOCKSTEP_OP_CLOCK:
+            return plugin->clock ? (uint32_t)plugin->clock(plugin, (clock_action_t)op->arg0, op->arg1) : 0;
+        case LOCKSTEP_OP_RESET:
+            return plugin->reset ? (uint32_t)plugin->reset(plugin, (reset_action_t)op->arg0) : 0;
+        case LOCKSTEP_OP_INTERRUPT:
+            return plugin->interrupt ? (uint32_t)plugin->interrupt(plugin, op->arg0) : 0;
+        case LOCKSTEP_OP_INPUT:
+            return plugin->input ? (uint32_t)plugin->input(plugin, op->arg0, op->arg1) : 0;
+    }
+    return 0;
+}
+
+static void lockstep_print_op(const lockstep_op_t *op, const char *marker) {
+    printf("    %s #%-8llu %-9s 0x%08X 0x%08X  ref=0x%08X cand=0x%08X\n", marker,
+           (unsigned long long)op->seq, g_op_names[op->type], op->arg0, op->arg1,
+           op->ref_result, op->cand_result);
+}
+
+// 记录第一处分歧并打印最近的访问作为上下文
+static void lockstep_diverge(simulator_plugin_t *plugin, const lockstep_op_t *op, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void lockstep_diverge(simulator_plugin_t *plugin, const lockstep_op_t *op, const char *fmt, ...) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    va_list ap;
+
+    pthread_mutex_lock(&priv->report_lock);
+    if (priv->report.diverged) {
+        pthread_mutex_unlock(&priv->report_lock);
+        return;
+    }
+    va_start(ap, fmt);
+    vsnprintf(priv->report.diverge_reason, sizeof(priv->report.diverge_reason), fmt, ap);
+    va_end(ap);
+    priv->report.diverge_op = op ? op->seq : priv->report.ops;
+    __atomic_store_n(&priv->report.diverged, true, __ATOMIC_RELEASE);
+
+    printf("[%s:%s] %s lockstep divergence at op %llu: %s\n", __FILE__, __func__, plugin->name,
+           (unsigned long long)priv->report.diverge_op, priv->report.diverge_reason);
+    if (op) {
+        uint64_t first = op->seq >= LOCKSTEP_HISTORY - 1 ? op->seq - (LOCKSTEP_HISTORY - 1) : 0;
+        for (uint64_t s = first; s < op->seq; s++) {
+            lockstep_print_op(&priv->history[s % LOCKSTEP_HISTORY], " ");
+        }
+        lockstep_print_op(op, ">");
+    }
+    pthread_mutex_unlock(&priv->report_lock);
+}
+
+// 参考实现的定时器已到期：候选实现的同号定时器也应已到期，回调它；未到期返回1
+static uint32_t lockstep_cand_timer_expired(lockstep_private_t *priv, const lockstep_op_t *op) {
+    lockstep_timer_t *t = op->arg0 < LOCKSTEP_MAX_TIMERS ? &priv->cand_timers[op->arg0] : NULL;
+
+    if (!t || !t->used || t->deadline_ns == 0 || t->deadline_ns > op->vtime) {
+        return 1;
+    }
+    t->deadline_ns = 0;     // 先清零，回调中可以重新启动
+    t->fn(t->fn_ctx, op->vtime);
+    return 0;
+}
+
+static void lockstep_compare(simulator_plugin_t *plugin, lockstep_op_t *op) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+
+    priv->cand_now = op->vtime;
+    op->cand_result = op->type == LOCKSTEP_OP_TIMER ? lockstep_cand_timer_expired(priv, op)
+                                                    : lockstep_exec(priv->cand, op);
+    if (op->cand_result != op->ref_result) {
+        if (op->type == LOCKSTEP_OP_READ) {
+            priv->report.read_mismatches++;
+            lockstep_diverge(plugin, op, "read 0x%08X returned 0x%08X, reference 0x%08X",
+                             op->arg0, op->cand_result, op->ref_result);
+        } else if (op->type == LOCKSTEP_OP_TIMER) {
+            lockstep_diverge(plugin, op, "timer %u expired at %llu ns, candidate's was not due",
+                             op->arg0, (unsigned long long)op->vtime);
+        } else {
+            lockstep_diverge(plugin, op, "%s 0x%08X returned %d, reference %d", g_op_names[op->type],
+                             op->arg0, (int)op->cand_result, (int)op->ref_result);
+        }
+    }
+    priv->history[op->seq % LOCKSTEP_HISTORY] = *op;
+    priv->report.ops++;
+}
+
+static void* lockstep_thread(void *arg) {
+    simulator_plugin_t *plugin = (simulator_plugin_t*)arg;
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+
+    // 中断信号只递送给驱动线程
+    sigset_t all;
+    sigfillset(&all);
+    sigdelset(&all, SIGSYS);    // hotpath-check经SIGSYS统计系统调用
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    for (;;) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LOCKSTEP_POLL_NS;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (sem_timedwait(&priv->wakeup, &deadline) != 0 && errno == EINTR) {
+        }
+
+        uint64_t head = __atomic_load_n(&priv->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = priv->tail;
+        while (tail < head) {
+            lockstep_compare(plugin, &priv->ring[tail & (LOCKSTEP_RING - 1)]);
+            tail++;
+            __atomic_store_n(&priv->tail, tail, __ATOMIC_RELEASE);
+        }
+        if (__atomic_load_n(&priv->stop, __ATOMIC_ACQUIRE) &&
+            tail == __atomic_load_n(&priv->head, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// ---- 总线访问日志 ----
+
+// 持bus_lock调用：释放表头上候选实现已用完的日志项
+static void lockstep_bus_reclaim(lockstep_private_t *priv) {
+    lockstep_bus_entry_t *e;
+
+    while ((e = priv->bus_head) && e->consumed && e->complete && !e->held) {
+        priv->bus_head = e->next;
+        if (!priv->bus_head) {
+            priv->bus_tail = NULL;
+        }
+        free(e->before);
+        free(e->after);
+        free(e);
+    }
+}
+
+static void lockstep_bus_append(lockstep_private_t *priv, lockstep_bus_entry_t *e) {
+    pthread_mutex_lock(&priv->bus_lock);
+    if (priv->bus_tail) {
+        priv->bus_tail->next = e;
+    } else {
+        priv->bus_head = e;
+    }
+    priv->bus_tail = e;
+    lockstep_bus_reclaim(priv);
+    pthread_cond_broadcast(&priv->bus_cond);
+    pthread_mutex_unlock(&priv->bus_lock);
+}
+
+// 参考实现：访问真实总线并记入日志
+static void* lockstep_ref_map(void *ctx, uint32_t addr, uint32_t len, bool write) {
+    lockstep_private_t *priv = (lockstep_private_t*)ctx;
+    void *ptr = get_mapped_range(addr, len);
+    lockstep_bus_entry_t *e = calloc(1, sizeof(*e));
+
+    if (!e) {
+        return ptr;     // 日志缺这一项，候选实现的同一访问记为分歧
+    }
+    e->kind = write ? LOCKSTEP_BUS_MAP_W : LOCKSTEP_BUS_MAP_R;
+    e->addr = addr;
+    e->len = len;
+    e->mapped = ptr != NULL;
+    e->complete = !(ptr && write);
+    e->ref_ptr = ptr;
+    if (ptr && (e->before = malloc(len)) != NULL) {
+        memcpy(e->before, ptr, len);
+    }
+    lockstep_bus_append(priv, e);
+    return ptr;
+}
+
+static void lockstep_ref_unmap(void *ctx, void *ptr, uint32_t addr, uint32_t len, bool write) {
+    lockstep_private_t *priv = (lockstep_private_t*)ctx;
+
+    if (!write) {
+        return;
+    }
+    pthread_mutex_lock(&priv->bus_lock);
+    for (lockstep_bus_entry_t *e = priv->bus_head; e; e = e->next) {
+        if (e->kind == LOCKSTEP_BUS_MAP_W && !e->complete && e->ref_ptr == ptr &&
+            e->addr == addr && e->len == len) {
+            if ((e->after = malloc(len)) != NULL) {
+                memcpy(e->after, ptr, len);
+            }
+            e->complete = true;
+            break;
+        }
+    }
+    lockstep_bus_reclaim(priv);
+    pthread_cond_broadcast(&priv->bus_cond);
+    pthread_mutex_unlock(&priv->bus_lock);
+}
+
+static int lockstep_ref_read(void *ctx, uint32_t addr, uint32_t *value) {
+    lockstep_bus_entry_t *e = calloc(1, sizeof(*e));
+    int result = sim_bus_read(addr, value);
+
+    if (e) {
+        e->kind = LOCKSTEP_BUS_READ;
+        e->addr = addr;
+        e->value = *value;
+        e->result = result;
+        e->complete = true;
+        lockstep_bus_append((lockstep_private_t*)ctx, e);
+    }
+    return result;
+}
+
+static int lockstep_ref_write(void *ctx, uint32_t addr, uint32_t value) {
+    lockstep_bus_entry_t *e = calloc(1, sizeof(*e));
+    int result = sim_bus_write(addr, value);
+
+    if (e) {
+        e->kind = LOCKSTEP_BUS_WRITE;
+        e->addr = addr;
+        e->value = value;
+        e->result = result;
+        e->complete = true;
+        lockstep_bus_append((lockstep_private_t*)ctx, e);
+    }
+    return result;
+}
+
+// 持bus_lock调用：取走参考实现日志中最早一条未取走的同类访问，参考实现还没执行到时等待
+// 已有分歧时不再等待，避免每个多出的访问都等满超时
+static lockstep_bus_entry_t* lockstep_bus_take(lockstep_private_t *priv, uint8_t kind, uint32_t addr, uint32_t len) {
+    struct timespec deadline = lockstep_deadline(
+        __atomic_load_n(&priv->report.diverged, __ATOMIC_ACQUIRE) ? 0 : LOCKSTEP_DRAIN_NS);
+    bool timed_out = false;
+
+    for (;;) {
+        for (lockstep_bus_entry_t *e = priv->bus_head; e; e = e->next) {
+            if (!e->consumed && e->kind == kind && e->addr == addr && e->len == len) {
+                e->consumed = true;
+                pthread_cond_broadcast(&priv->bus_cond);
+                return e;
+            }
+        }
+        if (timed_out) {
+            return NULL;
+        }
+        timed_out = pthread_cond_timedwait(&priv->bus_cond, &priv->bus_lock, &deadline) == ETIMEDOUT;
+    }
+}
+
+static void lockstep_bus_diverge(simulator_plugin_t *plugin, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void lockstep_bus_diverge(simulator_plugin_t *plugin, const char *fmt, ...) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    char reason[128];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(reason, sizeof(reason), fmt, ap);
+    va_end(ap);
+    __atomic_fetch_add(&priv->report.bus_mismatches, 1, __ATOMIC_RELAXED);
+    lockstep_diverge(plugin, NULL, "%s", reason);
+}
+
+// 候选实现：映射到参考实现映射时内存内容的私有副本
+static void* lockstep_cand_map(void *ctx, uint32_t addr, uint32_t len, bool write) {
+    simulator_plugin_t *plugin = (simulator_plugin_t*)ctx;
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    uint8_t kind = write ? LOCKSTEP_BUS_MAP_W : LOCKSTEP_BUS_MAP_R;
+    lockstep_shadow_t *shadow = NULL;
+
+    pthread_mutex_lock(&priv->bus_lock);
+    lockstep_bus_entry_t *e = lockstep_bus_take(priv, kind, addr, len);
+    bool found = e != NULL;
+    bool mapped = e && e->mapped;
+    if (mapped && e->before && (shadow = malloc(sizeof(*shadow) + len)) != NULL) {
+        shadow->entry = e;
+        memcpy(shadow->data, e->before, len);
+        e->held = write;
+    }
+    pthread_mutex_unlock(&priv->bus_lock);
+
+    if (!found) {
+        lockstep_bus_diverge(plugin, "candidate %s 0x%08X (%u bytes), reference did not",
+                             g_bus_names[kind], addr, len);
+    } else if (mapped && !shadow) {
+        lockstep_bus_diverge(plugin, "out of memory replaying map of 0x%08X (%u bytes)", addr, len);
+    }
+    return shadow ? shadow->data : NULL;
+}
+
+// 候选实现写完后和参考实现写完后的内存内容比对
+static void lockstep_cand_unmap(void *ctx, void *ptr, uint32_t addr, uint32_t len, bool write) {
+    simulator_plugin_t *plugin = (simulator_plugin_t*)ctx;
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    lockstep_shadow_t *shadow = (lockstep_shadow_t*)((uint8_t*)ptr - offsetof(lockstep_shadow_t, data));
+    lockstep_bus_entry_t *e = shadow->entry;
+
+    if (write) {
+        struct timespec deadline = lockstep_deadline(LOCKSTEP_DRAIN_NS);
+        pthread_mutex_lock(&priv->bus_lock);
+        while (!e->complete &&
+               pthread_cond_timedwait(&priv->bus_cond, &priv->bus_lock, &deadline) != ETIMEDOUT) {
+        }
+        uint32_t offset = 0;
+        uint8_t ref_byte = 0;
+        bool complete = e->complete && e->after;
+        while (complete && offset < len && shadow->data[offset] == e->after[offset]) {
+            offset++;
+        }
+        if (complete && offset < len) {
+            ref_byte = e->after[offset];
+        }
+        e->held = false;     // 之后日志项可能被回收
+        lockstep_bus_reclaim(priv);
+        pthread_cond_broadcast(&priv->bus_cond);
+        pthread_mutex_unlock(&priv->bus_lock);
+
+        if (!complete) {
+            lockstep_bus_diverge(plugin, "reference never finished writing 0x%08X (%u bytes)", addr, len);
+        } else if (offset < len) {
+            lockstep_bus_diverge(plugin, "candidate wrote 0x%02X to 0x%08X, reference 0x%02X",
+                                 shadow->data[offset], addr + offset, ref_byte);
+        }
+    }
+    free(shadow);
+}
+
+static int lockstep_cand_read(void *ctx, uint32_t addr, uint32_t *value) {
+    simulator_plugin_t *plugin = (simulator_plugin_t*)ctx;
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    int result = -1;
+
+    *value = 0;
+    pthread_mutex_lock(&priv->bus_lock);
+    lockstep_bus_entry_t *e = lockstep_bus_take(priv, LOCKSTEP_BUS_READ, addr, 0);
+    if (e) {
+        *value = e->value;
+        result = e->result;
+    }
+    lockstep_bus_reclaim(priv);
+    pthread_mutex_unlock(&priv->bus_lock);
+
+    if (!e) {
+        lockstep_bus_diverge(plugin, "candidate read 0x%08X, reference did not", addr);
+    }
+    return result;
+}
+
+static int lockstep_cand_write(void *ctx, uint32_t addr, uint32_t value) {
+    simulator_plugin_t *plugin = (simulator_plugin_t*)ctx;
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    uint32_t ref_value = 0;
+    int result = -1;
+
+    pthread_mutex_lock(&priv->bus_lock);
+    lockstep_bus_entry_t *e = lockstep_bus_take(priv, LOCKSTEP_BUS_WRITE, addr, 0);
+    if (e) {
+        ref_value = e->value;
+        result = e->result;
+    }
+    lockstep_bus_reclaim(priv);
+    pthread_mutex_unlock(&priv->bus_lock);
+
+    if (!e) {
+        lockstep_bus_diverge(plugin, "candidate wrote 0x%08X to 0x%08X, reference did not", value, addr);
+    } else if (value != ref_value) {
+        lockstep_bus_diverge(plugin, "candidate wrote 0x%08X to 0x%08X, reference 0x%08X", value, addr, ref_value);
+    }
+    return result;
+}
+
+// 等待候选实现重放完日志，返回参考实现做了而候选实现没有做的总线访问数
+static uint64_t lockstep_bus_settle(lockstep_private_t *priv) {
+    struct timespec deadline = lockstep_deadline(LOCKSTEP_DRAIN_NS);
+    bool timed_out = false;
+    uint64_t pending;
+
+    pthread_mutex_lock(&priv->bus_lock);
+    for (;;) {
+        pending = 0;
+        bool held = false;
+        for (lockstep_bus_entry_t *e = priv->bus_head; e; e = e->next) {
+            pending += !e->consumed;
+            held = held || e->held;
+        }
+        if ((pending == 0 && !held) || timed_out) {
+            break;
+        }
+        timed_out = pthread_cond_timedwait(&priv->bus_cond, &priv->bus_lock, &deadline) == ETIMEDOUT;
+    }
+    pthread_mutex_unlock(&priv->bus_lock);
+    return pending;
+}
+
+// ---- 访问路径 ----
+
+// 持锁调用：队列满时等待候选线程腾出空间
+static void lockstep_enqueue(lockstep_private_t *priv, const lockstep_op_t *op) {
+    uint64_t head = priv->head;
+
+    while (head - __atomic_load_n(&priv->tail, __ATOMIC_ACQUIRE) >= LOCKSTEP_RING) {
+        sem_post(&priv->wakeup);
+        sched_yield();
+    }
+    lockstep_op_t *slot = &priv->ring[head & (LOCKSTEP_RING - 1)];
+    *slot = *op;
+    slot->seq = head;
+    __atomic_store_n(&priv->head, head + 1, __ATOMIC_RELEASE);
+
+    // 寄存器访问按批交接，时钟/复位等控制操作立即唤醒
+    if (head + 1 - priv->signaled >= LOCKSTEP_BATCH ||
+        (op->type != LOCKSTEP_OP_READ && op->type != LOCKSTEP_OP_WRITE)) {
+        priv->signaled = head + 1;
+        sem_post(&priv->wakeup);
+    }
+}
+
+static uint32_t lockstep_forward(simulator_plugin_t *plugin, lockstep_op_type_t type, uint32_t arg0, uint32_t arg1) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    lockstep_op_t op = {0};
+
+    op.type = (uint8_t)type;
+    op.arg0 = arg0;
+    op.arg1 = arg1;
+    pthread_mutex_lock(&priv->lock);
+    op.vtime = sim_vtime_now();
+    op.ref_result = lockstep_exec(priv->ref, &op);
+    lockstep_enqueue(priv, &op);
+    pthread_mutex_unlock(&priv->lock);
+    return op.ref_result;
+}
+
+static uint32_t lockstep_reg_read(simulator_plugin_t *plugin, uint32_t address) {
+    return lockstep_forward(plugin, LOCKSTEP_OP_READ, address, 0);
+}
+
+static int lockstep_reg_write(simulator_plugin_t *plugin, uint32_t address, uint32_t value) {
+    return (int)lockstep_forward(plugin, LOCKSTEP_OP_WRITE, address, value);
+}
+
+static int lockstep_clock(simulator_plugin_t *plugin, clock_action_t action, uint32_t cycles) {
+    return (int)lockstep_forward(plugin, LOCKSTEP_OP_CLOCK, action, cycles);
+}
+
+static int lockstep_reset(simulator_plugin_t *plugin, reset_action_t action) {
+    return (int)lockstep_forward(plugin, LOCKSTEP_OP_RESET, action, 0);
+}
+
+static int lockstep_interrupt(simulator_plugin_t *plugin, uint32_t irq_num) {
+    return (int)lockstep_forward(plugin, LOCKSTEP_OP_INTERRUPT, irq_num, 0);
+}
+
+static int lockstep_input(simulator_plugin_t *plugin, uint32_t channel, uint32_t value) {
+    return (int)lockstep_forward(plugin, LOCKSTEP_OP_INPUT, channel, value);
+}
+
+// ---- 虚拟时间 ----
+
+static int lockstep_timer_alloc(lockstep_timer_t *timers, void (*fn)(void *fn_ctx, uint64_t vtime_ns), void *fn_ctx) {
+    for (int i = 0; i < LOCKSTEP_MAX_TIMERS; i++) {
+        if (!timers[i].used) {
+            timers[i] = (lockstep_timer_t){ .fn = fn, .fn_ctx = fn_ctx, .used = true, .id = -1 };
+            return i;
+        }
+    }
+    printf("[%s:%s] No free lockstep timer\n", __FILE__, __func__);
+    return -1;
+}
+
+// 参考实现的定时器到期（陷入路径）：和访问一样在锁内执行并入队，候选线程在同一位置让候选实现的定时器到期
+static void lockstep_ref_timer_expired(void *ctx, uint64_t vtime_ns) {
+    lockstep_timer_t *t = (lockstep_timer_t*)ctx;
+    lockstep_private_t *priv = (lockstep_private_t*)t->lockstep->private_data;
+    lockstep_op_t op = {0};
+
+    op.type = LOCKSTEP_OP_TIMER;
+    op.arg0 = (uint32_t)(t - priv->ref_timers);
+    op.vtime = vtime_ns;
+    pthread_mutex_lock(&priv->lock);
+    t->fn(t->fn_ctx, vtime_ns);
+    lockstep_enqueue(priv, &op);
+    pthread_mutex_unlock(&priv->lock);
+}
+
+static uint64_t lockstep_ref_now(void *ctx) {
+    (void)ctx;
+    return sim_vtime_now();
+}
+
+static int lockstep_ref_timer_create(void *ctx, void (*fn)(void *fn_ctx, uint64_t vtime_ns), void *fn_ctx) {
+    simulator_plugin_t *plugin = (simulator_plugin_t*)ctx;
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    int i = lockstep_timer_alloc(priv->ref_timers, fn, fn_ctx);
+
+    if (i < 0) {
+        return -1;
+    }
+    priv->ref_timers[i].lockstep = plugin;
+    priv->ref_timers[i].id = sim_vtimer_create(lockstep_ref_timer_expired, &priv->ref_timers[i]);
+    if (priv->ref_timers[i].id < 0) {
+        priv->ref_timers[i].used = false;
+        return -1;
+    }
+    return i;
+}
+
+static void lockstep_ref_timer_arm(void *ctx, int id, uint64_t deadline_ns) {
+    lockstep_private_t *priv = (lockstep_private_t*)((simulator_plugin_t*)ctx)->private_data;
+    if (id >= 0 && id < LOCKSTEP_MAX_TIMERS) {
+        sim_vtimer_arm(priv->ref_timers[id].id, deadline_ns);
+    }
+}
+
+static void lockstep_ref_timer_destroy(void *ctx, int id) {
+    lockstep_private_t *priv = (lockstep_private_t*)((simulator_plugin_t*)ctx)->private_data;
+    if (id >= 0 && id < LOCKSTEP_MAX_TIMERS && priv->ref_timers[id].used) {
+        sim_vtimer_destroy(priv->ref_timers[id].id);
+        priv->ref_timers[id].used = false;
+    }
+}
+
+// 候选实现：不接触全局定时器，到期时刻只在候选线程上随访问队列推进
+static uint64_t lockstep_cand_now(void *ctx) {
+    return ((lockstep_private_t*)ctx)->cand_now;
+}
+
+static int lockstep_cand_timer_create(void *ctx, void (*fn)(void *fn_ctx, uint64_t vtime_ns), void *fn_ctx) {
+    return lockstep_timer_alloc(((lockstep_private_t*)ctx)->cand_timers, fn, fn_ctx);
+}
+
+static void lockstep_cand_timer_arm(void *ctx, int id, uint64_t deadline_ns) {
+    lockstep_private_t *priv = (lockstep_private_t*)ctx;
+    if (id >= 0 && id < LOCKSTEP_MAX_TIMERS) {
+        priv->cand_timers[id].deadline_ns = deadline_ns;
+    }
+}
+
+static void lockstep_cand_timer_destroy(void *ctx, int id) {
+    lockstep_private_t *priv = (lockstep_private_t*)ctx;
+    if (id >= 0 && id < LOCKSTEP_MAX_TIMERS) {
+        priv->cand_timers[id].deadline_ns = 0;
+        priv->cand_timers[id].used = false;
+    }
+}
+
+// 持锁调用：等待候选线程处理完队列中的所有访问
+static bool lockstep_drain(lockstep_private_t *priv) {
+    uint64_t start = lockstep_now_ns();
+
+    sem_post(&priv->wakeup);
+    while (__atomic_load_n(&priv->tail, __ATOMIC_ACQUIRE) != priv->head) {
+        if (lockstep_now_ns() - start > LOCKSTEP_DRAIN_NS) {
+            return false;
+        }
+        sched_yield();
+    }
+    return true;
+}
+
+// 运行时观测显示参考实现（驱动看到的就是参考实现）
+static int lockstep_inspect(simulator_plugin_t *plugin, plugin_inspect_item_t *items, int max) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    return priv && priv->ref->inspect ? priv->ref->inspect(priv->ref, items, max) : 0;
+}
+
+// 快照取参考实现的状态；恢复时两个实现同时恢复
+static size_t lockstep_save_state(simulator_plugin_t *plugin, void *buf, size_t size) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    return priv->ref->save_state ? priv->ref->save_state(priv->ref, buf, size) : 0;
+}
+
+static int lockstep_load_state(simulator_plugin_t *plugin, const void *buf, size_t size) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    int result = -1;
+
+    pthread_mutex_lock(&priv->lock);
+    lockstep_drain(priv);
+    if (priv->ref->load_state && priv->cand->load_state) {
+        priv->cand_now = sim_vtime_now();   // 候选线程已空闲
+        result = priv->ref->load_state(priv->ref, buf, size);
+        if (result == 0) {
+            result = priv->cand->load_state(priv->cand, buf, size);
+        }
+    }
+    pthread_mutex_unlock(&priv->lock);
+    return result;
+}
+
+// ---- 比对 ----
+
+int lockstep_check(simulator_plugin_t *plugin, lockstep_report_t *report) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    static uint8_t ref_state[LOCKSTEP_STATE_SIZE];
+    static uint8_t cand_state[LOCKSTEP_STATE_SIZE];
+
+    pthread_mutex_lock(&priv->lock);
+    if (!lockstep_drain(priv)) {
+        lockstep_diverge(plugin, NULL, "candidate stalled %llu ops behind",
+                         (unsigned long long)(priv->head - priv->tail));
+    }
+
+    // 让两个实现在当前线程上完成已启动的后台工作（如DMA传输），再比对中断和状态
+    if (priv->ref->clock && priv->cand->clock) {
+        priv->ref->clock(priv->ref, CLOCK_TICK, 0);
+        priv->cand->clock(priv->cand, CLOCK_TICK, 0);
+    }
+
+    // 候选实现必须重放参考实现的全部总线访问
+    uint64_t unreplayed = lockstep_bus_settle(priv);
+    if (unreplayed) {
+        __atomic_fetch_add(&priv->report.bus_mismatches, unreplayed, __ATOMIC_RELAXED);
+        lockstep_diverge(plugin, NULL, "reference made %llu bus accesses the candidate did not",
+                         (unsigned long long)unreplayed);
+    }
+
+    priv->report.irq_mismatches = 0;
+    for (uint32_t irq = 0; irq < LOCKSTEP_MAX_IRQS; irq++) {
+        uint64_t ref_count = __atomic_load_n(&priv->report.ref_irqs[irq], __ATOMIC_RELAXED);
+        uint64_t cand_count = __atomic_load_n(&priv->report.cand_irqs[irq], __ATOMIC_RELAXED);
+        if (ref_count != cand_count) {
+            priv->report.irq_mismatches++;
+            lockstep_diverge(plugin, NULL, "IRQ %u raised %llu times, reference %llu", irq,
+                             (unsigned long long)cand_count, (unsigned long long)ref_count);
+        }
+    }
+
+    if (priv->ref->save_state && priv->cand->save_state) {
+        size_t ref_len = priv->ref->save_state(priv->ref, ref_state, sizeof(ref_state));
+        size_t cand_len = priv->cand->save_state(priv->cand, cand_state, sizeof(cand_state));
+        priv->report.state_mismatch = ref_len != cand_len || memcmp(ref_state, cand_state, ref_len) != 0;
+        if (priv->report.state_mismatch) {
+            size_t offset = 0;
+            while (offset < ref_len && offset < cand_len && ref_state[offset] == cand_state[offset]) {
+                offset++;
+            }
+            lockstep_diverge(plugin, NULL, "final state differs at byte %zu of %zu", offset, ref_len);
+        }
+    }
+
+    if (report) {
+        *report = priv->report;
+    }
+    pthread_mutex_unlock(&priv->lock);
+
+    return (int)(priv->report.read_mismatches + priv->report.irq_mismatches +
+                 __atomic_load_n(&priv->report.bus_mismatches, __ATOMIC_RELAXED) +
+                 (priv->report.state_mismatch ? 1 : 0));
+}
+
+bool lockstep_irq_raise(const char *module, uint32_t irq_num) {
+    for (int i = 0; i < g_instance_count; i++) {
+        lockstep_private_t *priv = (lockstep_private_t*)g_instances[i]->private_data;
+        if (strcmp(priv->ref->name, module) == 0) {
+            __atomic_fetch_add(&priv->report.ref_irqs[irq_num % LOCKSTEP_MAX_IRQS], 1, __ATOMIC_RELAXED);
+            return true;
+        }
+        if (strcmp(priv->cand->name, module) == 0) {
+            __atomic_fetch_add(&priv->report.cand_irqs[irq_num % LOCKSTEP_MAX_IRQS], 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool lockstep_is_candidate(const char *module) {
+    for (int i = 0; i < g_instance_count; i++) {
+        lockstep_private_t *priv = (lockstep_private_t*)g_instances[i]->private_data;
+        if (strcmp(priv->cand->name, module) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---- 生命周期 ----
+
+static int lockstep_init(simulator_plugin_t *plugin) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+
+    if (g_instance_count >= LOCKSTEP_MAX_INSTANCES) {
+        printf("[%s:%s] Error: Maximum lockstep instances reached\n", __FILE__, __func__);
+        return -1;
+    }
+    if ((priv->ref->init && priv->ref->init(priv->ref) != 0) ||
+        (priv->cand->init && priv->cand->init(priv->cand) != 0)) {
+        printf("[%s:%s] %s failed to initialize reference or candidate\n", __FILE__, __func__, plugin->name);
+        return -1;
+    }
+    g_instances[g_instance_count++] = plugin;
+
+    if (pthread_create(&priv->thread, NULL, lockstep_thread, plugin) != 0) {
+        printf("[%s:%s] %s failed to create candidate thread\n", __FILE__, __func__, plugin->name);
+        return -1;
+    }
+    priv->thread_running = true;
+
+    printf("[%s:%s] %s lockstep: reference '%s', candidate '%s'\n", __FILE__, __func__,
+           plugin->name, priv->ref->name, priv->cand->name);
+    return 0;
+}
+
+static void lockstep_cleanup(simulator_plugin_t *plugin) {
+    lockstep_private_t *priv = (lockstep_private_t*)plugin->private_data;
+    lockstep_report_t report;
+
+    if (!priv) {
+        return;
+    }
+
+    int divergences = lockstep_check(plugin, &report);
+    printf("[%s:%s] %s lockstep: %llu ops compared, %llu read mismatches, %llu IRQ count mismatches, "
+           "%llu bus mismatches, final state %s -> %s\n", __FILE__, __func__, plugin->name,
+           (unsigned long long)report.ops, (unsigned long long)report.read_mismatches,
+           (unsigned long long)report.irq_mismatches, (unsigned long long)report.bus_mismatches,
+           report.state_mismatch ? "differs" : "matches", divergences ? "DIVERGED" : "MATCH");
+
+    if (priv->thread_running) {
+        __atomic_store_n(&priv->stop, true, __ATOMIC_RELEASE);
+        sem_post(&priv->wakeup);
+        pthread_join(priv->thread, NULL);
+        priv->thread_running = false;
+    }
+
+    for (int i = 0; i < g_instance_count; i++) {
+        if (g_instances[i] == plugin) {
+            g_instances[i] = g_instances[--g_instance_count];
+            break;
+        }
+    }
+
+    if (priv->ref->cleanup) {
+        priv->ref->cleanup(priv->ref);
+    }
+    if (priv->cand->cleanup) {
+        priv->cand->cleanup(priv->cand);
+    }
+    while (priv->bus_head) {
+        lockstep_bus_entry_t *e = priv->bus_head;
+        priv->bus_head = e->next;
+        free(e->before);
+        free(e->after);
+        free(e);
+    }
+    pthread_cond_destroy(&priv->bus_cond);
+    pthread_mutex_destroy(&priv->bus_lock);
+    pthread_mutex_destroy(&priv->report_lock);
+    sem_destroy(&priv->wakeup);
+    pthread_mutex_destroy(&priv->lock);
+    free(priv);
+    plugin->private_data = NULL;
+}
+
+simulator_plugin_t* create_lockstep_plugin(simulator_plugin_t *reference, simulator_plugin_t *candidate) {
+    if (!reference || !candidate || strcmp(reference->name, candidate->name) == 0) {
+        printf("[%s:%s] Error: reference and candidate need distinct instance names\n", __FILE__, __func__);
+        return NULL;
+    }
+
+    simulator_plugin_t *plugin = malloc(sizeof(simulator_plugin_t));
+    lockstep_private_t *priv = calloc(1, sizeof(lockstep_private_t));
+    if (!plugin || !priv) {
+        free(plugin);
+        free(priv);
+        return NULL;
+    }
+
+    memset(plugin, 0, sizeof(simulator_plugin_t));
+    strncpy(plugin->name, reference->name, sizeof(plugin->name) - 1);
+    plugin->clock = lockstep_clock;
+    plugin->reset = lockstep_reset;
+    plugin->reg_read = lockstep_reg_read;
+    plugin->reg_write = lockstep_reg_write;
+    plugin->interrupt = lockstep_interrupt;
+    plugin->input = lockstep_input;
+    plugin->init = lockstep_init;
+    plugin->cleanup = lockstep_cleanup;
+    plugin->save_state = lockstep_save_state;
+    plugin->load_state = lockstep_load_state;
+    plugin->inspect = lockstep_inspect;
+
+    // 参考实现的访问可能经总线重入同一个包装插件
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&priv->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    sem_init(&priv->wakeup, 0, 0);
+    pthread_mutex_init(&priv->bus_lock, NULL);
+    pthread_mutex_init(&priv->report_lock, NULL);
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&priv->bus_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    priv->ref = reference;
+    priv->cand = candidate;
+    plugin->private_data = priv;
+
+    // 参考实现经日志访问真实总线；候选实现只看到日志，没有任何副作用
+    priv->ref_bus = (plugin_bus_ops_t){ priv, lockstep_ref_map, lockstep_ref_unmap,
+                                        lockstep_ref_read, lockstep_ref_write };
+    priv->cand_bus = (plugin_bus_ops_t){ plugin, lockstep_cand_map, lockstep_cand_unmap,
+                                         lockstep_cand_read, lockstep_cand_write };
+    reference->bus = &priv->ref_bus;
+    candidate->bus = &priv->cand_bus;
+    priv->ref_vtime = (plugin_vtime_ops_t){ plugin, lockstep_ref_now, lockstep_ref_timer_create,
+                                            lockstep_ref_timer_arm, lockstep_ref_timer_destroy };
+    priv->cand_vtime = (plugin_vtime_ops_t){ priv, lockstep_cand_now, lockstep_cand_timer_create,
+                                             lockstep_cand_timer_arm, lockstep_cand_timer_destroy };
+    reference->vtime = &priv->ref_vtime;
+    candidate->vtime = &priv->cand_vtime;
+
+    printf("[%s:%s] Lockstep plugin '%s' created\n", __FILE__, __func__, plugin->name);
+    return plugin;
+}
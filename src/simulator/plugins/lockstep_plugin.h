@@ -0,0 +1,50 @@
+#ifndef LOCKSTEP_PLUGIN_H
+#define LOCKSTEP_PLUGIN_H
+
+#include "../plugin_interface.h"
+
+// 差分锁步插件 - 把同一访问流同时送给参考实现和候选实现并比对
+//
+//   - 包装插件以参考实现的名字注册；参考实现在访问线程上同步执行，读出值返回给驱动
+//   - 每次访问连同参考结果进入环形队列，按批交给候选线程执行并比对读出值
+//   - 两个实现发出的中断按中断号分别计数（候选实现的中断不发信号），结束时比对计数
+//     和save_state导出的最终状态
+//   - 发现第一处分歧时打印最近的访问历史作为上下文
+//   - 每次读之前两个实现各走一个时钟节拍，后台线程上的工作不会因调度先后造成误报
+//   - 总线主设备的内存和外设访问经plugin_bus_ops_t：参考实现访问真实总线并记入日志，
+//     候选实现的读和映射从日志取参考实现当时看到的内容，写和写入的内存与日志比对，
+//     不接触真实内存和其他插件（日志暂存每次映射的内容，额外内存约为在途传输的字节数）
+//   - 虚拟时间和定时器经plugin_vtime_ops_t：参考实现的定时器到期作为一次访问入队，候选实现的
+//     同号定时器在队列中的同一位置到期；候选实现看到的虚拟时间是访问入队时的值，不启动全局定时器
+//
+// 候选实现必须使用与参考实现不同的实例名（如"dma0.cand"），以区分两者发出的中断。
+
+#define LOCKSTEP_MAX_IRQS  32
+
+typedef struct {
+    uint64_t ops;                           // 已比对的访问数
+    uint64_t read_mismatches;
+    uint64_t irq_mismatches;
+    uint64_t bus_mismatches;                // 总线访问（DMA搬运、外设读写）不一致
+    bool state_mismatch;
+    uint64_t ref_irqs[LOCKSTEP_MAX_IRQS];
+    uint64_t cand_irqs[LOCKSTEP_MAX_IRQS];
+    bool diverged;
+    uint64_t diverge_op;                    // 第一处分歧的访问序号
+    char diverge_reason[160];
+} lockstep_report_t;
+
+// 创建包装插件；reference和candidate尚未初始化，由包装插件的init/cleanup负责
+// 同时设置两者的bus和vtime入口，候选实现的总线访问只对参考实现的日志回放
+simulator_plugin_t* create_lockstep_plugin(simulator_plugin_t *reference, simulator_plugin_t *candidate);
+
+// 等待候选线程追上并比对中断计数和最终状态，返回分歧数（0表示一致）
+int lockstep_check(simulator_plugin_t *plugin, lockstep_report_t *report);
+
+// trigger_interrupt钩子：计入锁步统计；返回false表示不发信号（候选实现的中断）
+bool lockstep_irq_raise(const char *module, uint32_t irq_num);
+
+// 是否为锁步候选实现的实例名（候选实现自身的外部输入源被忽略，输入经包装插件送给两者）
+bool lockstep_is_candidate(const char *module);
+
+#endif // LOCKSTEP_PLUGIN_H
@@ -1,13 +1,27 @@
+// sem_timedwait/clock_gettime需要POSIX声明
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "../plugin_interface.h"
 #include "../../common/register_map.h"
+#include "../irq_moderation.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <errno.h>
 #include <unistd.h>
 
 // 声明外部函数
 extern int trigger_interrupt(const char *module, uint32_t irq_num);
+extern int sim_device_input(const char *module, uint32_t channel, uint32_t value);
+extern uint64_t sim_vtime_now(void);
+extern int sim_vtimer_create(void (*fn)(void *ctx, uint64_t vtime_ns), void *ctx);
+extern void sim_vtimer_arm(int id, uint64_t deadline_ns);
+extern void sim_vtimer_destroy(int id);
 
 // 前向声明
 static simulator_plugin_t* create_uart_plugin_instance(const char *instance_name, int instance_id);
@@ -23,16 +37,84 @@ typedef struct {
     bool rx_ready;
     uint8_t rx_buffer[256];
     int rx_head, rx_tail;
+    uint32_t rsr_reg;          // 接收状态（溢出等），写ECR清除
+    uint64_t rx_overruns;      // 接收缓冲满时丢弃的字节数
+    uint32_t imsc_reg;         // 中断屏蔽：复位值允许RX/TX中断，与未实现屏蔽时的行为一致
+    uint32_t ris_reg;          // 锁存的原始中断状态（RT），写ICR清除；RX位由接收缓冲实时给出
+    uint32_t rxto_ns;          // 接收空闲超时（虚拟时间纳秒），0取默认值
+    bool rx_since_idle;        // 上次空闲事件之后收到过字节
+    int idle_timer;            // 接收空闲超时的虚拟时间定时器，-1表示不可用
+    const plugin_vtime_ops_t *vtime;  // 虚拟时间入口（锁步插件设置），NULL时用仿真器的
+    uint64_t rx_idle_events;   // 空闲事件次数
     bool interrupt_enabled;
     bool simulation_running;
     pthread_t monitor_thread;
+    sem_t stop_sem;            // 停止时唤醒监控线程，禁用和复位不必等满1秒
     
     // 实例标识和地址配置
     int instance_id;
     char instance_name[32];
     uint32_t base_addr;        // 实例基地址
+
+    // 中断调节：TX(5)和RX(6)各自累积，阈值由IMODCNT/IMODTIME统一配置
+    irq_moderation_t tx_mod;
+    irq_moderation_t rx_mod;
+    uint32_t imod_cnt;
+    uint32_t imod_time;
 } uart_private_t;
 
+#define UART_TX_IRQ  5
+#define UART_RX_IRQ  6
+
+// 外部输入通道
+#define UART_INPUT_RX  0   // RX线上到达的字节
+
+// 可保存/恢复的设备状态（不含监控线程等宿主资源）
+typedef struct {
+    uint32_t tx_reg;
+    uint32_t rx_reg;
+    uint32_t status_reg;
+    uint32_t ctrl_reg;
+    uint32_t dma_ctrl_reg;
+    bool tx_ready;
+    bool rx_ready;
+    uint8_t rx_buffer[256];
+    int rx_head, rx_tail;
+    uint32_t rsr_reg;
+    uint32_t imod_cnt;
+    uint32_t imod_time;
+    uint32_t imsc_reg;
+    uint32_t ris_reg;
+    uint32_t rxto_ns;
+    bool rx_since_idle;
+} uart_state_t;
+
+#define UART_IMSC_RESET  (UART_IMSC_RXIM | UART_IMSC_TXIM)
+
+// 中断调节上报回调
+static bool uart_raise_tx_irq(void *ctx) {
+    uart_private_t *priv = (uart_private_t*)ctx;
+    printf("[uart_plugin.c:%s] %s UART: TX complete interrupt triggered\n", 
+           __func__, priv->instance_name);
+    return trigger_interrupt(priv->instance_name, UART_TX_IRQ) == 0;
+}
+
+static bool uart_raise_rx_irq(void *ctx) {
+    uart_private_t *priv = (uart_private_t*)ctx;
+    return trigger_interrupt(priv->instance_name, UART_RX_IRQ) == 0;
+}
+
+// 两路中断的统计之和
+static void uart_irq_stats(uart_private_t *priv, irq_mod_stats_t *total) {
+    irq_mod_stats_t tx, rx;
+    irq_mod_get_stats(&priv->tx_mod, &tx);
+    irq_mod_get_stats(&priv->rx_mod, &rx);
+    total->events = tx.events + rx.events;
+    total->raised = tx.raised + rx.raised;
+    total->suppressed = tx.suppressed + rx.suppressed;
+    total->pending = tx.pending + rx.pending;
+}
+
 // UART状态监控线程
 static void* uart_monitor_thread(void *arg) {
     simulator_plugin_t *plugin = (simulator_plugin_t*)arg;
@@ -42,7 +124,16 @@ static void* uart_monitor_thread(void *arg) {
     
     int cycle_count = 0;
     while (priv->simulation_running) {
-        sleep(1);  // 每1秒检查一次
+        // 每1秒检查一次，停止时被提前唤醒
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += 1;
+        int rc;
+        while ((rc = sem_timedwait(&priv->stop_sem, &deadline)) != 0 && errno == EINTR) {
+        }
+        if (rc == 0) {
+            continue;
+        }
         cycle_count++;
         
         if (priv->interrupt_enabled && priv->ctrl_reg & 0x01) {
@@ -50,12 +141,8 @@ static void* uart_monitor_thread(void *arg) {
             if (cycle_count % 5 == 0 && priv->rx_head == priv->rx_tail) {
                 printf("[uart_plugin.c:%s] %s simulating RX data available (cycle %d)\n", 
                        __func__, priv->instance_name, cycle_count);
-                priv->rx_buffer[priv->rx_head] = 0x41 + (cycle_count / 5 - 1) % 26;  // 模拟接收字符A-Z循环
-                priv->rx_head = (priv->rx_head + 1) % 256;
-                priv->status_reg |= UART_RX_READY;
-                
-                // 触发接收中断
-                trigger_interrupt(priv->instance_name, 6);
+                // 模拟接收字符A-Z循环；经外部输入接口注入，记录/回放时可重现
+                sim_device_input(priv->instance_name, UART_INPUT_RX, 0x41 + (cycle_count / 5 - 1) % 26);
             }
         }
     }
@@ -64,6 +151,81 @@ static void* uart_monitor_thread(void *arg) {
     return NULL;
 }
 
+// 停止监控线程并等待其退出
+static void uart_stop_monitor(uart_private_t *priv) {
+    if (!priv->simulation_running) {
+        return;
+    }
+    priv->simulation_running = false;
+    sem_post(&priv->stop_sem);
+    pthread_join(priv->monitor_thread, NULL);
+}
+
+// 原始中断状态：RX位在接收缓冲非空时有效，RT位锁存到写ICR
+static uint32_t uart_ris(const uart_private_t *priv) {
+    return priv->ris_reg | (priv->rx_head != priv->rx_tail ? UART_IMSC_RXIM : 0);
+}
+
+// 虚拟时间和定时器：设置了vtime入口时经它访问，否则用仿真器全局的
+static uint64_t uart_vtime_now(const uart_private_t *priv) {
+    return priv->vtime ? priv->vtime->now(priv->vtime->ctx) : sim_vtime_now();
+}
+
+static void uart_vtimer_arm(const uart_private_t *priv, uint64_t deadline_ns) {
+    if (priv->vtime) {
+        priv->vtime->timer_arm(priv->vtime->ctx, priv->idle_timer, deadline_ns);
+    } else {
+        sim_vtimer_arm(priv->idle_timer, deadline_ns);
+    }
+}
+
+// RX线上有活动：从最后一个字节起重新计算空闲超时
+static void uart_rx_activity(uart_private_t *priv) {
+    priv->rx_since_idle = true;
+    uart_vtimer_arm(priv, uart_vtime_now(priv) + (priv->rxto_ns ? priv->rxto_ns : UART_RXTO_DEFAULT));
+}
+
+// 空闲超时到期（陷入路径）：最后一个字节之后线路空闲了RXTO，锁存RT并上报一次接收中断，
+// 不定长的帧因此每帧只有一次中断
+static void uart_rx_idle_expired(void *ctx, uint64_t vtime_ns) {
+    uart_private_t *priv = (uart_private_t*)ctx;
+    (void)vtime_ns;
+    
+    if (!priv->rx_since_idle) {
+        return;
+    }
+    priv->rx_since_idle = false;
+    priv->ris_reg |= UART_IMSC_RTIM;
+    priv->rx_idle_events++;
+    if (priv->interrupt_enabled && priv->ctrl_reg & 0x01 && priv->imsc_reg & UART_IMSC_RTIM) {
+        irq_mod_event(&priv->rx_mod);
+    }
+}
+
+// 外部输入：RX线上到达的字节进入接收缓冲并触发接收中断（经中断调节）
+// 缓冲已满时丢弃该字节并置RSR溢出位，驱动跟不上线速率时由此可见
+static int uart_input(simulator_plugin_t *plugin, uint32_t channel, uint32_t value) {
+    uart_private_t *priv = (uart_private_t*)plugin->private_data;
+    
+    if (channel != UART_INPUT_RX) {
+        return -1;
+    }
+    uart_rx_activity(priv);
+    if ((priv->rx_head + 1) % 256 == priv->rx_tail) {
+        priv->rsr_reg |= UART_RSR_OE;
+        priv->rx_overruns++;
+        return 0;
+    }
+    priv->rx_buffer[priv->rx_head] = (uint8_t)value;
+    priv->rx_head = (priv->rx_head + 1) % 256;
+    priv->status_reg &= ~UART_FR_RXFE;   // 接收非空
+    
+    if (priv->interrupt_enabled && priv->ctrl_reg & 0x01 && priv->imsc_reg & UART_IMSC_RXIM) {
+        irq_mod_event(&priv->rx_mod);
+    }
+    return 0;
+}
+
 // UART时钟处理
 static int uart_clock(simulator_plugin_t *plugin, clock_action_t action, uint32_t cycles) {
     uart_private_t *priv = (uart_private_t*)plugin->private_data;
@@ -90,6 +252,9 @@ static int uart_reset(simulator_plugin_t *plugin, reset_action_t action) {
     
     if (action == RESET_ASSERT) {
         printf("[uart_plugin.c:%s] UART reset asserted\n", __func__);
+        // 回到上电状态：监控线程随CR使能位重新启动
+        uart_stop_monitor(priv);
+        priv->interrupt_enabled = false;
         priv->tx_reg = 0;
         priv->rx_reg = 0;
         priv->status_reg = UART_TX_READY;  // 复位后发送就绪
@@ -98,6 +263,16 @@ static int uart_reset(simulator_plugin_t *plugin, reset_action_t action) {
         priv->tx_ready = true;
         priv->rx_ready = false;
         priv->rx_head = priv->rx_tail = 0;
+        priv->rsr_reg = 0;
+        priv->imsc_reg = UART_IMSC_RESET;
+        priv->ris_reg = 0;
+        priv->rxto_ns = 0;
+        priv->rx_since_idle = false;
+        uart_vtimer_arm(priv, 0);
+        priv->imod_cnt = 0;
+        priv->imod_time = 0;
+        irq_mod_configure(&priv->tx_mod, 0, 0);
+        irq_mod_configure(&priv->rx_mod, 0, 0);
     } else {
         printf("[uart_plugin.c:%s] UART reset deasserted\n", __func__);
     }
@@ -118,14 +293,14 @@ static uint32_t uart_reg_read(simulator_plugin_t *plugin, uint32_t address) {
                 uint8_t data = priv->rx_buffer[priv->rx_tail];
                 priv->rx_tail = (priv->rx_tail + 1) % 256;
                 if (priv->rx_head == priv->rx_tail) {
-                    priv->status_reg &= ~UART_RX_READY;
+                    priv->status_reg |= UART_FR_RXFE;
                 }
                 printf("[uart_plugin.c:%s] %s UART read: 0x%02X\n", __func__, priv->instance_name, data);
                 return data;
             }
             return 0;
         case 0x04:  // UART_RSR_ECR (Receive Status/Error Clear Register)
-            return 0; // No errors for now
+            return priv->rsr_reg;
         case 0x18:  // UART_FR (Flag Register)
             return priv->status_reg; // Use status_reg as flag register
         case 0x20:  // UART_ILPR (IrDA Low Power Register)
@@ -141,11 +316,11 @@ static uint32_t uart_reg_read(simulator_plugin_t *plugin, uint32_t address) {
         case 0x34:  // UART_IFLS (Interrupt FIFO Level Select Register)
             return 0x0000; // Default FIFO levels
         case 0x38:  // UART_IMSC (Interrupt Mask Set/Clear Register)
-            return 0x0000; // No interrupts masked by default
+            return priv->imsc_reg;
         case 0x3C:  // UART_RIS (Raw Interrupt Status Register)
-            return 0x0000; // No raw interrupts
+            return uart_ris(priv);
         case 0x40:  // UART_MIS (Masked Interrupt Status Register)
-            return 0x0000; // No masked interrupts
+            return uart_ris(priv) & priv->imsc_reg;
         case 0x48:  // UART_DMACR (DMA Control Register)
             return priv->dma_ctrl_reg;
         // Legacy compatibility offsets
@@ -155,6 +330,21 @@ static uint32_t uart_reg_read(simulator_plugin_t *plugin, uint32_t address) {
             return priv->ctrl_reg;
         case 0x10:  // Legacy UART_DMA_CTRL_REG offset
             return priv->dma_ctrl_reg;
+        // Interrupt moderation
+        case 0x50:  // UART_IMODCNT
+            return priv->imod_cnt;
+        case 0x54:  // UART_IMODTIME
+            return priv->imod_time;
+        case 0x58:  // UART_IRQRAISED
+        case 0x5C: {  // UART_IRQSUPP
+            irq_mod_stats_t stats;
+            uart_irq_stats(priv, &stats);
+            return (uint32_t)(relative_addr == 0x58 ? stats.raised : stats.suppressed);
+        }
+        case 0x60:  // UART_RXLVL (Receive FIFO Level) - DMA按此决定一次搬运的字节数
+            return (uint32_t)((priv->rx_head - priv->rx_tail + 256) % 256);
+        case 0x64:  // UART_RXTO (Receive Idle Timeout, ns)
+            return priv->rxto_ns;
         default:
             printf("[uart_plugin.c:%s] %s UART: Invalid read address 0x%08X (relative: 0x%08X)\n", 
                    __func__, priv->instance_name, address, relative_addr);
@@ -176,14 +366,13 @@ static int uart_reg_write(simulator_plugin_t *plugin, uint32_t address, uint32_t
                    __func__, priv->instance_name, value & 0xFF, 
                    (value >= 32 && value < 127) ? (char)value : '.');
             // 模拟发送完成，触发TX完成中断
-            if (priv->interrupt_enabled && priv->ctrl_reg & 0x01) {
-                printf("[uart_plugin.c:%s] %s UART: TX complete interrupt triggered\n", 
-                       __func__, priv->instance_name);
-                trigger_interrupt(priv->instance_name, 5);
+            if (priv->interrupt_enabled && priv->ctrl_reg & 0x01 && priv->imsc_reg & UART_IMSC_TXIM) {
+                irq_mod_event(&priv->tx_mod);
             }
             break;
         case 0x04:  // UART_RSR_ECR (Receive Status/Error Clear Register)
             // Status/Error clear register
+            priv->rsr_reg = 0;
             printf("[uart_plugin.c:%s] %s UART: RSR/ECR register write: 0x%08X\n", 
                    __func__, priv->instance_name, value);
             break;
@@ -228,9 +417,8 @@ static int uart_reg_write(simulator_plugin_t *plugin, uint32_t address, uint32_t
                 }
             } else if (!(value & 0x01) && priv->interrupt_enabled) {
                 // 如果UART被禁用，停止监控线程
-                priv->simulation_running = false;
+                uart_stop_monitor(priv);
                 priv->interrupt_enabled = false;
-                pthread_join(priv->monitor_thread, NULL);
                 printf("[uart_plugin.c:%s] %s UART monitor thread stopped\n", 
                        __func__, priv->instance_name);
             }
@@ -240,12 +428,12 @@ static int uart_reg_write(simulator_plugin_t *plugin, uint32_t address, uint32_t
                    __func__, priv->instance_name, value);
             break;
         case 0x38:  // UART_IMSC (Interrupt Mask Set/Clear Register)
+            priv->imsc_reg = value;
             printf("[uart_plugin.c:%s] %s UART: IMSC register write: 0x%08X\n", 
                    __func__, priv->instance_name, value);
             break;
         case 0x44:  // UART_ICR (Interrupt Clear Register)
-            printf("[uart_plugin.c:%s] %s UART: ICR register write: 0x%08X\n", 
-                   __func__, priv->instance_name, value);
+            priv->ris_reg &= ~value;
             break;
         case 0x48:  // UART_DMACR (DMA Control Register)
             priv->dma_ctrl_reg = value;
@@ -278,6 +466,29 @@ static int uart_reg_write(simulator_plugin_t *plugin, uint32_t address, uint32_t
             printf("[uart_plugin.c:%s] %s UART: Legacy DMA control register write: 0x%08X\n", 
                    __func__, priv->instance_name, value);
             break;
+        // Interrupt moderation
+        case 0x50:  // UART_IMODCNT
+        case 0x54:  // UART_IMODTIME
+            if (relative_addr == 0x50) {
+                priv->imod_cnt = value;
+            } else {
+                priv->imod_time = value;
+            }
+            irq_mod_configure(&priv->tx_mod, priv->imod_cnt, priv->imod_time);
+            irq_mod_configure(&priv->rx_mod, priv->imod_cnt, priv->imod_time);
+            printf("[uart_plugin.c:%s] %s UART: interrupt moderation count=%u time=%uus\n", 
+                   __func__, priv->instance_name, priv->imod_cnt, priv->imod_time);
+            break;
+        case 0x58:  // UART_IRQRAISED - 写任意值清零统计
+            irq_mod_reset_stats(&priv->tx_mod);
+            irq_mod_reset_stats(&priv->rx_mod);
+            break;
+        case 0x5C:  // UART_IRQSUPP - read only
+        case 0x60:  // UART_RXLVL - read only
+            break;
+        case 0x64:  // UART_RXTO
+            priv->rxto_ns = value;
+            break;
         default:
             printf("[uart_plugin.c:%s] %s UART: Invalid write address 0x%08X (relative: 0x%08X)\n", 
                    __func__, priv->instance_name, address, relative_addr);
@@ -307,6 +518,7 @@ static int uart_init(simulator_plugin_t *plugin) {
     priv->dma_ctrl_reg = 0;  // 初始化DMA控制寄存器
     priv->interrupt_enabled = false;
     priv->simulation_running = false;
+    priv->imsc_reg = UART_IMSC_RESET;
     
     // 设置实例信息
     strncpy(priv->instance_name, plugin->name, sizeof(priv->instance_name) - 1);
@@ -322,12 +534,119 @@ static int uart_init(simulator_plugin_t *plugin) {
     printf("[uart_plugin.c:%s] %s configured with base addr 0x%08X\n", 
            __func__, priv->instance_name, priv->base_addr);
     
+    if (irq_mod_init(&priv->tx_mod, "uart_tx", uart_raise_tx_irq, priv) != 0 ||
+        irq_mod_init(&priv->rx_mod, "uart_rx", uart_raise_rx_irq, priv) != 0) {
+        irq_mod_destroy(&priv->tx_mod);
+        free(priv);
+        return -1;
+    }
+    sem_init(&priv->stop_sem, 0, 0);
+    priv->vtime = plugin->vtime;
+    priv->idle_timer = priv->vtime ? priv->vtime->timer_create(priv->vtime->ctx, uart_rx_idle_expired, priv)
+                                   : sim_vtimer_create(uart_rx_idle_expired, priv);
+    
     plugin->private_data = priv;
     printf("[uart_plugin.c:%s] %s UART plugin initialized\n", 
            __func__, priv->instance_name);
     return 0;
 }
 
+// 保存设备状态
+static size_t uart_save_state(simulator_plugin_t *plugin, void *buf, size_t size) {
+    uart_private_t *priv = (uart_private_t*)plugin->private_data;
+    uart_state_t state;
+    
+    if (size < sizeof(state)) {
+        return 0;
+    }
+    memset(&state, 0, sizeof(state));
+    state.tx_reg = priv->tx_reg;
+    state.rx_reg = priv->rx_reg;
+    state.status_reg = priv->status_reg;
+    state.ctrl_reg = priv->ctrl_reg;
+    state.dma_ctrl_reg = priv->dma_ctrl_reg;
+    state.tx_ready = priv->tx_ready;
+    state.rx_ready = priv->rx_ready;
+    memcpy(state.rx_buffer, priv->rx_buffer, sizeof(state.rx_buffer));
+    state.rx_head = priv->rx_head;
+    state.rx_tail = priv->rx_tail;
+    state.rsr_reg = priv->rsr_reg;
+    state.imod_cnt = priv->imod_cnt;
+    state.imod_time = priv->imod_time;
+    state.imsc_reg = priv->imsc_reg;
+    state.ris_reg = priv->ris_reg;
+    state.rxto_ns = priv->rxto_ns;
+    state.rx_since_idle = priv->rx_since_idle;
+    memcpy(buf, &state, sizeof(state));
+    return sizeof(state);
+}
+
+// 恢复设备状态
+static int uart_load_state(simulator_plugin_t *plugin, const void *buf, size_t size) {
+    uart_private_t *priv = (uart_private_t*)plugin->private_data;
+    uart_state_t state;
+    
+    if (size != sizeof(state)) {
+        return -1;
+    }
+    memcpy(&state, buf, sizeof(state));
+    priv->tx_reg = state.tx_reg;
+    priv->rx_reg = state.rx_reg;
+    priv->status_reg = state.status_reg;
+    priv->ctrl_reg = state.ctrl_reg;
+    priv->dma_ctrl_reg = state.dma_ctrl_reg;
+    priv->tx_ready = state.tx_ready;
+    priv->rx_ready = state.rx_ready;
+    memcpy(priv->rx_buffer, state.rx_buffer, sizeof(priv->rx_buffer));
+    priv->rx_head = state.rx_head % 256;
+    priv->rx_tail = state.rx_tail % 256;
+    priv->rsr_reg = state.rsr_reg;
+    priv->imod_cnt = state.imod_cnt;
+    priv->imod_time = state.imod_time;
+    priv->imsc_reg = state.imsc_reg;
+    priv->ris_reg = state.ris_reg;
+    priv->rxto_ns = state.rxto_ns;
+    // 快照不含定时器：收到过字节时从恢复时刻重新计算空闲超时
+    if (state.rx_since_idle) {
+        uart_rx_activity(priv);
+    } else {
+        priv->rx_since_idle = false;
+        uart_vtimer_arm(priv, 0);
+    }
+    irq_mod_configure(&priv->tx_mod, priv->imod_cnt, priv->imod_time);
+    irq_mod_configure(&priv->rx_mod, priv->imod_cnt, priv->imod_time);
+    return 0;
+}
+
+// 运行时观测：直接读取寄存器副本和接收缓冲深度，不经过有副作用的reg_read
+static int uart_inspect(simulator_plugin_t *plugin, plugin_inspect_item_t *items, int max) {
+    uart_private_t *priv = (uart_private_t*)plugin->private_data;
+    irq_mod_stats_t tx, rx;
+    int count = 0;
+    
+    if (!priv) {
+        return 0;
+    }
+    irq_mod_get_stats(&priv->tx_mod, &tx);
+    irq_mod_get_stats(&priv->rx_mod, &rx);
+    
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "DR(tx)", priv->base_addr + 0x00, priv->tx_reg, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "RSR", priv->base_addr + 0x04, priv->rsr_reg, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "FR", priv->base_addr + 0x18, priv->status_reg, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "CR", priv->base_addr + 0x30, priv->ctrl_reg, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IMSC", priv->base_addr + 0x38, priv->imsc_reg, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "RIS", priv->base_addr + 0x3C, uart_ris(priv), 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "DMACR", priv->base_addr + 0x48, priv->dma_ctrl_reg, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IMODCNT", priv->base_addr + 0x50, priv->imod_cnt, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "IMODTIME", priv->base_addr + 0x54, priv->imod_time, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_REG, "RXTO", priv->base_addr + 0x64, priv->rxto_ns, 0);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_QUEUE, "rx_fifo", 0,
+                       (uint32_t)((priv->rx_head - priv->rx_tail + 256) % 256), 255);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_QUEUE, "tx_irq_pending", 0, tx.pending, priv->imod_cnt);
+    plugin_inspect_add(items, max, &count, PLUGIN_INSPECT_QUEUE, "rx_irq_pending", 0, rx.pending, priv->imod_cnt);
+    return count;
+}
+
 // UART清理
 static void uart_cleanup(simulator_plugin_t *plugin) {
     if (plugin->private_data) {
@@ -335,12 +654,33 @@ static void uart_cleanup(simulator_plugin_t *plugin) {
         
         // 停止监控线程
         if (priv->simulation_running) {
-            priv->simulation_running = false;
-            pthread_join(priv->monitor_thread, NULL);
+            uart_stop_monitor(priv);
             printf("[uart_plugin.c:%s] %s UART monitor thread joined\n", 
                    __func__, priv->instance_name);
         }
         
+        irq_mod_stats_t stats;
+        uart_irq_stats(priv, &stats);
+        printf("[uart_plugin.c:%s] %s UART interrupts: %llu events, %llu raised, %llu suppressed\n", 
+               __func__, priv->instance_name, (unsigned long long)stats.events,
+               (unsigned long long)stats.raised, (unsigned long long)stats.suppressed);
+        if (priv->rx_overruns) {
+            printf("[uart_plugin.c:%s] %s UART RX overruns: %llu bytes dropped\n",
+                   __func__, priv->instance_name, (unsigned long long)priv->rx_overruns);
+        }
+        if (priv->rx_idle_events) {
+            printf("[uart_plugin.c:%s] %s UART RX idle events: %llu\n",
+                   __func__, priv->instance_name, (unsigned long long)priv->rx_idle_events);
+        }
+        if (priv->vtime) {
+            priv->vtime->timer_destroy(priv->vtime->ctx, priv->idle_timer);
+        } else {
+            sim_vtimer_destroy(priv->idle_timer);
+        }
+        irq_mod_destroy(&priv->tx_mod);
+        irq_mod_destroy(&priv->rx_mod);
+        sem_destroy(&priv->stop_sem);
+        
         free(plugin->private_data);
         plugin->private_data = NULL;
     }
@@ -373,8 +713,12 @@ static simulator_plugin_t* create_uart_plugin_instance(const char *instance_name
     plugin->reg_read = uart_reg_read;
     plugin->reg_write = uart_reg_write;
     plugin->interrupt = uart_interrupt;
+    plugin->input = uart_input;
     plugin->init = uart_init;
     plugin->cleanup = uart_cleanup;
+    plugin->save_state = uart_save_state;
+    plugin->load_state = uart_load_state;
+    plugin->inspect = uart_inspect;
     plugin->private_data = NULL;
     
     printf("[uart_plugin.c:%s] UART plugin '%s' created\n", __func__, plugin->name);
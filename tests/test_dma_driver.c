@@ -19,15 +19,50 @@
  */
 
 /* Includes ------------------------------------------------------------------*/
+#define _DEFAULT_SOURCE
+
 #include "test_framework.h"
 #include "../src/driver/dma_driver.h"
 #include "../src/common/register_map.h"
+#include "../src/sim_interface/replay.h"
+#include "../src/sim_interface/sim_interface.h"
+#include "../src/simulator/plugin_interface.h"
+#include "test_sim_fixture.h"
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+/* External functions --------------------------------------------------------*/
+extern simulator_plugin_t* find_plugin(const char *name);
 
 /* Private variables ---------------------------------------------------------*/
 static DMA_HandleTypeDef test_dma_handle;
-static uint8_t test_src_buffer[256];
-static uint8_t test_dst_buffer[256];
+/* Transfer buffers live in simulated SRAM so the DMA controller can reach them */
+#define TEST_DMA_BUFFER_SIZE 256
+static uint8_t *const test_src_buffer = (uint8_t *)(uintptr_t)(SRAM_BASE + 0x8000);
+static uint8_t *const test_dst_buffer = (uint8_t *)(uintptr_t)(SRAM_BASE + 0x8100);
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief Wait for a channel started with dma_start_transfer to finish
+ * @note  The channel is stopped afterwards so the driver can reconfigure it
+ * @retval 0 when the channel completed, -1 on error or after 100 ms
+ */
+static int test_dma_wait_channel(int channel)
+{
+    volatile uint32_t *status = (volatile uint32_t *)(uintptr_t)DMA_CH_STATUS_REG(channel);
+    int result = -1;
+    
+    for (int polls = 0; polls < 1000; polls++) {
+        if (*status & (DMA_CSTAT_DONE | DMA_CSTAT_ERR)) {
+            result = (*status & DMA_CSTAT_ERR) ? -1 : 0;
+            break;
+        }
+        usleep(100);
+    }
+    dma_stop_transfer(channel);
+    return result;
+}
 
 /* Test setup and teardown ---------------------------------------------------*/
 void dma_test_setup(void)
@@ -45,10 +80,10 @@ void dma_test_setup(void)
     test_dma_handle.Init.Priority = DMA_PRIORITY_LOW;
     
     /* Initialize test buffers */
-    for (int i = 0; i < sizeof(test_src_buffer); i++) {
+    for (int i = 0; i < TEST_DMA_BUFFER_SIZE; i++) {
         test_src_buffer[i] = (uint8_t)(i & 0xFF);
     }
-    memset(test_dst_buffer, 0, sizeof(test_dst_buffer));
+    memset(test_dst_buffer, 0, TEST_DMA_BUFFER_SIZE);
 }
 
 void dma_test_teardown(void)
@@ -428,6 +463,224 @@ test_result_t test_dma_transfer_types(void)
     TEST_PASS_MSG("DMA transfer types tests passed");
 }
 
+/**
+ * @brief Test DMA 2D strided and fill transfers through the channel registers
+ */
+test_result_t test_dma_2d_fill_modes(void)
+{
+    static const uint8_t pattern[4] = {0x0D, 0xF0, 0xA5, 0xA5};
+    int result;
+    int channel;
+    dma_config_t config;
+    uint32_t i;
+    
+    /* Initialize DMA */
+    result = dma_init();
+    TEST_ASSERT_EQUAL(0, result, "DMA init should succeed");
+    
+    channel = dma_allocate_channel();
+    TEST_ASSERT_TRUE(channel >= 0, "DMA channel allocation should succeed");
+    
+    /* Extract the left channel of 16-bit interleaved stereo samples */
+    memset(&config, 0, sizeof(config));
+    config.src_addr = (uint32_t)test_src_buffer;
+    config.dst_addr = (uint32_t)test_dst_buffer;
+    config.size = 2;
+    config.type = DMA_TRANSFER_MEM_TO_MEM;
+    config.inc_src = true;
+    config.inc_dst = true;
+    config.mode = DMA_XFER_2D;
+    config.elem_size = 2;
+    config.rows = 64;
+    config.src_stride = 4;
+    config.dst_stride = 2;
+    
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(0, result, "DMA 2D configuration should succeed");
+    TEST_ASSERT_EQUAL(0, dma_start_transfer(channel), "DMA 2D transfer start should succeed");
+    TEST_ASSERT_EQUAL(0, test_dma_wait_channel(channel), "DMA 2D transfer should complete");
+    
+    for (i = 0; i < 64; i++) {
+        TEST_ASSERT_EQUAL(test_src_buffer[i * 4], test_dst_buffer[i * 2], "Left sample low byte should be extracted");
+        TEST_ASSERT_EQUAL(test_src_buffer[i * 4 + 1], test_dst_buffer[i * 2 + 1], "Left sample high byte should be extracted");
+    }
+    for (i = 128; i < TEST_DMA_BUFFER_SIZE; i++) {
+        TEST_ASSERT_EQUAL(0, test_dst_buffer[i], "Bytes past the packed destination should stay untouched");
+    }
+    
+    /* Invalid shapes are rejected */
+    config.rows = 0;
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(-1, result, "DMA 2D configuration without rows should fail");
+    
+    config.rows = 64;
+    config.elem_size = 3;
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(-1, result, "DMA element size 3 should fail");
+    
+    config.elem_size = 4;
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(-1, result, "DMA size not a multiple of element size should fail");
+    
+    /* memset-style fill with a 32-bit pattern */
+    memset(&config, 0, sizeof(config));
+    config.dst_addr = (uint32_t)test_dst_buffer;
+    config.size = TEST_DMA_BUFFER_SIZE;
+    config.type = DMA_TRANSFER_MEM_TO_MEM;
+    config.inc_dst = true;
+    config.mode = DMA_XFER_FILL;
+    config.elem_size = 8;
+    config.fill_value = 0xA5A5F00D;
+    
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(-1, result, "DMA fill with 8-byte elements should fail");
+    
+    config.elem_size = 4;
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(0, result, "DMA fill configuration should succeed");
+    TEST_ASSERT_EQUAL(0, dma_start_transfer(channel), "DMA fill start should succeed");
+    TEST_ASSERT_EQUAL(0, test_dma_wait_channel(channel), "DMA fill should complete");
+    
+    for (i = 0; i < TEST_DMA_BUFFER_SIZE; i++) {
+        TEST_ASSERT_EQUAL(pattern[i % 4], test_dst_buffer[i], "Linear fill should repeat the pattern");
+    }
+    
+    /* 2D fill: 8 bytes of every 16-byte row, the other 8 are a gap */
+    memset(test_dst_buffer, 0x11, TEST_DMA_BUFFER_SIZE);
+    config.size = 8;
+    config.rows = 16;
+    config.dst_stride = 16;
+    result = dma_configure_channel(channel, &config);
+    TEST_ASSERT_EQUAL(0, result, "DMA 2D fill configuration should succeed");
+    TEST_ASSERT_EQUAL(0, dma_start_transfer(channel), "DMA 2D fill start should succeed");
+    TEST_ASSERT_EQUAL(0, test_dma_wait_channel(channel), "DMA 2D fill should complete");
+    
+    for (i = 0; i < TEST_DMA_BUFFER_SIZE; i++) {
+        if (i % 16 < 8) {
+            TEST_ASSERT_EQUAL(pattern[i % 4], test_dst_buffer[i], "Filled rows should hold the pattern");
+        } else {
+            TEST_ASSERT_EQUAL(0x11, test_dst_buffer[i], "Gaps between filled rows should stay untouched");
+        }
+    }
+    
+    /* Cleanup */
+    dma_free_channel(channel);
+    dma_cleanup();
+    
+    TEST_PASS_MSG("DMA 2D and fill mode tests passed");
+}
+
+/**
+ * @brief Write a recognisable value set into the registers of one DMA channel
+ */
+static void test_dma_program_channel(int channel, uint32_t seed)
+{
+    *(volatile uint32_t *)(uintptr_t)DMA_CH_SRC_REG(channel) = SRAM_BASE + seed;
+    *(volatile uint32_t *)(uintptr_t)DMA_CH_DST_REG(channel) = SRAM_BASE + 0x1000 + seed;
+    *(volatile uint32_t *)(uintptr_t)DMA_CH_SIZE_REG(channel) = 0x40 + seed;
+    *(volatile uint32_t *)(uintptr_t)DMA_CH_STRIDE_REG(channel) = seed;
+}
+
+/**
+ * @brief Test seeking a recorded log back to a point in virtual time
+ * @note  The log is recorded with a snapshot every 4 traps, so the seek
+ *        restores a snapshot taken mid-log and re-applies the accesses
+ *        recorded after it.
+ */
+test_result_t test_dma_replay_seek(void)
+{
+    simulator_plugin_t *dma = find_plugin("dma0");
+    uint8_t expected[1024];
+    uint8_t final_state[1024];
+    uint8_t restored[1024];
+    replay_stats_t stats;
+    char path[] = "/tmp/test_replay_seekXXXXXX";
+    int fd;
+    
+    TEST_ASSERT_NOT_NULL(dma, "dma0 plugin should be registered");
+    fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0, "Temporary log file should be created");
+    close(fd);
+    
+    TEST_ASSERT_EQUAL(0, replay_record_start(path, 4), "Recording should start");
+    test_dma_program_channel(2, 0x10);
+    test_dma_program_channel(3, 0x20);
+    test_dma_program_channel(2, 0x34);
+    uint64_t seek_vtime = sim_vtime_now();
+    size_t expected_len = dma->save_state(dma, expected, sizeof(expected));
+    test_dma_program_channel(2, 0x58);
+    test_dma_program_channel(3, 0x6C);
+    size_t final_len = dma->save_state(dma, final_state, sizeof(final_state));
+    replay_stop();
+    replay_get_stats(&stats);
+    
+    TEST_ASSERT_EQUAL(20, (int)stats.traps, "Every register write should be recorded");
+    TEST_ASSERT_TRUE(stats.snapshots >= 5, "Periodic snapshots should be recorded");
+    TEST_ASSERT_TRUE(expected_len > 0 && expected_len == final_len, "dma0 should save its state");
+    TEST_ASSERT_TRUE(memcmp(expected, final_state, expected_len) != 0,
+                     "Writes after the seek point should change the state");
+    
+    /* The seek point is the snapshot written after trap 12 */
+    test_sim_fixture_reset();
+    int applied = replay_seek(path, seek_vtime);
+    TEST_ASSERT_EQUAL(0, applied, "Seek onto a snapshot should re-apply no events");
+    TEST_ASSERT_EQUAL(expected_len, dma->save_state(dma, restored, sizeof(restored)), "dma0 should save its state");
+    TEST_ASSERT_TRUE(memcmp(expected, restored, expected_len) == 0, "Seek should restore the state at the seek point");
+    TEST_ASSERT_EQUAL(seek_vtime, sim_vtime_now(), "Seek should move virtual time to the seek point");
+    
+    /* Between snapshots the two writes recorded after trap 12 are re-applied */
+    test_sim_fixture_reset();
+    applied = replay_seek(path, seek_vtime + 2 * SIM_VTIME_TRAP_NS);
+    TEST_ASSERT_EQUAL(2, applied, "Seek should re-apply the writes after the snapshot");
+    TEST_ASSERT_EQUAL(SRAM_BASE + 0x58, *(volatile uint32_t *)(uintptr_t)DMA_CH_SRC_REG(2),
+                      "Re-applied SRC write should land");
+    TEST_ASSERT_EQUAL(SRAM_BASE + 0x1058, *(volatile uint32_t *)(uintptr_t)DMA_CH_DST_REG(2),
+                      "Re-applied DST write should land");
+    TEST_ASSERT_EQUAL(0x40 + 0x34, *(volatile uint32_t *)(uintptr_t)DMA_CH_SIZE_REG(2),
+                      "Writes after the seek point should not be applied");
+    
+    unlink(path);
+    TEST_PASS_MSG("DMA replay seek tests passed");
+}
+
+/**
+ * @brief Test synchronous DMA transfer latency (start, completion, status readback)
+ */
+test_result_t test_dma_transfer_latency(void)
+{
+    static test_bench_t bench;
+    uint8_t *src = (uint8_t *)(SRAM_BASE + 0xC000);
+    uint8_t *dst = (uint8_t *)(SRAM_BASE + 0xD000);
+    int result;
+    int channel;
+    int failures = 0;
+    
+    result = dma_init();
+    TEST_ASSERT_EQUAL(0, result, "DMA init should succeed");
+    
+    channel = dma_allocate_channel();
+    TEST_ASSERT_TRUE(channel >= 0, "DMA channel allocation should succeed");
+    
+    for (int i = 0; i < 256; i++) {
+        src[i] = (uint8_t)(i ^ 0x5A);
+    }
+    memset(dst, 0, 256);
+    
+    TEST_BENCH(bench, "dma_transfer_sync 256B", 256) {
+        failures += dma_transfer_sync((uint8_t)channel, SRAM_BASE + 0xC000, SRAM_BASE + 0xD000,
+                                      256, DMA_TRANSFER_MEM_TO_MEM) != 0;
+    }
+    
+    dma_free_channel(channel);
+    dma_cleanup();
+    
+    TEST_ASSERT_EQUAL(0, failures, "DMA synchronous transfer should succeed on every iteration");
+    TEST_ASSERT_TRUE(test_compare_memory(src, dst, 256), "DMA destination should match source");
+    TEST_ASSERT_LATENCY(bench, 99, TEST_MS(20), "DMA transfer p99 latency over budget");
+    
+    TEST_PASS_MSG("DMA transfer latency within budget");
+}
+
 /* Test suite definition -----------------------------------------------------*/
 const test_case_t dma_test_cases[] = {
     {"DMA_HAL_Init", test_dma_hal_init, "Test DMA HAL initialization functionality"},
@@ -439,6 +692,9 @@ const test_case_t dma_test_cases[] = {
     {"DMA_Legacy_Functions", test_dma_legacy_functions, "Test legacy DMA functions"},
     {"DMA_Async_Transfer", test_dma_async_transfer, "Test DMA asynchronous transfer"},
     {"DMA_Transfer_Types", test_dma_transfer_types, "Test different DMA transfer types"},
+    {"DMA_2D_Fill_Modes", test_dma_2d_fill_modes, "Test DMA 2D strided and fill transfers"},
+    {"DMA_Replay_Seek", test_dma_replay_seek, "Test restoring dma0 state from a recorded log at a given virtual time"},
+    {"DMA_Transfer_Latency", test_dma_transfer_latency, "Benchmark synchronous DMA transfer latency against its budget"},
 };
 
 const uint32_t dma_test_count = sizeof(dma_test_cases) / sizeof(dma_test_cases[0]);
@@ -449,6 +705,8 @@ const uint32_t dma_test_count = sizeof(dma_test_cases) / sizeof(dma_test_cases[0
  */
 test_result_t run_dma_tests(void)
 {
+    test_set_suite_hooks(dma_test_setup, dma_test_teardown);
     test_result_t result = run_test_suite(dma_test_cases, dma_test_count, "DMA Driver Tests");
+    test_set_suite_hooks(NULL, NULL);
     return result;
 }
\ No newline at end of file
@@ -0,0 +1,457 @@
+/**
+ ******************************************************************************
+ * @file    test_footprint.c
+ * @author  IC Simulator Team
+ * @brief   Register Footprint Index for Regression Test Selection
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ *
+ * Index format (one line per test case, offsets relative to the device base):
+ *
+ *   # test  device:offset,offset...  device:offset...
+ *   UART_Transmit uart0:0x000,0x018,0x024,0x030
+ *   UART_State_Management -
+ *
+ * "-" marks a case that touched no device registers.
+ *
+ ******************************************************************************
+ */
+
+/* strtok_r needs POSIX declarations under -std=c99 */
+#define _POSIX_C_SOURCE 200809L
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_footprint.h"
+#include "test_framework.h"
+#include "../src/sim_interface/sim_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* Private types -------------------------------------------------------------*/
+
+/** @brief Registers one test case touched on one device */
+typedef struct {
+    char module[32];
+    uint32_t words[SIM_FOOTPRINT_MAX_WORDS / 32];
+} footprint_module_t;
+
+/** @brief Index entry for one test case */
+typedef struct {
+    char name[64];
+    int module_count;
+    footprint_module_t modules[TEST_FOOTPRINT_MAX_MODULES];
+} footprint_entry_t;
+
+/** @brief One change: a device (all registers) or a single register */
+typedef struct {
+    char module[32];
+    bool all_offsets;
+    uint32_t offset;
+} footprint_change_t;
+
+typedef enum {
+    FOOTPRINT_OFF = 0,
+    FOOTPRINT_RECORD,
+    FOOTPRINT_SELECT
+} footprint_mode_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+/** @brief Sources whose changes only affect one device model or driver */
+static const struct {
+    const char *file;
+    const char *module;
+} source_modules[] = {
+    {"uart_plugin.c", "uart"},
+    {"uart_driver.c", "uart"},
+    {"uart_driver.h", "uart"},
+    {"dma_plugin.c",  "dma"},
+    {"dma_kernels.c", "dma"},
+    {"dma_kernels.h", "dma"},
+    {"dma_workers.c", "dma"},
+    {"dma_workers.h", "dma"},
+    {"dma_driver.c",  "dma"},
+    {"dma_driver.h",  "dma"},
+};
+
+/** @brief Paths that never influence the driver suites */
+static const char *const unrelated_prefixes[] = { "tools/", "bench/", "fuzz/", "docs/" };
+
+static footprint_mode_t footprint_mode = FOOTPRINT_OFF;
+static char footprint_path[256];
+static footprint_entry_t footprint_entries[TEST_FOOTPRINT_MAX_TESTS];
+static int footprint_entry_count = 0;
+static footprint_change_t footprint_changes[TEST_FOOTPRINT_MAX_CHANGES];
+static int footprint_change_count = 0;
+static const char *select_all_reason = NULL;
+static char select_all_token[256];
+static uint32_t selected_count = 0;
+static uint32_t deselected_count = 0;
+
+/* Private functions ---------------------------------------------------------*/
+
+static footprint_entry_t* find_entry(const char *name)
+{
+    for (int i = 0; i < footprint_entry_count; i++) {
+        if (strcmp(footprint_entries[i].name, name) == 0) {
+            return &footprint_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static footprint_entry_t* find_or_add_entry(const char *name)
+{
+    footprint_entry_t *entry = find_entry(name);
+
+    if (entry == NULL && footprint_entry_count < TEST_FOOTPRINT_MAX_TESTS) {
+        entry = &footprint_entries[footprint_entry_count++];
+        memset(entry, 0, sizeof(*entry));
+        strncpy(entry->name, name, sizeof(entry->name) - 1);
+    }
+    return entry;
+}
+
+/**
+ * @brief Parse "uart0:0x000,0x018" into a module footprint
+ */
+static int parse_module_footprint(const char *token, footprint_module_t *module)
+{
+    const char *colon = strchr(token, ':');
+    size_t length = colon ? (size_t)(colon - token) : strlen(token);
+
+    if (colon == NULL || length == 0 || length >= sizeof(module->module)) {
+        return -1;
+    }
+    memset(module, 0, sizeof(*module));
+    memcpy(module->module, token, length);
+
+    const char *p = colon + 1;
+    while (*p) {
+        char *end;
+        unsigned long offset = strtoul(p, &end, 0);
+        if (end == p) {
+            return -1;
+        }
+        if (offset / 4 < SIM_FOOTPRINT_MAX_WORDS) {
+            module->words[offset / 128] |= 1U << ((offset / 4) & 31);
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return 0;
+}
+
+/**
+ * @brief Load an existing index; a missing file is an empty index
+ */
+static int load_index(const char *path)
+{
+    char line[4096];
+    FILE *file = fopen(path, "r");
+
+    footprint_entry_count = 0;
+    if (file == NULL) {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *save = NULL;
+        char *token = strtok_r(line, " \t\r\n", &save);
+        if (token == NULL || token[0] == '#') {
+            continue;
+        }
+
+        footprint_entry_t *entry = find_or_add_entry(token);
+        if (entry == NULL) {
+            break;
+        }
+        entry->module_count = 0;
+        while ((token = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+            if (strcmp(token, "-") == 0 || entry->module_count >= TEST_FOOTPRINT_MAX_MODULES) {
+                continue;
+            }
+            if (parse_module_footprint(token, &entry->modules[entry->module_count]) == 0) {
+                entry->module_count++;
+            }
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static int write_index(const char *path)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        printf("[FOOTPRINT] Cannot write index %s\n", path);
+        return -1;
+    }
+
+    fprintf(file, "# IC Simulator test footprint index: test device:offset,... (offsets from device base)\n");
+    for (int i = 0; i < footprint_entry_count; i++) {
+        const footprint_entry_t *entry = &footprint_entries[i];
+        fprintf(file, "%s", entry->name);
+        if (entry->module_count == 0) {
+            fprintf(file, " -");
+        }
+        for (int m = 0; m < entry->module_count; m++) {
+            const footprint_module_t *module = &entry->modules[m];
+            char separator = ':';
+            fprintf(file, " %s", module->module);
+            for (uint32_t word = 0; word < SIM_FOOTPRINT_MAX_WORDS; word++) {
+                if (module->words[word >> 5] & (1U << (word & 31))) {
+                    fprintf(file, "%c0x%03X", separator, word * 4);
+                    separator = ',';
+                }
+            }
+        }
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/**
+ * @brief "uart" matches uart0/uart1, "uart0" only matches uart0
+ */
+static bool module_matches(const char *change, const char *module)
+{
+    size_t length = strlen(change);
+
+    if (strncmp(change, module, length) != 0) {
+        return false;
+    }
+    for (const char *p = module + length; *p; p++) {
+        if (!isdigit((unsigned char)*p)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ends_with(const char *text, const char *suffix)
+{
+    size_t text_length = strlen(text);
+    size_t suffix_length = strlen(suffix);
+    return text_length >= suffix_length && strcmp(text + text_length - suffix_length, suffix) == 0;
+}
+
+static void add_change(const char *module, bool all_offsets, uint32_t offset)
+{
+    if (footprint_change_count >= TEST_FOOTPRINT_MAX_CHANGES) {
+        select_all_reason = "too many changes";
+        return;
+    }
+    footprint_change_t *change = &footprint_changes[footprint_change_count++];
+    memset(change, 0, sizeof(*change));
+    strncpy(change->module, module, sizeof(change->module) - 1);
+    change->all_offsets = all_offsets;
+    change->offset = offset;
+}
+
+/**
+ * @brief Turn one change token into device changes, or fall back to running everything
+ */
+static void parse_change(const char *token)
+{
+    /* Source paths: device-specific files narrow the selection, anything else is global */
+    if (strchr(token, '/') != NULL || strchr(token, '.') != NULL) {
+        const char *base = strrchr(token, '/');
+        base = base ? base + 1 : token;
+
+        for (size_t i = 0; i < sizeof(unrelated_prefixes) / sizeof(unrelated_prefixes[0]); i++) {
+            if (strncmp(token, unrelated_prefixes[i], strlen(unrelated_prefixes[i])) == 0) {
+                return;
+            }
+        }
+        if (ends_with(token, ".md")) {
+            return;
+        }
+        for (size_t i = 0; i < sizeof(source_modules) / sizeof(source_modules[0]); i++) {
+            if (strcmp(base, source_modules[i].file) == 0) {
+                add_change(source_modules[i].module, true, 0);
+                return;
+            }
+        }
+        select_all_reason = "change outside a single device";
+        strncpy(select_all_token, token, sizeof(select_all_token) - 1);
+        return;
+    }
+
+    /* Device or device register: "uart", "dma0", "uart:0x18" */
+    const char *colon = strchr(token, ':');
+    char module[32] = {0};
+    size_t length = colon ? (size_t)(colon - token) : strlen(token);
+    if (length == 0 || length >= sizeof(module)) {
+        select_all_reason = "unrecognized change";
+        strncpy(select_all_token, token, sizeof(select_all_token) - 1);
+        return;
+    }
+    memcpy(module, token, length);
+    if (colon == NULL) {
+        add_change(module, true, 0);
+        return;
+    }
+
+    char *end;
+    unsigned long offset = strtoul(colon + 1, &end, 0);
+    if (end == colon + 1 || *end != '\0') {
+        select_all_reason = "unrecognized change";
+        strncpy(select_all_token, token, sizeof(select_all_token) - 1);
+        return;
+    }
+    add_change(module, false, (uint32_t)offset);
+}
+
+static bool entry_affected(const footprint_entry_t *entry)
+{
+    for (int c = 0; c < footprint_change_count; c++) {
+        const footprint_change_t *change = &footprint_changes[c];
+        for (int m = 0; m < entry->module_count; m++) {
+            const footprint_module_t *module = &entry->modules[m];
+            if (!module_matches(change->module, module->module)) {
+                continue;
+            }
+            if (change->all_offsets) {
+                return true;
+            }
+            uint32_t word = change->offset / 4;
+            if (word < SIM_FOOTPRINT_MAX_WORDS && (module->words[word >> 5] & (1U << (word & 31)))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Case filter: cases missing from the index always run
+ */
+static bool footprint_filter(const char *name)
+{
+    const footprint_entry_t *entry = find_entry(name);
+    bool selected = select_all_reason != NULL || entry == NULL || entry_affected(entry);
+
+    if (selected) {
+        selected_count++;
+    } else {
+        deselected_count++;
+    }
+    return selected;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+int test_footprint_record(const char *index_path)
+{
+    if (strlen(index_path) >= sizeof(footprint_path)) {
+        return -1;
+    }
+    strcpy(footprint_path, index_path);
+    load_index(footprint_path);
+    footprint_mode = FOOTPRINT_RECORD;
+    printf("[FOOTPRINT] Recording register footprints to %s\n", footprint_path);
+    return 0;
+}
+
+int test_footprint_select(const char *index_path, const char *changed)
+{
+    char token_buffer[4096];
+    char *save = NULL;
+
+    if (load_index(index_path) != 0) {
+        printf("[FOOTPRINT] No footprint index at %s, running every test\n", index_path);
+        select_all_reason = "no footprint index";
+    }
+
+    footprint_change_count = 0;
+    strncpy(token_buffer, changed ? changed : "", sizeof(token_buffer) - 1);
+    token_buffer[sizeof(token_buffer) - 1] = '\0';
+    for (char *token = strtok_r(token_buffer, " \t\r\n,;", &save); token != NULL;
+         token = strtok_r(NULL, " \t\r\n,;", &save)) {
+        parse_change(token);
+    }
+
+    footprint_mode = FOOTPRINT_SELECT;
+    test_set_case_filter(footprint_filter);
+    if (select_all_reason != NULL) {
+        printf("[FOOTPRINT] Running every test: %s%s%s\n", select_all_reason,
+               select_all_token[0] ? " - " : "", select_all_token);
+    } else {
+        printf("[FOOTPRINT] %d device changes against %d indexed tests\n",
+               footprint_change_count, footprint_entry_count);
+    }
+    return 0;
+}
+
+void test_footprint_case_begin(void)
+{
+    if (footprint_mode == FOOTPRINT_RECORD) {
+        sim_footprint_clear();
+    }
+}
+
+void test_footprint_case_end(const char *name)
+{
+    sim_footprint_t footprints[32];
+
+    if (footprint_mode != FOOTPRINT_RECORD || name == NULL) {
+        return;
+    }
+
+    footprint_entry_t *entry = find_or_add_entry(name);
+    if (entry == NULL) {
+        printf("[FOOTPRINT] Index full, %s not recorded\n", name);
+        return;
+    }
+
+    entry->module_count = 0;
+    int count = sim_footprint_get(footprints, (int)(sizeof(footprints) / sizeof(footprints[0])));
+    for (int i = 0; i < count && entry->module_count < TEST_FOOTPRINT_MAX_MODULES; i++) {
+        bool touched = false;
+        for (int w = 0; w < SIM_FOOTPRINT_MAX_WORDS / 32; w++) {
+            touched |= footprints[i].words[w] != 0;
+        }
+        if (!touched) {
+            continue;
+        }
+        footprint_module_t *module = &entry->modules[entry->module_count++];
+        memset(module, 0, sizeof(*module));
+        strncpy(module->module, footprints[i].module, sizeof(module->module) - 1);
+        memcpy(module->words, footprints[i].words, sizeof(module->words));
+    }
+}
+
+int test_footprint_finish(void)
+{
+    int result = 0;
+
+    if (footprint_mode == FOOTPRINT_RECORD) {
+        result = write_index(footprint_path);
+        if (result == 0) {
+            printf("[FOOTPRINT] Wrote %d test footprints to %s\n", footprint_entry_count, footprint_path);
+        }
+    } else if (footprint_mode == FOOTPRINT_SELECT) {
+        printf("[FOOTPRINT] Selected %u of %u tests, %u skipped as unaffected\n",
+               selected_count, selected_count + deselected_count, deselected_count);
+        test_set_case_filter(NULL);
+    }
+    footprint_mode = FOOTPRINT_OFF;
+    return result;
+}
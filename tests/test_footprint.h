@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * @file    test_footprint.h
+ * @author  IC Simulator Team
+ * @brief   Register Footprint Index for Regression Test Selection
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TEST_FOOTPRINT_H
+#define __TEST_FOOTPRINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define TEST_FOOTPRINT_MAX_TESTS    128     /*!< Test cases held in the index */
+#define TEST_FOOTPRINT_MAX_MODULES  8       /*!< Devices recorded per test case */
+#define TEST_FOOTPRINT_MAX_CHANGES  64      /*!< Change tokens accepted per run */
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Record the register footprint of every test case that runs.
+ * @note   An existing index is loaded first, so a partial run (--uart) only
+ *         replaces the entries of the cases it ran.
+ * @param  index_path Footprint index file, written by test_footprint_finish()
+ * @retval 0 on success, -1 on error
+ */
+int test_footprint_record(const char *index_path);
+
+/**
+ * @brief  Run only the test cases whose footprint intersects the changes.
+ * @param  index_path Footprint index file recorded earlier
+ * @param  changed    Whitespace/comma separated changes: source paths
+ *                    (src/simulator/plugins/uart_plugin.c), device names
+ *                    (uart, dma0) or device registers (uart:0x18, dma0:0x110)
+ * @retval 0 on success, -1 on error
+ */
+int test_footprint_select(const char *index_path, const char *changed);
+
+/**
+ * @brief  Per-case hooks called from test_setup() and test_teardown().
+ */
+void test_footprint_case_begin(void);
+void test_footprint_case_end(const char *name);
+
+/**
+ * @brief  Write the recorded index and print the selection summary.
+ * @retval 0 on success, -1 on error
+ */
+int test_footprint_finish(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEST_FOOTPRINT_H */
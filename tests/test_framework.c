@@ -18,12 +18,19 @@
  ******************************************************************************
  */
 
+/* clock_gettime needs POSIX declarations under -std=c99 */
+#define _POSIX_C_SOURCE 200809L
+
 /* Includes ------------------------------------------------------------------*/
 #include "test_framework.h"
 #include <time.h>
 
 /* Private variables ---------------------------------------------------------*/
 static test_stats_t global_stats = {0};
+static void (*suite_setup)(void) = NULL;
+static void (*suite_teardown)(void) = NULL;
+static bool (*case_filter)(const char *name) = NULL;
+static const char *current_test_name = NULL;
 
 /* Test runner functions -----------------------------------------------------*/
 
@@ -39,24 +46,40 @@ test_result_t run_test_case(const test_case_t *test_case)
         return TEST_FAIL;
     }
 
+    /* Cases deselected by the filter are skipped without setup */
+    if (case_filter != NULL && !case_filter(test_case->name)) {
+        printf("○ SKIP: %s (not selected)\n", test_case->name);
+        return TEST_SKIP;
+    }
+
     printf("Running test: %s - %s\n", test_case->name, test_case->description);
+    current_test_name = test_case->name;
     
     /* Setup for each test */
     test_setup();
+    if (suite_setup != NULL) {
+        suite_setup();
+    }
     
     /* Run the test */
+    uint64_t start_ns = test_monotonic_ns();
     test_result_t result = test_case->test_func();
+    double elapsed_ms = (double)(test_monotonic_ns() - start_ns) / 1e6;
     
     /* Cleanup after each test */
+    if (suite_teardown != NULL) {
+        suite_teardown();
+    }
     test_teardown();
+    current_test_name = NULL;
     
     /* Print result */
     switch (result) {
         case TEST_PASS:
-            printf("✓ PASS: %s\n", test_case->name);
+            printf("✓ PASS: %s (%.3f ms)\n", test_case->name, elapsed_ms);
             break;
         case TEST_FAIL:
-            printf("✗ FAIL: %s\n", test_case->name);
+            printf("✗ FAIL: %s (%.3f ms)\n", test_case->name, elapsed_ms);
             break;
         case TEST_SKIP:
             printf("○ SKIP: %s\n", test_case->name);
@@ -86,7 +109,7 @@ test_result_t run_test_suite(const test_case_t test_cases[], uint32_t num_tests,
     printf("Starting Test Suite: %s (%u tests)\n", suite_name ? suite_name : "Unknown", num_tests);
     test_print_separator();
     
-    clock_t start_time = clock();
+    uint64_t start_ns = test_monotonic_ns();
     
     for (uint32_t i = 0; i < num_tests; i++) {
         test_result_t result = run_test_case(&test_cases[i]);
@@ -109,8 +132,7 @@ test_result_t run_test_suite(const test_case_t test_cases[], uint32_t num_tests,
         global_stats.total_tests++;
     }
     
-    clock_t end_time = clock();
-    double execution_time = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+    double execution_time = (double)(test_monotonic_ns() - start_ns) / 1e9;
     
     test_print_separator();
     print_test_summary(&stats, suite_name);
@@ -150,6 +172,35 @@ void print_test_summary(const test_stats_t *stats, const char *suite_name)
     }
 }
 
+/**
+ * @brief Install per-suite hooks run around each test after the global ones
+ * @param setup Called after test_setup(), or NULL
+ * @param teardown Called before test_teardown(), or NULL
+ */
+void test_set_suite_hooks(void (*setup)(void), void (*teardown)(void))
+{
+    suite_setup = setup;
+    suite_teardown = teardown;
+}
+
+/**
+ * @brief Install a filter deciding which test cases run
+ * @param filter Returns false for cases to skip, or NULL to run every case
+ */
+void test_set_case_filter(bool (*filter)(const char *name))
+{
+    case_filter = filter;
+}
+
+/**
+ * @brief Get the name of the test case being run
+ * @retval Test case name, or NULL outside a test case
+ */
+const char* test_current_name(void)
+{
+    return current_test_name;
+}
+
 /**
  * @brief Test setup function (called before each test)
  */
@@ -217,6 +268,128 @@ void test_fill_memory(void *ptr, uint8_t value, size_t size)
     }
 }
 
+/* Benchmark functions -------------------------------------------------------*/
+
+/**
+ * @brief Read the monotonic clock
+ * @retval Nanoseconds since an arbitrary fixed point
+ */
+uint64_t test_monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Start a benchmark (called by TEST_BENCH)
+ * @param bench Benchmark state
+ * @param name Name printed in the report
+ * @param bytes_per_iteration Bytes moved per iteration, 0 for latency-only benchmarks
+ */
+void test_bench_begin(test_bench_t *bench, const char *name, uint64_t bytes_per_iteration)
+{
+    bench->name = name;
+    bench->bytes_per_iteration = bytes_per_iteration;
+    bench->iterations = 0;
+    bench->total_ns = 0;
+    bench->start_ns = 0;
+    bench->warmup = true;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    uint64_t sa = *(const uint64_t *)a;
+    uint64_t sb = *(const uint64_t *)b;
+    return sa < sb ? -1 : sa > sb;
+}
+
+/**
+ * @brief Close the previous iteration and decide whether to run another
+ * @note  Iterations scale with the cost of the body: cheap bodies run up to
+ *        TEST_BENCH_MAX_SAMPLES times, slow ones stop after TEST_BENCH_MIN_TIME_NS.
+ *        On the last call the samples are sorted and the report printed.
+ * @param bench Benchmark state
+ * @retval true to run the body again
+ */
+bool test_bench_next(test_bench_t *bench)
+{
+    uint64_t now = test_monotonic_ns();
+
+    if (bench->start_ns != 0) {
+        if (bench->warmup) {
+            bench->warmup = false;
+        } else {
+            uint64_t elapsed = now - bench->start_ns;
+            bench->samples[bench->iterations++] = elapsed;
+            bench->total_ns += elapsed;
+        }
+    }
+
+    bool enough = bench->iterations >= TEST_BENCH_MIN_ITERATIONS && bench->total_ns >= TEST_BENCH_MIN_TIME_NS;
+    if (enough || bench->iterations >= TEST_BENCH_MAX_SAMPLES) {
+        qsort(bench->samples, bench->iterations, sizeof(bench->samples[0]), compare_samples);
+        test_bench_report(bench);
+        return false;
+    }
+
+    bench->start_ns = test_monotonic_ns();
+    return true;
+}
+
+/**
+ * @brief Latency percentile (nearest rank) of a finished benchmark
+ * @param bench Benchmark state
+ * @param percentile Percentile in (0, 100]
+ * @retval Iteration time in nanoseconds
+ */
+uint64_t test_bench_percentile_ns(const test_bench_t *bench, double percentile)
+{
+    if (bench->iterations == 0) {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)((percentile / 100.0) * bench->iterations + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > bench->iterations) {
+        rank = bench->iterations;
+    }
+    return bench->samples[rank - 1];
+}
+
+/**
+ * @brief Throughput of a finished benchmark
+ * @param bench Benchmark state
+ * @retval Bytes per second
+ */
+double test_bench_throughput(const test_bench_t *bench)
+{
+    if (bench->total_ns == 0) {
+        return 0.0;
+    }
+    return (double)bench->bytes_per_iteration * bench->iterations * 1e9 / (double)bench->total_ns;
+}
+
+/**
+ * @brief Print benchmark results
+ * @param bench Benchmark state
+ */
+void test_bench_report(const test_bench_t *bench)
+{
+    printf("BENCH %s: %u iterations, mean %.0f ns, p50 %llu ns, p90 %llu ns, p99 %llu ns, max %llu ns",
+           bench->name, bench->iterations,
+           bench->iterations ? (double)bench->total_ns / bench->iterations : 0.0,
+           (unsigned long long)test_bench_percentile_ns(bench, 50),
+           (unsigned long long)test_bench_percentile_ns(bench, 90),
+           (unsigned long long)test_bench_percentile_ns(bench, 99),
+           (unsigned long long)(bench->iterations ? bench->samples[bench->iterations - 1] : 0));
+    if (bench->bytes_per_iteration) {
+        printf(", %.3f MB/s", test_bench_throughput(bench) / 1e6);
+    }
+    printf("\n");
+}
+
 /**
  * @brief Get global test statistics
  * @retval Pointer to global test statistics
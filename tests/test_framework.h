@@ -117,6 +117,64 @@ typedef struct {
         return TEST_SKIP; \
     } while(0)
 
+/* Benchmark support ---------------------------------------------------------*/
+#define TEST_BENCH_MIN_TIME_NS     100000000ULL    /* Run each benchmark for at least 100 ms */
+#define TEST_BENCH_MIN_ITERATIONS  10
+#define TEST_BENCH_MAX_SAMPLES     4096            /* Also the iteration cap */
+
+/* Budget units */
+#define TEST_KB_PER_SEC(x)  ((double)(x) * 1e3)
+#define TEST_MB_PER_SEC(x)  ((double)(x) * 1e6)
+#define TEST_US(x)          ((uint64_t)(x) * 1000ULL)
+#define TEST_MS(x)          ((uint64_t)(x) * 1000000ULL)
+
+/* Benchmark state: one monotonic-clock sample per timed iteration */
+typedef struct {
+    const char *name;
+    uint64_t bytes_per_iteration;   /* 0 if throughput is not meaningful */
+    uint32_t iterations;            /* Timed iterations (warm-up excluded) */
+    uint64_t total_ns;
+    uint64_t start_ns;              /* Start of the iteration in progress, 0 before the first */
+    bool warmup;                    /* The first iteration is run but not timed */
+    uint64_t samples[TEST_BENCH_MAX_SAMPLES];
+} test_bench_t;
+
+/**
+ * @brief Benchmark loop: runs the body until TEST_BENCH_MIN_TIME_NS and
+ *        TEST_BENCH_MIN_ITERATIONS are both reached (or TEST_BENCH_MAX_SAMPLES
+ *        iterations), then prints mean/percentiles/throughput.
+ * @note  The body must not use break or return.
+ *
+ *   test_bench_t bench;
+ *   TEST_BENCH(bench, "uart_send_string", len) {
+ *       uart_send_string(msg);
+ *   }
+ *   TEST_ASSERT_THROUGHPUT(bench, TEST_KB_PER_SEC(64), "UART TX throughput");
+ */
+#define TEST_BENCH(bench, name, bytes_per_iteration) \
+    for (test_bench_begin(&(bench), (name), (bytes_per_iteration)); test_bench_next(&(bench)); )
+
+#define TEST_ASSERT_THROUGHPUT(bench, min_bytes_per_sec, message) \
+    do { \
+        double throughput_ = test_bench_throughput(&(bench)); \
+        if (throughput_ < (double)(min_bytes_per_sec)) { \
+            printf("ASSERTION FAILED: %s - Throughput: %.0f B/s, Budget: >= %.0f B/s at %s:%d\n", \
+                   message, throughput_, (double)(min_bytes_per_sec), __FILE__, __LINE__); \
+            return TEST_FAIL; \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_LATENCY(bench, percentile, max_ns, message) \
+    do { \
+        uint64_t latency_ = test_bench_percentile_ns(&(bench), (percentile)); \
+        if (latency_ >= (uint64_t)(max_ns)) { \
+            printf("ASSERTION FAILED: %s - p%g latency: %llu ns, Budget: < %llu ns at %s:%d\n", \
+                   message, (double)(percentile), (unsigned long long)latency_, \
+                   (unsigned long long)(max_ns), __FILE__, __LINE__); \
+            return TEST_FAIL; \
+        } \
+    } while(0)
+
 /* Test runner functions -----------------------------------------------------*/
 test_result_t run_test_case(const test_case_t *test_case);
 test_result_t run_test_suite(const test_case_t test_cases[], uint32_t num_tests, const char *suite_name);
@@ -126,6 +184,9 @@ test_result_t run_all_tests(void);
 /* Test initialization and cleanup */
 void test_setup(void);
 void test_teardown(void);
+void test_set_suite_hooks(void (*setup)(void), void (*teardown)(void));
+void test_set_case_filter(bool (*filter)(const char *name));
+const char* test_current_name(void);
 
 /* Utility functions */
 void test_print_header(const char *test_name);
@@ -133,6 +194,14 @@ void test_print_separator(void);
 bool test_compare_memory(const void *ptr1, const void *ptr2, size_t size);
 void test_fill_memory(void *ptr, uint8_t value, size_t size);
 
+/* Benchmark functions */
+uint64_t test_monotonic_ns(void);
+void test_bench_begin(test_bench_t *bench, const char *name, uint64_t bytes_per_iteration);
+bool test_bench_next(test_bench_t *bench);
+uint64_t test_bench_percentile_ns(const test_bench_t *bench, double percentile);
+double test_bench_throughput(const test_bench_t *bench);
+void test_bench_report(const test_bench_t *bench);
+
 /* Global test statistics functions */
 const test_stats_t* get_global_test_stats(void);
 void reset_global_test_stats(void);
@@ -20,6 +20,8 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "test_framework.h"
+#include "test_sim_fixture.h"
+#include "test_footprint.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -63,12 +65,18 @@ static void print_usage(void)
     printf("  --dma              Run only DMA driver tests\n");
     printf("  --all              Run all test suites (default)\n");
     printf("  --verbose, -v      Enable verbose output\n");
+    printf("  --record-footprint FILE\n");
+    printf("                     Record the registers each test touches into FILE\n");
+    printf("  --footprint FILE   Footprint index used by --changed\n");
+    printf("  --changed LIST     Run only tests whose footprint intersects LIST: source\n");
+    printf("                     paths, devices (uart, dma0) or registers (uart:0x18)\n");
     printf("\n");
     printf("Examples:\n");
     printf("  test_runner              # Run all tests\n");
     printf("  test_runner --uart       # Run only UART tests\n");
     printf("  test_runner --dma        # Run only DMA tests\n");
     printf("  test_runner --verbose    # Run all tests with verbose output\n");
+    printf("  test_runner --footprint build/test_footprint.idx --changed src/simulator/plugins/uart_plugin.c\n");
     printf("\n");
 }
 
@@ -107,6 +115,9 @@ int main(int argc, char* argv[])
     bool run_dma = false;
     bool run_all = true;
     bool verbose = false;
+    const char *record_footprint = NULL;
+    const char *footprint_index = NULL;
+    const char *changed = NULL;
     
     /* Parse command line arguments */
     for (int i = 1; i < argc; i++) {
@@ -123,6 +134,12 @@ int main(int argc, char* argv[])
             run_all = true;
         } else if (strcmp(argv[i], "--verbose") == 0 || strcmp(argv[i], "-v") == 0) {
             verbose = true;
+        } else if (strcmp(argv[i], "--record-footprint") == 0 && i + 1 < argc) {
+            record_footprint = argv[++i];
+        } else if (strcmp(argv[i], "--footprint") == 0 && i + 1 < argc) {
+            footprint_index = argv[++i];
+        } else if (strcmp(argv[i], "--changed") == 0 && i + 1 < argc) {
+            changed = argv[++i];
         } else {
             printf("Error: Unknown option '%s'\n", argv[i]);
             print_usage();
@@ -133,6 +150,25 @@ int main(int argc, char* argv[])
     /* Print banner */
     print_test_banner();
     
+    /* Bring up the simulated chip once; each case then starts from a device reset */
+    if (test_sim_fixture_init() != 0) {
+        printf("Error: Failed to initialize the simulator fixture\n");
+        return 1;
+    }
+    
+    /* Footprint recording, or selection of the tests affected by a change */
+    if (record_footprint != NULL && test_footprint_record(record_footprint) != 0) {
+        printf("Error: Cannot record footprints to '%s'\n", record_footprint);
+        return 1;
+    }
+    if (changed != NULL) {
+        if (footprint_index == NULL) {
+            printf("Error: --changed needs --footprint FILE\n");
+            return 1;
+        }
+        test_footprint_select(footprint_index, changed);
+    }
+    
     /* Reset global test statistics */
     reset_global_test_stats();
     
@@ -171,6 +207,11 @@ int main(int argc, char* argv[])
         }
     }
     
+    if (test_footprint_finish() != 0) {
+        exit_code = 1;
+    }
+    test_sim_fixture_cleanup();
+    
     /* Print global summary */
     printf("\n");
     print_global_test_summary();
@@ -206,6 +247,8 @@ void test_setup(void)
 {
     /* Global test setup - can be customized */
     /* This function is called before each individual test */
+    test_sim_fixture_reset();
+    test_footprint_case_begin();
 }
 
 /**
@@ -215,4 +258,5 @@ void test_teardown(void)
 {
     /* Global test teardown - can be customized */
     /* This function is called after each individual test */
+    test_footprint_case_end(test_current_name());
 }
\ No newline at end of file
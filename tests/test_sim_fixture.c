@@ -0,0 +1,185 @@
+/**
+ ******************************************************************************
+ * @file    test_sim_fixture.c
+ * @author  IC Simulator Team
+ * @brief   Shared Simulator Fixture for Driver Test Suites
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "test_sim_fixture.h"
+#include "test_framework.h"
+#include "../src/common/register_map.h"
+#include "../src/sim_interface/sim_interface.h"
+#include "../src/sim_interface/interrupt_manager.h"
+#include "../src/simulator/plugin_interface.h"
+#include <stdio.h>
+#include <string.h>
+
+/* External functions --------------------------------------------------------*/
+extern simulator_plugin_t* create_uart_plugin_multi_instance(const char *instance_name, int instance_id);
+extern simulator_plugin_t* create_dma_plugin_multi_instance(const char *instance_name, int instance_id);
+extern int register_plugin(simulator_plugin_t *plugin);
+extern int get_plugin_count(void);
+extern simulator_plugin_t* get_plugin_at(int index);
+extern int handle_sim_message(const sim_message_t *msg, sim_message_t *response);
+
+/* Private variables ---------------------------------------------------------*/
+
+/** @brief Devices exercised by the driver suites (same layout as the simulator) */
+static const struct {
+    uint32_t start_addr;
+    uint32_t end_addr;
+    const char *module;
+} fixture_register_mappings[] = {
+    {UART_BASE + 0x0000, UART_BASE + 0x0068, "uart0"},
+    {DMA_BASE_ADDR + 0x0000, DMA_BASE_ADDR + 0x0300, "dma0"},
+};
+
+static const struct {
+    uint32_t start_addr;
+    uint32_t size;
+    const char *name;
+} fixture_memory_mappings[] = {
+    {SRAM_BASE, SRAM_SIZE, "sram"},
+    {DRAM_BASE, DRAM_SIZE, "dram"},
+};
+
+static const struct {
+    int signal_num;
+    const char *module;
+    uint32_t irq_num;
+} fixture_signal_mappings[] = {
+    {34, "uart0", 5},
+    {35, "uart0", 6},
+    {40, "dma0", 8},
+};
+
+#define FIXTURE_COUNT(table) (sizeof(table) / sizeof((table)[0]))
+
+static bool fixture_ready = false;
+static uint32_t fixture_resets = 0;
+static uint64_t fixture_reset_ns = 0;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Drive one reset phase on a plugin through the message dispatcher
+ */
+static int fixture_reset_plugin(simulator_plugin_t *plugin, reset_action_t action)
+{
+    sim_message_t msg;
+    sim_message_t response;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_RESET;
+    strncpy(msg.module, plugin->name, sizeof(msg.module) - 1);
+    msg.data.reset.action = action;
+    return handle_sim_message(&msg, &response);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+int test_sim_fixture_init(void)
+{
+    if (fixture_ready) {
+        return 0;
+    }
+
+    uint64_t start_ns = test_monotonic_ns();
+
+    if (interrupt_manager_init() != 0 || sim_interface_init() != 0) {
+        printf("[SIM_FIXTURE] Failed to initialize interrupt manager or sim interface\n");
+        return -1;
+    }
+
+    simulator_plugin_t *uart = create_uart_plugin_multi_instance("uart0", 0);
+    if (!uart || register_plugin(uart) != 0) {
+        printf("[SIM_FIXTURE] Failed to register uart0 plugin\n");
+        return -1;
+    }
+    simulator_plugin_t *dma = create_dma_plugin_multi_instance("dma0", 0);
+    if (!dma || register_plugin(dma) != 0) {
+        printf("[SIM_FIXTURE] Failed to register dma0 plugin\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < FIXTURE_COUNT(fixture_register_mappings); i++) {
+        if (add_register_mapping(fixture_register_mappings[i].start_addr,
+                                 fixture_register_mappings[i].end_addr,
+                                 fixture_register_mappings[i].module) != 0) {
+            printf("[SIM_FIXTURE] Failed to map %s registers\n", fixture_register_mappings[i].module);
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < FIXTURE_COUNT(fixture_memory_mappings); i++) {
+        if (add_memory_mapping(fixture_memory_mappings[i].start_addr,
+                               fixture_memory_mappings[i].size,
+                               fixture_memory_mappings[i].name) != 0) {
+            printf("[SIM_FIXTURE] Failed to map %s\n", fixture_memory_mappings[i].name);
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < FIXTURE_COUNT(fixture_signal_mappings); i++) {
+        if (add_signal_mapping(fixture_signal_mappings[i].signal_num,
+                               fixture_signal_mappings[i].module,
+                               fixture_signal_mappings[i].irq_num) != 0) {
+            printf("[SIM_FIXTURE] Failed to map %s IRQ %u\n",
+                   fixture_signal_mappings[i].module, fixture_signal_mappings[i].irq_num);
+            return -1;
+        }
+    }
+
+    fixture_ready = true;
+    printf("[SIM_FIXTURE] Simulator ready in %.3f ms (%d plugins)\n",
+           (double)(test_monotonic_ns() - start_ns) / 1e6, get_plugin_count());
+    return 0;
+}
+
+bool test_sim_fixture_ready(void)
+{
+    return fixture_ready;
+}
+
+void test_sim_fixture_reset(void)
+{
+    if (!fixture_ready) {
+        return;
+    }
+
+    uint64_t start_ns = test_monotonic_ns();
+    for (int i = 0; i < get_plugin_count(); i++) {
+        simulator_plugin_t *plugin = get_plugin_at(i);
+        fixture_reset_plugin(plugin, RESET_ASSERT);
+        fixture_reset_plugin(plugin, RESET_DEASSERT);
+    }
+    fixture_reset_ns += test_monotonic_ns() - start_ns;
+    fixture_resets++;
+}
+
+void test_sim_fixture_cleanup(void)
+{
+    if (!fixture_ready) {
+        return;
+    }
+
+    if (fixture_resets > 0) {
+        printf("[SIM_FIXTURE] %u device resets, %.3f ms average\n",
+               fixture_resets, (double)fixture_reset_ns / fixture_resets / 1e6);
+    }
+    interrupt_manager_cleanup();
+    sim_interface_cleanup();
+    fixture_ready = false;
+}
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file    test_sim_fixture.h
+ * @author  IC Simulator Team
+ * @brief   Shared Simulator Fixture for Driver Test Suites
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TEST_SIM_FIXTURE_H
+#define __TEST_SIM_FIXTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief  Bring up the simulated chip once per test run.
+ * @note   Installs the trap handler, registers the uart0 and dma0 plugins and
+ *         maps their registers, SRAM/DRAM and interrupt signals. Later calls
+ *         return immediately.
+ * @retval 0 on success, -1 on error
+ */
+int test_sim_fixture_init(void);
+
+/**
+ * @brief  Check whether the simulated chip is up.
+ * @retval true when test_sim_fixture_init() succeeded
+ */
+bool test_sim_fixture_ready(void);
+
+/**
+ * @brief  Return every device to its power-on state between test cases.
+ * @note   Pulses reset on each plugin through its reset hook instead of
+ *         tearing the simulator down, so a case costs microseconds of setup.
+ */
+void test_sim_fixture_reset(void);
+
+/**
+ * @brief  Stop the plugins and release the mappings at the end of the run.
+ */
+void test_sim_fixture_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TEST_SIM_FIXTURE_H */
@@ -20,28 +20,35 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "test_framework.h"
+#include "test_sim_fixture.h"
 #include "../src/driver/uart_driver.h"
+#include "../src/driver/dma_driver.h"
+#include "../src/driver/uart_log.h"
 #include "../src/common/register_map.h"
 #include "../src/sim_interface/sim_interface.h"
 #include "../src/sim_interface/interrupt_manager.h"
+#include "../src/sim_interface/sim_stimulus.h"
+#include "../src/simulator/plugin_interface.h"
 #include <string.h>
 
+/* External functions --------------------------------------------------------*/
+extern simulator_plugin_t* find_plugin(const char *name);
+
 /* Private variables ---------------------------------------------------------*/
 static UART_HandleTypeDef test_uart_handle;
 static uint8_t test_tx_buffer[256];
 static uint8_t test_rx_buffer[256];
-static bool sim_initialized = false;
+
+/* Bytes written to the UART data register while a capture is installed */
+static int (*test_uart_reg_write)(simulator_plugin_t *plugin, uint32_t address, uint32_t value);
+static uint8_t test_uart_wire[64];
+static volatile uint32_t test_uart_wire_len;
 
 /* Test setup and teardown ---------------------------------------------------*/
 void uart_test_setup(void)
 {
-    /* Initialize simulation interface if not already done */
-    if (!sim_initialized) {
-        /* Note: In a real test environment, we might skip simulation init 
-         * and just test the driver logic directly */
-        sim_initialized = true;
-        printf("[UART_TEST] Simulation interface initialization skipped for unit testing\n");
-    }
+    /* The simulator itself is brought up once by the shared fixture */
+    test_sim_fixture_init();
     
     /* Initialize UART handle for testing */
     memset(&test_uart_handle, 0, sizeof(test_uart_handle));
@@ -314,6 +321,305 @@ test_result_t test_uart_dma_functions(void)
     TEST_PASS_MSG("UART DMA function tests passed");
 }
 
+/**
+ * @brief Test UART TX throughput through the trapped register path
+ */
+test_result_t test_uart_send_string_throughput(void)
+{
+    static test_bench_t bench;
+    const char *message = "0123456789abcdef0123456789abcdef";
+    int result;
+    int failures = 0;
+    
+    result = uart_init();
+    TEST_ASSERT_EQUAL(0, result, "UART init should succeed");
+    
+    TEST_BENCH(bench, "uart_send_string", strlen(message)) {
+        failures += uart_send_string(message) != 0;
+    }
+    uart_cleanup();
+    
+    TEST_ASSERT_EQUAL(0, failures, "uart_send_string should succeed on every iteration");
+    TEST_ASSERT_THROUGHPUT(bench, TEST_KB_PER_SEC(2), "UART TX throughput below budget");
+    
+    TEST_PASS_MSG("UART TX throughput within budget");
+}
+
+/**
+ * @brief Test UART polling receive of seeded RX-line stimulus
+ */
+test_result_t test_uart_receive_stimulus(void)
+{
+    sim_stim_config_t cfg;
+    sim_stim_stats_t stats;
+    HAL_StatusTypeDef status;
+    uint32_t i;
+    
+    status = HAL_UART_Init(&test_uart_handle);
+    TEST_ASSERT_EQUAL(HAL_OK, status, "UART init should succeed");
+    
+    /* One sequence byte every third trapped access, 16 bytes in total */
+    TEST_ASSERT_EQUAL(0, sim_stim_parse("uart0:const:interval=300,count=16", &cfg), "Stimulus spec should parse");
+    TEST_ASSERT_EQUAL(0, sim_stim_add(&cfg), "Stimulus should be added");
+    
+    status = HAL_UART_Receive(&test_uart_handle, test_rx_buffer, 16, 1000);
+    TEST_ASSERT_EQUAL(1, sim_stim_stats(&stats, 1), "One stimulus generator should be reported");
+    sim_stim_clear();
+    
+    TEST_ASSERT_EQUAL(HAL_OK, status, "UART receive should complete with injected bytes");
+    for (i = 0; i < 16; i++) {
+        TEST_ASSERT_EQUAL(i, test_rx_buffer[i], "Received bytes should follow the stimulus sequence");
+    }
+    TEST_ASSERT_EQUAL(16, stats.injected, "All stimulus bytes should be injected");
+    TEST_ASSERT_TRUE(stats.done, "Stimulus should be done after its count");
+    
+    TEST_PASS_MSG("UART stimulus receive tests passed");
+}
+
+/**
+ * @brief Test the RX loan ring: DMA-filled spans consumed in place across a wrap
+ */
+test_result_t test_uart_rx_loan(void)
+{
+    sim_stim_config_t cfg;
+    const uint8_t *span;
+    uint32_t len;
+    uint32_t expected = 0;
+    uint32_t i;
+    int attempts;
+    int result;
+    
+    TEST_ASSERT_EQUAL(0, dma_init(), "DMA init should succeed");
+    
+    /* Ring size must be a power of two inside SRAM */
+    TEST_ASSERT_EQUAL(-1, uart_rx_ring_start(SRAM_BASE, 48), "Non power of two ring should be rejected");
+    TEST_ASSERT_EQUAL(-1, uart_rx_loan(&span, &len), "Loan before start should fail");
+    
+    result = uart_rx_ring_start(SRAM_BASE + 0x20000, 32);
+    TEST_ASSERT_EQUAL(0, result, "RX ring start should succeed");
+    
+    /* 80 sequence bytes through a 32-byte ring wrap it more than twice */
+    TEST_ASSERT_EQUAL(0, sim_stim_parse("uart0:const:interval=300,count=80", &cfg), "Stimulus spec should parse");
+    TEST_ASSERT_EQUAL(0, sim_stim_add(&cfg), "Stimulus should be added");
+    
+    for (attempts = 0; attempts < 2000 && expected < 80; attempts++) {
+        if (uart_rx_loan(&span, &len) != 0) {
+            break;
+        }
+        TEST_ASSERT_TRUE(len <= 32, "A loaned span should not exceed the ring");
+        for (i = 0; i < len && span[i] == (uint8_t)(expected + i); i++) {
+        }
+        if (i != len) {
+            break;
+        }
+        /* Consume only half of longer spans, the remainder must be loaned again */
+        len = len > 4 ? len / 2 : len;
+        expected += len;
+        TEST_ASSERT_EQUAL(0, uart_rx_release(len), "Release should succeed");
+    }
+    sim_stim_clear();
+    
+    TEST_ASSERT_EQUAL(80, expected, "All stimulus bytes should be loaned in order");
+    TEST_ASSERT_EQUAL(-1, uart_rx_release(1), "Release without a loan should fail");
+    
+    uart_rx_ring_stop();
+    dma_cleanup();
+    
+    TEST_PASS_MSG("UART RX loan ring tests passed");
+}
+
+/**
+ * @brief Test the DMA-drained log sink under each overflow policy
+ */
+test_result_t test_uart_log_sink(void)
+{
+    static const uart_log_policy_t policies[] = {UART_LOG_DROP, UART_LOG_OVERWRITE, UART_LOG_BLOCK};
+    uart_log_stats_t stats;
+    uint32_t p;
+    int i;
+    int accepted;
+    
+    TEST_ASSERT_EQUAL(0, dma_init(), "DMA init should succeed");
+    TEST_ASSERT_EQUAL(-1, uart_log_init(SRAM_BASE + 0x30000, 100, UART_LOG_DROP), "Non power of two ring should be rejected");
+    TEST_ASSERT_EQUAL(-1, uart_log_init(SRAM_BASE, 0x80000000U, UART_LOG_DROP), "Ring larger than SRAM should be rejected");
+    TEST_ASSERT_EQUAL(-1, uart_log_write("x", 1), "Write before init should fail");
+    
+    for (p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        TEST_ASSERT_EQUAL(0, uart_log_init(SRAM_BASE + 0x30000, 128, policies[p]), "Log sink init should succeed");
+        
+        /* A burst of 40-byte records overruns the 128-byte ring unless the policy blocks */
+        accepted = 0;
+        for (i = 0; i < 32; i++) {
+            accepted += uart_log_printf("[%02d] policy %u burst record........\n", i, p) == 0;
+        }
+        TEST_ASSERT_EQUAL(0, uart_log_flush(1000), "Flush should drain the ring");
+        uart_log_get_stats(&stats);
+        uart_log_deinit();
+        
+        TEST_ASSERT_EQUAL((uint32_t)accepted, stats.records, "Accepted writes should be counted as records");
+        TEST_ASSERT_EQUAL(32U, stats.records + stats.dropped, "Every write should be accepted or dropped");
+        TEST_ASSERT_EQUAL(0U, stats.dma_errors, "Drain transfers should not fail");
+        TEST_ASSERT_TRUE(stats.high_water <= 128U, "Ring use should stay within the ring");
+        if (policies[p] == UART_LOG_DROP) {
+            TEST_ASSERT_TRUE(stats.dropped > 0U, "Drop policy should drop records of the burst");
+        } else {
+            TEST_ASSERT_EQUAL(0U, stats.dropped, "Overwrite and block policies should not drop records");
+        }
+        if (policies[p] == UART_LOG_OVERWRITE) {
+            TEST_ASSERT_TRUE(stats.overwritten > 0U, "Overwrite policy should discard older records");
+        }
+        if (policies[p] != UART_LOG_OVERWRITE) {
+            TEST_ASSERT_EQUAL(stats.bytes, stats.sent_bytes, "Every accepted byte should reach the UART");
+        } else {
+            /* Records of the burst all have the same length */
+            TEST_ASSERT_EQUAL(stats.bytes / stats.records * (stats.records - stats.overwritten), stats.sent_bytes,
+                              "Every record not overwritten should reach the UART");
+        }
+    }
+    
+    dma_cleanup();
+    TEST_PASS_MSG("UART log sink tests passed");
+}
+
+/**
+ * @brief uart0 register write hook recording the bytes sent on the line
+ */
+static int test_uart_capture_write(simulator_plugin_t *plugin, uint32_t address, uint32_t value)
+{
+    if (address == UART_TX_REG && test_uart_wire_len < sizeof(test_uart_wire)) {
+        test_uart_wire[test_uart_wire_len] = (uint8_t)value;
+        test_uart_wire_len = test_uart_wire_len + 1U;
+    }
+    return test_uart_reg_write(plugin, address, value);
+}
+
+/**
+ * @brief Test a vectored transmit gathered by one chained DMA operation
+ */
+test_result_t test_uart_transmit_v(void)
+{
+    uint8_t *frame = (uint8_t *)(uintptr_t)(SRAM_BASE + 0x31000);
+    uint8_t host_buffer[4] = {0};
+    struct iovec iov[4];
+    uint32_t raised = 0;
+    uint32_t waits;
+    
+    TEST_ASSERT_EQUAL(0, dma_init(), "DMA init should succeed");
+    TEST_ASSERT_EQUAL(HAL_OK, HAL_UART_Init(&test_uart_handle), "UART init should succeed");
+    test_uart_handle.pTxLli = (DMA_LLI_TypeDef *)(uintptr_t)(SRAM_BASE + 0x31100);
+    test_uart_handle.TxLliCount = 2;
+    
+    /* Header, payload and CRC of one frame in separate buffers, an empty piece is skipped */
+    memcpy(frame, "\xA5\x5A\x00\x10", 4);
+    memcpy(frame + 0x40, "vectored payload", 16);
+    memcpy(frame + 0x80, "\x12\x34", 2);
+    iov[0].iov_base = frame;
+    iov[0].iov_len = 4;
+    iov[1].iov_base = frame + 0x40;
+    iov[1].iov_len = 16;
+    iov[2].iov_base = frame + 0x60;
+    iov[2].iov_len = 0;
+    iov[3].iov_base = frame + 0x80;
+    iov[3].iov_len = 2;
+    
+    TEST_ASSERT_EQUAL(HAL_ERROR, HAL_UART_TransmitV(&test_uart_handle, iov, 4), "More pieces than items should be rejected");
+    test_uart_handle.TxLliCount = 3;
+    iov[2].iov_base = host_buffer;
+    iov[2].iov_len = sizeof(host_buffer);
+    TEST_ASSERT_EQUAL(HAL_ERROR, HAL_UART_TransmitV(&test_uart_handle, iov, 4), "Buffers outside SRAM should be rejected");
+    iov[2].iov_len = 0;
+    
+    iov[1].iov_len = SRAM_SIZE + 1U;
+    TEST_ASSERT_EQUAL(HAL_ERROR, HAL_UART_TransmitV(&test_uart_handle, iov, 4), "Pieces larger than SRAM should be rejected");
+    iov[1].iov_len = 16;
+    
+    /* Record what the DMA writes to the data register */
+    simulator_plugin_t *uart = find_plugin("uart0");
+    TEST_ASSERT_NOT_NULL(uart, "uart0 plugin should be registered");
+    test_uart_reg_write = uart->reg_write;
+    test_uart_wire_len = 0;
+    uart->reg_write = test_uart_capture_write;
+    
+    dma_get_irq_stats(NULL, NULL, true);
+    HAL_StatusTypeDef started = HAL_UART_TransmitV(&test_uart_handle, iov, 4);
+    for (waits = 0; started == HAL_OK && waits < 10000000U && test_uart_handle.gState != HAL_UART_STATE_READY; waits++) {
+    }
+    dma_get_irq_stats(&raised, NULL, false);
+    uart->reg_write = test_uart_reg_write;
+    
+    TEST_ASSERT_EQUAL(HAL_OK, started, "Vectored transmit should start");
+    
+    TEST_ASSERT_EQUAL(HAL_UART_STATE_READY, test_uart_handle.gState, "Vectored transmit should complete");
+    TEST_ASSERT_TRUE(test_uart_handle.TxCompleted, "Completion should be flagged");
+    TEST_ASSERT_EQUAL(HAL_UART_ERROR_NONE, test_uart_handle.ErrorCode, "Vectored transmit should not fail");
+    TEST_ASSERT_EQUAL(1U, raised, "The whole frame should raise a single DMA interrupt");
+    TEST_ASSERT_EQUAL(22U, test_uart_wire_len, "Every byte of the non-empty pieces should be sent");
+    TEST_ASSERT_TRUE(memcmp(test_uart_wire, "\xA5\x5A\x00\x10" "vectored payload" "\x12\x34", 22) == 0,
+                     "Pieces should be sent in chain order without the empty one");
+    
+    HAL_UART_DeInit(&test_uart_handle);
+    dma_cleanup();
+    TEST_PASS_MSG("UART vectored transmit tests passed");
+}
+
+/**
+ * @brief Test reception to idle: variable-length frames, one UART interrupt each
+ */
+test_result_t test_uart_rx_to_idle(void)
+{
+    static const uint32_t frames[] = {10, 23};
+    uint8_t *buffer = (uint8_t *)(uintptr_t)(SRAM_BASE + 0x32000);
+    sim_stim_config_t cfg;
+    char spec[64];
+    uint32_t raised = 0;
+    uint32_t waits;
+    uint32_t f;
+    uint32_t i;
+    
+    TEST_ASSERT_EQUAL(0, dma_init(), "DMA init should succeed");
+    TEST_ASSERT_EQUAL(HAL_OK, HAL_UART_Init(&test_uart_handle), "UART init should succeed");
+    TEST_ASSERT_EQUAL(HAL_ERROR, HAL_UARTEx_ReceiveToIdle_DMA(&test_uart_handle, test_rx_buffer, 64),
+                      "Buffers outside SRAM should be rejected");
+    
+    /* Idle after 2 us of silence; bytes 300 ns apart belong to one frame */
+    test_uart_handle.Instance->RXTO = 2000;
+    while (test_uart_handle.Instance->RXLVL != 0U) {
+        (void)test_uart_handle.Instance->DR;
+    }
+    
+    for (f = 0; f < sizeof(frames) / sizeof(frames[0]); f++) {
+        memset(buffer, 0xFF, 64);
+        uart_get_irq_stats(NULL, NULL, true);
+        TEST_ASSERT_EQUAL(HAL_OK, HAL_UARTEx_ReceiveToIdle_DMA(&test_uart_handle, buffer, 64), "Reception to idle should start");
+        TEST_ASSERT_EQUAL(HAL_BUSY, HAL_UARTEx_ReceiveToIdle_DMA(&test_uart_handle, buffer, 64), "A second reception should be refused");
+        
+        snprintf(spec, sizeof(spec), "uart0:const:interval=300,count=%u", (unsigned)frames[f]);
+        TEST_ASSERT_EQUAL(0, sim_stim_parse(spec, &cfg), "Stimulus spec should parse");
+        TEST_ASSERT_EQUAL(0, sim_stim_add(&cfg), "Stimulus should be added");
+        
+        /* Each trapped access advances virtual time, the line goes idle after the frame */
+        for (waits = 0; waits < 100000U && test_uart_handle.RxState != HAL_UART_STATE_READY; waits++) {
+            (void)test_uart_handle.Instance->FR;
+        }
+        uart_get_irq_stats(&raised, NULL, false);
+        sim_stim_clear();
+        
+        TEST_ASSERT_EQUAL(HAL_UART_STATE_READY, test_uart_handle.RxState, "Reception should end on idle");
+        TEST_ASSERT_EQUAL(HAL_UART_ERROR_NONE, test_uart_handle.ErrorCode, "Reception should not fail");
+        TEST_ASSERT_EQUAL(frames[f], (uint32_t)(test_uart_handle.RxXferSize - test_uart_handle.RxXferCount),
+                          "The actual frame length should be reported");
+        for (i = 0; i < frames[f]; i++) {
+            TEST_ASSERT_EQUAL(i, buffer[i], "Received bytes should follow the stimulus sequence");
+        }
+        TEST_ASSERT_EQUAL(0xFF, buffer[frames[f]], "Nothing should be written past the frame");
+        TEST_ASSERT_EQUAL(1U, raised, "A frame should raise a single UART interrupt");
+    }
+    
+    HAL_UART_DeInit(&test_uart_handle);
+    dma_cleanup();
+    TEST_PASS_MSG("UART reception to idle tests passed");
+}
+
 /* Test suite definition -----------------------------------------------------*/
 const test_case_t uart_test_cases[] = {
     {"UART_HAL_Init", test_uart_hal_init, "Test UART HAL initialization functionality"},
@@ -323,6 +629,12 @@ const test_case_t uart_test_cases[] = {
     {"UART_State_Management", test_uart_state_management, "Test UART state and error management"},
     {"UART_Legacy_Functions", test_uart_legacy_functions, "Test legacy UART functions"},
     {"UART_DMA_Functions", test_uart_dma_functions, "Test UART DMA functionality"},
+    {"UART_Receive_Stimulus", test_uart_receive_stimulus, "Test UART receive of seeded RX stimulus"},
+    {"UART_RX_Loan", test_uart_rx_loan, "Test UART RX loan ring filled by DMA"},
+    {"UART_Log_Sink", test_uart_log_sink, "Test the DMA-drained UART log sink"},
+    {"UART_TransmitV", test_uart_transmit_v, "Test UART vectored transmit over chained DMA"},
+    {"UART_RX_To_Idle", test_uart_rx_to_idle, "Test UART variable-length DMA reception ended by line idle"},
+    {"UART_TX_Throughput", test_uart_send_string_throughput, "Benchmark uart_send_string against its throughput budget"},
 };
 
 const uint32_t uart_test_count = sizeof(uart_test_cases) / sizeof(uart_test_cases[0]);
@@ -333,6 +645,8 @@ const uint32_t uart_test_count = sizeof(uart_test_cases) / sizeof(uart_test_case
  */
 test_result_t run_uart_tests(void)
 {
+    test_set_suite_hooks(uart_test_setup, uart_test_teardown);
     test_result_t result = run_test_suite(uart_test_cases, uart_test_count, "UART Driver Tests");
+    test_set_suite_hooks(NULL, NULL);
     return result;
 }
\ No newline at end of file
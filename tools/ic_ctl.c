@@ -0,0 +1,195 @@
+/**
+ ******************************************************************************
+ * @file    ic_ctl.c
+ * @author  IC Simulator Team
+ * @brief   Simulator Control Socket Client
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ *
+ * Usage: ic_ctl SOCKET [--watch SECONDS] [COMMAND [ARGS...]]
+ *
+ * Connects to a simulator started with `ic_simulator --control SOCKET`.
+ * With a command, sends it and prints the reply; --watch repeats it every
+ * SECONDS until interrupted. Without a command, reads commands from stdin.
+ * Exits non-zero if any command is answered with ERR.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* Private define ------------------------------------------------------------*/
+#define CTL_LINE_MAX            256U
+
+/* Private variables ---------------------------------------------------------*/
+static char s_rx[4096];
+static size_t s_rx_len = 0;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Connect to the control socket
+ * @retval Socket descriptor, -1 on failure
+ */
+static int ctl_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "ic_ctl: socket path too long\n");
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("ic_ctl: connect");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief  Read one reply line into line (without the newline)
+ * @retval 0 on success, -1 if the simulator closed the connection
+ */
+static int ctl_read_line(int fd, char *line, size_t size)
+{
+    for (;;) {
+        char *nl = memchr(s_rx, '\n', s_rx_len);
+        if (nl) {
+            size_t len = (size_t)(nl - s_rx);
+            size_t copy = len < size - 1U ? len : size - 1U;
+            memcpy(line, s_rx, copy);
+            line[copy] = '\0';
+            s_rx_len -= len + 1U;
+            memmove(s_rx, nl + 1, s_rx_len);
+            return 0;
+        }
+        if (s_rx_len == sizeof(s_rx)) {
+            s_rx_len = 0;                    /* Overlong line: drop it */
+        }
+        ssize_t n = recv(fd, s_rx + s_rx_len, sizeof(s_rx) - s_rx_len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        s_rx_len += (size_t)n;
+    }
+}
+
+/**
+ * @brief  Send one command and print its reply up to the OK/ERR line
+ * @retval 0 if answered OK, 1 if answered ERR, -1 on connection loss
+ */
+static int ctl_command(int fd, const char *command)
+{
+    char line[CTL_LINE_MAX];
+    size_t len = strlen(command);
+
+    if (send(fd, command, len, MSG_NOSIGNAL) != (ssize_t)len ||
+        send(fd, "\n", 1, MSG_NOSIGNAL) != 1) {
+        return -1;
+    }
+    while (ctl_read_line(fd, line, sizeof(line)) == 0) {
+        if (strcmp(line, "OK") == 0) {
+            return 0;
+        }
+        if (strncmp(line, "ERR", 3) == 0) {
+            fprintf(stderr, "%s\n", line);
+            return 1;
+        }
+        printf("%s\n", line);
+    }
+    return -1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    char command[CTL_LINE_MAX] = "";
+    unsigned int watch = 0;
+    int status = 0;
+    int argi = 2;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s SOCKET [--watch SECONDS] [COMMAND [ARGS...]]\n", argv[0]);
+        return 2;
+    }
+    if (argi + 1 < argc && strcmp(argv[argi], "--watch") == 0) {
+        watch = (unsigned int)strtoul(argv[argi + 1], NULL, 0);
+        argi += 2;
+    }
+    for (; argi < argc; argi++) {
+        if (command[0] != '\0') {
+            strncat(command, " ", sizeof(command) - strlen(command) - 1U);
+        }
+        strncat(command, argv[argi], sizeof(command) - strlen(command) - 1U);
+    }
+
+    int fd = ctl_connect(argv[1]);
+    if (fd < 0) {
+        return 2;
+    }
+
+    if (command[0] != '\0') {
+        do {
+            int result = ctl_command(fd, command);
+            if (result < 0) {
+                fprintf(stderr, "ic_ctl: connection closed\n");
+                status = 2;
+                break;
+            }
+            status |= result;
+            if (watch) {
+                printf("\n");
+                fflush(stdout);
+                sleep(watch);
+            }
+        } while (watch);
+    } else {
+        char line[CTL_LINE_MAX];
+        while (fgets(line, sizeof(line), stdin)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0') {
+                continue;
+            }
+            int result = ctl_command(fd, line);
+            if (result < 0) {
+                break;
+            }
+            status |= result;
+            if (strcmp(line, "quit") == 0) {
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return status;
+}
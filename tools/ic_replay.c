@@ -0,0 +1,308 @@
+/**
+ ******************************************************************************
+ * @file    ic_replay.c
+ * @author  IC Simulator Team
+ * @brief   Record/Replay Log Inspection Tool
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ *
+ * Usage: ic_replay FILE [--from VTIME_NS] [--to VTIME_NS] [--count N] [--summary]
+ *                  [--chunks] [--module NAME] [--address ADDR]
+ *
+ * Prints the header and snapshot index of a log written by
+ * `ic_simulator --record FILE`, then decodes events. --from seeks through the
+ * index to the nearest snapshot before VTIME_NS instead of scanning the log.
+ *
+ * --chunks lists the compressed chunks of the log. With --module, --address
+ * or --to only chunks whose header (vtime range, module mask, address bloom
+ * filter) can match are decompressed; the others are skipped unread.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_interface/replay_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TOOL_DEFAULT_COUNT      64U
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    const replay_log_header_t *header;
+    uint64_t from;
+    uint64_t to;
+    int module;                 /* Module table index, -1 for any */
+    int has_address;
+    uint32_t address;
+    uint64_t count;
+    int summary;
+    uint64_t totals[REPLAY_EV_SNAPSHOT + 1];
+    uint64_t printed;
+    uint64_t last_vtime;
+} tool_walk_t;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Print one decoded event
+ */
+static void print_event(const replay_log_header_t *header, const replay_event_t *ev)
+{
+    const char *module = header->modules[ev->module];
+
+    switch (ev->type) {
+        case REPLAY_EV_TRAP:
+            printf("  %14llu  TRAP   %-6s slot %c%-3u %-5s 0x%08X = 0x%08X\n",
+                   (unsigned long long)ev->vtime, module,
+                   (ev->slot & REPLAY_SLOT_ISR) ? 'i' : ' ', ev->slot & 0x7FU,
+                   ev->is_write ? "write" : "read", ev->address, ev->value);
+            break;
+        case REPLAY_EV_INPUT:
+            printf("  %14llu  INPUT  %-6s channel %u value 0x%02X\n",
+                   (unsigned long long)ev->vtime, module, ev->channel, ev->value);
+            break;
+        case REPLAY_EV_IRQ:
+            printf("  %14llu  IRQ    %-6s irq %u delivered\n",
+                   (unsigned long long)ev->vtime, module, ev->value);
+            break;
+        case REPLAY_EV_RAISE:
+            printf("  %14llu  RAISE  %-6s irq %u\n",
+                   (unsigned long long)ev->vtime, module, ev->value);
+            break;
+        case REPLAY_EV_SNAPSHOT:
+            printf("  %14llu  SNAP   trap %llu, %u device states, %u bytes\n",
+                   (unsigned long long)ev->vtime, (unsigned long long)ev->trap_seq,
+                   ev->count, ev->data_len);
+            break;
+    }
+}
+
+/**
+ * @brief  Print the chunk table and the overall compression ratio
+ */
+static void print_chunks(const replay_log_header_t *header,
+                         const replay_chunk_info_t *chunks, size_t chunk_count)
+{
+    uint64_t raw = 0;
+    uint64_t stored = 0;
+
+    printf("%zu chunks:\n", chunk_count);
+    for (size_t i = 0; i < chunk_count; i++) {
+        const replay_chunk_info_t *c = &chunks[i];
+        printf("  #%-4zu @%-9llu vtime %llu..%llu  %6u events  %6u -> %6u bytes%s  ",
+               i, (unsigned long long)c->offset, (unsigned long long)c->vtime_first,
+               (unsigned long long)c->vtime_last, c->events, c->raw_len, c->stored_len,
+               c->compressed ? "" : " (stored)");
+        for (uint32_t m = 0; m < header->module_count; m++) {
+            if (c->module_mask & (1U << m)) {
+                printf(" %s", header->modules[m]);
+            }
+        }
+        printf("%s\n", c->snapshot ? "  [snapshot]" : "");
+        raw += c->raw_len;
+        stored += c->stored_len;
+    }
+    if (stored) {
+        printf("Compressed %llu event bytes to %llu (%.2fx)\n",
+               (unsigned long long)raw, (unsigned long long)stored, (double)raw / (double)stored);
+    }
+}
+
+/**
+ * @brief  Whether a chunk header admits events matching the filters
+ */
+static int chunk_selected(const tool_walk_t *walk, const replay_chunk_info_t *c)
+{
+    if (c->vtime_last < walk->from || c->vtime_first > walk->to) {
+        return 0;
+    }
+    if (walk->module >= 0 && !(c->module_mask & (1U << walk->module))) {
+        return 0;
+    }
+    if (walk->has_address && !replay_chunk_may_contain(c, walk->address)) {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief  Tally and print one event if it matches the filters
+ * @retval 1 once enough events have been printed, 0 to continue
+ */
+static int visit_event(tool_walk_t *walk, const replay_event_t *ev)
+{
+    if (ev->vtime < walk->from || ev->vtime > walk->to) {
+        return 0;
+    }
+    if (walk->module >= 0 && (ev->type == REPLAY_EV_SNAPSHOT || ev->module != walk->module)) {
+        return 0;
+    }
+    if (walk->has_address && (ev->type != REPLAY_EV_TRAP || ev->address != walk->address)) {
+        return 0;
+    }
+    walk->totals[ev->type]++;
+    walk->last_vtime = ev->vtime;
+    if (walk->summary) {
+        return 0;
+    }
+    if (walk->printed == walk->count) {
+        return 1;
+    }
+    print_event(walk->header, ev);
+    walk->printed++;
+    return 0;
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+    const char *module_name = NULL;
+    int seek = 0;
+    int list_chunks = 0;
+    tool_walk_t walk;
+
+    memset(&walk, 0, sizeof(walk));
+    walk.to = UINT64_MAX;
+    walk.module = -1;
+    walk.count = TOOL_DEFAULT_COUNT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            walk.from = strtoull(argv[++i], NULL, 0);
+            seek = 1;
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            walk.to = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            walk.count = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--summary") == 0) {
+            walk.summary = 1;
+        } else if (strcmp(argv[i], "--chunks") == 0) {
+            list_chunks = 1;
+        } else if (strcmp(argv[i], "--module") == 0 && i + 1 < argc) {
+            module_name = argv[++i];
+        } else if (strcmp(argv[i], "--address") == 0 && i + 1 < argc) {
+            walk.address = (uint32_t)strtoul(argv[++i], NULL, 0);
+            walk.has_address = 1;
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL) {
+        printf("Usage: %s FILE [--from VTIME_NS] [--to VTIME_NS] [--count N] [--summary]\n"
+               "       [--chunks] [--module NAME] [--address ADDR]\n", argv[0]);
+        return 1;
+    }
+
+    replay_reader_t *reader = replay_reader_open(path);
+    if (reader == NULL) {
+        return 1;
+    }
+
+    const replay_log_header_t *header = replay_reader_header(reader);
+    const replay_index_entry_t *index;
+    size_t index_count = replay_reader_index(reader, &index);
+    const replay_chunk_info_t *chunks;
+    size_t chunk_count = replay_reader_chunks(reader, &chunks);
+    walk.header = header;
+
+    printf("%s: %u modules, %u ns/trap, snapshot every %u traps, %zu snapshots\n",
+           path, header->module_count, header->trap_ns, header->snapshot_interval, index_count);
+    for (uint32_t i = 0; i < header->module_count; i++) {
+        printf("  module %u: %s\n", i, header->modules[i]);
+        if (module_name != NULL && strcmp(module_name, header->modules[i]) == 0) {
+            walk.module = (int)i;
+        }
+    }
+    if (module_name != NULL && walk.module < 0) {
+        printf("Module %s is not in this log\n", module_name);
+        replay_reader_close(reader);
+        return 1;
+    }
+    if (list_chunks) {
+        print_chunks(header, chunks, chunk_count);
+    }
+
+    replay_event_t ev;
+    int rc = 0;
+
+    if (chunk_count > 0 && (walk.module >= 0 || walk.has_address || walk.to != UINT64_MAX)) {
+        /* Filtered walk: decompress only chunks whose header can match */
+        size_t scanned = 0;
+        int done = 0;
+        for (size_t i = 0; i < chunk_count && !done && rc >= 0; i++) {
+            if (!chunk_selected(&walk, &chunks[i])) {
+                continue;
+            }
+            if (replay_reader_seek_chunk(reader, i) != 0) {
+                rc = -1;
+                break;
+            }
+            scanned++;
+            for (uint32_t n = 0; n < chunks[i].events && !done; n++) {
+                rc = replay_reader_next(reader, &ev);
+                if (rc != 1) {
+                    rc = -1;
+                    break;
+                }
+                done = visit_event(&walk, &ev);
+            }
+        }
+        printf("Decoded %zu of %zu chunks\n", scanned, chunk_count);
+    } else {
+        if (seek) {
+            replay_event_t snapshot;
+            rc = replay_reader_seek(reader, walk.from, &snapshot);
+            if (rc < 0) {
+                printf("Corrupt snapshot in index\n");
+                replay_reader_close(reader);
+                return 1;
+            }
+            if (rc == 1) {
+                printf("Seeked to snapshot at vtime %llu (trap %llu)\n",
+                       (unsigned long long)snapshot.vtime, (unsigned long long)snapshot.trap_seq);
+            }
+        }
+
+        /* Walk events: print up to count from the requested time, tally everything */
+        while ((rc = replay_reader_next(reader, &ev)) == 1) {
+            if (visit_event(&walk, &ev)) {
+                break;
+            }
+        }
+    }
+    if (rc < 0) {
+        printf("Corrupt record, stopped\n");
+    }
+
+    if (walk.summary) {
+        printf("Events from vtime %llu to %llu: %llu traps, %llu inputs, %llu IRQ deliveries, "
+               "%llu raises, %llu snapshots\n",
+               (unsigned long long)walk.from, (unsigned long long)walk.last_vtime,
+               (unsigned long long)walk.totals[REPLAY_EV_TRAP], (unsigned long long)walk.totals[REPLAY_EV_INPUT],
+               (unsigned long long)walk.totals[REPLAY_EV_IRQ], (unsigned long long)walk.totals[REPLAY_EV_RAISE],
+               (unsigned long long)walk.totals[REPLAY_EV_SNAPSHOT]);
+    }
+
+    replay_reader_close(reader);
+    return rc < 0 ? 1 : 0;
+}
@@ -0,0 +1,766 @@
+/**
+ ******************************************************************************
+ * @file    ic_trace_stats.c
+ * @author  IC Simulator Team
+ * @brief   Parallel Trace Analytics Tool
+ * @version V1.0.0
+ * @date    26-July-2025
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 IC Simulator Project.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ *
+ * Usage: ic_trace_stats FILE [--threads N] [--bucket VTIME_NS] [--top N]
+ *
+ * Aggregates a log written by `ic_simulator --record FILE`: register accesses
+ * per device, inter-access time distribution per device, the hottest register
+ * addresses, interrupt rate over virtual time and the longest polling loops
+ * (back-to-back reads of one register).
+ *
+ * Each worker thread opens its own reader on the log (its own mapping of the
+ * file and scan of the chunk index) and pulls compressed chunks one at a time.
+ * Workers aggregate into their own mergeable sketches (log-linear histograms,
+ * a count-min sketch, per-bucket counters). What depends on where chunks end
+ * (the gap to the previous access of a device, a polling loop spanning chunks,
+ * each chunk's heavy-hitter candidates) is recorded per chunk and combined in
+ * chunk order after the workers finish, so the report does not depend on the
+ * number of threads.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "sim_interface/replay_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define STATS_MAX_THREADS       64U
+#define STATS_DEFAULT_BUCKET_NS 1000000ULL  /* Interrupt rate bucket: 1 ms of vtime */
+#define STATS_MAX_BUCKETS       (1U << 20)  /* Buckets widen to stay under this */
+#define STATS_REPORT_ROWS       20U         /* Interrupt rate rows printed */
+#define STATS_DEFAULT_TOP       10U
+#define STATS_MAX_TOP           64U
+
+/* Log-linear histogram: exact below 16, then 16 sub-buckets per power of two */
+#define STATS_HIST_SUB_BITS     4U
+#define STATS_HIST_SUB          (1U << STATS_HIST_SUB_BITS)
+#define STATS_HIST_BUCKETS      (64U * STATS_HIST_SUB)
+
+/* Count-min sketch over register addresses */
+#define STATS_CMS_DEPTH         4U
+#define STATS_CMS_WIDTH_BITS    12U
+#define STATS_CMS_WIDTH         (1U << STATS_CMS_WIDTH_BITS)
+#define STATS_CANDIDATES        16U         /* Heavy-hitter candidates kept per chunk */
+#define STATS_CHUNK_ADDR_BITS   8U
+#define STATS_CHUNK_ADDRS       (1U << STATS_CHUNK_ADDR_BITS)   /* Register words counted exactly per chunk */
+#define STATS_MAX_HOT           4096U       /* Distinct candidates re-estimated at the end */
+
+#define STATS_NO_VTIME          UINT64_MAX
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+    uint64_t counts[STATS_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} stats_hist_t;
+
+typedef struct {
+    uint64_t rows[STATS_CMS_DEPTH][STATS_CMS_WIDTH];
+} stats_cms_t;
+
+typedef struct {
+    uint32_t address;
+    uint8_t module;
+    uint64_t estimate;
+} stats_candidate_t;
+
+/* Exact access count of one register word within a chunk */
+typedef struct {
+    uint32_t address;
+    uint32_t count;
+    uint8_t module;
+} stats_addr_count_t;
+
+/* A run of back-to-back reads of one register from one thread slot */
+typedef struct {
+    uint32_t address;
+    uint8_t module;
+    uint8_t slot;
+    uint64_t length;
+    uint64_t vtime_start;
+    uint64_t vtime_end;
+} stats_run_t;
+
+/* What a chunk leaves for the stitching pass */
+typedef struct {
+    uint64_t first_vtime[REPLAY_MAX_MODULES];   /* First/last access per module */
+    uint64_t last_vtime[REPLAY_MAX_MODULES];
+    stats_run_t lead;           /* Run containing the chunk's first trap */
+    stats_run_t tail;           /* Run still open at the chunk's end */
+    int whole;                  /* The chunk is a single run (or has no traps) */
+    stats_candidate_t candidates[STATS_CANDIDATES];    /* Most accessed registers */
+} stats_chunk_t;
+
+typedef struct stats_ctx stats_ctx_t;
+
+typedef struct {
+    pthread_t thread;
+    stats_ctx_t *ctx;
+    replay_reader_t *reader;
+    uint64_t reads[REPLAY_MAX_MODULES];
+    uint64_t writes[REPLAY_MAX_MODULES];
+    uint64_t inputs;
+    uint64_t events;
+    stats_hist_t *gaps;         /* One per module */
+    stats_cms_t *cms;
+    stats_addr_count_t addrs[STATS_CHUNK_ADDRS];   /* Open addressing on the register word */
+    uint64_t *raised;           /* Per vtime bucket */
+    uint64_t *delivered;
+    stats_run_t top[STATS_MAX_TOP];
+    int rc;
+} stats_worker_t;
+
+struct stats_ctx {
+    const char *path;
+    const replay_log_header_t *header;
+    const replay_chunk_info_t *chunks;
+    size_t chunk_count;
+    stats_chunk_t *chunk_state;
+    size_t next_chunk;          /* Shared work counter */
+    uint64_t bucket_ns;
+    size_t bucket_count;
+    uint32_t top;
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned hist_index(uint64_t v)
+{
+    if (v < STATS_HIST_SUB) {
+        return (unsigned)v;
+    }
+    unsigned e = 63U - (unsigned)__builtin_clzll(v);
+    unsigned m = (unsigned)(v >> (e - STATS_HIST_SUB_BITS)) & (STATS_HIST_SUB - 1U);
+    return (e - STATS_HIST_SUB_BITS + 1U) * STATS_HIST_SUB + m;
+}
+
+static uint64_t hist_value(unsigned idx)
+{
+    if (idx < STATS_HIST_SUB) {
+        return idx;
+    }
+    unsigned e = idx / STATS_HIST_SUB + STATS_HIST_SUB_BITS - 1U;
+    uint64_t m = idx % STATS_HIST_SUB;
+    return (STATS_HIST_SUB + m) << (e - STATS_HIST_SUB_BITS);
+}
+
+static void hist_add(stats_hist_t *h, uint64_t v)
+{
+    h->counts[hist_index(v)]++;
+    h->total++;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+static void hist_merge(stats_hist_t *dst, const stats_hist_t *src)
+{
+    for (unsigned i = 0; i < STATS_HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+/**
+ * @brief  Lower bound of the bucket holding the given percentile
+ */
+static uint64_t hist_percentile(const stats_hist_t *h, double pct)
+{
+    uint64_t rank = (uint64_t)((double)h->total * pct / 100.0);
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < STATS_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen > rank) {
+            return hist_value(i);
+        }
+    }
+    return h->max;
+}
+
+static uint32_t cms_hash(uint32_t address, unsigned row)
+{
+    static const uint32_t seeds[STATS_CMS_DEPTH] = { 0x9E3779B1U, 0x85EBCA77U, 0xC2B2AE3DU, 0x27D4EB2FU };
+    return ((address >> 2) * seeds[row]) >> (32U - STATS_CMS_WIDTH_BITS);
+}
+
+static void cms_add(stats_cms_t *cms, uint32_t address)
+{
+    for (unsigned row = 0; row < STATS_CMS_DEPTH; row++) {
+        cms->rows[row][cms_hash(address, row)]++;
+    }
+}
+
+static uint64_t cms_estimate(const stats_cms_t *cms, uint32_t address)
+{
+    uint64_t estimate = UINT64_MAX;
+    for (unsigned row = 0; row < STATS_CMS_DEPTH; row++) {
+        uint64_t c = cms->rows[row][cms_hash(address, row)];
+        if (c < estimate) {
+            estimate = c;
+        }
+    }
+    return estimate;
+}
+
+/**
+ * @brief  Count an access in the chunk's exact per-register table
+ * @note   Register words of one device are dense and few, so the table rarely
+ *         fills; addresses that do not fit are left out of this chunk's count
+ */
+static void addr_count(stats_worker_t *w, uint32_t address, uint8_t module)
+{
+    unsigned i = ((address >> 2) * 0x9E3779B1U) >> (32U - STATS_CHUNK_ADDR_BITS);
+
+    for (unsigned probe = 0; probe < STATS_CHUNK_ADDRS; probe++) {
+        stats_addr_count_t *a = &w->addrs[(i + probe) & (STATS_CHUNK_ADDRS - 1U)];
+        if (a->count == 0) {
+            a->address = address;
+            a->module = module;
+        } else if (a->address != address) {
+            continue;
+        }
+        a->count++;
+        return;
+    }
+}
+
+/* Heavier first, ties by address */
+static int candidate_before(const stats_candidate_t *a, const stats_candidate_t *b)
+{
+    return a->estimate != b->estimate ? a->estimate > b->estimate : a->address < b->address;
+}
+
+/**
+ * @brief  Insert a candidate into a table sorted by candidate_before, keeping n
+ */
+static void candidate_insert(stats_candidate_t *table, uint32_t n, const stats_candidate_t *c)
+{
+    if (n == 0 || (table[n - 1].estimate && !candidate_before(c, &table[n - 1]))) {
+        return;
+    }
+    uint32_t i = n - 1;
+    while (i > 0 && (table[i - 1].estimate == 0 || candidate_before(c, &table[i - 1]))) {
+        table[i] = table[i - 1];
+        i--;
+    }
+    table[i] = *c;
+}
+
+/**
+ * @brief  Keep the chunk's most accessed registers as heavy-hitter candidates
+ */
+static void chunk_candidates(stats_worker_t *w, stats_chunk_t *cs)
+{
+    memset(cs->candidates, 0, sizeof(cs->candidates));
+    for (unsigned i = 0; i < STATS_CHUNK_ADDRS; i++) {
+        const stats_addr_count_t *a = &w->addrs[i];
+        if (a->count) {
+            stats_candidate_t c = { a->address, a->module, a->count };
+            candidate_insert(cs->candidates, STATS_CANDIDATES, &c);
+        }
+    }
+    memset(w->addrs, 0, sizeof(w->addrs));
+}
+
+/* Longer first, ties by start time, then address and slot */
+static int run_before(const stats_run_t *a, const stats_run_t *b)
+{
+    if (a->length != b->length) {
+        return a->length > b->length;
+    }
+    if (a->vtime_start != b->vtime_start) {
+        return a->vtime_start < b->vtime_start;
+    }
+    if (a->address != b->address) {
+        return a->address < b->address;
+    }
+    return a->slot < b->slot;
+}
+
+/**
+ * @brief  Insert a finished run into a top-N table sorted by run_before
+ */
+static void run_offer(stats_run_t *top, uint32_t n, const stats_run_t *run)
+{
+    if (run->length < 2 || n == 0 || !run_before(run, &top[n - 1])) {
+        return;
+    }
+    uint32_t i = n - 1;
+    while (i > 0 && run_before(run, &top[i - 1])) {
+        top[i] = top[i - 1];
+        i--;
+    }
+    top[i] = *run;
+}
+
+static size_t bucket_of(const stats_ctx_t *ctx, uint64_t vtime)
+{
+    size_t b = (size_t)(vtime / ctx->bucket_ns);
+    return b < ctx->bucket_count ? b : ctx->bucket_count - 1;
+}
+
+/**
+ * @brief  Aggregate up to limit events from the reader's current position
+ * @param  cs: Boundary state of the chunk being processed
+ */
+static int process_events(stats_worker_t *w, uint64_t limit, stats_chunk_t *cs)
+{
+    const stats_ctx_t *ctx = w->ctx;
+    uint64_t last[REPLAY_MAX_MODULES];
+    stats_run_t cur;
+    int in_lead = 1;
+    replay_event_t ev;
+
+    for (unsigned m = 0; m < REPLAY_MAX_MODULES; m++) {
+        last[m] = STATS_NO_VTIME;
+        cs->first_vtime[m] = STATS_NO_VTIME;
+    }
+    memset(&cur, 0, sizeof(cur));
+    memset(&cs->lead, 0, sizeof(cs->lead));
+    memset(&cs->tail, 0, sizeof(cs->tail));
+
+    for (uint64_t n = 0; n < limit; n++) {
+        int rc = replay_reader_next(w->reader, &ev);
+        if (rc == 0 && limit == UINT64_MAX) {
+            break;
+        }
+        if (rc != 1) {
+            return -1;
+        }
+        w->events++;
+
+        switch (ev.type) {
+            case REPLAY_EV_TRAP: {
+                uint8_t m = ev.module;
+                if (ev.is_write) {
+                    w->writes[m]++;
+                } else {
+                    w->reads[m]++;
+                }
+                if (last[m] == STATS_NO_VTIME) {
+                    cs->first_vtime[m] = ev.vtime;
+                } else {
+                    hist_add(&w->gaps[m], ev.vtime - last[m]);
+                }
+                last[m] = ev.vtime;
+                cms_add(w->cms, ev.address);
+                addr_count(w, ev.address, m);
+
+                /* Polling loops: runs of reads of one register from one slot */
+                if (!ev.is_write && cur.length && cur.address == ev.address && cur.slot == ev.slot) {
+                    cur.length++;
+                    cur.vtime_end = ev.vtime;
+                    break;
+                }
+                if (in_lead) {
+                    cs->lead = cur;
+                    in_lead = cur.length == 0 && !ev.is_write;
+                } else {
+                    run_offer(w->top, ctx->top, &cur);
+                }
+                memset(&cur, 0, sizeof(cur));
+                if (!ev.is_write) {
+                    cur.address = ev.address;
+                    cur.module = m;
+                    cur.slot = ev.slot;
+                    cur.length = 1;
+                    cur.vtime_start = ev.vtime;
+                    cur.vtime_end = ev.vtime;
+                }
+                break;
+            }
+            case REPLAY_EV_INPUT:
+                w->inputs++;
+                break;
+            case REPLAY_EV_IRQ:
+                w->delivered[bucket_of(ctx, ev.vtime)]++;
+                break;
+            case REPLAY_EV_RAISE:
+                w->raised[bucket_of(ctx, ev.vtime)]++;
+                break;
+            case REPLAY_EV_SNAPSHOT:
+                break;
+        }
+    }
+
+    for (unsigned m = 0; m < REPLAY_MAX_MODULES; m++) {
+        cs->last_vtime[m] = last[m];
+    }
+    cs->whole = in_lead;
+    if (in_lead) {
+        cs->lead = cur;
+    } else {
+        cs->tail = cur;
+    }
+    chunk_candidates(w, cs);
+    return 0;
+}
+
+static void *worker_main(void *arg)
+{
+    stats_worker_t *w = (stats_worker_t *)arg;
+    stats_ctx_t *ctx = w->ctx;
+
+    for (;;) {
+        size_t i = __atomic_fetch_add(&ctx->next_chunk, 1, __ATOMIC_RELAXED);
+        if (i >= ctx->chunk_count) {
+            break;
+        }
+        if (replay_reader_seek_chunk(w->reader, i) != 0 ||
+            process_events(w, ctx->chunks[i].events, &ctx->chunk_state[i]) != 0) {
+            printf("Corrupt chunk #%zu at offset %llu\n", i, (unsigned long long)ctx->chunks[i].offset);
+            w->rc = -1;
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int worker_init(stats_worker_t *w, stats_ctx_t *ctx)
+{
+    memset(w, 0, sizeof(*w));
+    w->ctx = ctx;
+    w->reader = replay_reader_open(ctx->path);
+    w->gaps = calloc(REPLAY_MAX_MODULES, sizeof(stats_hist_t));
+    w->cms = calloc(1, sizeof(stats_cms_t));
+    w->raised = calloc(ctx->bucket_count, sizeof(uint64_t));
+    w->delivered = calloc(ctx->bucket_count, sizeof(uint64_t));
+    return (w->reader && w->gaps && w->cms && w->raised && w->delivered) ? 0 : -1;
+}
+
+static void worker_free(stats_worker_t *w)
+{
+    replay_reader_close(w->reader);
+    free(w->gaps);
+    free(w->cms);
+    free(w->raised);
+    free(w->delivered);
+}
+
+static int run_same(const stats_run_t *a, const stats_run_t *b)
+{
+    return a->length && b->length && a->address == b->address && a->slot == b->slot;
+}
+
+/**
+ * @brief  Merge worker w into the totals held by worker 0
+ */
+static void worker_merge(stats_worker_t *dst, const stats_worker_t *w, uint32_t top)
+{
+    const stats_ctx_t *ctx = dst->ctx;
+
+    for (unsigned m = 0; m < REPLAY_MAX_MODULES; m++) {
+        dst->reads[m] += w->reads[m];
+        dst->writes[m] += w->writes[m];
+        hist_merge(&dst->gaps[m], &w->gaps[m]);
+    }
+    dst->inputs += w->inputs;
+    dst->events += w->events;
+    for (unsigned row = 0; row < STATS_CMS_DEPTH; row++) {
+        for (unsigned i = 0; i < STATS_CMS_WIDTH; i++) {
+            dst->cms->rows[row][i] += w->cms->rows[row][i];
+        }
+    }
+    for (size_t b = 0; b < ctx->bucket_count; b++) {
+        dst->raised[b] += w->raised[b];
+        dst->delivered[b] += w->delivered[b];
+    }
+    for (uint32_t i = 0; i < top; i++) {
+        run_offer(dst->top, top, &w->top[i]);
+    }
+}
+
+/**
+ * @brief  Add what crosses chunk boundaries: gaps to the previous chunk's last
+ *         access of each device, and polling loops spanning chunks
+ */
+static void stitch_chunks(stats_worker_t *total, const stats_ctx_t *ctx)
+{
+    uint64_t last[REPLAY_MAX_MODULES];
+    stats_run_t carry;
+
+    for (unsigned m = 0; m < REPLAY_MAX_MODULES; m++) {
+        last[m] = STATS_NO_VTIME;
+    }
+    memset(&carry, 0, sizeof(carry));
+
+    for (size_t i = 0; i < ctx->chunk_count; i++) {
+        const stats_chunk_t *cs = &ctx->chunk_state[i];
+        for (unsigned m = 0; m < REPLAY_MAX_MODULES; m++) {
+            if (cs->first_vtime[m] == STATS_NO_VTIME) {
+                continue;
+            }
+            if (last[m] != STATS_NO_VTIME) {
+                hist_add(&total->gaps[m], cs->first_vtime[m] - last[m]);
+            }
+            last[m] = cs->last_vtime[m];
+        }
+
+        stats_run_t lead = cs->lead;
+        if (run_same(&carry, &lead)) {
+            carry.length += lead.length;
+            carry.vtime_end = lead.vtime_end;
+        } else if (cs->whole && lead.length == 0) {
+            continue;   /* No traps in this chunk: the carried run stays open */
+        } else {
+            run_offer(total->top, ctx->top, &carry);
+            carry = lead;
+        }
+        if (!cs->whole) {
+            run_offer(total->top, ctx->top, &carry);
+            carry = cs->tail;
+        }
+    }
+    run_offer(total->top, ctx->top, &carry);
+}
+
+static const char *module_name(const stats_ctx_t *ctx, uint8_t module)
+{
+    return module < ctx->header->module_count ? ctx->header->modules[module] : "?";
+}
+
+static void print_report(stats_worker_t *total, const stats_ctx_t *ctx)
+{
+    printf("\nAccesses by device (inter-access gap in vtime ns):\n");
+    printf("  %-8s %12s %12s %10s %10s %10s %12s\n", "module", "reads", "writes", "gap p50", "gap p90", "gap p99", "gap max");
+    for (uint32_t m = 0; m < ctx->header->module_count; m++) {
+        const stats_hist_t *h = &total->gaps[m];
+        printf("  %-8s %12llu %12llu %10llu %10llu %10llu %12llu\n", ctx->header->modules[m],
+               (unsigned long long)total->reads[m], (unsigned long long)total->writes[m],
+               (unsigned long long)hist_percentile(h, 50.0), (unsigned long long)hist_percentile(h, 90.0),
+               (unsigned long long)hist_percentile(h, 99.0), (unsigned long long)h->max);
+    }
+
+    /* Heavy hitters: union of the chunks' candidates, re-estimated on the merged sketch */
+    size_t chunks = ctx->chunk_count ? ctx->chunk_count : 1;
+    stats_candidate_t *hot = calloc(STATS_MAX_HOT, sizeof(*hot));
+    stats_candidate_t top[STATS_MAX_TOP];
+    uint32_t hot_count = 0;
+    memset(top, 0, sizeof(top));
+    for (size_t k = 0; k < chunks && hot; k++) {
+        for (unsigned i = 0; i < STATS_CANDIDATES; i++) {
+            const stats_candidate_t *c = &ctx->chunk_state[k].candidates[i];
+            uint32_t j = 0;
+            if (c->estimate == 0) {
+                break;
+            }
+            while (j < hot_count && hot[j].address != c->address) {
+                j++;
+            }
+            if (j == hot_count && hot_count < STATS_MAX_HOT) {
+                hot[hot_count] = *c;
+                hot[hot_count].estimate = cms_estimate(total->cms, c->address);
+                candidate_insert(top, ctx->top, &hot[hot_count]);
+                hot_count++;
+            }
+        }
+    }
+    free(hot);
+    printf("\nHottest registers (count-min estimate):\n");
+    for (uint32_t i = 0; i < ctx->top && top[i].estimate; i++) {
+        printf("  0x%08X  %-8s %12llu\n", top[i].address, module_name(ctx, top[i].module),
+               (unsigned long long)top[i].estimate);
+    }
+
+    /* Interrupt rate, coalesced to at most STATS_REPORT_ROWS rows */
+    uint64_t raised = 0, delivered = 0, peak = 0;
+    size_t peak_bucket = 0;
+    for (size_t b = 0; b < ctx->bucket_count; b++) {
+        raised += total->raised[b];
+        delivered += total->delivered[b];
+        if (total->raised[b] > peak) {
+            peak = total->raised[b];
+            peak_bucket = b;
+        }
+    }
+    size_t per_row = (ctx->bucket_count + STATS_REPORT_ROWS - 1) / STATS_REPORT_ROWS;
+    printf("\nInterrupts: %llu raised, %llu delivered; peak %llu raised in [%llu, %llu) ns\n",
+           (unsigned long long)raised, (unsigned long long)delivered, (unsigned long long)peak,
+           (unsigned long long)(peak_bucket * ctx->bucket_ns),
+           (unsigned long long)((peak_bucket + 1) * ctx->bucket_ns));
+    for (size_t b = 0; b < ctx->bucket_count && raised + delivered; b += per_row) {
+        uint64_t r = 0, d = 0;
+        size_t end = b + per_row < ctx->bucket_count ? b + per_row : ctx->bucket_count;
+        for (size_t k = b; k < end; k++) {
+            r += total->raised[k];
+            d += total->delivered[k];
+        }
+        double seconds = (double)((end - b) * ctx->bucket_ns) / 1e9;
+        printf("  [%12llu, %12llu) ns  %8llu raised %8llu delivered  %10.0f IRQ/s\n",
+               (unsigned long long)(b * ctx->bucket_ns), (unsigned long long)(end * ctx->bucket_ns),
+               (unsigned long long)r, (unsigned long long)d, (double)r / seconds);
+    }
+
+    printf("\nLongest polling loops (back-to-back reads of one register):\n");
+    for (uint32_t i = 0; i < ctx->top && total->top[i].length; i++) {
+        const stats_run_t *run = &total->top[i];
+        printf("  %10llu reads  0x%08X %-8s slot %c%-3u vtime %llu..%llu\n",
+               (unsigned long long)run->length, run->address, module_name(ctx, run->module),
+               (run->slot & REPLAY_SLOT_ISR) ? 'i' : ' ', run->slot & 0x7FU,
+               (unsigned long long)run->vtime_start, (unsigned long long)run->vtime_end);
+    }
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    stats_ctx_t ctx;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned threads = cores > 0 ? (unsigned)cores : 1U;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.bucket_ns = STATS_DEFAULT_BUCKET_NS;
+    ctx.top = STATS_DEFAULT_TOP;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (unsigned)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--bucket") == 0 && i + 1 < argc) {
+            ctx.bucket_ns = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            ctx.top = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (ctx.path == NULL && argv[i][0] != '-') {
+            ctx.path = argv[i];
+        } else {
+            ctx.path = NULL;
+            break;
+        }
+    }
+    if (ctx.path == NULL || ctx.bucket_ns == 0) {
+        printf("Usage: %s FILE [--threads N] [--bucket VTIME_NS] [--top N]\n", argv[0]);
+        return 1;
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (threads > STATS_MAX_THREADS) {
+        threads = STATS_MAX_THREADS;
+    }
+    if (ctx.top > STATS_MAX_TOP) {
+        ctx.top = STATS_MAX_TOP;
+    }
+
+    replay_reader_t *reader = replay_reader_open(ctx.path);
+    if (reader == NULL) {
+        return 1;
+    }
+    ctx.header = replay_reader_header(reader);
+    ctx.chunk_count = replay_reader_chunks(reader, &ctx.chunks);
+
+    /* Size the interrupt rate buckets from the chunk headers' vtime range */
+    uint64_t vtime_end = ctx.chunk_count ? ctx.chunks[ctx.chunk_count - 1].vtime_last : 0;
+    uint64_t raw_bytes = 0, stored_bytes = 0;
+    for (size_t i = 0; i < ctx.chunk_count; i++) {
+        raw_bytes += ctx.chunks[i].raw_len;
+        stored_bytes += ctx.chunks[i].stored_len;
+    }
+    while (vtime_end / ctx.bucket_ns + 1 > STATS_MAX_BUCKETS) {
+        ctx.bucket_ns *= 2;
+    }
+    ctx.bucket_count = (size_t)(vtime_end / ctx.bucket_ns) + 1;
+
+    /* Version 1 logs have no chunks: one worker walks the whole stream */
+    if (ctx.chunk_count == 0) {
+        threads = 1;
+    } else if (threads > ctx.chunk_count) {
+        threads = (unsigned)ctx.chunk_count;
+    }
+    stats_chunk_t single;
+    ctx.chunk_state = ctx.chunk_count ? calloc(ctx.chunk_count, sizeof(stats_chunk_t)) : &single;
+    stats_worker_t *workers = calloc(threads, sizeof(stats_worker_t));
+    int rc = (ctx.chunk_state && workers) ? 0 : -1;
+    for (unsigned t = 0; t < threads && rc == 0; t++) {
+        rc = worker_init(&workers[t], &ctx);
+    }
+    if (rc != 0) {
+        printf("Failed to set up %u workers\n", threads);
+        return 1;
+    }
+
+    uint64_t start = monotonic_ns();
+    if (ctx.chunk_count == 0) {
+        rc = process_events(&workers[0], UINT64_MAX, &single);
+        single.whole = 0;
+        run_offer(workers[0].top, ctx.top, &single.lead);
+        run_offer(workers[0].top, ctx.top, &single.tail);
+    } else {
+        for (unsigned t = 1; t < threads; t++) {
+            if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) {
+                workers[t].rc = -1;
+                workers[t].thread = 0;
+            }
+        }
+        worker_main(&workers[0]);
+        for (unsigned t = 1; t < threads; t++) {
+            if (workers[t].thread) {
+                pthread_join(workers[t].thread, NULL);
+            }
+            if (workers[t].rc != 0) {
+                rc = -1;
+            }
+        }
+        rc |= workers[0].rc;
+        for (unsigned t = 1; t < threads; t++) {
+            worker_merge(&workers[0], &workers[t], ctx.top);
+        }
+        stitch_chunks(&workers[0], &ctx);
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+
+    printf("%s: %u modules, %zu chunks, %llu events, %llu event bytes (%llu stored)\n",
+           ctx.path, ctx.header->module_count, ctx.chunk_count, (unsigned long long)workers[0].events,
+           (unsigned long long)raw_bytes, (unsigned long long)stored_bytes);
+    print_report(&workers[0], &ctx);
+    printf("\nAnalyzed in %.3f ms on %u threads: %.1f MB/s of events (%.1f MB/s stored)\n",
+           (double)elapsed / 1e6, threads,
+           elapsed ? (double)raw_bytes * 1e3 / (double)elapsed : 0.0,
+           elapsed ? (double)stored_bytes * 1e3 / (double)elapsed : 0.0);
+
+    for (unsigned t = 0; t < threads; t++) {
+        worker_free(&workers[t]);
+    }
+    free(workers);
+    if (ctx.chunk_count) {
+        free(ctx.chunk_state);
+    }
+    replay_reader_close(reader);
+    if (rc != 0) {
+        printf("Corrupt record, report is partial\n");
+    }
+    return rc != 0 ? 1 : 0;
+}